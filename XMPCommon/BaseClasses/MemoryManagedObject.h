@@ -14,6 +14,7 @@
 
 namespace XMP_COMPONENT_INT_NAMESPACE {
 	using AdobeXMPCommon::pIMemoryAllocator;
+	class MemoryArena;
 	//!
 	//! \brief class which serves as the base class for all internal concrete classes.
 	//! \details Provides all the concrete classes with a set of new/delete functions which internally
@@ -28,6 +29,9 @@ namespace XMP_COMPONENT_INT_NAMESPACE {
 		void * operator new( std::size_t, const std::nothrow_t & ) __NOTHROW__;
 		void * operator new( std::size_t, void * ptr ) __NOTHROW__;
 
+		//! allocates the object from a memory arena, or from the library's allocator if arena is NULL.
+		void * operator new( std::size_t, MemoryArena * arena );
+
 		void * operator new[]( std::size_t );
 		void * operator new[]( std::size_t, const std::nothrow_t & ) __NOTHROW__;
 		void * operator new[]( std::size_t, void * ptr ) __NOTHROW__;
@@ -35,6 +39,7 @@ namespace XMP_COMPONENT_INT_NAMESPACE {
 		void operator delete( void * ptr ) throw ();
 		void operator delete( void * ptr, const std::nothrow_t & ) __NOTHROW__;
 		void operator delete( void * ptr, void * voidptr2 ) __NOTHROW__;
+		void operator delete( void * ptr, MemoryArena * arena ) __NOTHROW__;
 
 		void operator delete[]( void * ptr ) throw ();
 		void operator delete[]( void * ptr, const std::nothrow_t & ) __NOTHROW__;
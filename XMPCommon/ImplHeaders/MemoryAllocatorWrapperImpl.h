@@ -23,6 +23,9 @@ namespace XMP_COMPONENT_INT_NAMESPACE {
 		MemoryAllocatorWrapperImpl();
 		pIMemoryAllocator_base SetMemoryAllocator( pIMemoryAllocator_base memoryAllocator );
 
+		// allocates from the given allocator, deallocate and reallocate send the block back to it.
+		void * AllocateFrom( pIMemoryAllocator_base allocator, sizet size ) __NOTHROW__;
+
 		virtual void * APICALL allocate( sizet size ) __NOTHROW__;
 		virtual void APICALL deallocate( void * ptr ) __NOTHROW__;
 		virtual void * APICALL reallocate( void * ptr, sizet size ) __NOTHROW__;
@@ -39,6 +39,13 @@ namespace XMP_COMPONENT_INT_NAMESPACE {
 		//!
 		static pIMemoryAllocator SetMemoryAllocator( pIMemoryAllocator_base memoryAllocator ) __NOTHROW__;
 
+		//!
+		//! Allocate a block from a specific allocator instead of the current one. The block is freed
+		//! as usual through the allocator returned by GetMemoryAllocator(), which hands it back to
+		//! the allocator it came from.
+		//!
+		static void * AllocateFrom( pIMemoryAllocator_base memoryAllocator, sizet size ) __NOTHROW__;
+
 
 	protected:
 		~IMemoryAllocator_I() {}
@@ -0,0 +1,93 @@
+#ifndef __MemoryArena_h__
+#define __MemoryArena_h__ 1
+
+// =================================================================================================
+// Copyright Adobe
+// Copyright 2026 Adobe
+// All Rights Reserved
+//
+// NOTICE: Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it.
+// =================================================================================================
+
+#include "XMPCommon/XMPCommonFwdDeclarations_I.h"
+#include "XMPCommon/Interfaces/IMemoryAllocator.h"
+#include "XMPCommon/BaseClasses/MemoryManagedObject.h"
+#include "XMPCommon/Interfaces/ISharedMutex.h"
+#include "XMPCommon/Utilities/TAtomicTypes.h"
+
+namespace XMP_COMPONENT_INT_NAMESPACE {
+
+	//!
+	//! \brief Monotonic memory allocator backing all the objects of a single document.
+	//! \details Memory is handed out from large chunks by bumping a pointer. Individual deallocations only
+	//! decrement the count of outstanding blocks; the chunks are returned to the library's allocator in one
+	//! step once the owner has called Release() and every block handed out has been deallocated.
+	//! Only the objects explicitly created from an arena, see MemoryManagedObject::operator new( std::size_t, pMemoryArena ),
+	//! draw their memory from it; everything else keeps using the library's allocator.
+	//! \attention Allocation and reallocation are serialized by a lock, deallocation can be done from any thread.
+	//!
+	class MemoryArena
+		: public virtual IMemoryAllocator
+		, public MemoryManagedObject
+	{
+	public:
+		static const sizet kDefaultChunkSize = 8 * 1024;
+		static const sizet kMaxChunkSize = 256 * 1024;
+
+		//!
+		//! Creates a new arena owned by the caller.
+		//! \param[in] initialChunkSize size in bytes of the first chunk; later chunks double in size.
+		//! \return a pointer to the arena. Owner should call Release() once it no longer needs it.
+		//!
+		static MemoryArena * CreateMemoryArena( sizet initialChunkSize = kDefaultChunkSize );
+
+		//!
+		//! Gives up the ownership of the arena.
+		//! \details Memory is returned once all the blocks handed out by the arena are deallocated.
+		//!
+		void Release() __NOTHROW__;
+
+		//!
+		//! Takes one more share of the ownership of the arena, given up by a matching call to Release().
+		//!
+		void Acquire() __NOTHROW__;
+
+		//!
+		//! Total number of bytes reserved from the library's allocator by this arena.
+		//!
+		sizet GetReservedSize() const __NOTHROW__ { return mReservedSize; }
+
+		virtual void * APICALL allocate( sizet size ) __NOTHROW__;
+		virtual void APICALL deallocate( void * ptr ) __NOTHROW__;
+		virtual void * APICALL reallocate( void * ptr, sizet size ) __NOTHROW__;
+
+	protected:
+		MemoryArena( sizet initialChunkSize );
+		virtual ~MemoryArena() __NOTHROW__;
+
+		struct Chunk {
+			Chunk *			mNext;
+			sizet			mSize;
+		};
+
+		bool AddChunk( sizet minimumSize ) __NOTHROW__;
+		void * AllocateBlock( sizet size ) __NOTHROW__;
+		void DecrementCount() __NOTHROW__;
+
+		Chunk *				mChunks;
+		XMP_Uns8 *			mCurrent;
+		XMP_Uns8 *			mEnd;
+		sizet				mNextChunkSize;
+		sizet				mReservedSize;
+		atomic_sizet		mCount;
+		spISharedMutex		mSharedMutex;
+
+	private:
+		MemoryArena( const MemoryArena & );
+		MemoryArena & operator = ( const MemoryArena & );
+	};
+
+}
+
+#endif  // __MemoryArena_h__
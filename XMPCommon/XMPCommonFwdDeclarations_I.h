@@ -79,6 +79,10 @@ namespace XMP_COMPONENT_INT_NAMESPACE {
 	typedef shared_ptr< IConfigurable_I >												spIConfigurable_I;
 	typedef shared_ptr< const IConfigurable_I >											spcIConfigurable_I;
 
+	// MemoryArena
+	class MemoryArena;
+	typedef MemoryArena *																pMemoryArena;
+
 	// ISharedMutex
 	class ISharedMutex;
 	typedef ISharedMutex *																pISharedMutex;
@@ -23,4 +23,8 @@ namespace XMP_COMPONENT_INT_NAMESPACE {
 		return sDefaultMemoryAllocator.SetMemoryAllocator( memoryAllocator );
 	}
 
+	void * IMemoryAllocator_I::AllocateFrom( pIMemoryAllocator_base memoryAllocator, sizet size ) __NOTHROW__ {
+		return sDefaultMemoryAllocator.AllocateFrom( memoryAllocator, size );
+	}
+
 }
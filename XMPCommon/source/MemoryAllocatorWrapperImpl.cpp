@@ -31,16 +31,20 @@ namespace XMP_COMPONENT_INT_NAMESPACE {
 	}
 
 	void * APICALL MemoryAllocatorWrapperImpl::allocate( sizet size ) __NOTHROW__ {
+		return AllocateFrom( mpMemoryAllocator, size );
+	}
+
+	void * MemoryAllocatorWrapperImpl::AllocateFrom( pIMemoryAllocator_base allocator, sizet size ) __NOTHROW__ {
 		size_t actualSize = size + kOFFSET;
 		void * memPtr = NULL;
-		if ( mpMemoryAllocator )
-			memPtr = mpMemoryAllocator->allocate( actualSize );
+		if ( allocator )
+			memPtr = allocator->allocate( actualSize );
 		else
 			memPtr = malloc( actualSize );
 
 		if ( memPtr ) {
 			IMemoryAllocator ** address = ( IMemoryAllocator ** ) memPtr;
-			*address = mpMemoryAllocator;
+			*address = allocator;
 			return ( XMP_Uns8 * ) memPtr + kOFFSET;
 		}
 		return NULL;
@@ -60,14 +64,16 @@ namespace XMP_COMPONENT_INT_NAMESPACE {
 		size_t actualSize = size + kOFFSET;
 		void * actualMemPtr = ( XMP_Uns8 * ) ptr - kOFFSET;
 		void * memPtr( NULL );
-		if ( mpMemoryAllocator )
-			memPtr = mpMemoryAllocator->reallocate( actualMemPtr, actualSize );
+		// block has to go back to the allocator it came from, which need not be the current one.
+		pIMemoryAllocator allocator = *( ( IMemoryAllocator ** ) actualMemPtr );
+		if ( allocator )
+			memPtr = allocator->reallocate( actualMemPtr, actualSize );
 		else
 			memPtr = realloc( actualMemPtr, actualSize );
 
 		if ( memPtr ) {
 			IMemoryAllocator ** address = ( IMemoryAllocator ** ) memPtr;
-			*address = mpMemoryAllocator;
+			*address = allocator;
 			return ( XMP_Uns8 * ) memPtr + kOFFSET;
 		}
 		return NULL;
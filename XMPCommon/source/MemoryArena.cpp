@@ -0,0 +1,131 @@
+// =================================================================================================
+// Copyright Adobe
+// Copyright 2026 Adobe
+// All Rights Reserved
+//
+// NOTICE: Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it.
+// =================================================================================================
+
+#include "XMPCommon/Utilities/MemoryArena.h"
+#include "XMPCommon/Interfaces/IMemoryAllocator_I.h"
+#include "XMPCommon/Utilities/AutoSharedLock.h"
+
+#include <cstring>
+
+namespace XMP_COMPONENT_INT_NAMESPACE {
+
+	// every block is preceded by its size so that reallocate can copy the old contents.
+	static const sizet kAlignment = sizeof( double ) > sizeof( sizet ) ? sizeof( double ) : sizeof( sizet );
+	static const sizet kBlockHeaderSize = kAlignment;
+	static const sizet kChunkHeaderSize = ( ( sizeof( void * ) + sizeof( sizet ) + kAlignment - 1 ) / kAlignment ) * kAlignment;
+
+	static inline sizet AlignUp( sizet size ) {
+		return ( size + kAlignment - 1 ) & ~( kAlignment - 1 );
+	}
+
+	MemoryArena * MemoryArena::CreateMemoryArena( sizet initialChunkSize ) {
+		return new MemoryArena( initialChunkSize );
+	}
+
+	MemoryArena::MemoryArena( sizet initialChunkSize )
+		: mChunks( NULL )
+		, mCurrent( NULL )
+		, mEnd( NULL )
+		, mNextChunkSize( initialChunkSize > 0 ? initialChunkSize : kDefaultChunkSize )
+		, mReservedSize( 0 )
+		, mCount( 1 )
+		, mSharedMutex( ISharedMutex::CreateSharedMutex() ) { }
+
+	MemoryArena::~MemoryArena() __NOTHROW__ {
+		pIMemoryAllocator allocator = IMemoryAllocator_I::GetMemoryAllocator();
+		while ( mChunks ) {
+			Chunk * next = mChunks->mNext;
+			allocator->deallocate( mChunks );
+			mChunks = next;
+		}
+	}
+
+	void MemoryArena::Release() __NOTHROW__ {
+		DecrementCount();
+	}
+
+	void MemoryArena::Acquire() __NOTHROW__ {
+		++mCount;
+	}
+
+	void MemoryArena::DecrementCount() __NOTHROW__ {
+		// every owner holds one count, every live block holds one more.
+		if ( --mCount == 0 )
+			delete this;
+	}
+
+	bool MemoryArena::AddChunk( sizet minimumSize ) __NOTHROW__ {
+		sizet chunkSize = mNextChunkSize;
+		if ( chunkSize < minimumSize )
+			chunkSize = minimumSize;
+
+		void * memPtr = IMemoryAllocator_I::GetMemoryAllocator()->allocate( kChunkHeaderSize + chunkSize );
+		if ( !memPtr ) return false;
+
+		Chunk * chunk = static_cast< Chunk * >( memPtr );
+		chunk->mSize = chunkSize;
+		chunk->mNext = mChunks;
+		mChunks = chunk;
+		mReservedSize += chunkSize;
+
+		mCurrent = static_cast< XMP_Uns8 * >( memPtr ) + kChunkHeaderSize;
+		mEnd = mCurrent + chunkSize;
+		if ( mNextChunkSize < kMaxChunkSize )
+			mNextChunkSize *= 2;
+		return true;
+	}
+
+	void * APICALL MemoryArena::allocate( sizet size ) __NOTHROW__ {
+		AutoSharedLock lock( mSharedMutex, true );
+		return AllocateBlock( size );
+	}
+
+	void * MemoryArena::AllocateBlock( sizet size ) __NOTHROW__ {
+		sizet blockSize = kBlockHeaderSize + AlignUp( size );
+		if ( static_cast< sizet >( mEnd - mCurrent ) < blockSize ) {
+			if ( !AddChunk( blockSize ) )
+				return NULL;
+		}
+		XMP_Uns8 * block = mCurrent;
+		mCurrent += blockSize;
+		*reinterpret_cast< sizet * >( block ) = size;
+		++mCount;
+		return block + kBlockHeaderSize;
+	}
+
+	void APICALL MemoryArena::deallocate( void * ptr ) __NOTHROW__ {
+		// space is only reclaimed when the whole arena goes away, so that blocks can be
+		// deallocated from any thread without locking.
+		if ( ptr ) DecrementCount();
+	}
+
+	void * APICALL MemoryArena::reallocate( void * ptr, sizet size ) __NOTHROW__ {
+		AutoSharedLock lock( mSharedMutex, true );
+		if ( !ptr ) return AllocateBlock( size );
+		XMP_Uns8 * block = static_cast< XMP_Uns8 * >( ptr ) - kBlockHeaderSize;
+		sizet oldSize = *reinterpret_cast< sizet * >( block );
+
+		// grow or shrink in place if it is the last block handed out.
+		if ( block + kBlockHeaderSize + AlignUp( oldSize ) == mCurrent &&
+			static_cast< sizet >( mEnd - block ) >= kBlockHeaderSize + AlignUp( size ) )
+		{
+			*reinterpret_cast< sizet * >( block ) = size;
+			mCurrent = block + kBlockHeaderSize + AlignUp( size );
+			return ptr;
+		}
+
+		void * newPtr = AllocateBlock( size );
+		if ( newPtr ) {
+			memcpy( newPtr, ptr, oldSize < size ? oldSize : size );
+			deallocate( ptr );
+		}
+		return newPtr;
+	}
+
+}
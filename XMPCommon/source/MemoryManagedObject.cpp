@@ -10,6 +10,7 @@
 
 #include "XMPCommon/BaseClasses/MemoryManagedObject.h"
 #include "XMPCommon/Interfaces/IMemoryAllocator_I.h"
+#include "XMPCommon/Utilities/MemoryArena.h"
 
 namespace XMP_COMPONENT_INT_NAMESPACE {
 
@@ -28,6 +29,15 @@ namespace XMP_COMPONENT_INT_NAMESPACE {
 		return ptr;
 	}
 
+	void * MemoryManagedObject::operator new( std::size_t size, MemoryArena * arena ) {
+		if ( !arena )
+			return operator new( size );
+		void * ptr = IMemoryAllocator_I::AllocateFrom( arena, size );
+		if ( ptr )
+			return ptr;
+		throw std::bad_alloc();
+	}
+
 	void * MemoryManagedObject::operator new[]( std::size_t size ) {
 		return operator new( size );
 	}
@@ -52,6 +62,10 @@ namespace XMP_COMPONENT_INT_NAMESPACE {
 		return;
 	}
 
+	void MemoryManagedObject::operator delete( void * ptr, MemoryArena * arena ) throw () {
+		return operator delete( ptr );
+	}
+
 	void MemoryManagedObject::operator delete[]( void * ptr ) throw () {
 		return operator delete( ptr );
 	}
@@ -45,6 +45,7 @@ namespace AdobeXMPCore_Int {
 		virtual spINode APICALL ReplaceNodeAtIndex( const spINode & node, sizet index );
 		virtual void APICALL AppendNode( const spINode & node );
 		virtual spINodeIterator APICALL Iterator();
+		virtual pINode APICALL GetRawNextChildPointer( pcINode child ) __NOTHROW__;
 		virtual sizet APICALL ChildCount() const __NOTHROW__;
 		virtual spIArrayNode APICALL ConvertToArrayNode();
 		virtual eNodeType APICALL GetNodeType() const;
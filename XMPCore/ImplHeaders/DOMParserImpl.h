@@ -47,6 +47,9 @@ namespace AdobeXMPCore_Int {
         using IDOMParser_I::clone;
 		virtual DOMParserImpl * APICALL clone() const = 0;
 
+		// same as ParseAsNode but the nodes are allocated from the arena, parsers not supporting it ignore the arena.
+		virtual spINode APICALL ParseAsNodeUsingMemoryArena( const char * buffer, sizet bufferLength, pMemoryArena arena );
+
 		spISharedMutex				mSharedMutex;
 		XMPMeta::ErrorCallbackInfo *	mGenericErrorCallbackPtr;
 
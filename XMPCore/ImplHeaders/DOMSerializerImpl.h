@@ -39,6 +39,7 @@ namespace AdobeXMPCore_Int {
 		virtual spISharedMutex APICALL GetMutex() const;
 		virtual spIDOMSerializer APICALL Clone() const;
 		virtual spIUTF8String APICALL SerializeInternal(const spINode & node, XMP_OptionBits options, sizet padding, const char * newline, const char * indent, sizet baseIndent, const spcINameSpacePrefixMap & nameSpacePrefixMap) const = 0;
+		virtual bool APICALL SerializeToRegionInternal(const spINode & node, XMP_Uns8 * region, XMP_StringLen regionSize, std::string * overflow, XMP_OptionBits options, const char * newline, const char * indent, sizet baseIndent) const;
 
 	protected:
 		virtual ~DOMSerializerImpl() __NOTHROW__ {}
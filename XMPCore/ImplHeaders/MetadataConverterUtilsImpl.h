@@ -24,10 +24,10 @@
 #include "XMPCommon/Interfaces/IUTF8String_I.h"
 #include "XMPCommon/Utilities/AutoSharedLock.h"
 #include "XMPCommon/Utilities/TSmartPointers_I.h"
-#include "XMPCore/Interfaces/ISimpleNode.h"
-#include "XMPCore/Interfaces/IStructureNode.h"
-#include "XMPCore/Interfaces/IArrayNode.h"
+#include "XMPCore/Interfaces/ISimpleNode_I.h"
+#include "XMPCore/Interfaces/IStructureNode_I.h"
 #include "XMPCore/Interfaces/IArrayNode_I.h"
+#include "XMPCore/Interfaces/IMetadata_I.h"
 #include "XMPCore/Interfaces/IMetadata.h"
 #include "XMPCore/Interfaces/INameSpacePrefixMap.h"
 #include "XMPCore/Interfaces/INameSpacePrefixMap_I.h"
@@ -49,14 +49,22 @@ namespace AdobeXMPCore_Int {
     {
     public:
         MetadataConverterUtilsImpl();
-        static AdobeXMPCore::spIMetadata ConvertOldDOMtoNewDOM(const XMPMeta* inOldMeta);
+        static AdobeXMPCore::spIMetadata ConvertOldDOMtoNewDOM(const XMPMeta* inOldMeta, pMemoryArena arena = NULL);
         static XMPMetaRef ConvertNewDOMtoOldDOM(const AdobeXMPCore::spINode node, const AdobeXMPCore::spcINameSpacePrefixMap & nameSpacePrefixMap ,XMP_OptionBits& options);
+
+        // Zero copy bridge, only available when the old API is backed by the new DOM (XMPMeta2).
+        // Both return an empty value when the document can't be shared and has to be converted.
+        static AdobeXMPCore::spIMetadata ShareOldDOMAsNewDOM( const XMPMeta * inOldMeta );
+        static XMPMetaRef ShareNewDOMAsOldDOM( const AdobeXMPCore::spIMetadata & inNewMeta );
+
+        static spcINameSpacePrefixMap_I MergeWithDefaultNameSpacePrefixMap( const AdobeXMPCore::spcINameSpacePrefixMap & nameSpacePrefixMap );
+        static bool ConvertNewDOMPropertyToOldDOM( const AdobeXMPCore::spINode & property, XMPMeta * xmpObj, const spcINameSpacePrefixMap_I & userSuppliedMap );
         
     protected:
         virtual ~MetadataConverterUtilsImpl() __NOTHROW__ {}
         
     private:
-        static void CreateAndPopulateNode( const AdobeXMPCore::spINode & parentNode, XMP_Node * node, bool nodeIsQualifier = false );
+        static void CreateAndPopulateNode( const AdobeXMPCore::spINode & parentNode, XMP_Node * node, pMemoryArena arena, bool nodeIsQualifier = false );
         static spcIUTF8String CreateQualifiedName( const spINode & node, const spcINameSpacePrefixMap_I & userSuppliedMap, spINameSpacePrefixMap_I & generatedMap );
         static XMP_Node * AddQualifierNode( XMP_Node * xmpParent, const spINode & node, const char * value, const spcINameSpacePrefixMap_I & userSuppliedMap, spINameSpacePrefixMap_I & generatedMap ) ;
         static bool FindPrefixFromUserSuppliedMap ( void * voidUserSuppliedMap, XMP_StringPtr nsURI, XMP_StringPtr * namespacePrefix, XMP_StringLen * prefixSize ) ;
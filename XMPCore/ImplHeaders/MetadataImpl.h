@@ -17,6 +17,10 @@
 
 #include "XMPCore/Interfaces/IMetadata_I.h"
 #include "XMPCore/ImplHeaders/StructureNodeImpl.h"
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
 #if XMP_WinBuild
 	#pragma warning( push )
 	#pragma warning( disable : 4250 )
@@ -32,8 +36,16 @@ namespace AdobeXMPCore_Int {
 		MetadataImpl();
 
 
+		virtual pMemoryArena APICALL GetMemoryArena() const __NOTHROW__;
+		virtual void APICALL AdoptMemoryArena( pMemoryArena arena ) __NOTHROW__;
+		virtual spRDFFragmentCache APICALL GetRDFFragmentCache() const __NOTHROW__;
+		virtual void APICALL SetRDFFragmentCache( const spRDFFragmentCache & cache ) __NOTHROW__;
+		virtual void APICALL AttachSharedView( ISharedMetadataView_I * view ) __NOTHROW__;
+		virtual void APICALL DetachSharedView( ISharedMetadataView_I * view, bool waitForDetach = false ) __NOTHROW__;
+		virtual void APICALL DetachSharedViews();
+
 	protected:
-		virtual ~MetadataImpl() __NOTHROW__ {}
+		virtual ~MetadataImpl() __NOTHROW__;
 
 		virtual spcIUTF8String APICALL GetAboutURI() const;
 		virtual void APICALL SetAboutURI( const char * uri, sizet uriLength ) __NOTHROW__;
@@ -62,6 +74,13 @@ namespace AdobeXMPCore_Int {
 
 		spIUTF8String			mAboutURI;
 		mutable bool			mSupportAliases;
+		pMemoryArena			mMemoryArena;
+		spRDFFragmentCache		mRDFFragmentCache;
+		// The shared mutex of the nodes does no locking, views are attached from any thread.
+		std::mutex								mSharedViewsLock;
+		std::condition_variable					mSharedViewsDetached;
+		std::vector< ISharedMetadataView_I * >	mSharedViews;
+		std::vector< ISharedMetadataView_I * >	mDetachingViews;
 
 	#ifdef FRIEND_CLASS_DECLARATION
 		FRIEND_CLASS_DECLARATION();
@@ -42,6 +42,8 @@ namespace AdobeXMPCore_Int {
 
 		virtual void APICALL ChangeParent( pINode parent );
 		virtual pINode APICALL GetRawParentPointer();
+		virtual pINode APICALL GetRawNextChildPointer( pcINode child ) __NOTHROW__;
+		virtual pINode APICALL GetRawNextQualifierPointer( pcINode qualifier ) __NOTHROW__;
 		virtual spINode APICALL GetParent();
 		virtual void APICALL SetName( const char * name, sizet nameLength );
 		virtual spcIUTF8String APICALL GetName() const;
@@ -68,6 +70,7 @@ namespace AdobeXMPCore_Int {
 		virtual bool APICALL IsQualifierNode() const;
 		virtual sizet APICALL GetIndex() const;
 		virtual void RegisterChange();
+		virtual bool CountChange() __NOTHROW__;
 		virtual eNodeType APICALL GetParentNodeType() const;
 		virtual eNodeType APICALL GetQualifierNodeType( const char * nameSpace, sizet nameSpaceLength, const char * name, sizet nameLength ) const;
 		virtual spISimpleNode APICALL ConvertToSimpleNode();
@@ -85,9 +88,14 @@ namespace AdobeXMPCore_Int {
 		virtual void APICALL ClearContents() = 0;
 		virtual spINode APICALL CloneContents( bool ignoreEmptyNodes, bool ignoreNodesWithOnlyQualifiers, sizet qualifiersCount ) const = 0;
 		virtual void SetQualifiers( const spIStructureNode & node );
+		virtual sizet GetModificationStamp() const __NOTHROW__;
+		virtual sizet GetUnobservedModificationStamp() const __NOTHROW__;
+		virtual void SetModificationStamp( sizet stamp ) __NOTHROW__;
 
 	protected:
 		void updateParentSharedPointer( bool calledFromRelease = false );
+		static void MarkModified( pINode node );
+		void PrepareForModification();
 		virtual void resetChangesForChildren() const = 0;
 		void CreateQualifierNode();
 		virtual ~NodeImpl() __NOTHROW__ {}
@@ -99,6 +107,7 @@ namespace AdobeXMPCore_Int {
 		spINode								mspParent;
 		spIStructureNode					mQualifiers;
 		mutable atomic_sizet				mChangeCount;
+		atomic_sizet						mModificationStamp;
 		bool								mIsQualifierNode;
 
 	#ifdef FRIEND_CLASS_DECLARATION
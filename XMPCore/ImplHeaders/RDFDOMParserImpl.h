@@ -33,6 +33,7 @@ namespace AdobeXMPCore_Int {
 			mGenericErrorCallbackPtr = NULL;
 		}
 		virtual spINode APICALL ParseAsNode( const char * buffer, sizet bufferLength );
+		virtual spINode APICALL ParseAsNodeUsingMemoryArena( const char * buffer, sizet bufferLength, pMemoryArena arena );
         
 		virtual eConfigurableErrorCode APICALL ValidateValue( const uint64 & key, eDataType type, const CombinedDataValue & value ) const;
 		void InitializeDefaultValues();
@@ -32,6 +32,7 @@ namespace AdobeXMPCore_Int {
 		virtual spIUTF8String APICALL Serialize( const spINode & node, const spcINameSpacePrefixMap & nameSpacePrefixMap );
 		virtual eConfigurableErrorCode APICALL ValidateValue( const uint64 & key, eDataType type, const CombinedDataValue & value ) const;
 		virtual spIUTF8String APICALL SerializeInternal(const spINode & node, XMP_OptionBits options, sizet padding, const char * newline, const char * indent, sizet baseIndent, const spcINameSpacePrefixMap & nameSpacePrefixMap) const;
+		virtual bool APICALL SerializeToRegionInternal(const spINode & node, XMP_Uns8 * region, XMP_StringLen regionSize, std::string * overflow, XMP_OptionBits options, const char * newline, const char * indent, sizet baseIndent) const;
 		void InitializeDefaultValues();
 
 	protected:
@@ -60,6 +60,7 @@ namespace AdobeXMPCore_Int {
 		virtual spINode APICALL ReplaceNode( const spINode & node );
 		virtual void APICALL AppendNode( const spINode & node );
 		virtual spINodeIterator APICALL Iterator();
+		virtual pINode APICALL GetRawNextChildPointer( pcINode child ) __NOTHROW__;
 		virtual sizet APICALL ChildCount() const __NOTHROW__;
 		virtual spIStructureNode APICALL ConvertToStructureNode();
 		virtual bool APICALL HasContent() const;
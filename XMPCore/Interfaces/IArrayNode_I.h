@@ -63,6 +63,14 @@ namespace AdobeXMPCore_Int {
 		//!
 		XMP_PRIVATE static spIArrayNode CreateArrayNode( const spcIUTF8String & nameSpace, const spcIUTF8String & name, eArrayForm arrayForm );
 
+		//!
+		//! Creates an array node whose object is allocated from a memory arena.
+		//! \param[in] arena arena to allocate the node from, the library's allocator is used if NULL.
+		//! Rest of the parameters are same as of the other overload.
+		//!
+		XMP_PRIVATE static spIArrayNode CreateArrayNode( pMemoryArena arena, const char * nameSpace, sizet nameSpaceLength,
+			const char * name, sizet nameLength, eArrayForm arrayForm );
+
 	protected:
 		virtual ~IArrayNode_I() __NOTHROW__ {}
 		pvoid APICALL GetInterfacePointerInternal( uint64 interfaceID, uint32 interfaceVersion, bool isTopLevel );
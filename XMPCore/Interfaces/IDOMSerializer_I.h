@@ -49,6 +49,12 @@ namespace AdobeXMPCore_Int {
 
 		virtual spIUTF8String APICALL SerializeInternal(const spINode & node, XMP_OptionBits options, sizet padding, const char * newline, const char * indent, sizet baseIndent, const spcINameSpacePrefixMap & nameSpacePrefixMap = spcINameSpacePrefixMap()) const = 0;
 
+		//!
+		//! Serializes a packet of exactly regionSize bytes into region, like XMPMeta::SerializeToRegion.
+		//! \return false if the packet does not fit, overflow then gets a normally padded packet if not NULL.
+		//!
+		virtual bool APICALL SerializeToRegionInternal(const spINode & node, XMP_Uns8 * region, XMP_StringLen regionSize, std::string * overflow, XMP_OptionBits options, const char * newline, const char * indent, sizet baseIndent) const = 0;
+
 
 		// Factory functions
 
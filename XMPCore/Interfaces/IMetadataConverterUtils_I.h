@@ -20,6 +20,14 @@ namespace AdobeXMPCore_Int {
     
     //!
     //! \brief Internal interface that represents an utility functions that can convert old xmp object(SXMPMeta) to new xmp object(IMetadata) and vice versa.
+    //! \details When the old API is backed by the new DOM (XMPMeta2), conversions share the document
+    //! instead of copying it: converting an XMPMeta2 returns the IMetadata it holds and converting an
+    //! IMetadata returns an XMPMeta2 bound to it. The XMPMeta2 registers itself with the document as an
+    //! ISharedMetadataView_I and the sharing is copy-on-write. A write through the old API first moves the
+    //! XMPMeta2 to a copy (XMPMeta::PrepareForUpdate), a change of any node of the document first tells the
+    //! XMPMeta2 to take a copy of the unchanged state (NodeImpl::PrepareForModification). An IMetadata is
+    //! only shared when it needs none of the clean ups applied by ConvertNewDOMtoOldDOM and no client
+    //! prefixes are supplied, in all other cases a deep copy is made.
     //!
     
     class IMetadataConverterUtils_I
@@ -33,10 +41,24 @@ namespace AdobeXMPCore_Int {
         static XMPMetaRef APICALL convertIMetadatatoXMPMeta(AdobeXMPCore::pIMetadata_base iMeta, const AdobeXMPCore::spcINameSpacePrefixMap & nameSpacePrefixMap = AdobeXMPCore::spcINameSpacePrefixMap()) __NOTHROW__;
         
         /* For internal use : called from RDFDOMParserImpl::ParseAsNode*/
-        static AdobeXMPCore::spIMetadata APICALL convertXMPMetatoIMetadata( XMPMeta* inpMeta) __NOTHROW__;
+        static AdobeXMPCore::spIMetadata APICALL convertXMPMetatoIMetadata( XMPMeta* inpMeta, pMemoryArena arena = NULL ) __NOTHROW__;
         
         /* For internal use : called from RDFDOMSerializerImpl::Serialize and RDFDOMSerializerImpl::SerializeInternal*/
         static XMPMetaRef APICALL convertIMetadatatoXMPMeta(const AdobeXMPCore::spINode & node,XMP_OptionBits options, const AdobeXMPCore::spcINameSpacePrefixMap & nameSpacePrefixMap = AdobeXMPCore::spcINameSpacePrefixMap()) __NOTHROW__;
+
+        /* For internal use : called from RDFDOMSerializerImpl to convert the top level properties one at a time.*/
+        static spcINameSpacePrefixMap_I APICALL mergeWithDefaultNameSpacePrefixMap( const AdobeXMPCore::spcINameSpacePrefixMap & nameSpacePrefixMap );
+
+        //!
+        //! Converts a single top level property and adds it to an empty xmp object, applying the same clean
+        //! ups as a conversion of the whole metadata.
+        //! \param[in] property top level property of an IMetadata.
+        //! \param[in] xmpObj empty xmp object receiving the property.
+        //! \param[in] nameSpacePrefixMap map returned by mergeWithDefaultNameSpacePrefixMap.
+        //! \return false if the result would depend on the other properties of the metadata, the content of
+        //! xmpObj is then undefined.
+        //!
+        static bool APICALL convertIMetadataPropertytoXMPMeta( const AdobeXMPCore::spINode & property, XMPMeta * xmpObj, const spcINameSpacePrefixMap_I & nameSpacePrefixMap );
         
         //!
         //! return the version of the interface.
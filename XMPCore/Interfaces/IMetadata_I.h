@@ -21,6 +21,22 @@ namespace AdobeXMPCore_Int {
 	#pragma warning( disable : 4250 )
 #endif
 
+	//!
+	//! \brief Internal interface implemented by the objects of the old DOM which work directly on a metadata
+	//! shared with the clients of the new DOM.
+	//!
+	class ISharedMetadataView_I {
+	public:
+		//!
+		//! Called before the first modification of the shared metadata. The view has to switch to its own copy
+		//! of the metadata, the metadata does not know the view anymore once the call returns.
+		//!
+		virtual void DetachFromSharedMetadata() = 0;
+
+	protected:
+		virtual ~ISharedMetadataView_I() {}
+	};
+
 	//!
 	//! \brief Internal interface that represents the whole XMP metadata for an asset.
 	//! Provides all the functions to add or remove nodes to and from metadata.
@@ -45,6 +61,65 @@ namespace AdobeXMPCore_Int {
 
 		virtual pvoid APICALL GetInterfacePointer( uint64 interfaceID, uint32 interfaceVersion );
 
+		//!
+		//! Get the memory arena from which this metadata and the nodes created along with it are allocated.
+		//! \return pointer to the arena, NULL in case metadata is using the library's allocator.
+		//!
+		virtual pMemoryArena APICALL GetMemoryArena() const __NOTHROW__ = 0;
+
+		//!
+		//! Hands over the ownership of a memory arena to the metadata. Arena is released when the metadata
+		//! is destroyed.
+		//! \param[in] arena pointer to an arena created by #MemoryArena::CreateMemoryArena.
+		//!
+		virtual void APICALL AdoptMemoryArena( pMemoryArena arena ) __NOTHROW__ = 0;
+
+		//!
+		//! @{
+		//! Get or set the cache in which the RDF serializer keeps the serialized form of the top level
+		//! properties of this metadata between two serializations.
+		//! \return shared pointer to the cache, an invalid shared pointer if the metadata was never serialized.
+		//!
+		virtual spRDFFragmentCache APICALL GetRDFFragmentCache() const __NOTHROW__ = 0;
+		virtual void APICALL SetRDFFragmentCache( const spRDFFragmentCache & cache ) __NOTHROW__ = 0;
+		//! @}
+
+		//!
+		//! @{
+		//! Register or unregister an object of the old DOM which works on this metadata without a copy of its own.
+		//! \param[in] view pointer to the object, it is told to detach itself before the metadata is modified.
+		//! \param[in] waitForDetach when true and another thread is already detaching the view, returns only once
+		//! that is done. Used by a view about to be destroyed, it must not hold its own lock.
+		//!
+		virtual void APICALL AttachSharedView( ISharedMetadataView_I * view ) __NOTHROW__ = 0;
+		virtual void APICALL DetachSharedView( ISharedMetadataView_I * view, bool waitForDetach = false ) __NOTHROW__ = 0;
+		//! @}
+
+		//!
+		//! Asks all the registered views to switch to their own copy of the metadata. Called before the metadata
+		//! is modified.
+		//!
+		virtual void APICALL DetachSharedViews() = 0;
+
+		//!
+		//! Indicates whether any metadata currently has a registered view, lets the nodes skip looking
+		//! for their metadata on every modification when nothing is shared.
+		//!
+		static bool HasSharedViews() __NOTHROW__;
+
+		// Factory functions
+
+		//!
+		//! Creates an empty metadata object allocated from a memory arena and keeps the arena alive as long
+		//! as it exists. Nodes explicitly created from the same arena, like the ones created by the parser,
+		//! draw their memory from it and the whole arena is returned in one step once the caller has released
+		//! the arena and the metadata and all those nodes are destroyed.
+		//! \param[in] arena pointer to an arena created by #MemoryArena::CreateMemoryArena, the library's
+		//! allocator is used if NULL.
+		//! \return a shared pointer to an object of #IMetadata.
+		//!
+		static spIMetadata CreateMetadataUsingMemoryArena( pMemoryArena arena );
+
 	protected:
 		virtual ~IMetadata_I() __NOTHROW__ {}
 
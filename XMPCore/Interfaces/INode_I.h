@@ -161,6 +161,32 @@ namespace AdobeXMPCore_Int {
 		virtual pINode APICALL GetRawParentPointer() = 0;
 		//! @}
 
+		//!
+		//! @{
+		//! Get the raw pointer to the child following the specified child of the node.
+		//! \param[in] child a pointer to a child of the node, NULL to get the first child.
+		//! \return a const or non const pointer to the next child in the order used by Iterator(), NULL
+		//! in case there are no more children or the node is not a composite node.
+		//!
+		pcINode GetRawNextChildPointer( pcINode child ) const {
+			return const_cast< INode_I * >( this )->GetRawNextChildPointer( child );
+		}
+		virtual pINode APICALL GetRawNextChildPointer( pcINode child ) __NOTHROW__ = 0;
+		//! @}
+
+		//!
+		//! @{
+		//! Get the raw pointer to the qualifier following the specified qualifier of the node.
+		//! \param[in] qualifier a pointer to a qualifier of the node, NULL to get the first qualifier.
+		//! \return a const or non const pointer to the next qualifier in the order used by QualifiersIterator(),
+		//! NULL in case there are no more qualifiers.
+		//!
+		pcINode GetRawNextQualifierPointer( pcINode qualifier ) const {
+			return const_cast< INode_I * >( this )->GetRawNextQualifierPointer( qualifier );
+		}
+		virtual pINode APICALL GetRawNextQualifierPointer( pcINode qualifier ) __NOTHROW__ = 0;
+		//! @}
+
 
 		virtual pINode APICALL GetActualINode() __NOTHROW__ { return this; }
 		virtual pINode_I APICALL GetINode_I() __NOTHROW__ { return this; }
@@ -170,11 +196,30 @@ namespace AdobeXMPCore_Int {
 		virtual void SetIndex( sizet currentIndex ) = 0;
 		virtual void SetIsQualifierNode( bool isQualifierNode ) = 0;
 		virtual void RegisterChange() = 0;
+
+		//!
+		//! Adds one to the count of unacknowledged changes of the node.
+		//! \return true if the node had no unacknowledged change before, its parent has to count the change then.
+		//!
+		virtual bool CountChange() __NOTHROW__ = 0;
 		virtual bool ValidateNameOrNameSpaceChangeForAChild( const spcIUTF8String & currentNameSpace, const spcIUTF8String & currentName,
 			const spcIUTF8String & newNameSpace, const spcIUTF8String & newName ) = 0;
 		virtual void UnRegisterChange() = 0;
 		virtual void SetQualifiers( const spIStructureNode & node ) = 0;
 
+		//!
+		//! Returns a number which changes every time the node, its qualifiers or any node below it is modified.
+		//! Unlike HasChanged() it is not affected by AcknowledgeChanges(), so internal clients can use it to
+		//! find out whether something derived from the node is still up to date.
+		//!
+		virtual sizet GetModificationStamp() const __NOTHROW__ = 0;
+		virtual void SetModificationStamp( sizet stamp ) __NOTHROW__ = 0;
+
+		//!
+		//! Returns the stamp without counting as a look at it, for the bookkeeping of the stamps only.
+		//!
+		virtual sizet GetUnobservedModificationStamp() const __NOTHROW__ = 0;
+
 	protected:
 		virtual ~INode_I() __NOTHROW__ {}
 		pvoid APICALL GetInterfacePointerInternal( uint64 interfaceID, uint32 interfaceVersion, bool isTopLevel );
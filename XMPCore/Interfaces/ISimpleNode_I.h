@@ -58,6 +58,14 @@ namespace AdobeXMPCore_Int {
 		//!
 		XMP_PRIVATE static spISimpleNode CreateSimpleNode( const spcIUTF8String & nameSpace, const spcIUTF8String & name, const spcIUTF8String & value = spcIUTF8String() );
 
+		//!
+		//! Creates a simple property node whose object is allocated from a memory arena.
+		//! \param[in] arena arena to allocate the node from, the library's allocator is used if NULL.
+		//! Rest of the parameters are same as of #AdobeXMPCore::ISimpleNode::CreateSimpleNode.
+		//!
+		XMP_PRIVATE static spISimpleNode CreateSimpleNode( pMemoryArena arena, const char * nameSpace, sizet nameSpaceLength,
+			const char * name, sizet nameLength, const char * value, sizet valueLength );
+
 	protected:
 		virtual ~ISimpleNode_I() __NOTHROW__ {}
 		pvoid APICALL GetInterfacePointerInternal( uint64 interfaceID, uint32 interfaceVersion, bool isTopLevel );
@@ -163,6 +163,14 @@ namespace AdobeXMPCore_Int {
 		//!
 		XMP_PRIVATE static spIStructureNode CreateStructureNode( const spcIUTF8String & nameSpace, const spcIUTF8String name );
 
+		//!
+		//! Creates a structure node whose object is allocated from a memory arena.
+		//! \param[in] arena arena to allocate the node from, the library's allocator is used if NULL.
+		//! Rest of the parameters are same as of #AdobeXMPCore::IStructureNode::CreateStructureNode.
+		//!
+		XMP_PRIVATE static spIStructureNode CreateStructureNode( pMemoryArena arena, const char * nameSpace, sizet nameSpaceLength,
+			const char * name, sizet nameLength );
+
 	protected:
 		virtual ~IStructureNode_I() __NOTHROW__ {}
 		pvoid APICALL GetInterfacePointerInternal( uint64 interfaceID, uint32 interfaceVersion, bool isTopLevel );
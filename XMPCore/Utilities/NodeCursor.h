@@ -0,0 +1,135 @@
+#ifndef __NodeCursor_h__
+#define __NodeCursor_h__ 1
+
+// =================================================================================================
+// Copyright Adobe
+// Copyright 2026 Adobe
+// All Rights Reserved
+//
+// NOTICE:  Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it.
+// =================================================================================================
+
+#include "XMPCore/XMPCoreFwdDeclarations_I.h"
+#include "XMPCore/Interfaces/INode_I.h"
+#include "XMPCommon/Utilities/TAllocator.h"
+
+#include <vector>
+
+namespace AdobeXMPCore_Int {
+
+	//!
+	//! \brief Depth first walk over a node and all the nodes below it, without creating node iterators.
+	//! \details Nodes are returned as raw pointers in pre-order, a node's qualifiers (if requested) being
+	//! visited before its children. The pending nodes are kept on an explicit stack which keeps its capacity
+	//! across calls to Reset(), so walking a document with a cursor which has been used before does not
+	//! allocate any memory.
+	//! \attention Nodes should not be added to or removed from the tree during the walk, changing the values
+	//! of the visited nodes is fine. Returned pointers are valid only as long as the nodes are part of the tree.
+	//! \note This is for use within the library only. Clients get every node through a reference counted
+	//! proxy, which would make a public cursor allocate per node; TXMPIterator is their lazy traversal.
+	//!
+	class NodeCursor {
+	public:
+		//!
+		//! Creates a cursor not positioned on any tree.
+		//! \param[in] visitQualifiers whether qualifiers of the nodes are to be visited.
+		//!
+		explicit NodeCursor( bool visitQualifiers = false )
+			: mPending( NULL )
+			, mVisitQualifiers( visitQualifiers )
+			, mRootPending( false )
+		{
+			mStack.reserve( kInitialDepth );
+		}
+
+		//!
+		//! @{
+		//! Starts a new walk; the next call to Next() returns the root itself.
+		//! \param[in] root the node at which the walk starts, NULL for an empty walk.
+		//!
+		void Reset( pINode root ) {
+			mStack.clear();
+			mPending = root;
+			mRootPending = root != NULL;
+		}
+		void Reset( pcINode root ) { Reset( const_cast< pINode >( root ) ); }
+		void Reset( const spcINode & root ) { Reset( root.get() ); }
+		//! @}
+
+		//!
+		//! Moves to the next node of the walk.
+		//! \return a pointer to the next node, NULL when all the nodes have been visited.
+		//!
+		pINode Next() {
+			if ( mRootPending ) {
+				mRootPending = false;
+				return mPending;
+			}
+			if ( mPending ) {
+				mStack.push_back( Frame( mPending, mVisitQualifiers ) );
+				mPending = NULL;
+			}
+			while ( !mStack.empty() ) {
+				Frame & frame = mStack.back();
+				pINode_I node = frame.mNode->GetINode_I();
+				if ( frame.mInQualifiers ) {
+					frame.mChild = node->GetRawNextQualifierPointer( frame.mChild );
+					if ( frame.mChild ) return mPending = frame.mChild;
+					frame.mInQualifiers = false;
+				}
+				frame.mChild = node->GetRawNextChildPointer( frame.mChild );
+				if ( frame.mChild ) return mPending = frame.mChild;
+				mStack.pop_back();
+			}
+			return NULL;
+		}
+
+		//!
+		//! Excludes the qualifiers and the children of the node last returned by Next() from the walk.
+		//!
+		void SkipSubtree() { mPending = NULL; }
+
+		//!
+		//! Returns the depth of the node last returned by Next(), 0 for the root.
+		//!
+		sizet Depth() const { return mStack.size(); }
+
+		//!
+		//! Returns true if the node last returned by Next() is reached through a qualifier of one of its ancestors.
+		//!
+		bool InQualifier() const {
+			for ( auto it = mStack.begin(), itEnd = mStack.end(); it != itEnd; ++it ) {
+				if ( it->mInQualifiers ) return true;
+			}
+			return false;
+		}
+
+	protected:
+		static const sizet kInitialDepth = 16;
+
+		struct Frame {
+			Frame( pINode node, bool inQualifiers )
+				: mNode( node )
+				, mChild( NULL )
+				, mInQualifiers( inQualifiers ) {}
+
+			pINode				mNode;
+			pINode				mChild;
+			bool				mInQualifiers;
+		};
+
+		typedef std::vector< Frame, TAllocator< Frame > > FrameStack;
+
+		FrameStack				mStack;
+		pINode					mPending;
+		bool					mVisitQualifiers;
+		bool					mRootPending;
+
+	private:
+		NodeCursor( const NodeCursor & );
+		NodeCursor & operator = ( const NodeCursor & );
+	};
+}
+
+#endif  // __NodeCursor_h__
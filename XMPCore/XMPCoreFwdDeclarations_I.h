@@ -78,5 +78,9 @@ namespace AdobeXMPCore_Int {
 	// ICoreConfigurationManager
 	typedef shared_ptr< ICoreConfigurationManager_I >									spICoreConfigurationManager_I;
 	typedef shared_ptr< const ICoreConfigurationManager_I >								spcICoreConfigurationManager_I;
+
+	// RDFFragmentCache
+	class RDFFragmentCache;
+	typedef shared_ptr< RDFFragmentCache >												spRDFFragmentCache;
 }
 #endif // XMPCoreFwdDeclarations_I_h__
@@ -61,6 +61,7 @@ namespace AdobeXMPCore_Int {
 		bool goAhead = CheckSuitabilityToBeUsedAsChildNode( node );
 
 		if ( goAhead ) {
+			PrepareForModification();
 			AutoSharedLock lock( mSharedMutex, true );
 			auto it = mChildren.begin();
 			std::advance( it, actualIndex );
@@ -78,6 +79,7 @@ namespace AdobeXMPCore_Int {
 	spINode APICALL ArrayNodeImpl::RemoveNodeAtIndex( sizet index ) {
 		spINode node = GetNodeAtIndex( index );
 		if ( node ) {
+			PrepareForModification();
 			sizet actualIndex = index - 1;
 			AutoSharedLock lock( mSharedMutex, true );
 			auto it = mChildren.begin();
@@ -117,6 +119,27 @@ namespace AdobeXMPCore_Int {
 			return MakeUncheckedSharedPointer( new TNodeIteratorImpl< NodeVector::iterator >( beginIt, endIt ), __FILE__, __LINE__, true );
 	}
 
+	pINode APICALL ArrayNodeImpl::GetRawNextChildPointer( pcINode child ) __NOTHROW__ {
+		AutoSharedLock lock( mSharedMutex );
+		sizet nextIndex = 0;
+		if ( child ) {
+			// children keep their 1 based index, so normally no search is required.
+			nextIndex = child->GetIndex();
+			if ( nextIndex == 0 || nextIndex > mChildren.size() || mChildren[ nextIndex - 1 ].get() != child ) {
+				nextIndex = mChildren.size();
+				for ( sizet i = 0, count = mChildren.size(); i < count; ++i ) {
+					if ( mChildren[ i ].get() == child ) {
+						nextIndex = i + 1;
+						break;
+					}
+				}
+			}
+		}
+		if ( nextIndex < mChildren.size() )
+			return mChildren[ nextIndex ].get();
+		return NULL;
+	}
+
 	sizet APICALL ArrayNodeImpl::ChildCount() const __NOTHROW__ {
 		AutoSharedLock lock( mSharedMutex );
 		return mChildren.size();
@@ -136,6 +159,7 @@ namespace AdobeXMPCore_Int {
 	}
 
 	void APICALL ArrayNodeImpl::ClearContents() {
+		PrepareForModification();
 		AutoSharedLock lock( mSharedMutex, true );
 		for ( auto it = mChildren.begin(), itEnd = mChildren.end(); it != itEnd; ++it ) {
 			( *it )->GetINode_I()->ChangeParent( NULL );
@@ -196,6 +220,13 @@ namespace AdobeXMPCore_Int {
 			name ? name->c_str() : NULL, name ? name->size() : 0, arrayForm ), __FILE__, __LINE__, true );
 	}
 
+	spIArrayNode IArrayNode_I::CreateArrayNode( pMemoryArena arena, const char * nameSpace, sizet nameSpaceLength,
+		const char * name, sizet nameLength, eArrayForm arrayForm )
+	{
+		return MakeUncheckedSharedPointer( new ( arena ) ArrayNodeImpl( nameSpace, nameSpaceLength, name, nameLength, arrayForm ),
+			__FILE__, __LINE__, true );
+	}
+
 	template<>
 	spINode TNodeIteratorImpl< ArrayNodeImpl::NodeVector::iterator >::GetNodeFromIterator( const ArrayNodeImpl::NodeVector::iterator & it ) const {
 		return MakeUncheckedSharedPointer( it->get(), __FILE__, __LINE__, false );
@@ -20,6 +20,7 @@
 #include "XMPCommon/Interfaces/ISharedMutex.h"
 #include "XMPCommon/Utilities/AutoSharedLock.h"
 #include "XMPCommon/Utilities/TSmartPointers_I.h"
+#include "XMPCommon/Utilities/MemoryArena.h"
 
 namespace AdobeXMPCore_Int {
 
@@ -45,8 +46,7 @@ namespace AdobeXMPCore_Int {
 		return MakeUncheckedSharedPointer( cloned, __FILE__, __LINE__, true );
 	}
 
-	spIMetadata APICALL DOMParserImpl::Parse( const char * buffer, sizet bufferLength ) {
-		auto node = ParseAsNode( buffer, bufferLength );
+	static spIMetadata ConvertToMetadata( const spINode & node ) {
 		if ( node ) {
 			switch ( node->GetNodeType() ) {
 			case INode::kNTSimple:
@@ -83,6 +83,31 @@ namespace AdobeXMPCore_Int {
 		return spIMetadata();
 	}
 
+	spIMetadata APICALL DOMParserImpl::Parse( const char * buffer, sizet bufferLength ) {
+		static const uint64 kUseMemoryArenaKey( IConfigurable::ConvertCharBufferToUint64( "useArena" ) );
+
+		// with "useArena" set, the nodes created by the parser are allocated from an arena kept alive by the
+		// returned metadata.
+		bool useMemoryArena( false );
+		if ( !GetParameter( kUseMemoryArenaKey, useMemoryArena ) || !useMemoryArena )
+			return ConvertToMetadata( ParseAsNode( buffer, bufferLength ) );
+
+		pMemoryArena arena = MemoryArena::CreateMemoryArena();
+		spIMetadata meta;
+		try {
+			meta = ConvertToMetadata( ParseAsNodeUsingMemoryArena( buffer, bufferLength, arena ) );
+		} catch ( ... ) {
+			arena->Release();
+			throw;
+		}
+		arena->Release();
+		return meta;
+	}
+
+	spINode APICALL DOMParserImpl::ParseAsNodeUsingMemoryArena( const char * buffer, sizet bufferLength, pMemoryArena arena ) {
+		return ParseAsNode( buffer, bufferLength );
+	}
+
 	static void AppendAsChildren( const spINode & contextNode, const spINode & parsedNode ) {
 		if ( !contextNode )
 			NOTIFY_ERROR( IError::kEDParser, kPECInvalidContextNode, "Context Node is invalid", IError::kESOperationFatal, false, false );
@@ -46,6 +46,13 @@ namespace AdobeXMPCore_Int {
 		return MakeUncheckedSharedPointer( cloned, __FILE__, __LINE__, true );
 	}
 
+	bool APICALL DOMSerializerImpl::SerializeToRegionInternal( const spINode & node, XMP_Uns8 * region, XMP_StringLen regionSize, std::string * overflow,
+		XMP_OptionBits options, const char * newline, const char * indent, sizet baseIndent ) const
+	{
+		// only the RDF serializer writes packets, the wrapper of a client serializer has nothing to offer here.
+		return false;
+	}
+
 	AdobeXMPCore::spIDOMSerializer IDOMSerializer_I::CreateDOMSerializer( pIClientDOMSerializer_base clientDOMSerializer ) {
 		return MakeUncheckedSharedPointer( new ClientDOMSerializerWrapperImpl( clientDOMSerializer ), __FILE__, __LINE__, true );
 	}
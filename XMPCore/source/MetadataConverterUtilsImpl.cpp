@@ -14,6 +14,8 @@
 #include "XMPCore/ImplHeaders/MetadataConverterUtilsImpl.h"
 #undef IMPLEMENTATION_HEADERS_CAN_BE_INCLUDED
 
+#include "XMPCore/source/XMPMeta2.hpp"
+
 namespace AdobeXMPCore_Int {
     
    /* AdobeXMPCore::spIMetadata APICALL IMetadataConverterUtils_I::convertXMPMetatoIMetadata( XMPMetaRef metaRef ) __NOTHROW__
@@ -22,24 +24,124 @@ namespace AdobeXMPCore_Int {
         return MetadataConverterUtilsImpl::ConvertOldDOMtoNewDOM(meta);
     }*/
     
-    AdobeXMPCore::spIMetadata IMetadataConverterUtils_I::convertXMPMetatoIMetadata( XMPMeta* inpMeta) __NOTHROW__
+    AdobeXMPCore::spIMetadata IMetadataConverterUtils_I::convertXMPMetatoIMetadata( XMPMeta* inpMeta, pMemoryArena arena ) __NOTHROW__
     {
-        return MetadataConverterUtilsImpl::ConvertOldDOMtoNewDOM(inpMeta);
+        return MetadataConverterUtilsImpl::ConvertOldDOMtoNewDOM(inpMeta, arena);
     }
     
     XMPMetaRef IMetadataConverterUtils_I::convertIMetadatatoXMPMeta(AdobeXMPCore::pIMetadata_base iMeta ,const AdobeXMPCore::spcINameSpacePrefixMap & nameSpacePrefixMap) __NOTHROW__
     {
+        // Client supplied prefixes only matter for a copy, the XMPMeta2 works with the registered ones.
+        if ( !nameSpacePrefixMap || nameSpacePrefixMap->Size() == 0 ) {
+            XMPMetaRef sharedRef = MetadataConverterUtilsImpl::ShareNewDOMAsOldDOM( IMetadata::MakeShared( iMeta ) );
+            if ( sharedRef ) return sharedRef;
+        }
         XMP_OptionBits options = 0;
         return MetadataConverterUtilsImpl::ConvertNewDOMtoOldDOM(INode::MakeShared(iMeta), nameSpacePrefixMap,options);
     }
+
+    AdobeXMPCore::spIMetadata MetadataConverterUtilsImpl::ShareOldDOMAsNewDOM( const XMPMeta * inOldMeta )
+    {
+        // Only an XMPMeta2 keeps its properties in the new DOM, a plain XMPMeta has to be copied.
+        if ( !sUseNewCoreAPIs || !inOldMeta ) return AdobeXMPCore::spIMetadata();
+        const XMPMeta2 * meta2 = dynamic_cast< const XMPMeta2 * >( inOldMeta );
+        if ( !meta2 ) return AdobeXMPCore::spIMetadata();
+        // The first change through either side gives the XMPMeta2 a copy of its own, see ShareDOM.
+        return meta2->ShareDOM();
+    }
+
+    bool IsNodeAlias( const char * nameSpace, const char * name, XMP_ExpandedXPath & exPath );
+
+    // True for an alternative array whose items are simple nodes with an xml:lang qualifier.
+    static bool IsLangAltArray( const spINode & node ) {
+        if ( node->GetNodeType() != INode::kNTArray ) return false;
+        spIArrayNode arrayNode = node->ConvertToArrayNode();
+        if ( arrayNode->GetArrayForm() != IArrayNode::kAFAlternative ) return false;
+        for ( sizet index = 1, count = arrayNode->ChildCount(); index <= count; ++index ) {
+            spINode item = arrayNode->GetNodeAtIndex( index );
+            if ( item->GetNodeType() != INode::kNTSimple ) return false;
+            if ( !item->GetQualifier( kXMP_NS_XML, AdobeXMPCommon::npos, "lang", AdobeXMPCommon::npos ) ) return false;
+        }
+        return true;
+    }
+
+    // A shared document is seen by the old API as it is. ConvertNewDOMtoOldDOM applies the parser's
+    // clean ups (NormalizeDCArrays, MoveExplicitAliases, TouchUpDataModel) to its copy, so sharing is
+    // only done when none of them would change anything.
+    static bool NeedsLegacyCleanUp( const spIMetadata & meta ) {
+        if ( meta->GetAboutURI()->size() != 0 ) return true;
+
+        spINodeIterator it = meta->Iterator();
+        while ( it ) {
+            spINode prop = it->GetNode();
+            it = it->Next();
+            const char * nameSpace = prop->GetNameSpace()->c_str();
+            const char * name = prop->GetName()->c_str();
+
+            XMP_ExpandedXPath exPath;
+            if ( IsNodeAlias( nameSpace, name, exPath ) ) return true;
+
+            if ( strcmp( nameSpace, kXMP_NS_EXIF ) == 0 ) {
+                if ( strcmp( name, "GPSTimeStamp" ) == 0 ) return true;
+                if ( ( strcmp( name, "UserComment" ) == 0 ) && !IsLangAltArray( prop ) ) return true;
+            } else if ( strcmp( nameSpace, kXMP_NS_DM ) == 0 ) {
+                if ( strcmp( name, "copyright" ) == 0 ) return true;
+            } else if ( strcmp( nameSpace, kXMP_NS_XMP_Rights ) == 0 ) {
+                if ( ( strcmp( name, "UsageTerms" ) == 0 ) && !IsLangAltArray( prop ) ) return true;
+            } else if ( strcmp( nameSpace, kXMP_NS_DC ) == 0 ) {
+                if ( ( strcmp( name, "description" ) == 0 ) || ( strcmp( name, "rights" ) == 0 ) || ( strcmp( name, "title" ) == 0 ) ) {
+                    if ( !IsLangAltArray( prop ) ) return true;
+                } else if ( strcmp( name, "subject" ) == 0 ) {
+                    if ( prop->GetNodeType() != INode::kNTArray ) return true;
+                    if ( prop->ConvertToArrayNode()->GetArrayForm() != IArrayNode::kAFUnordered ) return true;
+                } else if ( ( strcmp( name, "creator" ) == 0 ) || ( strcmp( name, "date" ) == 0 ) ||
+                            ( strcmp( name, "contributor" ) == 0 ) || ( strcmp( name, "language" ) == 0 ) ||
+                            ( strcmp( name, "publisher" ) == 0 ) || ( strcmp( name, "relation" ) == 0 ) ||
+                            ( strcmp( name, "type" ) == 0 ) ) {
+                    if ( prop->GetNodeType() == INode::kNTSimple ) return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    XMPMetaRef MetadataConverterUtilsImpl::ShareNewDOMAsOldDOM( const AdobeXMPCore::spIMetadata & inNewMeta )
+    {
+        if ( !sUseNewCoreAPIs || !inNewMeta ) return 0;
+        if ( NeedsLegacyCleanUp( inNewMeta ) ) return 0;
+        return XMPMetaRef ( new XMPMeta2( inNewMeta ) );
+    }
     
     XMPMetaRef IMetadataConverterUtils_I::convertIMetadatatoXMPMeta(const spINode & node,XMP_OptionBits options, const AdobeXMPCore::spcINameSpacePrefixMap & nameSpacePrefixMap) __NOTHROW__
     {
         return MetadataConverterUtilsImpl::ConvertNewDOMtoOldDOM(node, nameSpacePrefixMap,options);
     }
 
+    spcINameSpacePrefixMap_I IMetadataConverterUtils_I::mergeWithDefaultNameSpacePrefixMap( const AdobeXMPCore::spcINameSpacePrefixMap & nameSpacePrefixMap )
+    {
+        return MetadataConverterUtilsImpl::MergeWithDefaultNameSpacePrefixMap( nameSpacePrefixMap );
+    }
+
+    bool IMetadataConverterUtils_I::convertIMetadataPropertytoXMPMeta( const AdobeXMPCore::spINode & property, XMPMeta * xmpObj, const spcINameSpacePrefixMap_I & nameSpacePrefixMap )
+    {
+        return MetadataConverterUtilsImpl::ConvertNewDOMPropertyToOldDOM( property, xmpObj, nameSpacePrefixMap );
+    }
+
+    static void DeleteEmptySchemaNodes( XMP_Node & tree ) {
+        size_t schemaNum = 0;
+        while ( schemaNum < tree.children.size() ) {
+            XMP_Node * currSchema = tree.children[ schemaNum ];
+            if ( currSchema->children.size() > 0 ) {
+                ++schemaNum;
+            } else {
+                delete tree.children[ schemaNum ];	// ! Delete the schema node itself.
+                tree.children.erase( tree.children.begin() + schemaNum );
+            }
+        }
+    }
+
     
-    void MetadataConverterUtilsImpl::CreateAndPopulateNode( const AdobeXMPCore::spINode & parentNode, XMP_Node * node, bool nodeIsQualifier /*= false*/ ) {
+    void MetadataConverterUtilsImpl::CreateAndPopulateNode( const AdobeXMPCore::spINode & parentNode, XMP_Node * node, pMemoryArena arena, bool nodeIsQualifier /*= false*/ ) {
         const char * kItemName = "arrayItem";
         const char * kItemNameSpace = "http://www.w3.org/1999/02/22-rdf-syntax-ns#";
         
@@ -55,23 +157,21 @@ namespace AdobeXMPCore_Int {
         
         AdobeXMPCore::spINode spNode;
         if ( XMP_PropIsSimple( node->options ) ) {
-            AdobeXMPCore::spISimpleNode spSimpleNode = AdobeXMPCore::ISimpleNode::CreateSimpleNode( nameSpaceStr, nameSpaceLen, nameStr, nameLen, node->value.c_str(), node->value.size() );
+            AdobeXMPCore::spISimpleNode spSimpleNode = AdobeXMPCore_Int::ISimpleNode_I::CreateSimpleNode( arena, nameSpaceStr, nameSpaceLen, nameStr, nameLen, node->value.c_str(), node->value.size() );
             spSimpleNode->SetURIType( XMP_OptionIsSet( node->options, kXMP_PropValueIsURI ) );
             spNode = spSimpleNode;
         } else if ( XMP_PropIsStruct( node->options ) ) {
-            AdobeXMPCore::spIStructureNode spStructNode = AdobeXMPCore::IStructureNode::CreateStructureNode( nameSpaceStr, nameSpaceLen, nameStr, nameLen );
+            AdobeXMPCore::spIStructureNode spStructNode = AdobeXMPCore_Int::IStructureNode_I::CreateStructureNode( arena, nameSpaceStr, nameSpaceLen, nameStr, nameLen );
             for ( XMP_Uns64 index = 0, count = node->children.size(); index < count; index++ )
-                CreateAndPopulateNode( spStructNode, node->children[ index ] );
+                CreateAndPopulateNode( spStructNode, node->children[ index ], arena );
             spNode = spStructNode;
         } else if ( XMP_PropIsArray( node->options ) ) {
             AdobeXMPCore::IArrayNode::eArrayForm arrayNodeForm = AdobeXMPCore::IArrayNode::kAFUnordered;
             if ( XMP_ArrayIsAlternate( node->options ) ) arrayNodeForm = AdobeXMPCore::IArrayNode::kAFAlternative;
             else if ( XMP_ArrayIsOrdered( node->options ) ) arrayNodeForm = AdobeXMPCore::IArrayNode::kAFOrdered;
-            AdobeXMPCore::spIUTF8String nameSpaceUTF8Str( AdobeXMPCore_Int::IUTF8String_I::CreateUTF8String( nameSpaceStr, nameSpaceLen ) );
-            AdobeXMPCore::spIUTF8String nameUTF8Str( AdobeXMPCore_Int::IUTF8String_I::CreateUTF8String( nameStr, nameLen ) );
-            AdobeXMPCore::spIArrayNode spArrayNode = AdobeXMPCore_Int::IArrayNode_I::CreateArrayNode( nameSpaceUTF8Str, nameUTF8Str, arrayNodeForm );
+            AdobeXMPCore::spIArrayNode spArrayNode = AdobeXMPCore_Int::IArrayNode_I::CreateArrayNode( arena, nameSpaceStr, nameSpaceLen, nameStr, nameLen, arrayNodeForm );
             for ( XMP_Uns64 index = 0, count = node->children.size(); index < count; index++ )
-                CreateAndPopulateNode( spArrayNode, node->children[ index ] );
+                CreateAndPopulateNode( spArrayNode, node->children[ index ], arena );
             spNode = spArrayNode;
         }
         
@@ -79,7 +179,7 @@ namespace AdobeXMPCore_Int {
             // append qualifiers.
             if ( node->qualifiers.size() > 0 ) {
                 for ( XMP_Uns64 index = 0, count = node->qualifiers.size(); index < count; index++ ) {
-                    CreateAndPopulateNode( spNode, node->qualifiers[ index ], true );
+                    CreateAndPopulateNode( spNode, node->qualifiers[ index ], arena, true );
                 }
             }
             if ( nodeIsQualifier )
@@ -91,9 +191,16 @@ namespace AdobeXMPCore_Int {
     }
     
     
-    AdobeXMPCore::spIMetadata MetadataConverterUtilsImpl::ConvertOldDOMtoNewDOM(const XMPMeta* inOldMeta)
+    AdobeXMPCore::spIMetadata MetadataConverterUtilsImpl::ConvertOldDOMtoNewDOM(const XMPMeta* inOldMeta, pMemoryArena arena)
     {
-        AdobeXMPCore::spIMetadata metadata = AdobeXMPCore::IMetadata::CreateMetadata();
+        // A document asked for in an arena is always built in it.
+        if ( !arena ) {
+            AdobeXMPCore::spIMetadata shared = ShareOldDOMAsNewDOM( inOldMeta );
+            if ( shared ) return shared;
+        }
+
+        AdobeXMPCore::spIMetadata metadata = arena ? AdobeXMPCore_Int::IMetadata_I::CreateMetadataUsingMemoryArena( arena )
+            : AdobeXMPCore::IMetadata::CreateMetadata();
         if ( inOldMeta ) {
             metadata->SetAboutURI( inOldMeta->tree.name.c_str(), inOldMeta->tree.name.size() );
             
@@ -103,7 +210,7 @@ namespace AdobeXMPCore_Int {
             for ( sizet index = 0, count = inOldMeta->tree.children.size(); index < count; ++index ) {
                 XMP_Node * topLevelNode = inOldMeta->tree.children[ index ];
                 for ( sizet innerIndex = 0, innerCount = topLevelNode->children.size(); innerIndex < innerCount; ++innerIndex ) {
-                    CreateAndPopulateNode( metadata, topLevelNode->children[ innerIndex ] );
+                    CreateAndPopulateNode( metadata, topLevelNode->children[ innerIndex ], arena );
                 }
             }
         }
@@ -383,13 +490,7 @@ namespace AdobeXMPCore_Int {
         XMPMeta* xmpObj = new XMPMeta();
         spINameSpacePrefixMap_I genereatedMap;
         
-        spcINameSpacePrefixMap mergedMap = INameSpacePrefixMap::GetDefaultNameSpacePrefixMap();
-        if ( nameSpacePrefixMap ) {
-            spINameSpacePrefixMap newMergedMap = mergedMap->Clone();
-            newMergedMap->GetINameSpacePrefixMap_I()->Merge( nameSpacePrefixMap );
-            mergedMap = newMergedMap;
-        }
-        spINameSpacePrefixMap_I userSuppliedMap( MakeUncheckedSharedPointer( const_pointer_cast< INameSpacePrefixMap >( mergedMap )->GetINameSpacePrefixMap_I(), __FILE__, __LINE__, true ) );
+        spcINameSpacePrefixMap_I userSuppliedMap = MergeWithDefaultNameSpacePrefixMap( nameSpacePrefixMap );
         
         // TODO:meta->SetErrorCallback()
         HandleNode( node, &xmpObj->tree, userSuppliedMap, genereatedMap, true, false );
@@ -399,19 +500,43 @@ namespace AdobeXMPCore_Int {
         TouchUpDataModel( xmpObj, xmpObj->errorCallback );
         
         // Delete empty schema nodes. Do this last, other cleanup can make empty schema.
-        size_t schemaNum = 0;
-        while ( schemaNum < xmpObj->tree.children.size() ) {
-            XMP_Node * currSchema = xmpObj->tree.children[ schemaNum ];
-            if ( currSchema->children.size() > 0 ) {
-                ++schemaNum;
-            } else {
-                delete xmpObj->tree.children[ schemaNum ];	// ! Delete the schema node itself.
-                xmpObj->tree.children.erase( xmpObj->tree.children.begin() + schemaNum );
-            }
-        }
+        DeleteEmptySchemaNodes( xmpObj->tree );
         
         return XMPMetaRef ( xmpObj );
     }
+
+    spcINameSpacePrefixMap_I MetadataConverterUtilsImpl::MergeWithDefaultNameSpacePrefixMap( const AdobeXMPCore::spcINameSpacePrefixMap & nameSpacePrefixMap )
+    {
+        spcINameSpacePrefixMap mergedMap = INameSpacePrefixMap::GetDefaultNameSpacePrefixMap();
+        if ( nameSpacePrefixMap ) {
+            spINameSpacePrefixMap newMergedMap = mergedMap->Clone();
+            newMergedMap->GetINameSpacePrefixMap_I()->Merge( nameSpacePrefixMap );
+            mergedMap = newMergedMap;
+        }
+        return MakeUncheckedSharedPointer( const_pointer_cast< INameSpacePrefixMap >( mergedMap )->GetINameSpacePrefixMap_I(), __FILE__, __LINE__, true );
+    }
+
+    bool MetadataConverterUtilsImpl::ConvertNewDOMPropertyToOldDOM( const AdobeXMPCore::spINode & property, XMPMeta * xmpObj, const spcINameSpacePrefixMap_I & userSuppliedMap )
+    {
+        // TouchUpDataModel looks at other properties while fixing these two.
+        spcIUTF8String nameSpace = property->GetNameSpace();
+        spcIUTF8String name = property->GetName();
+        if ( ( nameSpace->compare( kXMP_NS_EXIF ) == 0 && name->compare( "GPSTimeStamp" ) == 0 ) ||
+             ( nameSpace->compare( kXMP_NS_DM ) == 0 && name->compare( "copyright" ) == 0 ) )
+            return false;
+
+        spINameSpacePrefixMap_I genereatedMap;
+        HandleNode( property, &xmpObj->tree, userSuppliedMap, genereatedMap, true, false );
+
+        // generated prefixes are numbered in the order of the whole metadata, aliases are resolved against the other properties.
+        if ( genereatedMap || ( xmpObj->tree.options & kXMP_PropHasAliases ) )
+            return false;
+
+        NormalizeDCArrays( &( xmpObj->tree ) );
+        TouchUpDataModel( xmpObj, xmpObj->errorCallback );
+        DeleteEmptySchemaNodes( xmpObj->tree );
+        return true;
+    }
     
 }
 
@@ -436,6 +561,8 @@ namespace AdobeXMPCore {
     
     SXMPMeta IMetadataConverterUtils::ConvertIMetadatatoXMPMeta(AdobeXMPCore::spIMetadata inNewXMP)
     {
+        XMPMetaRef sharedRef = MetadataConverterUtilsImpl::ShareNewDOMAsOldDOM( inNewXMP );
+        if ( sharedRef ) return SXMPMeta( sharedRef );
         XMP_OptionBits optionBits = 0;
         return MetadataConverterUtilsImpl::ConvertNewDOMtoOldDOM(inNewXMP, AdobeXMPCore::spcINameSpacePrefixMap(),optionBits);
     }
@@ -14,6 +14,7 @@
 #include "XMPCommon/Interfaces/IUTF8String_I.h"
 #include "XMPCommon/Utilities/AutoSharedLock.h"
 #include "XMPCommon/Utilities/TSmartPointers_I.h"
+#include "XMPCommon/Utilities/MemoryArena.h"
 #include "XMPCommon/Interfaces/IError_I.h"
 #include "XMPCore/XMPCoreErrorCodes.h"
 #include "XMPCore/Interfaces/INameSpacePrefixMap_I.h"
@@ -24,6 +25,7 @@
 
 
 #include <assert.h>
+#include <algorithm>
 
 namespace AdobeXMPCore_Int {
 	static const char * kMetadataNameSpace( "http://metadata" );
@@ -35,7 +37,83 @@ namespace AdobeXMPCore_Int {
 		: StructureNodeImpl( kMetadataNameSpace, kMetadataNameSpaceLength, kMetadataLocalName, kMetadataLocalNameLength )
 		, NodeImpl( kMetadataNameSpace, kMetadataNameSpaceLength, kMetadataLocalName, kMetadataLocalNameLength )
 		, mAboutURI( IUTF8String_I::CreateUTF8String() )
-		, mSupportAliases( false ) { }
+		, mSupportAliases( false )
+		, mMemoryArena( NULL ) { }
+
+	MetadataImpl::~MetadataImpl() __NOTHROW__ {
+		// remaining members and this object return their memory to the arena after this point,
+		// arena goes away with the last of them.
+		if ( mMemoryArena )
+			mMemoryArena->Release();
+	}
+
+	pMemoryArena APICALL MetadataImpl::GetMemoryArena() const __NOTHROW__ {
+		return mMemoryArena;
+	}
+
+	void APICALL MetadataImpl::AdoptMemoryArena( pMemoryArena arena ) __NOTHROW__ {
+		if ( mMemoryArena == arena ) return;
+		if ( mMemoryArena )
+			mMemoryArena->Release();
+		mMemoryArena = arena;
+	}
+
+	spRDFFragmentCache APICALL MetadataImpl::GetRDFFragmentCache() const __NOTHROW__ {
+		AutoSharedLock lock( mSharedMutex );
+		return mRDFFragmentCache;
+	}
+
+	void APICALL MetadataImpl::SetRDFFragmentCache( const spRDFFragmentCache & cache ) __NOTHROW__ {
+		AutoSharedLock lock( mSharedMutex, true );
+		mRDFFragmentCache = cache;
+	}
+
+	// number of views registered with all the metadata objects.
+	static atomic_sizet sSharedViewCount( 0 );
+
+	void APICALL MetadataImpl::AttachSharedView( ISharedMetadataView_I * view ) __NOTHROW__ {
+		std::lock_guard< std::mutex > lock( mSharedViewsLock );
+		mSharedViews.push_back( view );
+		++sSharedViewCount;
+	}
+
+	void APICALL MetadataImpl::DetachSharedView( ISharedMetadataView_I * view, bool waitForDetach ) __NOTHROW__ {
+		std::unique_lock< std::mutex > lock( mSharedViewsLock );
+		auto it = std::find( mSharedViews.begin(), mSharedViews.end(), view );
+		if ( it != mSharedViews.end() ) {
+			mSharedViews.erase( it );
+			--sSharedViewCount;
+			return;
+		}
+		// DetachSharedViews took the view already, a view being destroyed must outlive that call.
+		if ( waitForDetach ) {
+			while ( std::find( mDetachingViews.begin(), mDetachingViews.end(), view ) != mDetachingViews.end() )
+				mSharedViewsDetached.wait( lock );
+		}
+	}
+
+	void APICALL MetadataImpl::DetachSharedViews() {
+		std::vector< ISharedMetadataView_I * > views;
+		{
+			std::lock_guard< std::mutex > lock( mSharedViewsLock );
+			if ( mSharedViews.empty() ) return;
+			views.swap( mSharedViews );
+			mDetachingViews.insert( mDetachingViews.end(), views.begin(), views.end() );
+			for ( sizet i = 0; i < views.size(); ++i )
+				--sSharedViewCount;
+		}
+		// views copy the metadata under their own lock, so this lock can not be held here.
+		for ( auto it = views.begin(), itEnd = views.end(); it != itEnd; ++it ) {
+			( *it )->DetachFromSharedMetadata();
+			std::lock_guard< std::mutex > lock( mSharedViewsLock );
+			mDetachingViews.erase( std::find( mDetachingViews.begin(), mDetachingViews.end(), *it ) );
+			mSharedViewsDetached.notify_all();
+		}
+	}
+
+	bool IMetadata_I::HasSharedViews() __NOTHROW__ {
+		return sSharedViewCount > 0;
+	}
 
 	spcIUTF8String APICALL MetadataImpl::GetAboutURI() const {
 		AutoSharedLock lock( mSharedMutex );
@@ -43,6 +121,7 @@ namespace AdobeXMPCore_Int {
 	}
 
 	void APICALL MetadataImpl::SetAboutURI( const char * uri, sizet uriLength ) __NOTHROW__ {
+		PrepareForModification();
 		AutoSharedLock lock( mSharedMutex, true );
 		mAboutURI->assign( uri, uriLength );
 	}
@@ -430,6 +509,15 @@ namespace AdobeXMPCore_Int {
 		}
 	}
 
+	spIMetadata IMetadata_I::CreateMetadataUsingMemoryArena( pMemoryArena arena ) {
+		MetadataImpl * metadata = new ( arena ) MetadataImpl();
+		if ( arena ) {
+			arena->Acquire();
+			metadata->AdoptMemoryArena( arena );
+		}
+		return MakeUncheckedSharedPointer( metadata, __FILE__, __LINE__, true );
+	}
+
 }
 
 #if BUILDING_XMPCORE_LIB || SOURCE_COMPILING_XMPCORE_LIB
@@ -19,6 +19,7 @@
 #include "XMPCore/Interfaces/IPath.h"
 #include "XMPCore/Interfaces/IPathSegment_I.h"
 #include "XMPCore/Interfaces/IStructureNode_I.h"
+#include "XMPCore/Interfaces/IMetadata_I.h"
 
 #include "source/XMP_LibUtils.hpp"
 #include "source/UnicodeInlines.incl_cpp"
@@ -68,6 +69,13 @@ namespace AdobeXMPCore_Int {
 		return IPathSegment_I::CreatePropertyPathSegment( node->GetNameSpace(), node->GetName() );
 	}
 
+	// source of the modification stamps, shared by all the nodes so that a stamp is never reused.
+	static atomic_sizet sModificationStampCounter( 0 );
+
+	// value of the counter when a stamp was last handed out by GetModificationStamp. A node with a
+	// newer stamp has not been looked at since it changed, and neither have its ancestors.
+	static atomic_sizet sLastObservedStamp( 0 );
+
 	static const char * kQualifierNodeNameSpace( "http://qualifiers" );
 	static const AdobeXMPCommon::sizet kQualifiersNodeNameSpaceLength( 17 );
 	static const char * kQualifierNodeLocalName( "_qualifiers_" );
@@ -80,6 +88,7 @@ namespace AdobeXMPCore_Int {
 		, mpParent( NULL )
 		, mspParent()
 		, mChangeCount( 0 )
+		, mModificationStamp( ++sModificationStampCounter )
 		, mIsQualifierNode( false )
 	{
 		VerifyNameSpace( nameSpace, nameSpaceLength );
@@ -93,14 +102,17 @@ namespace AdobeXMPCore_Int {
 				return;
 			} else {
 				mspParent.reset();
+				MarkModified( mpParent );
 				if ( mChangeCount > 1 ) {
 					mpParent->GetINode_I()->UnRegisterChange();
 					if ( parent ) parent->GetINode_I()->RegisterChange();
 				}
 				mpParent = parent;
+				MarkModified( mpParent );
 				updateParentSharedPointer();
 			}
 		} else {
+			if ( mpParent && mpParent != parent ) MarkModified( mpParent );
 			if ( mChangeCount > 1 ) {
 				if ( mpParent ) mpParent->GetINode_I()->UnRegisterChange();
 				if ( parent ) parent->GetINode_I()->RegisterChange();
@@ -121,6 +133,16 @@ namespace AdobeXMPCore_Int {
 		return mpParent;
 	}
 
+	pINode APICALL NodeImpl::GetRawNextChildPointer( pcINode child ) __NOTHROW__ {
+		return NULL;
+	}
+
+	pINode APICALL NodeImpl::GetRawNextQualifierPointer( pcINode qualifier ) __NOTHROW__ {
+		AutoSharedLock lock( mSharedMutex );
+		if ( !mQualifiers ) return NULL;
+		return mQualifiers->GetINode_I()->GetRawNextChildPointer( qualifier );
+	}
+
 	spINode APICALL NodeImpl::GetParent() {
 		AutoSharedLock lock( mSharedMutex );
 		if ( mpParent ) {
@@ -137,6 +159,7 @@ namespace AdobeXMPCore_Int {
 		if ( VerifyName( name, nameLength ) ) {
 			spIUTF8String newName = IUTF8String_I::CreateUTF8String( name, nameLength );
 			if ( mName->compare( newName ) == 0 ) return;
+			PrepareForModification();
 			if ( mpParent ) {
 				if ( mpParent->GetINode_I()->ValidateNameOrNameSpaceChangeForAChild( mNameSpace, mName, mNameSpace, newName ) ) {
 					AutoSharedLock( mSharedMutex, true );
@@ -166,6 +189,7 @@ namespace AdobeXMPCore_Int {
 		if ( VerifyNameSpace( nameSpace, nameSpaceLength ) ) {
 			spIUTF8String newNameSpace = IUTF8String_I::CreateUTF8String( nameSpace, nameSpaceLength );
 			if ( mNameSpace->compare( newNameSpace ) == 0 ) return;
+			PrepareForModification();
 			if ( mpParent ) {
 				if ( mpParent->GetINode_I()->ValidateNameOrNameSpaceChangeForAChild( mNameSpace, mName, newNameSpace, mName ) ) {
 					AutoSharedLock( mSharedMutex, true );
@@ -243,12 +267,14 @@ namespace AdobeXMPCore_Int {
 	}
 
 	void APICALL NodeImpl::InsertQualifier( const spINode & node ) {
+		PrepareForModification();
 		CreateQualifierNode();
 		mQualifiers->InsertNode( node );
 		node->GetINode_I()->SetIsQualifierNode( true );
 	}
 
 	spINode APICALL NodeImpl::ReplaceQualifier( const spINode & node ) {
+		PrepareForModification();
 		CreateQualifierNode();
 		auto retValue = mQualifiers->ReplaceNode( node );
 		node->GetINode_I()->SetIsQualifierNode( true );
@@ -256,11 +282,13 @@ namespace AdobeXMPCore_Int {
 	}
 
 	spINode APICALL NodeImpl::RemoveQualifier( const char * nameSpace, sizet nameSpaceLength, const char * name, sizet nameLength ) {
+		PrepareForModification();
 		CreateQualifierNode();
 		return mQualifiers->RemoveNode( nameSpace, nameSpaceLength, name, nameLength );
 	}
 
 	spINode APICALL NodeImpl::RemoveQualifier( const spcIUTF8String & nameSpace, const spcIUTF8String & name ) {
+		PrepareForModification();
 		CreateQualifierNode();
 		return mQualifiers->GetIStructureNode_I()->RemoveQualifier( nameSpace, name );
 	}
@@ -440,13 +468,59 @@ namespace AdobeXMPCore_Int {
 	}
 
 	void NodeImpl::RegisterChange() {
-		mChangeCount++;
-		if ( mChangeCount == 1 ) {
-			auto parent = GetRawParentPointer();
-			if ( parent ) parent->GetINode_I()->RegisterChange();
+		// a single walk up the tree. The change is counted up to the first node which already had
+		// changes, the new stamp is set up to the first node whose stamp nobody has seen yet.
+		sizet stamp = ++sModificationStampCounter;
+		sizet lastObserved = sLastObservedStamp.load();
+		bool counting = true, stamping = true;
+		for ( pINode node = this; node && ( counting || stamping ); ) {
+			pINode_I node_I = node->GetINode_I();
+			if ( stamping ) {
+				stamping = node_I->GetUnobservedModificationStamp() <= lastObserved;
+				node_I->SetModificationStamp( stamp );
+			}
+			if ( counting ) counting = node_I->CountChange();
+			node = node_I->GetRawParentPointer();
+		}
+	}
+
+	bool NodeImpl::CountChange() __NOTHROW__ {
+		return ++mChangeCount == 1;
+	}
+
+	sizet NodeImpl::GetModificationStamp() const __NOTHROW__ {
+		sLastObservedStamp.store( sModificationStampCounter.load() );
+		return mModificationStamp;
+	}
+
+	sizet NodeImpl::GetUnobservedModificationStamp() const __NOTHROW__ {
+		return mModificationStamp;
+	}
+
+	void NodeImpl::SetModificationStamp( sizet stamp ) __NOTHROW__ {
+		mModificationStamp = stamp;
+	}
+
+	void NodeImpl::MarkModified( pINode node ) {
+		// every node on the way to the root gets the new stamp, a subtree is unchanged as long as its root keeps its stamp.
+		sizet stamp = ++sModificationStampCounter;
+		while ( node ) {
+			pINode_I node_I = node->GetINode_I();
+			node_I->SetModificationStamp( stamp );
+			node = node_I->GetRawParentPointer();
 		}
 	}
 
+	void NodeImpl::PrepareForModification() {
+		// the metadata may be in use by objects of the old DOM, they need a copy of the unmodified state.
+		if ( !IMetadata_I::HasSharedViews() ) return;
+		pINode root = this;
+		for ( pINode parent = root->GetINode_I()->GetRawParentPointer(); parent; parent = parent->GetINode_I()->GetRawParentPointer() )
+			root = parent;
+		spIMetadata metadata = root->ConvertToMetadata();
+		if ( metadata ) metadata->GetIMetadata_I()->DetachSharedViews();
+	}
+
 	void NodeImpl::SetIndex( sizet currentIndex ) {
 		mIndex = currentIndex;
 	}
@@ -160,7 +160,7 @@ using namespace std;
 //
 // Each of these is responsible for recognizing an RDF syntax production and adding the appropriate
 // structure to the XMP tree. They simply return for success, failures will throw an exception. The
-// class exists only to provide access to the error notification object.
+// class exists only to provide access to the error notification object and the spare nodes.
 
 class RDF_Parser {
 public:
@@ -191,17 +191,19 @@ public:
 
 	void EmptyPropertyElement ( XMP_Node * xmpParent, const XML_Node & xmlNode, bool isTopLevel );
 
-	RDF_Parser ( XMPMeta::ErrorCallbackInfo * ec ) : errorCallback(ec) {};
+	RDF_Parser ( XMPMeta::ErrorCallbackInfo * ec, XMP_NodeOffspring * spares = 0 ) : errorCallback(ec), spareNodes(spares) {};
 
 private:
 
 	RDF_Parser() { 
 
 		errorCallback = NULL;
+		spareNodes = NULL;
 
 	};	// Hidden on purpose.
 	
 	XMPMeta::ErrorCallbackInfo * errorCallback;
+	XMP_NodeOffspring * spareNodes;	// Nodes kept by XMPMeta::Reset, used before allocating new ones.
 
 	XMP_Node * AddChildNode ( XMP_Node * xmpParent, const XML_Node & xmlNode, const XMP_StringPtr value, bool isTopLevel );
 
@@ -524,7 +526,7 @@ XMP_Node * RDF_Parser::AddChildNode ( XMP_Node * xmpParent, const XML_Node & xml
 	}
 	
 	// Add the new child to the XMP parent node.
-	XMP_Node * newChild = new XMP_Node ( xmpParent, childName, value, childOptions );
+	XMP_Node * newChild = NewSpareNode ( this->spareNodes, xmpParent, childName, value, childOptions );
 	if ( (! isValueNode) || xmpParent->children.empty() ) {
 		 xmpParent->children.push_back ( newChild );
 	} else {
@@ -547,7 +549,7 @@ XMP_Node * RDF_Parser::AddQualifierNode ( XMP_Node * xmpParent, const XMP_VarStr
 
 	XMP_Node * newQual = 0;
 
-	newQual = new XMP_Node ( xmpParent, name, value, kXMP_PropIsQualifier );
+	newQual = NewSpareNode ( this->spareNodes, xmpParent, name.c_str(), value.c_str(), kXMP_PropIsQualifier );
 
 	if ( ! (isLang | isType) ) {
 		xmpParent->qualifiers.push_back ( newQual );
@@ -625,7 +627,7 @@ void RDF_Parser::FixupQualifiedNode ( XMP_Node * xmpParent )
 			XMP_Error error ( kXMPErr_BadXMP, "Duplicate xml:lang for rdf:value element" );
 			this->errorCallback->NotifyClient ( kXMPErrSev_Recoverable, error );
 			XMP_Assert ( xmpParent->qualifiers[0]->name == "xml:lang" );
-			RemoveQualifier ( xmpParent, 0 );	// Use the rdf:value node's language.
+			RemoveQualifier ( xmpParent, size_t(0) );	// Use the rdf:value node's language.
 		}
 
 		XMP_Node * langQual = valueNode->qualifiers[0];
@@ -1447,7 +1449,7 @@ void XMPMeta::ProcessRDF ( const XML_Node & rdfNode, XMP_OptionBits options )
 {
 	IgnoreParam(options);
 	
-	RDF_Parser parser ( &this->errorCallback );
+	RDF_Parser parser ( &this->errorCallback, &this->spareNodes );
 	
 	parser.RDF ( &this->tree, rdfNode );
 
@@ -27,10 +27,12 @@ namespace AdobeXMPCore_Int {
 //	const char * kArrayItemNameSpace = "http://www.w3.org/1999/02/22-rdf-syntax-ns#";
 
 	namespace Parser {
-		static uint64 kAllowedKeys[] = { IConfigurable::ConvertCharBufferToUint64( "rqMetaEl" ), IConfigurable::ConvertCharBufferToUint64( "sctAlias" ) };
+		static uint64 kAllowedKeys[] = { IConfigurable::ConvertCharBufferToUint64( "rqMetaEl" ), IConfigurable::ConvertCharBufferToUint64( "sctAlias" ),
+			IConfigurable::ConvertCharBufferToUint64( "useArena" ) };
 		static ConfigurableImpl::KeyValueTypePair kAllowedKeyValueTypes[] = {
 			std::make_pair( kAllowedKeys[ 0 ], IConfigurable::kDTBool ),
-			std::make_pair( kAllowedKeys[ 1 ], IConfigurable::kDTBool ) };
+			std::make_pair( kAllowedKeys[ 1 ], IConfigurable::kDTBool ),
+			std::make_pair( kAllowedKeys[ 2 ], IConfigurable::kDTBool ) };
 	}
 
 //	static void CreateAndPopulateNode( const spINode & parentNode, XMP_Node * node, bool nodeIsQualifier = false ) {
@@ -86,6 +88,12 @@ namespace AdobeXMPCore_Int {
 	}
 
 	spINode APICALL RDFDOMParserImpl::ParseAsNode( const char * buffer, sizet bufferLength ) {
+		return ParseAsNodeUsingMemoryArena( buffer, bufferLength, NULL );
+	}
+
+	spINode APICALL RDFDOMParserImpl::ParseAsNodeUsingMemoryArena( const char * buffer, sizet bufferLength, pMemoryArena arena ) {
+		// only the nodes of the new DOM come from the arena, the intermediate XMPMeta and anything it
+		// registers, like new namespaces, live on the library's allocator.
 		shared_ptr < XMPMeta > spMeta( new XMPMeta() );
 		try {
 
@@ -116,7 +124,7 @@ namespace AdobeXMPCore_Int {
 			mGenericErrorCallbackPtr->notifications = spMeta->errorCallback.notifications;
 		}
         
-        return IMetadataConverterUtils_I::convertXMPMetatoIMetadata(spMeta.get());
+        return IMetadataConverterUtils_I::convertXMPMetatoIMetadata(spMeta.get(), arena);
 //		spIMetadata metadata = IMetadata::CreateMetadata();
 //		if ( spMeta ) {
 //			metadata->SetAboutURI( spMeta->tree.name.c_str(), spMeta->tree.name.size() );
@@ -143,10 +151,11 @@ namespace AdobeXMPCore_Int {
 		TreatKeyAsCaseInsensitive( true );
 		AllowDifferentValueTypesForExistingEntries( false );
 		
-		SetAllowedKeys( &Parser::kAllowedKeys[ 0 ], 2 );
-		SetAllowedValueTypesForKeys( &Parser::kAllowedKeyValueTypes[ 0 ], 2 );
+		SetAllowedKeys( &Parser::kAllowedKeys[ 0 ], 3 );
+		SetAllowedValueTypesForKeys( &Parser::kAllowedKeyValueTypes[ 0 ], 3 );
 		SetParameter( Parser::kAllowedKeys[ 0 ], false );
 		SetParameter( Parser::kAllowedKeys[ 1 ], false );
+		SetParameter( Parser::kAllowedKeys[ 2 ], false );
 	}
 
 	void RDFDOMParserImpl::SetErrorCallback(XMPMeta::ErrorCallbackInfo * ec) {
@@ -25,9 +25,14 @@
 #include "XMPCommon/Utilities/UTF8String.h"
 #include "XMPCore/Interfaces/INodeIterator_I.h"
 #include "XMPCore/Interfaces/IMetadataConverterUtils_I.h"
+#include "XMPCore/Utilities/NodeCursor.h"
 
 #include "XMPMeta.hpp"
 
+#include <algorithm>
+#include <map>
+#include <vector>
+
 
 namespace AdobeXMPCore_Int {
 
@@ -397,6 +402,222 @@ namespace AdobeXMPCore_Int {
 
 
 
+	//!
+	//! \brief Keeps the RDF of the top level properties of a metadata between serializations.
+	//! \details A serialization only converts and renders the properties modified since the previous one,
+	//! the rest of the packet is assembled from the cached fragments. A property is converted to the old
+	//! DOM only long enough to render its fragment, the cache keeps a stub node with the name and options
+	//! of each property to give the packet its order. Properties are matched using the modification stamps
+	//! of the nodes so changes acknowledged by the client are still noticed.
+	//!
+	class RDFFragmentCache {
+	public:
+		RDFFragmentCache() : mPass( 0 ) {}
+
+		//!
+		//! Serializes the metadata in the canonical form.
+		//! \return false if the metadata has to be serialized as a whole, buffer is left untouched then.
+		//!
+		bool Serialize( const spIMetadata & metadata, XMP_OptionBits options, sizet padding, const char * newline,
+			const char * indent, sizet baseIndent, std::string & buffer );
+
+		//!
+		//! Serializes the metadata in the canonical form into a region of exactly regionSize bytes.
+		//! \return false if the metadata has to be serialized as a whole, fits is left untouched then.
+		//!
+		bool SerializeToRegion( const spIMetadata & metadata, XMP_Uns8 * region, XMP_StringLen regionSize, std::string * overflow,
+			XMP_OptionBits options, const char * newline, const char * indent, sizet baseIndent, bool & fits );
+
+	protected:
+		struct PropertyEntry {
+			PropertyEntry() : mStamp( 0 ), mNode( NULL ), mPass( 0 ) {}
+			sizet				mStamp;
+			XMP_Node *			mNode;		// stub node, NULL if the property has no RDF form.
+			sizet				mPass;
+		};
+		typedef std::map< pcINode, PropertyEntry > PropertyEntryMap;
+
+		bool Update( const spIMetadata & metadata );
+		bool ConvertProperty( const spINode & property, XMP_Node * & propNode );
+		void RemoveProperty( XMP_Node * propNode );
+		void Clear();
+
+		XMP_ReadWriteLock			mLock;
+		XMPMeta						mXMPMeta;		// schema nodes and stub property nodes only.
+		XMP_RDFFragmentCache		mFragments;
+		PropertyEntryMap			mEntries;
+		NodeCursor					mCursor;
+		spcINameSpacePrefixMap_I	mNameSpacePrefixMap;
+		sizet						mPass;
+	};
+
+	bool RDFFragmentCache::Serialize( const spIMetadata & metadata, XMP_OptionBits options, sizet padding, const char * newline,
+		const char * indent, sizet baseIndent, std::string & buffer )
+	{
+		XMP_AutoLock lock( &mLock, kXMP_WriteLock );
+		try {
+			// fragments are rendered during the update, all of them are redone if the formatting changed.
+			if ( SetRDFFragmentFormat( &mFragments, options, newline, indent, ( XMP_Index ) baseIndent ) )
+				Clear();
+			if ( !Update( metadata ) )
+				return false;
+			mXMPMeta.SerializeToBuffer( &buffer, options, ( XMP_StringLen ) padding, newline, indent, ( XMP_Index ) baseIndent, &mFragments );
+		} catch ( ... ) {
+			// let the conversion of the whole metadata report the problem.
+			Clear();
+			return false;
+		}
+		return true;
+	}
+
+	bool RDFFragmentCache::SerializeToRegion( const spIMetadata & metadata, XMP_Uns8 * region, XMP_StringLen regionSize, std::string * overflow,
+		XMP_OptionBits options, const char * newline, const char * indent, sizet baseIndent, bool & fits )
+	{
+		XMP_AutoLock lock( &mLock, kXMP_WriteLock );
+		try {
+			if ( SetRDFFragmentFormat( &mFragments, options, newline, indent, ( XMP_Index ) baseIndent ) )
+				Clear();
+			if ( !Update( metadata ) )
+				return false;
+			fits = mXMPMeta.SerializeToRegion( region, regionSize, overflow, options, newline, indent, ( XMP_Index ) baseIndent, &mFragments );
+		} catch ( ... ) {
+			Clear();
+			return false;
+		}
+		return true;
+	}
+
+	bool RDFFragmentCache::Update( const spIMetadata & metadata ) {
+		// xmpMM:InstanceID can be derived from the about URI during the conversion.
+		if ( metadata->GetAboutURI()->size() != 0 )
+			return false;
+
+		if ( !mNameSpacePrefixMap )
+			mNameSpacePrefixMap = IMetadataConverterUtils_I::mergeWithDefaultNameSpacePrefixMap( spcINameSpacePrefixMap() );
+
+		++mPass;
+		std::vector< XMP_Node * > properties;
+		properties.reserve( metadata->ChildCount() );
+
+		mCursor.Reset( metadata );
+		mCursor.Next();
+		while ( pINode property = mCursor.Next() ) {
+			mCursor.SkipSubtree();
+			sizet stamp = property->GetINode_I()->GetModificationStamp();
+			PropertyEntryMap::iterator pos = mEntries.find( property );
+			if ( pos == mEntries.end() || pos->second.mStamp != stamp ) {
+				XMP_Node * propNode( NULL );
+				if ( !ConvertProperty( MakeUncheckedSharedPointer( property, __FILE__, __LINE__ ), propNode ) )
+					return false;
+				if ( pos == mEntries.end() )
+					pos = mEntries.insert( std::make_pair( property, PropertyEntry() ) ).first;
+				else
+					RemoveProperty( pos->second.mNode );
+				pos->second.mStamp = stamp;
+				pos->second.mNode = propNode;
+			}
+			pos->second.mPass = mPass;
+			if ( pos->second.mNode )
+				properties.push_back( pos->second.mNode );
+		}
+
+		// forget the properties no longer part of the metadata.
+		for ( PropertyEntryMap::iterator it = mEntries.begin(); it != mEntries.end(); ) {
+			if ( it->second.mPass != mPass ) {
+				RemoveProperty( it->second.mNode );
+				mEntries.erase( it++ );
+			} else {
+				++it;
+			}
+		}
+
+		// put the schemas and properties in the order a conversion of the whole metadata would produce.
+		XMP_NodeOffspring & schemas = mXMPMeta.tree.children;
+		for ( size_t i = 0, count = schemas.size(); i < count; ++i )
+			schemas[ i ]->children.clear();
+
+		XMP_NodeOffspring orderedSchemas;
+		for ( size_t i = 0, count = properties.size(); i < count; ++i ) {
+			XMP_Node * schema = properties[ i ]->parent;
+			if ( schema->children.empty() ) orderedSchemas.push_back( schema );
+			schema->children.push_back( properties[ i ] );
+		}
+
+		for ( size_t i = 0, count = schemas.size(); i < count; ++i ) {
+			if ( schemas[ i ]->children.empty() ) delete schemas[ i ];
+		}
+		schemas.swap( orderedSchemas );
+		return true;
+	}
+
+	bool RDFFragmentCache::ConvertProperty( const spINode & property, XMP_Node * & propNode ) {
+		XMPMeta xmpObj;
+		if ( !IMetadataConverterUtils_I::convertIMetadataPropertytoXMPMeta( property, &xmpObj, mNameSpacePrefixMap ) )
+			return false;
+
+		XMP_NodeOffspring & newSchemas = xmpObj.tree.children;
+		if ( newSchemas.empty() ) {
+			propNode = NULL;
+			return true;
+		}
+		if ( newSchemas.size() != 1 || newSchemas[ 0 ]->children.size() != 1 )
+			return false;
+
+		// only a stub of the converted property is kept, along with its fragment.
+		XMP_Node * newSchema = newSchemas[ 0 ];
+		XMP_Node * newProp = newSchema->children[ 0 ];
+		XMP_Node * schema = FindSchemaNode( &mXMPMeta.tree, newSchema->name.c_str(), kXMP_ExistingOnly );
+		if ( schema == NULL ) {
+			schema = new XMP_Node( &mXMPMeta.tree, newSchema->name, newSchema->value, newSchema->options );
+			mXMPMeta.tree.children.push_back( schema );
+		}
+		propNode = new XMP_Node( schema, newProp->name, newProp->options );
+		schema->children.push_back( propNode );
+		RenderRDFFragment( newProp, mFragments, &mFragments.fragments[ propNode ] );
+		return true;
+	}
+
+	void RDFFragmentCache::RemoveProperty( XMP_Node * propNode ) {
+		if ( propNode == NULL ) return;
+		mFragments.fragments.erase( propNode );
+		XMP_NodeOffspring & siblings = propNode->parent->children;
+		siblings.erase( std::find( siblings.begin(), siblings.end(), propNode ) );
+		delete propNode;
+	}
+
+	void RDFFragmentCache::Clear() {
+		mEntries.clear();
+		mFragments.fragments.clear();
+		mXMPMeta.tree.RemoveChildren();
+	}
+
+	// Serializes a metadata reusing the RDF of the properties not modified since its last serialization.
+	static spRDFFragmentCache GetFragmentCache( const spINode & node, XMP_OptionBits options, const spcINameSpacePrefixMap & nameSpacePrefixMap,
+		spIMetadata & metadata )
+	{
+		// the compact form is not cached, neither are prefixes supplied by the client as they can change between calls.
+		if ( ( options & kXMP_UseCompactFormat ) || nameSpacePrefixMap ) return spRDFFragmentCache();
+
+		metadata = node->ConvertToMetadata();
+		if ( !metadata ) return spRDFFragmentCache();
+
+		pIMetadata_I metadata_I = metadata->GetIMetadata_I();
+		spRDFFragmentCache cache = metadata_I->GetRDFFragmentCache();
+		if ( !cache ) {
+			cache = shared_ptr< RDFFragmentCache >( new RDFFragmentCache() );
+			metadata_I->SetRDFFragmentCache( cache );
+		}
+		return cache;
+	}
+
+	static bool SerializeUsingFragmentCache( const spINode & node, XMP_OptionBits options, sizet padding, const char * newline,
+		const char * indent, sizet baseIndent, const spcINameSpacePrefixMap & nameSpacePrefixMap, std::string & buffer )
+	{
+		spIMetadata metadata;
+		spRDFFragmentCache cache = GetFragmentCache( node, options, nameSpacePrefixMap, metadata );
+		return cache && cache->Serialize( metadata, options, padding, newline, indent, baseIndent, buffer );
+	}
+
 	spIUTF8String APICALL RDFDOMSerializerImpl::Serialize( const spINode & node, const spcINameSpacePrefixMap & nameSpacePrefixMap ) {
 		XMP_OptionBits options = 0;
 //		shared_ptr< XMPMeta > spMeta( new XMPMeta() );
@@ -429,13 +650,13 @@ namespace AdobeXMPCore_Int {
 //			}
 //		}
         
-        shared_ptr< XMPMeta > spMeta( (XMPMeta*)(IMetadataConverterUtils_I::convertIMetadatatoXMPMeta(node, options, nameSpacePrefixMap)));
-        
-
 		std::string buffer;
 		uint64 padding;
 		GetSerializationOptions( this, options, padding );
-		spMeta->SerializeToBuffer( &buffer, options, (XMP_Uns32)padding, "", "", 0 );
+		if ( !SerializeUsingFragmentCache( node, options, ( sizet ) padding, "", "", 0, nameSpacePrefixMap, buffer ) ) {
+			shared_ptr< XMPMeta > spMeta( (XMPMeta*)(IMetadataConverterUtils_I::convertIMetadatatoXMPMeta(node, 0, nameSpacePrefixMap)));
+			spMeta->SerializeToBuffer( &buffer, options, (XMP_Uns32)padding, "", "", 0 );
+		}
 		spIUTF8String serializedOutput = IUTF8String_I::CreateUTF8String( buffer.c_str(), buffer.size() );
 		return serializedOutput;
 	}
@@ -503,12 +724,27 @@ namespace AdobeXMPCore_Int {
 //			}
 //		}
         
-        shared_ptr< XMPMeta > spMeta( (XMPMeta*)(IMetadataConverterUtils_I::convertIMetadatatoXMPMeta(node, options, nameSpacePrefixMap)));
 		std::string buffer;
-		spMeta->SerializeToBuffer(&buffer, options, (XMP_Uns32)padding, newline, indent, (XMP_Index)baseIndent);
+		if ( !SerializeUsingFragmentCache( node, options, padding, newline, indent, baseIndent, nameSpacePrefixMap, buffer ) ) {
+			shared_ptr< XMPMeta > spMeta( (XMPMeta*)(IMetadataConverterUtils_I::convertIMetadatatoXMPMeta(node, options, nameSpacePrefixMap)));
+			spMeta->SerializeToBuffer(&buffer, options, (XMP_Uns32)padding, newline, indent, (XMP_Index)baseIndent);
+		}
 		spIUTF8String serializedOutput = IUTF8String_I::CreateUTF8String(buffer.c_str(), buffer.size());
 		return serializedOutput;
 
 	}
 
+	bool APICALL RDFDOMSerializerImpl::SerializeToRegionInternal( const spINode & node, XMP_Uns8 * region, XMP_StringLen regionSize, std::string * overflow,
+		XMP_OptionBits options, const char * newline, const char * indent, sizet baseIndent ) const
+	{
+		// the packet is serialized once, then either copied into the region or padded normally into overflow.
+		bool fits = false;
+		spIMetadata metadata;
+		spRDFFragmentCache cache = GetFragmentCache( node, options, spcINameSpacePrefixMap(), metadata );
+		if ( cache && cache->SerializeToRegion( metadata, region, regionSize, overflow, options, newline, indent, baseIndent, fits ) )
+			return fits;
+		shared_ptr< XMPMeta > spMeta( ( XMPMeta * ) ( IMetadataConverterUtils_I::convertIMetadatatoXMPMeta( node, options, spcINameSpacePrefixMap() ) ) );
+		return spMeta->SerializeToRegion( region, regionSize, overflow, options, newline, indent, ( XMP_Index ) baseIndent );
+	}
+
 }
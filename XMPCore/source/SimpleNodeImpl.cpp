@@ -32,6 +32,7 @@ namespace AdobeXMPCore_Int {
 	}
 
 	void APICALL SimpleNodeImpl::SetValue( const char * value, sizet valueLength ) {
+		PrepareForModification();
 		AutoSharedLock lock( mSharedMutex, true );
 		mValue->assign( value, valueLength );
 		RegisterChange();
@@ -43,6 +44,7 @@ namespace AdobeXMPCore_Int {
 	}
 
 	void APICALL SimpleNodeImpl::SetURIType( bool isURI ) {
+		PrepareForModification();
 		AutoSharedLock( mSharedMutex, true );
 		mIsURIType = isURI;
 		RegisterChange();
@@ -58,6 +60,7 @@ namespace AdobeXMPCore_Int {
 	}
 
 	void APICALL SimpleNodeImpl::ClearContents() {
+		PrepareForModification();
 		AutoSharedLock  lock( mSharedMutex, true );
 		mValue->clear();
 		RegisterChange();
@@ -88,6 +91,13 @@ namespace AdobeXMPCore_Int {
 				value ? value->c_str() : NULL, value ? value->size() : AdobeXMPCommon::npos ), __FILE__, __LINE__, true );
 	}
 
+	spISimpleNode ISimpleNode_I::CreateSimpleNode( pMemoryArena arena, const char * nameSpace, sizet nameSpaceLength,
+		const char * name, sizet nameLength, const char * value, sizet valueLength )
+	{
+		return MakeUncheckedSharedPointer( new ( arena ) SimpleNodeImpl( nameSpace, nameSpaceLength, name, nameLength, value, valueLength ),
+			__FILE__, __LINE__, true );
+	}
+
 }
 
 namespace AdobeXMPCore {
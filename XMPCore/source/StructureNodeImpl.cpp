@@ -46,6 +46,7 @@ namespace AdobeXMPCore_Int {
 	spINode APICALL StructureNodeImpl::RemoveNode( const spcIUTF8String & nameSpace, const spcIUTF8String & name ) {
 		if ( nameSpace->size() == 0 || name->size() == 0 )
 			return spINode();
+		PrepareForModification();
 		QualifiedName qName( nameSpace, name );
 		AutoSharedLock lock( mSharedMutex, true );
 		auto it = mChildrenMap.find( qName );
@@ -79,6 +80,7 @@ namespace AdobeXMPCore_Int {
 	void APICALL StructureNodeImpl::InsertNode( const spINode & node ) {
 		if ( !CheckSuitabilityToBeUsedAsChildNode( node ) )
 			return;
+		PrepareForModification();
 		QualifiedName qName( node->GetNameSpace(), node->GetName() );
 		AutoSharedLock lock( mSharedMutex, true );
 		auto it = mChildrenMap.find( qName );
@@ -118,6 +120,14 @@ namespace AdobeXMPCore_Int {
 			return MakeUncheckedSharedPointer( new TNodeIteratorImpl< QualifiedNameNodeMap::iterator >( beginIt, endIt ), __FILE__, __LINE__, true );
 	}
 
+	pINode APICALL StructureNodeImpl::GetRawNextChildPointer( pcINode child ) __NOTHROW__ {
+		AutoSharedLock lock( mSharedMutex );
+		auto it = child ? mChildrenMap.upper_bound( QualifiedName( child->GetNameSpace(), child->GetName() ) ) : mChildrenMap.begin();
+		if ( it != mChildrenMap.end() )
+			return it->second.get();
+		return NULL;
+	}
+
 	sizet APICALL StructureNodeImpl::ChildCount() const __NOTHROW__ {
 		AutoSharedLock lock( mSharedMutex );
 		return mChildrenMap.size();
@@ -145,6 +155,7 @@ namespace AdobeXMPCore_Int {
 	}
 
 	void APICALL StructureNodeImpl::ClearContents() {
+		PrepareForModification();
 		AutoSharedLock lock( mSharedMutex, true );
 		for ( auto it = mChildrenMap.begin(), itEnd = mChildrenMap.end(); it != itEnd; ++it ) {
 			it->second->GetINode_I()->ChangeParent( NULL );
@@ -208,6 +219,13 @@ namespace AdobeXMPCore_Int {
 			name ? name->c_str() : NULL, name ? name->size(): 0 ), __FILE__, __LINE__ );
 	}
 
+	spIStructureNode IStructureNode_I::CreateStructureNode( pMemoryArena arena, const char * nameSpace, sizet nameSpaceLength,
+		const char * name, sizet nameLength )
+	{
+		return MakeUncheckedSharedPointer( new ( arena ) StructureNodeImpl( nameSpace, nameSpaceLength, name, nameLength ),
+			__FILE__, __LINE__, true );
+	}
+
 	template<>
 	spINode TNodeIteratorImpl< StructureNodeImpl::QualifiedNameNodeMap::iterator >::GetNodeFromIterator( const StructureNodeImpl::QualifiedNameNodeMap::iterator & it ) const {
 		return MakeUncheckedSharedPointer( it->second.get(), __FILE__, __LINE__, false );
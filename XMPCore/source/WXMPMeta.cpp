@@ -29,6 +29,18 @@
 	#endif
 #endif
 
+// Entry for the writers that change the tree, lets the object drop cached hashes and shared data first.
+
+#define XMP_ENTER_TreeWrite(Proc)				\
+	XMP_ENTER_ObjWrite ( XMPMeta, Proc )		\
+		thiz->PrepareForUpdate();
+
+// Entry for the writers that replace the whole tree, shared data need not be copied first.
+
+#define XMP_ENTER_TreeReplace(Proc)				\
+	XMP_ENTER_ObjWrite ( XMPMeta, Proc )		\
+		thiz->PrepareForReplace();
+
 #if __cplusplus
 extern "C" {
 #endif
@@ -408,7 +420,7 @@ WXMPMeta_SetProperty_1 ( XMPMetaRef		xmpObjRef,
 						 XMP_OptionBits options,
 						 WXMP_Result *	wResult )
 {
-	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_SetProperty_1" )
+	XMP_ENTER_TreeWrite ( "WXMPMeta_SetProperty_1" )
 
 		if ( (schemaNS == 0) || (*schemaNS == 0) ) XMP_Throw ( "Empty schema namespace URI", kXMPErr_BadSchema );
 		if ( (propName == 0) || (*propName == 0) ) XMP_Throw ( "Empty property name", kXMPErr_BadXPath );
@@ -429,7 +441,7 @@ WXMPMeta_SetArrayItem_1 ( XMPMetaRef	 xmpObjRef,
 						  XMP_OptionBits options,
 						  WXMP_Result *	 wResult )
 {
-	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_SetArrayItem_1" )
+	XMP_ENTER_TreeWrite ( "WXMPMeta_SetArrayItem_1" )
 
 		if ( (schemaNS == 0) || (*schemaNS == 0) ) XMP_Throw ( "Empty schema namespace URI", kXMPErr_BadSchema );
 		if ( (arrayName == 0) || (*arrayName == 0) ) XMP_Throw ( "Empty array name", kXMPErr_BadXPath );
@@ -450,7 +462,7 @@ WXMPMeta_AppendArrayItem_1 ( XMPMetaRef		xmpObjRef,
 							 XMP_OptionBits options,
 							 WXMP_Result *	wResult )
 {
-	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_AppendArrayItem_1" )
+	XMP_ENTER_TreeWrite ( "WXMPMeta_AppendArrayItem_1" )
 
 		if ( (schemaNS == 0) || (*schemaNS == 0) ) XMP_Throw ( "Empty schema namespace URI", kXMPErr_BadSchema );
 		if ( (arrayName == 0) || (*arrayName == 0) ) XMP_Throw ( "Empty array name", kXMPErr_BadXPath );
@@ -472,7 +484,7 @@ WXMPMeta_SetStructField_1 ( XMPMetaRef	   xmpObjRef,
 							XMP_OptionBits options,
 							WXMP_Result *  wResult )
 {
-	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_SetStructField_1" )
+	XMP_ENTER_TreeWrite ( "WXMPMeta_SetStructField_1" )
 
 		if ( (schemaNS == 0) || (*schemaNS == 0) ) XMP_Throw ( "Empty schema namespace URI", kXMPErr_BadSchema );
 		if ( (structName == 0) || (*structName == 0) ) XMP_Throw ( "Empty struct name", kXMPErr_BadXPath );
@@ -496,7 +508,7 @@ WXMPMeta_SetQualifier_1 ( XMPMetaRef	 xmpObjRef,
 						  XMP_OptionBits options,
 						  WXMP_Result *	 wResult )
 {
-	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_SetQualifier_1" )
+	XMP_ENTER_TreeWrite ( "WXMPMeta_SetQualifier_1" )
 
 		if ( (schemaNS == 0) || (*schemaNS == 0) ) XMP_Throw ( "Empty schema namespace URI", kXMPErr_BadSchema );
 		if ( (propName == 0) || (*propName == 0) ) XMP_Throw ( "Empty property name", kXMPErr_BadXPath );
@@ -516,7 +528,7 @@ WXMPMeta_DeleteProperty_1 ( XMPMetaRef	  xmpObjRef,
 							XMP_StringPtr propName,
 							WXMP_Result * wResult )
 {
-	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_DeleteProperty_1" )
+	XMP_ENTER_TreeWrite ( "WXMPMeta_DeleteProperty_1" )
  
 		if ( (schemaNS == 0) || (*schemaNS == 0) ) XMP_Throw ( "Empty schema namespace URI", kXMPErr_BadSchema );
 		if ( (propName == 0) || (*propName == 0) ) XMP_Throw ( "Empty property name", kXMPErr_BadXPath );
@@ -535,7 +547,7 @@ WXMPMeta_DeleteArrayItem_1 ( XMPMetaRef	   xmpObjRef,
 							 XMP_Index	   itemIndex,
 							 WXMP_Result * wResult )
 {
-	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_DeleteArrayItem_1" )
+	XMP_ENTER_TreeWrite ( "WXMPMeta_DeleteArrayItem_1" )
 
 		if ( (schemaNS == 0) || (*schemaNS == 0) ) XMP_Throw ( "Empty schema namespace URI", kXMPErr_BadSchema );
 		if ( (arrayName == 0) || (*arrayName == 0) ) XMP_Throw ( "Empty array name", kXMPErr_BadXPath );
@@ -555,7 +567,7 @@ WXMPMeta_DeleteStructField_1 ( XMPMetaRef	 xmpObjRef,
 							   XMP_StringPtr fieldName,
 							   WXMP_Result * wResult )
 {
-	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_DeleteStructField_1" )
+	XMP_ENTER_TreeWrite ( "WXMPMeta_DeleteStructField_1" )
 
 		if ( (schemaNS == 0) || (*schemaNS == 0) ) XMP_Throw ( "Empty schema namespace URI", kXMPErr_BadSchema );
 		if ( (structName == 0) || (*structName == 0) ) XMP_Throw ( "Empty struct name", kXMPErr_BadXPath );
@@ -577,7 +589,7 @@ WXMPMeta_DeleteQualifier_1 ( XMPMetaRef	   xmpObjRef,
 							 XMP_StringPtr qualName,
 							 WXMP_Result * wResult )
 {
-	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_DeleteQualifier_1" )
+	XMP_ENTER_TreeWrite ( "WXMPMeta_DeleteQualifier_1" )
 
 		if ( (schemaNS == 0) || (*schemaNS == 0) ) XMP_Throw ( "Empty schema namespace URI", kXMPErr_BadSchema );
 		if ( (propName == 0) || (*propName == 0) ) XMP_Throw ( "Empty property name", kXMPErr_BadXPath );
@@ -727,7 +739,7 @@ WXMPMeta_SetLocalizedText_1 ( XMPMetaRef	 xmpObjRef,
 							  XMP_OptionBits options,
 							  WXMP_Result *	 wResult )
 {
-	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_SetLocalizedText_1" )
+	XMP_ENTER_TreeWrite ( "WXMPMeta_SetLocalizedText_1" )
 
 		if ( (schemaNS == 0) || (*schemaNS == 0) ) XMP_Throw ( "Empty schema namespace URI", kXMPErr_BadSchema );
 		if ( (arrayName == 0) || (*arrayName == 0) ) XMP_Throw ( "Empty array name", kXMPErr_BadXPath );
@@ -748,7 +760,7 @@ WXMPMeta_DeleteLocalizedText_1 ( XMPMetaRef	   xmpObjRef,
                                  XMP_StringPtr specificLang,
                                  WXMP_Result * wResult )
 {
-	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_DeleteLocalizedText_1" )
+	XMP_ENTER_TreeWrite ( "WXMPMeta_DeleteLocalizedText_1" )
 		
 		if ( (schemaNS == 0) || (*schemaNS == 0) ) XMP_Throw ( "Empty schema namespace URI", kXMPErr_BadSchema );
 		if ( (arrayName == 0) || (*arrayName == 0) ) XMP_Throw ( "Empty array name", kXMPErr_BadXPath );
@@ -908,7 +920,7 @@ WXMPMeta_SetProperty_Bool_1 ( XMPMetaRef	 xmpObjRef,
 							  XMP_OptionBits options,
 							  WXMP_Result *	 wResult )
 {
-	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_SetProperty_Bool_1" )
+	XMP_ENTER_TreeWrite ( "WXMPMeta_SetProperty_Bool_1" )
 		
 		if ( (schemaNS == 0) || (*schemaNS == 0) ) XMP_Throw ( "Empty schema namespace URI", kXMPErr_BadSchema );
 		if ( (propName == 0) || (*propName == 0) ) XMP_Throw ( "Empty property name", kXMPErr_BadXPath );
@@ -928,7 +940,7 @@ WXMPMeta_SetProperty_Int_1 ( XMPMetaRef		xmpObjRef,
 							 XMP_OptionBits options,
 							 WXMP_Result *	wResult )
 {
-	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_SetProperty_Int_1" )
+	XMP_ENTER_TreeWrite ( "WXMPMeta_SetProperty_Int_1" )
 		
 		if ( (schemaNS == 0) || (*schemaNS == 0) ) XMP_Throw ( "Empty schema namespace URI", kXMPErr_BadSchema );
 		if ( (propName == 0) || (*propName == 0) ) XMP_Throw ( "Empty property name", kXMPErr_BadXPath );
@@ -948,7 +960,7 @@ WXMPMeta_SetProperty_Int64_1 ( XMPMetaRef	  xmpObjRef,
 							   XMP_OptionBits options,
 							   WXMP_Result *  wResult )
 {
-	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_SetProperty_Int64_1" )
+	XMP_ENTER_TreeWrite ( "WXMPMeta_SetProperty_Int64_1" )
 		
 		if ( (schemaNS == 0) || (*schemaNS == 0) ) XMP_Throw ( "Empty schema namespace URI", kXMPErr_BadSchema );
 		if ( (propName == 0) || (*propName == 0) ) XMP_Throw ( "Empty property name", kXMPErr_BadXPath );
@@ -968,7 +980,7 @@ WXMPMeta_SetProperty_Float_1 ( XMPMetaRef	  xmpObjRef,
 							   XMP_OptionBits options,
 							   WXMP_Result *  wResult )
 {
-	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_SetProperty_Float_1" )
+	XMP_ENTER_TreeWrite ( "WXMPMeta_SetProperty_Float_1" )
 		
 		if ( (schemaNS == 0) || (*schemaNS == 0) ) XMP_Throw ( "Empty schema namespace URI", kXMPErr_BadSchema );
 		if ( (propName == 0) || (*propName == 0) ) XMP_Throw ( "Empty property name", kXMPErr_BadXPath );
@@ -988,7 +1000,7 @@ WXMPMeta_SetProperty_Date_1 ( XMPMetaRef		   xmpObjRef,
 							  XMP_OptionBits	   options,
 							  WXMP_Result *		   wResult )
 {
-	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_SetProperty_Date_1" )
+	XMP_ENTER_TreeWrite ( "WXMPMeta_SetProperty_Date_1" )
 		
 		if ( (schemaNS == 0) || (*schemaNS == 0) ) XMP_Throw ( "Empty schema namespace URI", kXMPErr_BadSchema );
 		if ( (propName == 0) || (*propName == 0) ) XMP_Throw ( "Empty property name", kXMPErr_BadXPath );
@@ -1022,7 +1034,7 @@ void
 WXMPMeta_Sort_1 ( XMPMetaRef	xmpObjRef,
 				  WXMP_Result * wResult )
 {
-	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_Sort_1" )
+	XMP_ENTER_TreeWrite ( "WXMPMeta_Sort_1" )
 
 		thiz->Sort();
 		
@@ -1035,7 +1047,7 @@ void
 WXMPMeta_Erase_1 ( XMPMetaRef	 xmpObjRef,
 				   WXMP_Result * wResult )
 {
-	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_Erase_1" )
+	XMP_ENTER_TreeReplace ( "WXMPMeta_Erase_1" )
 
 		thiz->Erase();
 		
@@ -1044,6 +1056,19 @@ WXMPMeta_Erase_1 ( XMPMetaRef	 xmpObjRef,
 
 // -------------------------------------------------------------------------------------------------
 
+void
+WXMPMeta_Reset_1 ( XMPMetaRef	 xmpObjRef,
+				   WXMP_Result * wResult )
+{
+	XMP_ENTER_TreeReplace ( "WXMPMeta_Reset_1" )
+
+		thiz->Reset();
+		
+	XMP_EXIT
+}
+
+// -------------------------------------------------------------------------------------------------
+
 void
 WXMPMeta_Clone_1 ( XMPMetaRef	  xmpObjRef,
 				   XMP_OptionBits options,
@@ -1149,7 +1174,7 @@ WXMPMeta_SetObjectName_1 ( XMPMetaRef	 xmpObjRef,
 						   XMP_StringPtr name,
 						   WXMP_Result * wResult )
 {
-	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_SetObjectName_1" )
+	XMP_ENTER_TreeWrite ( "WXMPMeta_SetObjectName_1" )
 
 		if ( name == 0 ) name = "";
 
@@ -1174,6 +1199,19 @@ WXMPMeta_GetObjectOptions_1 ( XMPMetaRef    xmpObjRef,
 
 // -------------------------------------------------------------------------------------------------
 
+void
+WXMPMeta_GetFingerprint_1 ( XMPMetaRef    xmpObjRef,
+							WXMP_Result * wResult ) /* const */
+{
+	XMP_ENTER_ObjRead ( XMPMeta, "WXMPMeta_GetFingerprint_1" )
+
+		wResult->int64Result = thiz.GetFingerprint();
+
+	XMP_EXIT
+}
+
+// -------------------------------------------------------------------------------------------------
+
 void
 WXMPMeta_SetObjectOptions_1 ( XMPMetaRef	 xmpObjRef,
 							  XMP_OptionBits options,
@@ -1195,7 +1233,7 @@ WXMPMeta_ParseFromBuffer_1 ( XMPMetaRef		xmpObjRef,
 							 XMP_OptionBits options,
 							 WXMP_Result *	wResult )
 {
-	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_ParseFromBuffer_1" )
+	XMP_ENTER_TreeReplace ( "WXMPMeta_ParseFromBuffer_1" )
 
 		thiz->ParseFromBuffer ( buffer, bufferSize, options );
 		
@@ -1230,6 +1268,58 @@ WXMPMeta_SerializeToBuffer_1 ( XMPMetaRef	  xmpObjRef,
 
 // -------------------------------------------------------------------------------------------------
 
+void
+WXMPMeta_GetSerializedSize_1 ( XMPMetaRef	  xmpObjRef,
+							   XMP_OptionBits options,
+							   XMP_StringPtr  newline,
+							   XMP_StringPtr  indent,
+							   XMP_Index	  baseIndent,
+							   WXMP_Result *  wResult ) /* const */
+{
+	XMP_ENTER_ObjRead ( XMPMeta, "WXMPMeta_GetSerializedSize_1" )
+
+		if ( newline == 0 ) newline = "";
+		if ( indent == 0 ) indent = "";
+
+		wResult->int32Result = thiz.GetSerializedSize ( options, newline, indent, baseIndent );
+
+	XMP_EXIT
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void
+WXMPMeta_SerializeToRegion_1 ( XMPMetaRef	  xmpObjRef,
+							   void *         region,
+							   XMP_StringLen  regionSize,
+							   void *         overflowPacket,
+							   XMP_OptionBits options,
+							   XMP_StringPtr  newline,
+							   XMP_StringPtr  indent,
+							   XMP_Index	  baseIndent,
+							   SetClientStringProc SetClientString,
+							   WXMP_Result *  wResult ) /* const */
+{
+	XMP_ENTER_ObjRead ( XMPMeta, "WXMPMeta_SerializeToRegion_1" )
+
+		if ( (region == 0) && (regionSize != 0) ) XMP_Throw ( "Null region pointer", kXMPErr_BadParam );
+		if ( newline == 0 ) newline = "";
+		if ( indent == 0 ) indent = "";
+
+		XMP_VarString localStr;
+		XMP_VarString * overflow = (overflowPacket == 0) ? 0 : &localStr;
+
+		bool fits = thiz.SerializeToRegion ( (XMP_Uns8*)region, regionSize, overflow, options, newline, indent, baseIndent );
+		if ( (! fits) && (overflowPacket != 0) ) {
+			(*SetClientString) ( overflowPacket, localStr.c_str(), static_cast< XMP_StringLen >( localStr.size() ) );
+		}
+		wResult->int32Result = fits;
+
+	XMP_EXIT
+}
+
+// -------------------------------------------------------------------------------------------------
+
 void
 WXMPMeta_SetDefaultErrorCallback_1 ( XMPMeta_ErrorCallbackWrapper wrapperProc,
 									 XMPMeta_ErrorCallbackProc    clientProc,
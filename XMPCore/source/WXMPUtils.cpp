@@ -440,6 +440,23 @@ WXMPUtils_DecodeFromBase64_1 ( XMP_StringPtr encodedStr,
 	XMP_EXIT
 }
 
+// -------------------------------------------------------------------------------------------------
+
+void
+WXMPUtils_DecodeFromBase64ToBuffer_1 ( XMP_StringPtr encodedStr,
+									   XMP_StringLen encodedLen,
+									   void *        rawBuffer,
+									   XMP_StringLen bufferSize,
+									   WXMP_Result * wResult )
+{
+	XMP_ENTER_Static ( "WXMPUtils_DecodeFromBase64ToBuffer_1" )
+
+		XMP_StringLen rawLen = XMPUtils::DecodeFromBase64 ( encodedStr, encodedLen, rawBuffer, bufferSize );
+		wResult->int32Result = rawLen;
+
+	XMP_EXIT
+}
+
 // =================================================================================================
 
 void
@@ -481,6 +498,7 @@ WXMPUtils_MergeFromJPEG_1 ( XMPMetaRef    wfullXMP,
 
 		XMPMeta * fullXMP = WtoXMPMeta_Ptr ( wfullXMP );
 		XMP_AutoLock fullXMPLock ( &fullXMP->lock, kXMP_WriteLock );
+		fullXMP->PrepareForUpdate();
 
 		const XMPMeta & extendedXMP = WtoXMPMeta_Ref ( wextendedXMP );
 		XMP_AutoLock extendedXMPLock ( &extendedXMP.lock, kXMP_ReadLock );
@@ -541,6 +559,7 @@ WXMPUtils_SeparateArrayItems_1 ( XMPMetaRef 	wxmpObj,
 
 		XMPMeta * xmpObj = WtoXMPMeta_Ptr ( wxmpObj );
 		XMP_AutoLock metaLock ( &xmpObj->lock, kXMP_WriteLock );
+		xmpObj->PrepareForUpdate();
 
 		XMPUtils::SeparateArrayItems ( xmpObj, schemaNS, arrayName, options, catedStr );
 
@@ -561,6 +580,7 @@ WXMPUtils_ApplyTemplate_1 ( XMPMetaRef     wWorkingXMP,
 
 		XMPMeta * workingXMP = WtoXMPMeta_Ptr ( wWorkingXMP );
 		XMP_AutoLock workingLock ( &workingXMP->lock, kXMP_WriteLock );
+		workingXMP->PrepareForUpdate();
 
 		const XMPMeta & templateXMP = WtoXMPMeta_Ref ( wTemplateXMP );
 		XMP_AutoLock templateLock ( &templateXMP.lock, kXMP_ReadLock );
@@ -587,12 +607,63 @@ WXMPUtils_RemoveProperties_1 ( XMPMetaRef 	  wxmpObj,
 
 		XMPMeta * xmpObj = WtoXMPMeta_Ptr ( wxmpObj );
 		XMP_AutoLock metaLock ( &xmpObj->lock, kXMP_WriteLock );
+		xmpObj->PrepareForUpdate();
 
 		XMPUtils::RemoveProperties ( xmpObj, schemaNS, propName, options );
 
 	XMP_EXIT
 }
 
+// -------------------------------------------------------------------------------------------------
+// The batch functions lock each target in the worker thread that modifies it.
+
+void
+WXMPUtils_BatchApplyTemplate_1 ( const XMPMetaRef * wWorkingXMPs,
+								 XMP_Index          count,
+								 XMPMetaRef         wTemplateXMP,
+								 XMP_OptionBits     actions,
+								 XMP_Index          threadCount,
+								 WXMP_Result *      wResult )
+{
+	XMP_ENTER_Static ( "WXMPUtils_BatchApplyTemplate_1" )
+
+		if ( (wWorkingXMPs == 0) && (count != 0) ) XMP_Throw ( "Null working XMP array", kXMPErr_BadParam );
+		if ( count < 0 ) XMP_Throw ( "Negative batch count", kXMPErr_BadParam );
+		XMP_Assert ( wTemplateXMP != 0 );	// Client glue enforced.
+
+		const XMPMeta & templateXMP = WtoXMPMeta_Ref ( wTemplateXMP );
+		XMP_AutoLock templateLock ( &templateXMP.lock, kXMP_ReadLock );
+
+		XMPMeta * const * workingXMPs = (XMPMeta * const *) wWorkingXMPs;
+		XMPUtils::BatchApplyTemplate ( workingXMPs, (size_t)count, templateXMP, actions, threadCount );
+
+	XMP_EXIT
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void
+WXMPUtils_BatchRemoveProperties_1 ( const XMPMetaRef * wxmpObjs,
+									XMP_Index          count,
+									XMP_StringPtr      schemaNS,
+									XMP_StringPtr      propName,
+									XMP_OptionBits     options,
+									XMP_Index          threadCount,
+									WXMP_Result *      wResult )
+{
+	XMP_ENTER_Static ( "WXMPUtils_BatchRemoveProperties_1" )
+
+		if ( (wxmpObjs == 0) && (count != 0) ) XMP_Throw ( "Null XMP object array", kXMPErr_BadParam );
+		if ( count < 0 ) XMP_Throw ( "Negative batch count", kXMPErr_BadParam );
+		if ( schemaNS == 0 ) schemaNS = "";
+		if ( propName == 0 ) propName = "";
+
+		XMPMeta * const * xmpObjs = (XMPMeta * const *) wxmpObjs;
+		XMPUtils::BatchRemoveProperties ( xmpObjs, (size_t)count, schemaNS, propName, options, threadCount );
+
+	XMP_EXIT
+}
+
 // -------------------------------------------------------------------------------------------------
 
 // -------------------------------------------------------------------------------------------------
@@ -620,12 +691,63 @@ WXMPUtils_DuplicateSubtree_1 ( XMPMetaRef     wSource,
 
 		XMPMeta * dest = WtoXMPMeta_Ptr ( wDest );
 		XMP_AutoLock destLock ( &dest->lock, kXMP_WriteLock );
+		dest->PrepareForUpdate();
 
 		XMPUtils::DuplicateSubtree ( source, dest, sourceNS, sourceRoot, destNS, destRoot, options );
 
 	XMP_EXIT
 }
 
+// -------------------------------------------------------------------------------------------------
+
+void
+WXMPUtils_DiffProperties_1 ( XMPMetaRef     wOldXMP,
+							 XMPMetaRef     wNewXMP,
+							 void *         diffStr,
+							 XMP_OptionBits options,
+							 SetClientStringProc SetClientString,
+							 WXMP_Result *  wResult )
+{
+	XMP_ENTER_Static ( "WXMPUtils_DiffProperties_1" )
+
+		XMP_VarString localStr;
+
+		const XMPMeta & oldXMP = WtoXMPMeta_Ref ( wOldXMP );
+		XMP_AutoLock oldLock ( &oldXMP.lock, kXMP_ReadLock );
+
+		const XMPMeta & newXMP = WtoXMPMeta_Ref ( wNewXMP );
+		XMP_AutoLock newLock ( &newXMP.lock, kXMP_ReadLock, (wOldXMP != wNewXMP) );
+
+		XMPUtils::DiffProperties ( oldXMP, newXMP, options, &localStr );
+		if ( diffStr != 0 ) (*SetClientString) ( diffStr, localStr.c_str(), static_cast< XMP_StringLen >( localStr.size() ));
+
+	XMP_EXIT
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void
+WXMPUtils_ApplyDiff_1 ( XMPMetaRef     wxmpObj,
+						XMP_StringPtr  diffStr,
+						XMP_StringLen  diffLen,
+						XMP_OptionBits options,
+						WXMP_Result *  wResult )
+{
+	XMP_ENTER_Static ( "WXMPUtils_ApplyDiff_1" )
+
+		if ( wxmpObj == 0 ) XMP_Throw ( "Output XMP pointer is null", kXMPErr_BadParam );
+		if ( diffStr == 0 ) XMP_Throw ( "Null diff string", kXMPErr_BadParam );
+		if ( diffLen == kXMP_UseNullTermination ) diffLen = (XMP_StringLen) strlen ( diffStr );
+
+		XMPMeta * xmpObj = WtoXMPMeta_Ptr ( wxmpObj );
+		XMP_AutoLock metaLock ( &xmpObj->lock, kXMP_WriteLock );
+
+		// ! The base fingerprint check can use the cached hashes, ApplyDiff forgets them itself.
+		XMPUtils::ApplyDiff ( xmpObj, diffStr, diffLen, options );
+
+	XMP_EXIT
+}
+
 // =================================================================================================
 
 #if __cplusplus
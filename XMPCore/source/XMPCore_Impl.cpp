@@ -1076,7 +1076,7 @@ FindNode ( XMP_Node *		xmpTree,
 {
 	XMP_Node *     currNode = 0;
 	XMP_NodePtrPos currPos;
-	XMP_NodePtrPos newSubPos;	// Root of implicitly created subtree. Valid only if leaf is new.
+	XMP_NodePtrPos newSubPos = XMP_NodePtrPos();	// Root of implicitly created subtree. Valid only if leaf is new.
 	bool           leafIsNew = false;
 	
 	XMP_Assert ( (leafOptions == 0) || createNodes );
@@ -1267,6 +1267,265 @@ CloneSubtree ( const XMP_Node * origRoot, XMP_Node * cloneParent, bool skipEmpty
 	
 }	// CloneSubtree
 
+// =================================================================================================
+// Subtree hashes
+// ==============
+//
+// The hash of a node covers the same things as CompareSubtrees: the value, options, qualifiers, and
+// children, but not the node's own name. Named offspring (qualifiers, schemas, top level properties,
+// and struct fields) are mixed with their names and summed, so their order does not matter. Alt-text
+// items are summed since CompareSubtrees matches them by xml:lang, other array items are chained in
+// order. Subtrees that CompareSubtrees finds equal therefore have equal hashes.
+
+static inline XMP_Uns64
+MixHashBits ( XMP_Uns64 bits )
+{
+	// The finalizer of splitmix64, every input bit affects every output bit.
+	bits = (bits ^ (bits >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	bits = (bits ^ (bits >> 27)) * 0x94D049BB133111EBULL;
+	return bits ^ (bits >> 31);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+XMP_Uns64
+HashSubtreeString ( XMP_StringPtr str, XMP_StringLen len )
+{
+	XMP_Uns64 hash = 0xCBF29CE484222325ULL;	// 64 bit FNV-1a.
+	for ( XMP_StringLen i = 0; i < len; ++i ) {
+		hash = (hash ^ XMP_Uns8(str[i])) * 0x100000001B3ULL;
+	}
+	return MixHashBits ( hash + len );
+}
+
+// -------------------------------------------------------------------------------------------------
+
+XMP_Uns64
+CombineSubtreeHash ( XMP_Uns64 sum, XMP_Uns64 nameHash, XMP_Uns64 offspringHash )
+{
+	return sum + MixHashBits ( nameHash ^ (offspringHash * 0x9E3779B97F4A7C15ULL) );
+}
+
+// -------------------------------------------------------------------------------------------------
+
+XMP_Uns64
+FinishSubtreeHash ( XMP_Uns64 valueHash, XMP_Uns64 qualHash, XMP_Uns64 childHash )
+{
+	XMP_Uns64 hash = MixHashBits ( valueHash + MixHashBits ( qualHash + 1 ) );
+	hash = MixHashBits ( hash ^ (childHash + 0x9E3779B97F4A7C15ULL) );
+	return (hash != 0) ? hash : 1;	// Zero means "not known" in the cache.
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static XMP_Uns64
+HashSubtree ( const XMP_Node * node, bool keepHash )
+{
+	XMP_Uns64 hash = node->subtreeHash.load ( std::memory_order_relaxed );
+	if ( hash != 0 ) return hash;
+
+	XMP_Uns64 valueHash = HashSubtreeString ( node->value.c_str(), (XMP_StringLen)node->value.size() );
+	valueHash = MixHashBits ( valueHash ^ node->options );
+
+	XMP_Uns64 qualHash = 0;
+	for ( size_t qualNum = 0, qualLim = node->qualifiers.size(); qualNum != qualLim; ++qualNum ) {
+		const XMP_Node * qual = node->qualifiers[qualNum];
+		XMP_Uns64 nameHash = HashSubtreeString ( qual->name.c_str(), (XMP_StringLen)qual->name.size() );
+		qualHash = CombineSubtreeHash ( qualHash, nameHash, HashSubtree ( qual, keepHash ) );
+	}
+
+	XMP_Uns64 childHash = 0;
+	if ( (node->parent == 0) || (node->options & (kXMP_SchemaNode | kXMP_PropValueIsStruct)) ) {
+		for ( size_t childNum = 0, childLim = node->children.size(); childNum != childLim; ++childNum ) {
+			const XMP_Node * child = node->children[childNum];
+			XMP_Uns64 nameHash = HashSubtreeString ( child->name.c_str(), (XMP_StringLen)child->name.size() );
+			childHash = CombineSubtreeHash ( childHash, nameHash, HashSubtree ( child, keepHash ) );
+		}
+	} else if ( node->options & kXMP_PropArrayIsAltText ) {
+		for ( size_t childNum = 0, childLim = node->children.size(); childNum != childLim; ++childNum ) {
+			childHash = CombineSubtreeHash ( childHash, 0, HashSubtree ( node->children[childNum], keepHash ) );
+		}
+	} else {
+		for ( size_t childNum = 0, childLim = node->children.size(); childNum != childLim; ++childNum ) {
+			childHash = MixHashBits ( childHash + HashSubtree ( node->children[childNum], keepHash ) );
+		}
+	}
+
+	hash = FinishSubtreeHash ( valueHash, qualHash, childHash );
+	if ( keepHash ) node->subtreeHash.store ( hash, std::memory_order_relaxed );
+	return hash;
+
+}	// HashSubtree
+
+// -------------------------------------------------------------------------------------------------
+// XMP_Node::GetSubtreeHash
+// ------------------------
+//
+// Only whole trees are cached. That way a tree root without a cached hash has nothing cached below
+// it, and ForgetSubtreeHashes can return right away for the usual case of no hashing at all.
+
+XMP_Uns64
+XMP_Node::GetSubtreeHash() const
+{
+	return HashSubtree ( this, (this->parent == 0) );
+}
+
+// -------------------------------------------------------------------------------------------------
+// XMP_Node::ForgetSubtreeHashes
+// -----------------------------
+
+static void
+ForgetHashes ( XMP_Node * node )
+{
+	node->subtreeHash.store ( 0, std::memory_order_relaxed );
+	for ( size_t qualNum = 0, qualLim = node->qualifiers.size(); qualNum != qualLim; ++qualNum ) {
+		ForgetHashes ( node->qualifiers[qualNum] );
+	}
+	for ( size_t childNum = 0, childLim = node->children.size(); childNum != childLim; ++childNum ) {
+		ForgetHashes ( node->children[childNum] );
+	}
+}
+
+void
+XMP_Node::ForgetSubtreeHashes()
+{
+	XMP_Assert ( this->parent == 0 );
+	if ( this->subtreeHash.load ( std::memory_order_relaxed ) != 0 ) ForgetHashes ( this );
+}
+
+// -------------------------------------------------------------------------------------------------
+// XMP_Node::RecycleOffspring
+// --------------------------
+//
+// The tree is flattened in breadth first order using the spare list itself as the work queue. The
+// recycled nodes keep their string buffers and offspring blocks, only the counts are set to zero.
+
+void
+XMP_Node::RecycleOffspring ( XMP_NodeOffspring * spareNodes )
+{
+	size_t spareNum = spareNodes->size();
+
+	spareNodes->reserve ( spareNum + this->children.size() + this->qualifiers.size() );
+	for ( size_t i = 0, lim = this->qualifiers.size(); i < lim; ++i ) spareNodes->push_back ( this->qualifiers[i] );
+	for ( size_t i = 0, lim = this->children.size(); i < lim; ++i ) spareNodes->push_back ( this->children[i] );
+	this->qualifiers.erase ( this->qualifiers.begin(), this->qualifiers.end() );
+	this->children.erase ( this->children.begin(), this->children.end() );
+	this->InvalidateHash();
+
+	for ( ; spareNum < spareNodes->size(); ++spareNum ) {
+		XMP_Node * node = (*spareNodes)[spareNum];
+		for ( size_t i = 0, lim = node->qualifiers.size(); i < lim; ++i ) spareNodes->push_back ( node->qualifiers[i] );
+		for ( size_t i = 0, lim = node->children.size(); i < lim; ++i ) spareNodes->push_back ( node->children[i] );
+		node->qualifiers.erase ( node->qualifiers.begin(), node->qualifiers.end() );
+		node->children.erase ( node->children.begin(), node->children.end() );
+		node->name.erase();
+		node->value.erase();
+		node->options = 0;
+		node->parent = 0;
+		node->subtreeHash.store ( 0, std::memory_order_relaxed );
+	}
+
+}	// XMP_Node::RecycleOffspring
+
+// =================================================================================================
+// XMP_AliasMap
+// ============
+//
+// The index holds the hash of every registered alias name and the map position of that alias. The
+// hashes are forced odd so that zero can mark an empty slot. Linear probing stops at an empty slot,
+// the table is kept at most half full so a miss usually looks at one or two slots.
+
+XMP_Uns64
+XMP_AliasMap::HashName ( XMP_StringPtr name, XMP_StringLen nameLen )
+{
+	return HashSubtreeString ( name, nameLen ) | 1;
+}	// XMP_AliasMap::HashName
+
+// -------------------------------------------------------------------------------------------------
+
+void
+XMP_AliasMap::AddToIndex ( XMP_Uns64 hash, iterator pos )
+{
+	size_t slot = (size_t)hash & this->indexMask;
+	while ( this->hashIndex[slot].hash != 0 ) slot = (slot + 1) & this->indexMask;
+	this->hashIndex[slot].hash = hash;
+	this->hashIndex[slot].pos = pos;
+}	// XMP_AliasMap::AddToIndex
+
+// -------------------------------------------------------------------------------------------------
+
+XMP_AliasMap::iterator
+XMP_AliasMap::find ( XMP_StringPtr name, XMP_StringLen nameLen )
+{
+	if ( this->hashIndex.empty() ) return this->end();
+
+	XMP_Uns64 hash = HashName ( name, nameLen );
+
+	for ( size_t slot = (size_t)hash & this->indexMask; this->hashIndex[slot].hash != 0; slot = (slot + 1) & this->indexMask ) {
+		const IndexEntry & entry = this->hashIndex[slot];
+		if ( (entry.hash == hash) && (entry.pos->first.size() == nameLen) &&
+			 (memcmp ( entry.pos->first.c_str(), name, nameLen ) == 0) ) return entry.pos;
+	}
+
+	return this->end();
+
+}	// XMP_AliasMap::find
+
+// -------------------------------------------------------------------------------------------------
+
+std::pair < XMP_AliasMap::iterator, bool >
+XMP_AliasMap::insert ( const value_type & entry )
+{
+	iterator pos = this->find ( entry.first );
+	if ( pos != this->end() ) return std::pair < iterator, bool > ( pos, false );
+
+	pos = this->BaseMap::insert ( entry ).first;
+
+	if ( (this->size() * 2) <= this->hashIndex.size() ) {
+
+		this->AddToIndex ( HashName ( entry.first.c_str(), (XMP_StringLen)entry.first.size() ), pos );
+
+	} else {
+
+		// Grow the table and rehash every alias. This only happens while registering aliases.
+		size_t newSize = (this->hashIndex.empty()) ? 64 : (this->hashIndex.size() * 2);
+		this->hashIndex.assign ( newSize, IndexEntry() );
+		this->indexMask = newSize - 1;
+		for ( iterator curr = this->begin(), end = this->end(); curr != end; ++curr ) {
+			this->AddToIndex ( HashName ( curr->first.c_str(), (XMP_StringLen)curr->first.size() ), curr );
+		}
+
+	}
+
+	return std::pair < iterator, bool > ( pos, true );
+
+}	// XMP_AliasMap::insert
+
+// =================================================================================================
+// NewSpareNode
+// ============
+//
+// Like new XMP_Node, but takes the node from the spare list if there is one. The node is not added
+// to the parent's offspring.
+
+XMP_Node *
+NewSpareNode ( XMP_NodeOffspring * spareNodes, XMP_Node * parent, XMP_StringPtr name, XMP_StringPtr value, XMP_OptionBits options )
+{
+	if ( (spareNodes == 0) || spareNodes->empty() ) return new XMP_Node ( parent, name, value, options );
+
+	XMP_Node * node = spareNodes->back();
+	spareNodes->pop_back();
+
+	node->parent = parent;
+	node->name.assign ( name );
+	node->value.assign ( value );
+	node->options = options;
+	XMP_Assert ( node->children.empty() && node->qualifiers.empty() && (node->subtreeHash == 0) );
+
+	return node;
+
+}	// NewSpareNode
+
 // =================================================================================================
 // CompareSubtrees
 // ===============
@@ -1274,7 +1533,8 @@ CloneSubtree ( const XMP_Node * origRoot, XMP_Node * cloneParent, bool skipEmpty
 // Compare 2 subtrees for semantic equality. The comparison includes value, qualifiers, and form.
 // Schemas, top level properties, struct fields, and qualifiers are allowed to have differing order,
 // the appropriate right node is found from the left node's name. Alt-text arrays are allowed to be
-// in differing language order, other arrays are compared in order.
+// in differing language order, other arrays are compared in order. If both sides have cached hashes
+// that differ the subtrees can't be equal, equal hashes still get the full comparison.
 
 // *** Might someday consider sorting unordered arrays.
 // *** Should expose this through XMPUtils.
@@ -1282,6 +1542,10 @@ CloneSubtree ( const XMP_Node * origRoot, XMP_Node * cloneParent, bool skipEmpty
 bool
 CompareSubtrees ( const XMP_Node & leftNode, const XMP_Node & rightNode )
 {
+	XMP_Uns64 leftHash  = leftNode.subtreeHash.load ( std::memory_order_relaxed );
+	XMP_Uns64 rightHash = rightNode.subtreeHash.load ( std::memory_order_relaxed );
+	if ( (leftHash != 0) && (rightHash != 0) && (leftHash != rightHash) ) return false;
+
 	// Don't compare the names here, we want to allow the outermost roots to have different names.
 	if ( (leftNode.value != rightNode.value) ||
 	     (leftNode.options != rightNode.options) ||
@@ -1300,7 +1564,12 @@ CompareSubtrees ( const XMP_Node & leftNode, const XMP_Node & rightNode )
 		// The parent node is a tree root, a schema, or a struct.
 		for ( size_t childNum = 0, childLim = leftNode.children.size(); childNum != childLim; ++childNum ) {
 			const XMP_Node * leftChild  = leftNode.children[childNum];
-			const XMP_Node * rightChild = FindConstChild ( &rightNode, leftChild->name.c_str() );
+			const XMP_Node * rightChild;
+			if ( leftNode.parent == 0 ) {
+				rightChild = FindConstSchema ( &rightNode, leftChild->name.c_str() );	// The children of a root are schemas.
+			} else {
+				rightChild = FindConstChild ( &rightNode, leftChild->name.c_str() );
+			}
 			if ( (rightChild == 0) || (! CompareSubtrees ( *leftChild, *rightChild )) ) return false;
 		}
 
@@ -24,6 +24,8 @@
 #include <cassert>
 #include <cstring>
 #include <cstdlib>
+#include <cstddef>
+#include <atomic>
 
 #if XMP_WinBuild
 	#pragma warning ( disable : 4244 )	// possible loss of data (temporary for 64 bit builds)
@@ -39,7 +41,119 @@ class XPathStepInfo;
 
 typedef XMP_Node *	XMP_NodePtr;
 
-typedef std::vector<XMP_Node*>		XMP_NodeOffspring;
+// -------------------------------------------------------------------------------------------------
+// XMP_NodeOffspring
+// =================
+//
+// The children or qualifiers of a node. This is the subset of std::vector<XMP_Node*> used by the
+// rest of the code, packed into one pointer. Most nodes are leaves, an empty list has no block and
+// is just a null pointer. The items are plain pointers, so the block is grown with realloc.
+
+class XMP_NodeOffspring {
+public:
+
+	typedef XMP_Node *			value_type;
+	typedef XMP_Node *&			reference;
+	typedef XMP_Node * const &	const_reference;
+	typedef XMP_Node **			iterator;
+	typedef XMP_Node * const *	const_iterator;
+	typedef size_t				size_type;
+
+	XMP_NodeOffspring() : block(0) {};
+	XMP_NodeOffspring ( const XMP_NodeOffspring & other ) : block(0) { this->assign ( other.begin(), other.end() ); };
+	~XMP_NodeOffspring() { free ( this->block ); };
+
+	XMP_NodeOffspring & operator= ( const XMP_NodeOffspring & other )
+		{ if ( this != &other ) this->assign ( other.begin(), other.end() ); return *this; };
+
+	size_t size() const { return (this->block == 0) ? 0 : this->block->count; };
+	bool empty() const { return (this->block == 0) || (this->block->count == 0); };
+	size_t capacity() const { return (this->block == 0) ? 0 : this->block->capacity; };
+
+	iterator begin() { return (this->block == 0) ? 0 : this->block->items; };
+	iterator end() { return (this->block == 0) ? 0 : (this->block->items + this->block->count); };
+	const_iterator begin() const { return (this->block == 0) ? 0 : this->block->items; };
+	const_iterator end() const { return (this->block == 0) ? 0 : (this->block->items + this->block->count); };
+
+	reference operator[] ( size_t index ) { XMP_Assert ( index < this->size() ); return this->block->items[index]; };
+	const_reference operator[] ( size_t index ) const { XMP_Assert ( index < this->size() ); return this->block->items[index]; };
+	reference front() { return (*this)[0]; };
+	const_reference front() const { return (*this)[0]; };
+	reference back() { return (*this)[this->size()-1]; };
+	const_reference back() const { return (*this)[this->size()-1]; };
+
+	void push_back ( XMP_Node * node )
+	{
+		if ( this->size() == this->capacity() ) this->Grow ( this->size() + 1 );
+		this->block->items[this->block->count++] = node;
+	}
+
+	void pop_back() { XMP_Assert ( ! this->empty() ); --this->block->count; };
+
+	iterator insert ( iterator pos, XMP_Node * node )
+	{
+		size_t index = pos - this->begin();
+		XMP_Assert ( index <= this->size() );
+		if ( this->size() == this->capacity() ) this->Grow ( this->size() + 1 );
+		XMP_Node ** items = this->block->items;
+		memmove ( &items[index+1], &items[index], (this->block->count - index) * sizeof(XMP_Node*) );
+		items[index] = node;
+		++this->block->count;
+		return &items[index];
+	}
+
+	iterator erase ( iterator pos ) { return this->erase ( pos, pos+1 ); };
+
+	iterator erase ( iterator first, iterator last )
+	{
+		if ( first == last ) return first;
+		XMP_Node ** items = this->block->items;
+		XMP_Assert ( (items <= first) && (first <= last) && (last <= items + this->block->count) );
+		memmove ( first, last, ((items + this->block->count) - last) * sizeof(XMP_Node*) );
+		this->block->count -= (XMP_Uns32) (last - first);
+		return first;
+	}
+
+	void clear() { free ( this->block ); this->block = 0; };	// ! Unlike a vector, releases the storage.
+
+	void reserve ( size_t count ) { if ( count > this->capacity() ) this->Grow ( count ); };
+
+	void swap ( XMP_NodeOffspring & other ) { OffspringBlock * temp = this->block; this->block = other.block; other.block = temp; };
+
+	template < typename InputIter >
+	void assign ( InputIter first, InputIter last )
+	{
+		if ( this->block != 0 ) this->block->count = 0;
+		for ( ; first != last; ++first ) this->push_back ( *first );
+	}
+
+private:
+
+	struct OffspringBlock {
+		XMP_Uns32  count, capacity;
+		XMP_Node * items[1];	// Actually capacity items.
+	};
+
+	OffspringBlock * block;
+
+	void Grow ( size_t minCount )
+	{
+		size_t newCapacity = this->capacity() * 2;	// Leaves start with room for 2, arrays double.
+		if ( newCapacity < 2 ) newCapacity = 2;
+		if ( newCapacity < minCount ) newCapacity = minCount;
+		if ( newCapacity > 0x7FFFFFFF ) XMP_Throw ( "Too many children or qualifiers", kXMPErr_NoMemory );
+		size_t newSize = offsetof ( OffspringBlock, items ) + newCapacity * sizeof(XMP_Node*);
+		OffspringBlock * newBlock = (OffspringBlock*) realloc ( this->block, newSize );
+		if ( newBlock == 0 ) XMP_Throw ( "Out of memory for children or qualifiers", kXMPErr_NoMemory );
+		if ( this->block == 0 ) newBlock->count = 0;
+		newBlock->capacity = (XMP_Uns32) newCapacity;
+		this->block = newBlock;
+	}
+
+};
+
+inline void swap ( XMP_NodeOffspring & left, XMP_NodeOffspring & right ) { left.swap ( right ); };
+
 typedef XMP_NodeOffspring::iterator	XMP_NodePtrPos;
 
 typedef XMP_VarString::iterator			XMP_VarStringPos;
@@ -49,7 +163,56 @@ typedef std::vector < XPathStepInfo >		XMP_ExpandedXPath;
 typedef XMP_ExpandedXPath::iterator			XMP_ExpandedXPathPos;
 typedef XMP_ExpandedXPath::const_iterator	XMP_cExpandedXPathPos;
 
-typedef std::map < XMP_VarString, XMP_ExpandedXPath > XMP_AliasMap;	// Alias name to actual path.
+// Alias name to actual path. This is a std::map so that registration and enumeration see the
+// aliases in order, plus a hash index so that the per-property alias checks in the parser and in
+// ExpandXPath cost one hash compare for a name that is not an alias. Aliases are never removed, so
+// the map iterators kept in the index stay valid.
+
+class XMP_AliasMap : private std::map < XMP_VarString, XMP_ExpandedXPath > {
+public:
+
+	typedef std::map < XMP_VarString, XMP_ExpandedXPath > BaseMap;
+
+	// Only what keeps the hash index in step is exposed, erase and clear are deliberately not.
+	using BaseMap::key_type;
+	using BaseMap::mapped_type;
+	using BaseMap::value_type;
+	using BaseMap::size_type;
+	using BaseMap::iterator;
+	using BaseMap::const_iterator;
+	using BaseMap::begin;
+	using BaseMap::end;
+	using BaseMap::size;
+
+	XMP_AliasMap() : indexMask(0) {};
+
+	iterator find ( XMP_StringPtr name, XMP_StringLen nameLen );
+	iterator find ( const XMP_VarString & name ) { return this->find ( name.c_str(), (XMP_StringLen)name.size() ); };
+	const_iterator find ( const XMP_VarString & name ) const { return const_cast<XMP_AliasMap*>(this)->find ( name ); };
+
+	size_type count ( const XMP_VarString & name ) const { return (this->find ( name ) == this->end()) ? 0 : 1; };
+
+	std::pair < iterator, bool > insert ( const value_type & entry );
+
+	mapped_type & operator[] ( const XMP_VarString & name )
+		{ return this->insert ( value_type ( name, mapped_type() ) ).first->second; };
+
+private:
+
+	struct IndexEntry {
+		XMP_Uns64 hash;	// Zero for an empty slot.
+		iterator  pos;
+		IndexEntry() : hash(0) {};
+	};
+
+	std::vector < IndexEntry > hashIndex;	// Open addressed, the size is a power of 2 at most half full.
+	size_t indexMask;
+
+	static XMP_Uns64 HashName ( XMP_StringPtr name, XMP_StringLen nameLen );
+	void AddToIndex ( XMP_Uns64 hash, iterator pos );
+
+};
+
 typedef XMP_AliasMap::iterator			XMP_AliasMapPos;
 typedef XMP_AliasMap::const_iterator	XMP_cAliasMapPos;
 
@@ -237,6 +400,17 @@ CloneSubtree ( const XMP_Node * origRoot, XMP_Node * cloneParent, bool skipEmpty
 extern bool
 CompareSubtrees ( const XMP_Node & leftNode, const XMP_Node & rightNode );
 
+// Building blocks of XMP_Node::GetSubtreeHash, also used to fingerprint the C++ DOM.
+
+extern XMP_Uns64
+HashSubtreeString ( XMP_StringPtr str, XMP_StringLen len );
+
+extern XMP_Uns64
+CombineSubtreeHash ( XMP_Uns64 sum, XMP_Uns64 nameHash, XMP_Uns64 offspringHash );
+
+extern XMP_Uns64
+FinishSubtreeHash ( XMP_Uns64 valueHash, XMP_Uns64 qualHash, XMP_Uns64 childHash );
+
 extern void
 DeleteSubtree ( XMP_NodePtrPos rootNodePos );
 
@@ -255,6 +429,9 @@ DetectAltText ( XMP_Node * xmpParent );
 extern void
 SortNamedNodes ( XMP_NodeOffspring & nodeVector );
 
+extern XMP_Node *
+NewSpareNode ( XMP_NodeOffspring * spareNodes, XMP_Node * parent, XMP_StringPtr name, XMP_StringPtr value, XMP_OptionBits options );
+
 static inline bool
 IsPathPrefix ( XMP_StringPtr fullPath, XMP_StringPtr prefix )
 {
@@ -318,8 +495,13 @@ public:
 		// *** XMP_StringPtr	_namePtr, _valuePtr;	// *** Not working, need operator=?
 	#endif
 
+	// The cached result of GetSubtreeHash, zero if not known. Only whole trees are cached, see
+	// GetSubtreeHash. Most code changes the fields above directly, so the cache is trusted only
+	// between writes to the owning XMPMeta, whose write entry points call ForgetSubtreeHashes.
+	mutable std::atomic<XMP_Uns64> subtreeHash;
+
 	XMP_Node ( XMP_Node * _parent, XMP_StringPtr _name, XMP_OptionBits _options )
-		: options(_options), name(_name), parent(_parent)
+		: options(_options), name(_name), parent(_parent), subtreeHash(0)
 	{
 		#if XMP_DebugBuild
 			XMP_Assert ( (name.find ( ':' ) != XMP_VarString::npos) || (name == kXMP_ArrayItemName) ||
@@ -330,7 +512,7 @@ public:
 	};
 
 	XMP_Node ( XMP_Node * _parent, const XMP_VarString & _name, XMP_OptionBits _options )
-		: options(_options), name(_name), parent(_parent)
+		: options(_options), name(_name), parent(_parent), subtreeHash(0)
 	{
 		#if XMP_DebugBuild
 			XMP_Assert ( (name.find ( ':' ) != XMP_VarString::npos) || (name == kXMP_ArrayItemName) ||
@@ -341,7 +523,7 @@ public:
 	};
 
 	XMP_Node ( XMP_Node * _parent, XMP_StringPtr _name, XMP_StringPtr _value, XMP_OptionBits _options )
-		: options(_options), name(_name), value(_value), parent(_parent)
+		: options(_options), name(_name), value(_value), parent(_parent), subtreeHash(0)
 	{
 		#if XMP_DebugBuild
 			XMP_Assert ( (name.find ( ':' ) != XMP_VarString::npos) || (name == kXMP_ArrayItemName) ||
@@ -352,7 +534,7 @@ public:
 	};
 
 	XMP_Node ( XMP_Node * _parent, const XMP_VarString & _name, const XMP_VarString & _value, XMP_OptionBits _options )
-		: options(_options), name(_name), value(_value), parent(_parent)
+		: options(_options), name(_name), value(_value), parent(_parent), subtreeHash(0)
 	{
 		#if XMP_DebugBuild
 			XMP_Assert ( (name.find ( ':' ) != XMP_VarString::npos) || (name == kXMP_ArrayItemName) ||
@@ -368,6 +550,7 @@ public:
 
 	void RemoveChildren()
 	{
+		this->InvalidateHash();
 		for ( size_t i = 0, vLim = children.size(); i < vLim; ++i ) {
 			if ( children[i] != 0 ) delete children[i];
 		}
@@ -376,6 +559,7 @@ public:
 
 	void RemoveQualifiers()
 	{
+		this->InvalidateHash();
 		for ( size_t i = 0, vLim = qualifiers.size(); i < vLim; ++i ) {
 			if ( qualifiers[i] != 0 ) delete qualifiers[i];
 		}
@@ -384,6 +568,7 @@ public:
 
 	void ClearNode()
 	{
+		this->InvalidateHash();
 		options = 0;
 		name.erase();
 		value.erase();
@@ -393,10 +578,29 @@ public:
 
 	void SetValue( XMP_StringPtr value );
 
-	virtual ~XMP_Node() { RemoveChildren(); RemoveQualifiers(); };
+	// Returns a hash of the value, options, qualifiers, and children, see CompareSubtrees. Equal
+	// subtrees have equal hashes. The hashes are cached when called for the root of a tree.
+	XMP_Uns64 GetSubtreeHash() const;
+
+	// Forgets the cached hash of this node and its ancestors, call after changing the node.
+	void InvalidateHash()
+	{
+		for ( XMP_Node * node = this; node != 0; node = node->parent ) {
+			if ( node->subtreeHash.exchange ( 0, std::memory_order_relaxed ) == 0 ) break;	// Ancestors are already clear.
+		}
+	}
+
+	// Forgets all cached hashes below a tree root, quick if nothing was cached.
+	void ForgetSubtreeHashes();
+
+	// Moves all nodes below this one to the spare list, emptied but keeping the capacity of their
+	// strings and offspring. See XMPMeta::Reset and NewSpareNode.
+	void RecycleOffspring ( XMP_NodeOffspring * spareNodes );
+
+	~XMP_Node() { RemoveChildren(); RemoveQualifiers(); };	// ! Not virtual, there are no subclasses and no vtable.
 
 private:
-	XMP_Node() : options(0), parent(0)	// ! Make sure parent pointer is always set.
+	XMP_Node() : options(0), parent(0), subtreeHash(0)	// ! Make sure parent pointer is always set.
 	{
 		#if XMP_DebugBuild
 			// *** _namePtr  = name.c_str();
@@ -34,222 +34,262 @@
 	static const char * sStageNames[] = { "before", "self", "qualifiers", "children" };
 #endif
 
-static XMP_Node * sDummySchema = 0;	// ! Used for some ugliness with aliases.
-
 // -------------------------------------------------------------------------------------------------
-// AddSchemaProps
-// --------------
+// PushFrame
+// ---------
 //
-// Add the top level properties to the IterNode for a schema.
+// Add a frame for a child or qualifier of the node on top of the stack, extending the current path
+// with the step for the new node. All qualifiers are named and use paths like "Prop/?Qual", struct
+// fields use "Struct/Field", array items use "Array[1]". Schema nodes have an empty path.
 
 static void
-AddSchemaProps ( IterInfo & info, IterNode & iterSchema, const XMP_Node * xmpSchema )
+PushFrame ( IterInfo & info, const XMP_Node * xmpNode, size_t index, bool isQualifier )
 {
+	const IterFrame & parent = info.stack.back();
+	const XMP_Node *  xmpParent = parent.node;
+	IterFrame         frame ( xmpNode, index, isQualifier );
+
+	info.currPath.erase ( parent.pathEnd );
+
+	if ( XMP_NodeIsSchema ( xmpNode->options ) ) {
+
+		info.currSchema = xmpNode->name;	// The path of a schema node stays empty.
+
+	} else if ( isQualifier ) {
+
+		info.currPath += "/?";
+		frame.leafOffset = info.currPath.size();
+		info.currPath += xmpNode->name;
+
+	} else if ( xmpParent->options & kXMP_PropValueIsArray ) {
+
+		char buffer [32];	// AUDIT: Using sizeof(buffer) below for snprintf length is safe.
+		snprintf ( buffer, sizeof(buffer), "[%lu]", (unsigned long)index+1 );	// ! XPath indices are one-based.
+		frame.leafOffset = info.currPath.size();
+		info.currPath += buffer;
+
+	} else {
+
+		if ( xmpParent->options & kXMP_PropValueIsStruct ) info.currPath += '/';
+		frame.leafOffset = info.currPath.size();
+		info.currPath += xmpNode->name;
+
+	}
+
+	frame.pathEnd = info.currPath.size();
+	info.stack.push_back ( frame );
+
 	#if TraceIterators
-		printf ( "    Adding properties of %s\n", xmpSchema->name.c_str() );
+		printf ( "    Moved to %s\n", info.currPath.c_str() );
 	#endif
 
-	for ( size_t propNum = 0, propLim = xmpSchema->children.size(); propNum != propLim; ++propNum ) {
-		const XMP_Node * xmpProp = xmpSchema->children[propNum];
-		// *** set the has-aliases bit when appropriate
-		iterSchema.children.push_back ( IterNode ( xmpProp->options, xmpProp->name, 0 ) );
-		#if TraceIterators
-			printf ( "        %s\n", xmpProp->name.c_str() );
-		#endif
-	}
+}	// PushFrame
 
-}	// AddSchemaProps
+// -------------------------------------------------------------------------------------------------
+// GetSiblings
+// -----------
+
+static inline const XMP_NodeOffspring &
+GetSiblings ( const IterFrame & parent, const IterFrame & frame )
+{
+	return (frame.isQualifier ? parent.node->qualifiers : parent.node->children);
+}
 
 // -------------------------------------------------------------------------------------------------
-// AddNodeOffspring
-// ----------------
+// SetRootLineage
+// --------------
 //
-// Add the immediate children and qualifiers to an IterNode.
+// Set the nodes of the stack levels from the root of the XMP tree down to the root of the iteration.
+// The levels must already exist, only their nodes and indices are set.
 
 static void
-AddNodeOffspring ( IterInfo & info, IterNode & iterParent, const XMP_Node * xmpParent )
+SetRootLineage ( IterInfo & info, const XMP_Node * rootNode )
 {
-	XMP_VarString currPath ( iterParent.fullPath );
-	size_t        leafOffset = iterParent.fullPath.size();
-	
-	if ( (! xmpParent->qualifiers.empty()) && (! (info.options & kXMP_IterOmitQualifiers)) ) {
+	const XMP_Node * xmpNode = rootNode;
+
+	for ( size_t level = info.rootLevel; level > 0; --level ) {
+		const XMP_Node * xmpParent = xmpNode->parent;
+		bool isQualifier = XMP_PropIsQualifier ( xmpNode->options );
+		const XMP_NodeOffspring & siblings = (isQualifier ? xmpParent->qualifiers : xmpParent->children);
+		size_t index = 0;
+		while ( (index < siblings.size()) && (siblings[index] != xmpNode) ) ++index;
+		IterFrame & frame = info.stack[level];
+		frame.node = xmpNode;
+		frame.index = index;
+		frame.isQualifier = isQualifier;
+		xmpNode = xmpParent;
+	}
 
-		#if TraceIterators
-			printf ( "    Adding qualifiers of %s\n", currPath.c_str() );
-		#endif
+	info.stack[0].node = xmpNode;
 
-		currPath += "/?";	// All qualifiers are named and use paths like "Prop/?Qual".
-		leafOffset += 2;
-		
-		for ( size_t qualNum = 0, qualLim = xmpParent->qualifiers.size(); qualNum != qualLim; ++qualNum ) {
-			const XMP_Node * xmpQual = xmpParent->qualifiers[qualNum];
-			currPath += xmpQual->name;
-			iterParent.qualifiers.push_back ( IterNode ( xmpQual->options, currPath, leafOffset ) );
-			currPath.erase ( leafOffset );
-			#if TraceIterators
-				printf ( "        %s\n", xmpQual->name.c_str() );
-			#endif
-		}
-		
-		leafOffset -= 2;
-		currPath.erase ( leafOffset );
+}	// SetRootLineage
 
-	}
+// -------------------------------------------------------------------------------------------------
+// FindFrameNode
+// -------------
+//
+// Find the node for a frame below the root of the iteration among the current offspring of its
+// parent, without looking at the node pointer of the frame. Schema are found by URI, array items by
+// index, everything else by the name at the end of the frame's path. Returns the size of siblings
+// if the node is gone.
 
-	if ( ! xmpParent->children.empty() ) {
-	
-		#if TraceIterators
-			printf ( "    Adding children of %s\n", currPath.c_str() );
-		#endif
+static size_t
+FindFrameNode ( const IterInfo & info, size_t level, const XMP_Node * xmpParent, const XMP_NodeOffspring & siblings )
+{
+	const IterFrame & frame = info.stack[level];
+	size_t limit = siblings.size();
+
+	const char * name;
+	size_t nameLen;
+
+	if ( level == 1 ) {
+		name = info.currSchema.c_str();
+		nameLen = info.currSchema.size();
+	} else if ( (! frame.isQualifier) && (xmpParent->options & kXMP_PropValueIsArray) ) {
+		if ( (frame.index < limit) && (info.currPath[frame.leafOffset] == '[') ) return frame.index;
+		return limit;
+	} else {
+		name = info.currPath.c_str() + frame.leafOffset;
+		nameLen = frame.pathEnd - frame.leafOffset;
+	}
 
-		XMP_Assert ( xmpParent->options & kXMP_PropCompositeMask );
-		
-		if ( xmpParent->options & kXMP_PropValueIsStruct ) {
-			currPath += '/';
-			leafOffset += 1;
-		}
-		
-		for ( size_t childNum = 0, childLim = xmpParent->children.size(); childNum != childLim; ++childNum ) {
-			const XMP_Node * xmpChild = xmpParent->children[childNum];
-			if ( ! (xmpParent->options & kXMP_PropValueIsArray) ) {
-				currPath += xmpChild->name;
-			} else {
-				char buffer [32];	// AUDIT: Using sizeof(buffer) below for snprintf length is safe.
-				snprintf ( buffer, sizeof(buffer), "[%lu]", (unsigned long)childNum+1 );	// ! XPath indices are one-based.
-				currPath += buffer;
-			}
-			iterParent.children.push_back ( IterNode ( xmpChild->options, currPath, leafOffset ) );
-			currPath.erase ( leafOffset );
-			#if TraceIterators
-				printf ( "        %s\n", (iterParent.children.back().fullPath.c_str() + leafOffset) );
-			#endif
-		}
-	
+	if ( (frame.index < limit) && (siblings[frame.index]->name.compare ( 0, XMP_VarString::npos, name, nameLen ) == 0) ) {
+		return frame.index;
 	}
 
-}	// AddNodeOffspring
+	size_t index = 0;
+	while ( (index < limit) && (siblings[index]->name.compare ( 0, XMP_VarString::npos, name, nameLen ) != 0) ) ++index;
+	return index;
+
+}	// FindFrameNode
 
 // -------------------------------------------------------------------------------------------------
-// SetCurrSchema
+// ValidateStack
 // -------------
+//
+// The client may have modified the XMP object since the previous step. The node pointers in the
+// stack are only trusted while the update count of the XMPMeta object is unchanged, a deleted node
+// might have been freed and its address reused. Otherwise the root of the iteration is looked up
+// again by path, and the nodes below it by name or index from the top down. A node that moved among
+// its siblings is followed, a node that is gone is replaced by whatever sibling took its place.
 
-static inline void
-SetCurrSchema ( IterInfo & info, XMP_StringPtr schemaName )
+static void
+ValidateStack ( IterInfo & info )
 {
+	if ( info.updateCount == info.xmpObj->updateCount ) return;
+	info.updateCount = info.xmpObj->updateCount;
 
-	info.currSchema = schemaName;
-	#if 0	// *** XMP_DebugBuild
-		info._schemaPtr = info.currSchema.c_str();
-	#endif
+	if ( info.rootLevel > 0 ) {
 
-}	// SetCurrSchema
+		const XMP_Node * rootNode;
+		if ( info.rootPath.empty() ) {
+			rootNode = FindConstSchema ( &info.xmpObj->tree, info.currSchema.c_str() );
+		} else {
+			rootNode = FindConstNode ( &info.xmpObj->tree, info.rootPath );
+		}
 
-static inline void
-SetCurrSchema ( IterInfo & info, XMP_VarString & schemaName )
-{
+		size_t rootDepth = 0;
+		for ( const XMP_Node * xmpNode = rootNode; xmpNode != 0; xmpNode = xmpNode->parent ) ++rootDepth;
 
-	info.currSchema = schemaName;
-	#if 0	// *** XMP_DebugBuild
-		info._schemaPtr = info.currSchema.c_str();
-	#endif
+		if ( rootDepth != (info.rootLevel + 1) ) {	// The root is gone, or is now an alias.
+			info.stack.clear();
+			return;
+		}
+
+		SetRootLineage ( info, rootNode );
+
+	}
+
+	for ( size_t level = info.rootLevel + 1; level < info.stack.size(); ++level ) {
+
+		IterFrame & frame = info.stack[level];
+		const XMP_Node * xmpParent = info.stack[level-1].node;
+		const XMP_NodeOffspring & siblings = (frame.isQualifier ? xmpParent->qualifiers : xmpParent->children);
+
+		size_t index = FindFrameNode ( info, level, xmpParent, siblings );
+
+		if ( index < siblings.size() ) {
+			frame.node = siblings[index];
+			frame.index = index;
+			continue;
+		}
+
+		bool isQualifier = frame.isQualifier;
+		index = frame.index;
+		info.stack.erase ( info.stack.begin() + level, info.stack.end() );
+		if ( index < siblings.size() ) {
+			PushFrame ( info, siblings[index], index, isQualifier );
+		}
+		return;
+
+	}
 
-}	// SetCurrSchema
+}	// ValidateStack
 
 // -------------------------------------------------------------------------------------------------
 // AdvanceIterPos
 // --------------
 //
-// Adjust currPos and possibly endPos for the next step in a pre-order depth-first traversal. The
-// current node has just been visited, move on to its qualifiers, children, then siblings, or back
-// up to an ancestor. AdvanceIterPos either moves to a property or qualifier node that can be
-// visited, or to the end of the entire iteration.
+// Move the top of the stack to the next node to visit in a pre-order depth-first traversal. The
+// node on top has just been visited, move on to its qualifiers, children, then siblings, or back up
+// to an ancestor. AdvanceIterPos either moves to a node that can be visited, or empties the stack
+// at the end of the entire iteration. With kXMP_IterJustChildren nothing is entered below the
+// immediate children of the root.
 
 static void
 AdvanceIterPos ( IterInfo & info )
 {
-	// -------------------------------------------------------------------------------------------
-	// Keep looking until we find a node to visit or the end of everything. The first time through
-	// the current node will exist, we just visited it. But we have to keep looking if the current
-	// node was the last of its siblings or is an empty schema.
-	
-	// ! It is possible that info.currPos == info.endPos on entry. Don't dereference info.currPos yet!
 
-	while ( true ) {
-	
-		if ( info.currPos == info.endPos ) {
-		
-			// ------------------------------------------------------------------------------------
-			// At the end of a set of siblings, move up to an ancestor. We've either just finished
-			// the qualifiers and will move to the children, or have just finished the children and
-			// will move on to the next sibling.
-			
-			if ( info.ancestors.empty() ) break;	// We're at the end of the schema list.
-
-			IterPosPair & parent = info.ancestors.back();
-			info.currPos = parent.first;
-			info.endPos  = parent.second;
-			info.ancestors.pop_back();
-			
-			#if TraceIterators
-				printf ( "    Moved up to %s, stage = %s\n",
-				         info.currPos->fullPath.c_str(), sStageNames[info.currPos->visitStage] );
-			#endif
-		
-		} else {
-			
-			// -------------------------------------------------------------------------------------------
-			// Decide what to do with this iteration node based on its state. Don't use a switch statment,
-			// some of the cases want to break from the loop. A break in a switch just exits the case.
-			
-			#if TraceIterators
-				printf ( "    Moving from %s, stage = %s\n",
-				         info.currPos->fullPath.c_str(), sStageNames[info.currPos->visitStage] );
-			#endif
-			
-			if ( info.currPos->visitStage == kIter_BeforeVisit ) {		// Visit this node now.
-				if ( info.currPos->options & kXMP_SchemaNode ) SetCurrSchema ( info, info.currPos->fullPath );
-				break;
-			}
+	while ( ! info.stack.empty() ) {
 
-			if ( info.currPos->visitStage == kIter_VisitSelf ) {		// Just finished visiting the value portion.
-				info.currPos->visitStage = kIter_VisitQualifiers;		// Start visiting the qualifiers.
-				if ( ! info.currPos->qualifiers.empty() ) {
-					info.ancestors.push_back ( IterPosPair ( info.currPos, info.endPos ) );
-					info.endPos  = info.currPos->qualifiers.end();		// ! Set the parent's endPos before changing currPos!
-					info.currPos = info.currPos->qualifiers.begin();
-					break;
-				}
-			}
+		IterFrame &      top     = info.stack.back();
+		const XMP_Node * xmpNode = top.node;
+		size_t           level   = info.stack.size() - 1;
+		bool             descend = (! (info.options & kXMP_IterJustChildren)) || (level == info.rootLevel);
+
+		#if TraceIterators
+			printf ( "    Moving from %s, stage = %s\n", info.currPath.c_str(), sStageNames[top.visitStage] );
+		#endif
+
+		if ( top.visitStage == kIter_BeforeVisit ) {
+			if ( (! XMP_NodeIsSchema ( xmpNode->options )) || (! xmpNode->children.empty()) ||
+				 (info.options & kXMP_IterJustChildren) ) break;	// Visit this node now.
+			top.visitStage = kIter_VisitChildren;	// Empty schema nodes are not visited.
+		}
 
-			if ( info.currPos->visitStage == kIter_VisitQualifiers ) {	// Just finished visiting the qualifiers.
-				info.currPos->qualifiers.clear();
-				info.currPos->visitStage = kIter_VisitChildren;			// Start visiting the children.
-				if ( ! info.currPos->children.empty() ) {
-					info.ancestors.push_back ( IterPosPair ( info.currPos, info.endPos ) );
-					info.endPos  = info.currPos->children.end();		// ! Set the parent's endPos before changing currPos!
-					info.currPos = info.currPos->children.begin();
-					break;
-				}
+		if ( top.visitStage == kIter_VisitSelf ) {		// Just finished visiting the value portion.
+			top.visitStage = kIter_VisitQualifiers;		// Start visiting the qualifiers.
+			if ( descend && (! xmpNode->qualifiers.empty()) && (! (info.options & kXMP_IterOmitQualifiers)) ) {
+				PushFrame ( info, xmpNode->qualifiers[0], 0, true );
+				continue;
 			}
+		}
 
-			if ( info.currPos->visitStage == kIter_VisitChildren ) {	// Just finished visiting the children.
-				info.currPos->children.clear();
-				++info.currPos;											// Move to the next sibling.
+		if ( top.visitStage == kIter_VisitQualifiers ) {	// Just finished visiting the qualifiers.
+			top.visitStage = kIter_VisitChildren;			// Start visiting the children.
+			if ( descend && (! xmpNode->children.empty()) ) {
+				PushFrame ( info, xmpNode->children[0], 0, false );
 				continue;
 			}
-			
-			#if TraceIterators
-				if ( info.currPos != info.endPos ) {
-					printf ( "    Moved to %s, stage = %s\n",
-					         info.currPos->fullPath.c_str(), sStageNames[info.currPos->visitStage] );
-				}
-			#endif
-			
 		}
 
-	}	// Loop to find the next node.
-	
-	XMP_Assert ( (info.currPos == info.endPos) || (info.currPos->visitStage == kIter_BeforeVisit) );
+		// Just finished visiting the children, move to the next sibling.
+
+		if ( level == info.rootLevel ) {
+			info.stack.clear();		// Done with the root of the iteration.
+			break;
+		}
+
+		IterFrame frame ( top );
+		info.stack.pop_back();
+		const XMP_NodeOffspring & siblings = GetSiblings ( info.stack.back(), frame );
+		if ( frame.index + 1 < siblings.size() ) {
+			PushFrame ( info, siblings[frame.index+1], frame.index+1, frame.isQualifier );
+		}
+
+	}
+
+	XMP_Assert ( info.stack.empty() || (info.stack.back().visitStage == kIter_BeforeVisit) );
 
 }	// AdvanceIterPos
 
@@ -258,65 +298,20 @@ AdvanceIterPos ( IterInfo & info )
 // --------------
 //
 // Used by XMPIterator::Next to obtain the next XMP node, ignoring the kXMP_IterJustLeafNodes flag.
-// This isolates some messy code, allowing a clean loop in Next if kXMP_IterJustLeafNodes is set.
+// On entry the top of the stack is either a node that has not been visited yet, or the node that
+// was returned by the previous call.
 
 static const XMP_Node *
 GetNextXMPNode ( IterInfo & info )
 {
-	const XMP_Node * xmpNode = 0;
-
-	// ----------------------------------------------------------------------------------------------
-	// On entry currPos points to an iteration node whose state is either before-visit or visit-self.
-	// If it is before-visit then we will return that node's value part now. If it is visit-self it
-	// means the previous iteration returned the value portion of that node, so we can advance to the
-	// next node in the iteration tree. Then we find the corresponding XMP node, allowing for the XMP
-	// tree to have been modified since that part of the iteration tree was constructed.
-	
-	// ! NOTE: Supporting aliases throws in some nastiness with schemas. There might not be any XMP
-	// ! node for the schema, but we still have to visit it because of possible aliases. The static
-	// ! sDummySchema is returned if there is no real schema node.
+	ValidateStack ( info );
+	if ( info.stack.empty() ) return 0;
 
-	if ( info.currPos->visitStage != kIter_BeforeVisit ) AdvanceIterPos ( info );
-	
-	bool isSchemaNode = false;
-	XMP_ExpandedXPath expPath;	// Keep outside the loop to avoid constant construct/destruct.
-	
-	while ( info.currPos != info.endPos ) {
+	if ( info.stack.back().visitStage != kIter_BeforeVisit ) AdvanceIterPos ( info );
+	if ( info.stack.empty() ) return 0;
 
-		isSchemaNode = XMP_NodeIsSchema ( info.currPos->options );
-		if ( isSchemaNode ) {
-			SetCurrSchema ( info, info.currPos->fullPath );
-			xmpNode = FindConstSchema ( &info.xmpObj->tree, info.currPos->fullPath.c_str() );
-			if ( xmpNode == 0 ) xmpNode = sDummySchema;
-		} else {
-			ExpandXPath ( info.currSchema.c_str(), info.currPos->fullPath.c_str(), &expPath );
-			xmpNode = FindConstNode ( &info.xmpObj->tree, expPath );
-		}
-		if ( xmpNode != 0 ) break;	// Exit the loop, we found a live XMP node.
-
-		info.currPos->visitStage = kIter_VisitChildren;	// Make AdvanceIterPos move to the next sibling.
-		info.currPos->children.clear();
-		info.currPos->qualifiers.clear();
-		AdvanceIterPos ( info );
-
-	}
-
-	if ( info.currPos == info.endPos ) return 0;
-	
-	// -------------------------------------------------------------------------------------------
-	// Now we've got the iteration node and corresponding XMP node. Add the iteration children for
-	// structs and arrays. The children of schema were added when the iterator was constructed.
-
-	XMP_Assert ( info.currPos->visitStage == kIter_BeforeVisit );
-
-	if ( info.currPos->visitStage == kIter_BeforeVisit ) {
-		if ( (! isSchemaNode) && (! (info.options & kXMP_IterJustChildren)) ) {
-			AddNodeOffspring ( info, *info.currPos, xmpNode );
-		}
-		info.currPos->visitStage = kIter_VisitSelf;
-	}
-	
-	return xmpNode;
+	info.stack.back().visitStage = kIter_VisitSelf;
+	return info.stack.back().node;
 
 }	// GetNextXMPNode
 
@@ -331,7 +326,6 @@ GetNextXMPNode ( IterInfo & info )
 /* class static */ bool
 XMPIterator::Initialize()
 {
-	sDummySchema = new XMP_Node ( 0, "dummy:schema/", kXMP_SchemaNode);
 	return true;
 	
 }	// Initialize
@@ -343,8 +337,6 @@ XMPIterator::Initialize()
 /* class static */ void
 XMPIterator::Terminate() RELEASE_NO_THROW
 {
-	delete ( sDummySchema );
-	sDummySchema = 0;
 	return;
 	
 }	// Terminate
@@ -357,13 +349,11 @@ XMPIterator::Terminate() RELEASE_NO_THROW
 // XMPIterator
 // -----------
 //
-// Constructor for iterations over the nodes in an XMPMeta object. This builds a tree of iteration
-// nodes that caches the existing node names of the XMPMeta object. The iteration tree is a partial
-// replica of the XMPMeta tree. The initial iteration tree normally has just the root node, all of
-// the schema nodes for a full object iteration. Lower level nodes (children and qualifiers) are 
-// added when the parent is visited. If the kXMP_IterJustChildren option is passed then the initial
-// iterator includes the children and the parent is marked as done. The iteration tree nodes are
-// pruned when they are no longer needed. 
+// Constructor for iterations over the nodes in an XMPMeta object. The iteration walks the XMPMeta
+// tree itself, nothing is cached up front. The stack initially holds the nodes from the root of the
+// XMPMeta tree down to the root of the iteration: the XMPMeta root itself for a full object
+// iteration, a schema node, or a property node. The root of a full object iteration is never
+// visited, neither is the root of any iteration if the kXMP_IterJustChildren option is passed.
 
 XMPIterator::XMPIterator ( const XMPMeta & xmpObj,
 						   XMP_StringPtr   schemaNS,
@@ -387,7 +377,7 @@ XMPIterator::XMPIterator ( const XMPMeta & xmpObj,
 		
 		XMP_ExpandedXPath propPath;
 		ExpandXPath ( schemaNS, propName, &propPath );
-		XMP_Node * propNode = FindConstNode ( &xmpObj.tree, propPath );	// If not found get empty iteration.
+		const XMP_Node * propNode = FindConstNode ( &xmpObj.tree, propPath );	// If not found get empty iteration.
 		
 		if ( propNode != 0 ) {
 
@@ -403,78 +393,71 @@ XMPIterator::XMPIterator ( const XMPMeta & xmpObj,
 			while ( (leafOffset > 0) && (propName[leafOffset] != '/') && (propName[leafOffset] != '[') ) --leafOffset;
 			if ( propName[leafOffset] == '/' ) ++leafOffset;
 
-			info.tree.children.push_back ( IterNode ( propNode->options, propName, leafOffset ) );
-			SetCurrSchema ( info, propPath[kSchemaStep].step.c_str() );
-			if ( info.options & kXMP_IterJustChildren ) {
-				AddNodeOffspring ( info, info.tree.children.back(), propNode );
-			}
+			// The stack levels above the root hold its ancestors, they are found again after changes.
 
-		}
-	
-	} else if ( *schemaNS != 0 ) {
+			size_t rootDepth = 0;
+			for ( const XMP_Node * xmpNode = propNode; xmpNode != 0; xmpNode = xmpNode->parent ) ++rootDepth;
+
+			info.stack.reserve ( rootDepth + 4 );
+			info.stack.assign ( rootDepth, IterFrame ( 0, 0, false ) );
+			info.rootLevel = rootDepth - 1;
+			SetRootLineage ( info, propNode );
+
+			IterFrame & root = info.stack.back();
+			root.pathEnd = rootName.size();
+			root.leafOffset = leafOffset;
+			info.currPath = rootName;
+			info.currSchema = propPath[kSchemaStep].step;
+			info.rootPath.swap ( propPath );
 
-		// An iterator for all properties in one schema.
-		
-		#if TraceIterators
-			printf ( "\nNew XMP schema iterator for \"%s\", options = %X\n    Schema = %s\n",
-			         xmpObj.tree.name.c_str(), options, schemaNS );
-		#endif
-		
-		info.tree.children.push_back ( IterNode ( kXMP_SchemaNode, schemaNS, 0 ) );
-		IterNode & iterSchema = info.tree.children.back();
-		
-		XMP_Node * xmpSchema = FindConstSchema ( &xmpObj.tree, schemaNS );
-		if ( xmpSchema != 0 ) AddSchemaProps ( info, iterSchema, xmpSchema );
-		
-		if ( iterSchema.children.empty() ) {
-			info.tree.children.pop_back();	// No properties, remove the schema node.
-		} else {
-			SetCurrSchema ( info, schemaNS );
 		}
 	
 	} else {
 
-		// An iterator for all properties in all schema. First add schema that exist (have children),
-		// adding aliases from them if appropriate. Then add schema that have no actual properties
-		// but do have aliases to existing properties, if we're including aliases in the iteration.
-		
+		// An iterator for all properties in one schema, or for all properties in all schema.
+		// Schema without properties are only visited for a full object iteration using the
+		// kXMP_IterJustChildren option.
+
 		#if TraceIterators
-			printf ( "\nNew XMP tree iterator for \"%s\", options = %X\n",
-			         xmpObj.tree.name.c_str(), options );
+			printf ( "\nNew XMP iterator for \"%s\", options = %X\n    Schema = %s\n",
+			         xmpObj.tree.name.c_str(), options, schemaNS );
 		#endif
-		
-		// First pick up the schema that exist.
-		
-		for ( size_t schemaNum = 0, schemaLim = xmpObj.tree.children.size(); schemaNum != schemaLim; ++schemaNum ) {
 
-			const XMP_Node * xmpSchema = xmpObj.tree.children[schemaNum];
-			info.tree.children.push_back ( IterNode ( kXMP_SchemaNode, xmpSchema->name, 0 ) );
-			IterNode & iterSchema = info.tree.children.back();
+		info.stack.reserve ( 8 );
+		info.stack.push_back ( IterFrame ( &xmpObj.tree, 0, false ) );
+
+		if ( *schemaNS == 0 ) {
+
+			info.stack.back().visitStage = kIter_VisitSelf;
 
-			if ( ! (info.options & kXMP_IterJustChildren) ) {
-				AddSchemaProps ( info, iterSchema, xmpSchema );
-				if ( iterSchema.children.empty() ) info.tree.children.pop_back();	// No properties, remove the schema node.
+		} else {
+
+			const XMP_Node * xmpSchema = FindConstSchema ( &xmpObj.tree, schemaNS );
+			size_t schemaNum = 0, schemaLim = xmpObj.tree.children.size();
+			while ( (schemaNum < schemaLim) && (xmpObj.tree.children[schemaNum] != xmpSchema) ) ++schemaNum;
+			if ( schemaNum == schemaLim ) {
+				info.stack.clear();
+			} else {
+				PushFrame ( info, xmpSchema, schemaNum, false );
+				info.rootLevel = 1;
 			}
 
 		}
 
 	}
 	
-	// Set the current iteration position to the first node to be visited.
-	
-	info.currPos = info.tree.children.begin();
-	info.endPos  = info.tree.children.end();
+	// The root itself is skipped if just the children are wanted.
 	
-	if ( (info.options & kXMP_IterJustChildren) && (info.currPos != info.endPos) && (*schemaNS != 0) ) {
-		info.currPos->visitStage = kIter_VisitSelf;
+	if ( (info.options & kXMP_IterJustChildren) && (! info.stack.empty()) ) {
+		info.stack.back().visitStage = kIter_VisitSelf;
 	}
 
 	#if TraceIterators
-		if ( info.currPos == info.endPos ) {
+		if ( info.stack.empty() ) {
 			printf ( "    ** Empty iteration **\n" );
 		} else {
 			printf ( "    Initial node %s, stage = %s, iterator @ %.8X\n",
-			         info.currPos->fullPath.c_str(), sStageNames[info.currPos->visitStage], this );
+			         info.currPath.c_str(), sStageNames[info.stack.back().visitStage], this );
 		}
 	#endif
 	
@@ -514,9 +497,7 @@ XMPIterator::~XMPIterator() RELEASE_NO_THROW
 // Next
 // ----
 //
-// Do a preorder traversal of the cached nodes.
-
-// *** Need to document the relationships between currPos, endPos, and visitStage.
+// Do a preorder traversal of the XMP tree.
 
 bool
 XMPIterator::Next ( XMP_StringPtr *	 schemaNS,
@@ -529,33 +510,30 @@ XMPIterator::Next ( XMP_StringPtr *	 schemaNS,
 {
 	// *** Lock the XMPMeta object if we ever stop using a full DLL lock.
 	
-	// ! NOTE: Supporting aliases throws in some nastiness with schemas. There might not be any XMP
-	// ! node for the schema, but we still have to visit it because of possible aliases.
-	
-	if ( info.currPos == info.endPos ) return false;	// Happens at the start of an empty iteration.
+	if ( info.stack.empty() ) return false;	// Happens at the start of an empty iteration.
 	
 	#if TraceIterators
 		printf ( "Next iteration from %s, stage = %s, iterator @ %.8X\n",
-			     info.currPos->fullPath.c_str(), sStageNames[info.currPos->visitStage], this );
+			     info.currPath.c_str(), sStageNames[info.stack.back().visitStage], this );
 	#endif
 	
 	const XMP_Node * xmpNode = GetNextXMPNode ( info );
 	if ( xmpNode == 0 ) return false;
-	bool isSchemaNode = XMP_NodeIsSchema ( info.currPos->options );
 	
 	if ( info.options & kXMP_IterJustLeafNodes ) {
-		while ( isSchemaNode || (! xmpNode->children.empty()) ) {
-			info.currPos->visitStage = kIter_VisitQualifiers;	// Skip to this node's children.
+		while ( XMP_NodeIsSchema ( xmpNode->options ) || (! xmpNode->children.empty()) ) {
+			info.stack.back().visitStage = kIter_VisitQualifiers;	// Skip to this node's children.
 			xmpNode = GetNextXMPNode ( info );
 			if ( xmpNode == 0 ) return false;
-			isSchemaNode = XMP_NodeIsSchema ( info.currPos->options );
 		}
 	}
 	
+	const IterFrame & frame = info.stack.back();
+
 	*schemaNS = info.currSchema.c_str();
 	*nsSize   = static_cast<XMP_StringLen>(info.currSchema.size());
 
-	*propOptions = info.currPos->options;
+	*propOptions = xmpNode->options;
 
 	*propPath  = "";
 	*pathSize  = 0;
@@ -564,12 +542,12 @@ XMPIterator::Next ( XMP_StringPtr *	 schemaNS,
 	
 	if ( ! (*propOptions & kXMP_SchemaNode) ) {
 
-		*propPath = info.currPos->fullPath.c_str();
-		*pathSize = static_cast<XMP_StringLen>(info.currPos->fullPath.size());
+		*propPath = info.currPath.c_str();
+		*pathSize = static_cast<XMP_StringLen>(info.currPath.size());
 
 		if ( info.options & kXMP_IterJustLeafName ) {
-			*propPath += info.currPos->leafOffset;
-			*pathSize -= info.currPos->leafOffset;
+			*propPath += frame.leafOffset;
+			*pathSize -= static_cast<XMP_StringLen>(frame.leafOffset);
 			xmpNode->GetLocalURI ( schemaNS, nsSize );	// Use the leaf namespace, not the top namespace.
 		}
 		
@@ -581,8 +559,7 @@ XMPIterator::Next ( XMP_StringPtr *	 schemaNS,
 	}
 	
 	#if TraceIterators
-		printf ( "    Next node %s, stage = %s\n",
-			     info.currPos->fullPath.c_str(), sStageNames[info.currPos->visitStage] );
+		printf ( "    Next node %s, stage = %s\n", info.currPath.c_str(), sStageNames[frame.visitStage] );
 	#endif
 	
 	return true;
@@ -594,9 +571,8 @@ XMPIterator::Next ( XMP_StringPtr *	 schemaNS,
 // ----
 //
 // Skip some portion of the traversal related to the last visited node. We skip either that node's
-// children, or those children and the previous node's siblings. The implementation might look a bit
-// awkward because info.currNode always points to the next node to be visited. We might already have
-// moved past the things to skip, e.g. if the previous node was simple and the last of its siblings.
+// children, or those children and the previous node's siblings. The top of the stack is always the
+// last visited node, unless the iteration has not started yet or is over.
 
 enum {
 	kXMP_ValidIterSkipOptions	= kXMP_IterSkipSubtree | kXMP_IterSkipSiblings
@@ -605,33 +581,38 @@ enum {
 void
 XMPIterator::Skip ( XMP_OptionBits iterOptions )
 {
-//	if ( (info.currPos == kIter_NullPos) )  XMP_Throw ( "No prior postion to skip from", kXMPErr_BadIterPosition );
 	if ( iterOptions == 0 ) XMP_Throw ( "Must specify what to skip", kXMPErr_BadOptions );
 	if ( (iterOptions & ~kXMP_ValidIterSkipOptions) != 0 ) XMP_Throw ( "Undefined options", kXMPErr_BadOptions );
 
+	if ( info.stack.empty() ) return;
+
 	#if TraceIterators
 		printf ( "Skipping from %s, stage = %s, iterator @ %.8X",
-			     info.currPos->fullPath.c_str(), sStageNames[info.currPos->visitStage], this );
+			     info.currPath.c_str(), sStageNames[info.stack.back().visitStage], this );
 	#endif
 	
 	if ( iterOptions & kXMP_IterSkipSubtree ) {
 		#if TraceIterators
 			printf ( ", mode = subtree\n" );
 		#endif
-		info.currPos->visitStage = kIter_VisitChildren;
+		info.stack.back().visitStage = kIter_VisitChildren;
 	} else if ( iterOptions & kXMP_IterSkipSiblings ) {
 		#if TraceIterators
 			printf ( ", mode = siblings\n" );
 		#endif
-		info.currPos = info.endPos;
-		AdvanceIterPos ( info );
+		if ( info.stack.size() - 1 <= info.rootLevel ) {
+			info.stack.clear();
+		} else {
+			info.stack.pop_back();	// The parent moves on from where it is.
+		}
 	}
 	#if TraceIterators
-		printf ( "    Skipped to %s, stage = %s\n",
-			     info.currPos->fullPath.c_str(), sStageNames[info.currPos->visitStage] );
+		if ( ! info.stack.empty() ) {
+			printf ( "    Skipped to %s, stage = %s\n",
+			         info.currPath.c_str(), sStageNames[info.stack.back().visitStage] );
+		}
 	#endif
 	
-
 }	// Skip
 
 // =================================================================================================
@@ -15,13 +15,6 @@
 
 // =================================================================================================
 
-struct IterNode;
-typedef std::vector < IterNode >	IterOffspring;
-typedef IterOffspring::iterator		IterPos;
-
-typedef std::pair < IterPos, IterPos > IterPosPair;
-typedef std::vector < IterPosPair >	IterPosStack;
-
 enum {	// Values for the visitStage field, used to decide how to proceed past a node.
 	kIter_BeforeVisit		= 0,	// Have not visited this node at all.
 	kIter_VisitSelf			= 1,	// Have visited this node and returned its value/options portion.
@@ -29,60 +22,41 @@ enum {	// Values for the visitStage field, used to decide how to proceed past a
 	kIter_VisitChildren		= 3		// In the midst of visiting this node's children.
 };
 
-struct IterNode {
+// The iteration walks the XMP_Node tree directly. The stack holds one frame for each node from the
+// root of the XMP tree down to the node being visited, and the path of that node is kept up to date
+// as the walk goes up and down. Nothing is cached for the siblings that have not been visited yet.
 
-	XMP_OptionBits	options;
-	XMP_VarString	fullPath;
-	size_t			leafOffset;
-	IterOffspring	children, qualifiers;
-	XMP_Uns8		visitStage;
-	#if 0	// *** XMP_DebugBuild
-		XMP_StringPtr	_pathPtr, _leafPtr;	// *** Not working, need operator=?
-	#endif
-
-	IterNode() : options(0), leafOffset(0), visitStage(kIter_BeforeVisit)
-	{
-		#if 0	// *** XMP_DebugBuild
-			_pathPtr = _leafPtr = 0;
-		#endif
-	};
-
-	IterNode ( XMP_OptionBits _options, const XMP_VarString& _fullPath, size_t _leafOffset )
-			 : options(_options), fullPath(_fullPath), leafOffset(_leafOffset), visitStage(kIter_BeforeVisit)
-	{
-		#if 0	// *** XMP_DebugBuild
-			_pathPtr = fullPath.c_str();
-			_leafPtr = _pathPtr + leafOffset;
-		#endif
-	};
+struct IterFrame {
+
+	const XMP_Node * node;
+	size_t		index;			// Position of the node among the children or qualifiers of its parent.
+	size_t		pathEnd;		// Length of the node's full path within IterInfo::currPath.
+	size_t		leafOffset;		// Offset of the leaf portion within the full path.
+	XMP_Uns8	visitStage;
+	bool		isQualifier;
+
+	IterFrame ( const XMP_Node * _node, size_t _index, bool _isQualifier )
+			  : node(_node), index(_index), pathEnd(0), leafOffset(0), visitStage(kIter_BeforeVisit), isQualifier(_isQualifier) {};
 
 };
 
+typedef std::vector < IterFrame > IterFrameStack;
+
 struct IterInfo {
 
 	XMP_OptionBits	options;
 	const XMPMeta *	xmpObj;
 	XMP_VarString	currSchema;
-	IterPos			currPos, endPos;
-	IterPosStack	ancestors;
-	IterNode 		tree;
-	#if 0	// *** XMP_DebugBuild
-		XMP_StringPtr	_schemaPtr;	// *** Not working, need operator=?
-	#endif
-
-	IterInfo() : options(0), xmpObj(0)
-	{
-		#if 0	// *** XMP_DebugBuild
-			_schemaPtr = 0;
-		#endif
-	};
-
-	IterInfo ( XMP_OptionBits _options, const XMPMeta * _xmpObj ) : options(_options), xmpObj(_xmpObj)
-	{
-		#if 0	// *** XMP_DebugBuild
-			_schemaPtr = 0;
-		#endif
-	};
+	XMP_VarString	currPath;	// Full path of the node on top of the stack.
+	IterFrameStack	stack;		// Empty once the iteration is over.
+	size_t			rootLevel;	// Level of the stack holding the root of the iteration.
+	XMP_ExpandedXPath rootPath;	// Path of the root of a property iteration, to find it again.
+	XMP_Uns32		updateCount;	// The XMPMeta update count that the node pointers in the stack match.
+
+	IterInfo() : options(0), xmpObj(0), rootLevel(0), updateCount(0) {};
+
+	IterInfo ( XMP_OptionBits _options, const XMPMeta * _xmpObj )
+		: options(_options), xmpObj(_xmpObj), rootLevel(0), updateCount((_xmpObj == 0) ? 0 : _xmpObj->updateCount) {};
 
 };
 
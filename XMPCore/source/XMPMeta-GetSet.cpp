@@ -159,6 +159,7 @@ void XMP_Node::SetValue( XMP_StringPtr _value )
 	if ( XMP_PropIsQualifier(this->options) && (this->name == "xml:lang") ) NormalizeLangValue ( &newValue );
 
 	this->value.swap ( newValue );
+	this->InvalidateHash();
 
 	#if 0	// *** XMP_DebugBuild
 		this->_valuePtr = this->value.c_str();
@@ -578,9 +578,8 @@ MigrateAudioCopyright ( XMPMeta * xmp, XMP_Node * dmCopyright )
 // qualifier. If repairs are needed, keep simple non-empty items by adding the xml:lang.
 
 static void
-RepairAltText ( XMP_Node & tree, XMP_StringPtr schemaNS, XMP_StringPtr arrayName )
+RepairAltText ( XMP_Node * schemaNode, XMP_StringPtr arrayName )
 {
-	XMP_Node * schemaNode = FindSchemaNode ( &tree, schemaNS, kXMP_ExistingOnly );
 	if ( schemaNode == 0 ) return;
 	
 	XMP_Node * arrayNode = FindChildNode ( schemaNode, arrayName, kXMP_ExistingOnly );
@@ -638,11 +637,28 @@ TouchUpDataModel ( XMPMeta * xmp, XMPMeta::ErrorCallbackInfo & errorCallback )
 {
 	XMP_Node & tree = xmp->tree;
 	
-	// Do special case touch ups for certain schema.
-
-	XMP_Node * currSchema = 0;
+	// Do special case touch ups for certain schema. Find the ones that are present in one pass over
+	// the tree instead of a lookup per fix, most trees have none or only a few of them.
+
+	XMP_Node * exifSchema   = 0;
+	XMP_Node * dmSchema     = 0;
+	XMP_Node * dcSchema     = 0;
+	XMP_Node * rightsSchema = 0;
+
+	for ( size_t schemaNum = 0, schemaLim = tree.children.size(); schemaNum < schemaLim; ++schemaNum ) {
+		XMP_Node * currSchema = tree.children[schemaNum];
+		if ( currSchema->name == kXMP_NS_EXIF ) {
+			exifSchema = currSchema;
+		} else if ( currSchema->name == kXMP_NS_DM ) {
+			dmSchema = currSchema;
+		} else if ( currSchema->name == kXMP_NS_DC ) {
+			dcSchema = currSchema;
+		} else if ( currSchema->name == kXMP_NS_XMP_Rights ) {
+			rightsSchema = currSchema;
+		}
+	}
 
-	currSchema = FindSchemaNode ( &tree, kXMP_NS_EXIF, kXMP_ExistingOnly );
+	XMP_Node * currSchema = exifSchema;
 	if ( currSchema != 0 ) {
 
 		// Do a special case fix for exif:GPSTimeStamp.
@@ -668,15 +684,18 @@ TouchUpDataModel ( XMPMeta * xmp, XMPMeta::ErrorCallbackInfo & errorCallback )
 
 	}
 
-	currSchema = FindSchemaNode ( &tree, kXMP_NS_DM, kXMP_ExistingOnly );
+	currSchema = dmSchema;
 	if ( currSchema != 0 ) {
 		// Do a special case migration of xmpDM:copyright to dc:rights['x-default']. Do this before
 		// the dc: touch up since it can affect the dc: schema.
 		XMP_Node * dmCopyright = FindChildNode ( currSchema, "xmpDM:copyright", kXMP_ExistingOnly );
-		if ( dmCopyright != 0 ) MigrateAudioCopyright ( xmp, dmCopyright );
+		if ( dmCopyright != 0 ) {
+			MigrateAudioCopyright ( xmp, dmCopyright );
+			dcSchema = FindSchemaNode ( &tree, kXMP_NS_DC, kXMP_ExistingOnly );	// ! Might have been created.
+		}
 	}
 
-	currSchema = FindSchemaNode ( &tree, kXMP_NS_DC, kXMP_ExistingOnly );
+	currSchema = dcSchema;
 	if ( currSchema != 0 ) {
 		// Do a special case fix for dc:subject, make sure it is an unordered array.
 		XMP_Node * dcSubject = FindChildNode ( currSchema, "dc:subject", kXMP_ExistingOnly );
@@ -688,11 +707,13 @@ TouchUpDataModel ( XMPMeta * xmp, XMPMeta::ErrorCallbackInfo & errorCallback )
 	
 	// Fix any broken AltText arrays that we know about.
 	
-	RepairAltText ( tree, kXMP_NS_DC, "dc:description" );	// ! Note inclusion of prefixes for direct node lookup!
-	RepairAltText ( tree, kXMP_NS_DC, "dc:rights" );
-	RepairAltText ( tree, kXMP_NS_DC, "dc:title" );
-	RepairAltText ( tree, kXMP_NS_XMP_Rights, "xmpRights:UsageTerms" );
-	RepairAltText ( tree, kXMP_NS_EXIF, "exif:UserComment" );
+	if ( dcSchema != 0 ) {
+		RepairAltText ( dcSchema, "dc:description" );	// ! Note inclusion of prefixes for direct node lookup!
+		RepairAltText ( dcSchema, "dc:rights" );
+		RepairAltText ( dcSchema, "dc:title" );
+	}
+	RepairAltText ( rightsSchema, "xmpRights:UsageTerms" );
+	RepairAltText ( exifSchema, "exif:UserComment" );
 	
 	// Tweak old XMP: Move an instance ID from rdf:about to the xmpMM:InstanceID property. An old
 	// instance ID usually looks like "uuid:bac965c4-9d87-11d9-9a30-000d936b79c4", plus InDesign
@@ -389,14 +389,17 @@ IsRDFAttrQualifier ( XMP_VarString qualName )
 // ------------------------
 //
 // Start the outer rdf:Description element, including all needed xmlns attributes. Leave the element
-// open so that the compact form can add proprtty attributes.
+// open so that the compact form can add proprtty attributes. If nsDeclStart is not null the offset in
+// outputStr of the first xmlns attribute is stored in it.
 
 static void
-StartOuterRDFDescription ( const XMP_Node & xmpTree,
-						   XMP_VarString &  outputStr,
+StartOuterRDFDescription ( const XMP_Node &	xmpTree,
+						   XMP_VarString &	outputStr,
 						   XMP_StringPtr	newline,
 						   XMP_StringPtr	indentStr,
-						   XMP_Index		baseIndent )
+						   XMP_Index		baseIndent,
+						   const XMP_RDFFragmentCache * fragmentCache,
+						   size_t *			nsDeclStart = 0 )
 {
 	
 	// Begin the outer rdf:Description start tag.
@@ -409,17 +412,38 @@ StartOuterRDFDescription ( const XMP_Node & xmpTree,
 	
 	// Write all necessary xmlns attributes.
 
+	if ( nsDeclStart != 0 ) *nsDeclStart = outputStr.size();
+
 	XMP_VarString usedNS;
 	usedNS.reserve ( 400 );	// The predefined prefixes add up to about 320 bytes.
 	usedNS = ":xml:rdf:";
 
 	for ( size_t schema = 0, schemaLim = xmpTree.children.size(); schema != schemaLim; ++schema ) {
+
 		const XMP_Node * currSchema = xmpTree.children[schema];
-		DeclareUsedNamespaces ( currSchema, usedNS, outputStr, newline, indentStr, baseIndent+4 );
+
+		if ( fragmentCache == 0 ) {
+			DeclareUsedNamespaces ( currSchema, usedNS, outputStr, newline, indentStr, baseIndent+4 );
+			continue;
+		}
+
+		// Same order as DeclareUsedNamespaces, but using the prefixes remembered with the fragments.
+		DeclareOneNamespace ( currSchema->value.c_str(), currSchema->name.c_str(), usedNS, outputStr, newline, indentStr, baseIndent+4 );
+		for ( size_t propNum = 0, propLim = currSchema->children.size(); propNum < propLim; ++propNum ) {
+			XMP_RDFFragmentMap::const_iterator fragPos = fragmentCache->fragments.find ( currSchema->children[propNum] );
+			XMP_Assert ( fragPos != fragmentCache->fragments.end() );
+			const XMP_VarString & propNS = fragPos->second.usedNS;
+			for ( size_t prefixStart = 0, prefixEnd; prefixStart < propNS.size(); prefixStart = prefixEnd+1 ) {
+				prefixEnd = propNS.find ( ':', prefixStart );
+				DeclareElemNamespace ( propNS.substr ( prefixStart, prefixEnd-prefixStart+1 ), usedNS, outputStr, newline, indentStr, baseIndent+4 );
+			}
+		}
+
 	}
 
 }	// StartOuterRDFDescription
 
+
 // -------------------------------------------------------------------------------------------------
 // SerializeCanonicalRDFProperty
 // -----------------------------
@@ -669,6 +693,133 @@ SerializeCanonicalRDFProperty ( const XMP_Node * propNode,
 }	// SerializeCanonicalRDFProperty
 
 
+// -------------------------------------------------------------------------------------------------
+// RenderRDFFragment
+// -----------------
+//
+// Serialize one top level property with the formatting of the fragment cache.
+
+void
+RenderRDFFragment ( const XMP_Node *			   propNode,
+					const XMP_RDFFragmentCache & fragmentCache,
+					XMP_RDFFragment *			   fragment )
+{
+	XMP_StringPtr newline = fragmentCache.newline.c_str();
+	XMP_StringPtr indentStr = fragmentCache.indentStr.c_str();
+
+	fragment->rdf.erase();
+	SerializeCanonicalRDFProperty ( propNode, fragment->rdf, newline, indentStr, fragmentCache.baseIndent+3,
+									fragmentCache.useCanonicalRDF, kEmitAsNormalValue );
+	XMP_VarString usedNS ( ":xml:rdf:" ), unusedDecls;
+	DeclareUsedNamespaces ( propNode, usedNS, unusedDecls, newline, indentStr, 0 );
+	fragment->usedNS.assign ( usedNS, 9, XMP_VarString::npos );	// ! Strip the leading ":xml:rdf:".
+
+}	// RenderRDFFragment
+
+// -------------------------------------------------------------------------------------------------
+// ApplyFormattingDefaults
+// -----------------------
+
+static void
+ApplyFormattingDefaults ( XMP_OptionBits  options,
+						  XMP_StringPtr * newline,
+						  XMP_StringPtr * indentStr )
+{
+	if ( options & kXMP_OmitAllFormatting ) {
+		*newline = " ";	// ! Yes, a space for "newline". This ensures token separation.
+		*indentStr = "";
+	} else {
+		if ( **newline == 0 ) *newline = "\xA";	// Linefeed
+		if ( **indentStr == 0 ) {
+			*indentStr = " ";
+			if ( ! (options & kXMP_UseCompactFormat) ) *indentStr  = "   ";
+		}
+	}
+
+}	// ApplyFormattingDefaults
+
+// -------------------------------------------------------------------------------------------------
+// ResetRDFFragmentFormat
+// ----------------------
+//
+// All the fragments are discarded when the formatting changes. Returns true if that happened.
+
+static bool
+ResetRDFFragmentFormat ( XMP_RDFFragmentCache * fragmentCache,
+						 XMP_StringPtr			newline,
+						 XMP_StringPtr			indentStr,
+						 XMP_Index				baseIndent,
+						 bool					useCanonicalRDF )
+{
+	if ( (fragmentCache->newline == newline) && (fragmentCache->indentStr == indentStr) &&
+		 (fragmentCache->baseIndent == baseIndent) && (fragmentCache->useCanonicalRDF == useCanonicalRDF) ) return false;
+
+	fragmentCache->fragments.clear();
+	fragmentCache->newline = newline;
+	fragmentCache->indentStr = indentStr;
+	fragmentCache->baseIndent = baseIndent;
+	fragmentCache->useCanonicalRDF = useCanonicalRDF;
+	return true;
+
+}	// ResetRDFFragmentFormat
+
+// -------------------------------------------------------------------------------------------------
+// PrepareRDFFragments
+// -------------------
+//
+// Make sure the fragment cache has the canonical RDF of every top level property, returns the total
+// size of the fragments. Only the properties without a fragment are serialized.
+
+static size_t
+PrepareRDFFragments ( const XMP_Node &		 xmpTree,
+					  XMP_RDFFragmentCache & fragmentCache,
+					  XMP_StringPtr			 newline,
+					  XMP_StringPtr			 indentStr,
+					  XMP_Index				 baseIndent,
+					  bool					 useCanonicalRDF )
+{
+	(void) ResetRDFFragmentFormat ( &fragmentCache, newline, indentStr, baseIndent, useCanonicalRDF );
+	
+	size_t totalLen = 0;
+
+	for ( size_t schemaNum = 0, schemaLim = xmpTree.children.size(); schemaNum < schemaLim; ++schemaNum ) {
+		const XMP_Node * currSchema = xmpTree.children[schemaNum];
+		for ( size_t propNum = 0, propLim = currSchema->children.size(); propNum < propLim; ++propNum ) {
+
+			const XMP_Node * currProp = currSchema->children[propNum];
+			XMP_RDFFragment & fragment = fragmentCache.fragments[currProp];
+
+			if ( fragment.rdf.empty() ) RenderRDFFragment ( currProp, fragmentCache, &fragment );
+
+			totalLen += fragment.rdf.size();
+
+		}
+	}
+
+	return totalLen;
+
+}	// PrepareRDFFragments
+
+// -------------------------------------------------------------------------------------------------
+// SetRDFFragmentFormat
+// --------------------
+//
+// Give the fragment cache the formatting SerializeToBuffer uses for these parameters, so fragments
+// can be rendered ahead of the serialization. Returns true if the existing fragments were dropped.
+
+bool
+SetRDFFragmentFormat ( XMP_RDFFragmentCache * fragmentCache,
+					   XMP_OptionBits		  options,
+					   XMP_StringPtr		  newline,
+					   XMP_StringPtr		  indentStr,
+					   XMP_Index			  baseIndent )
+{
+	XMP_Assert ( ! (options & kXMP_UseCompactFormat) );	// The fragments are only for the canonical form.
+	ApplyFormattingDefaults ( options, &newline, &indentStr );
+	return ResetRDFFragmentFormat ( fragmentCache, newline, indentStr, baseIndent, XMP_OptionIsSet ( options, kXMP_UseCanonicalFormat ) );
+
+}	// SetRDFFragmentFormat
+
 // -------------------------------------------------------------------------------------------------
 // SerializeCanonicalRDFSchemas
 // ----------------------------
@@ -693,10 +844,11 @@ SerializeCanonicalRDFSchemas ( const XMP_Node & xmpTree,
 							   XMP_StringPtr	newline,
 							   XMP_StringPtr	indentStr,
 							   XMP_Index		baseIndent,
-							   bool				useCanonicalRDF )
+							   bool				useCanonicalRDF,
+							   const XMP_RDFFragmentCache * fragmentCache )
 {
 
-	StartOuterRDFDescription ( xmpTree, outputStr, newline, indentStr, baseIndent );
+	StartOuterRDFDescription ( xmpTree, outputStr, newline, indentStr, baseIndent, fragmentCache );
 	
 	if ( xmpTree.children.size() > 0 ) {
 		outputStr += ">";
@@ -711,8 +863,12 @@ SerializeCanonicalRDFSchemas ( const XMP_Node & xmpTree,
 		const XMP_Node * currSchema = xmpTree.children[schemaNum];
 		for ( size_t propNum = 0, propLim = currSchema->children.size(); propNum < propLim; ++propNum ) {
 			const XMP_Node * currProp = currSchema->children[propNum];
-			SerializeCanonicalRDFProperty ( currProp, outputStr, newline, indentStr, baseIndent+3,
-											useCanonicalRDF, kEmitAsNormalValue );
+			if ( fragmentCache != 0 ) {
+				outputStr += fragmentCache->fragments.find ( currProp )->second.rdf;
+			} else {
+				SerializeCanonicalRDFProperty ( currProp, outputStr, newline, indentStr, baseIndent+3,
+												useCanonicalRDF, kEmitAsNormalValue );
+			}
 		}
 	}
 	
@@ -729,14 +885,16 @@ SerializeCanonicalRDFSchemas ( const XMP_Node & xmpTree,
 // ----------------------------
 //
 // Write each of the parent's simple unqualified properties as an attribute. Returns true if all
-// of the properties are written as attributes.
+// of the properties are written as attributes. If propSizes is not null it has an entry for each
+// child of the parent, the size of the attributes written here is stored in it.
 
 static bool
 SerializeCompactRDFAttrProps ( const XMP_Node *	parentNode,
 							   XMP_VarString &	outputStr,
 							   XMP_StringPtr	newline,
 							   XMP_StringPtr	indentStr,
-							   XMP_Index		indent )
+							   XMP_Index		indent,
+							   size_t *			propSizes )
 {
 	size_t prop, propLim;
 	bool allAreAttrs = true;
@@ -749,12 +907,14 @@ SerializeCompactRDFAttrProps ( const XMP_Node *	parentNode,
 			continue;
 		}
 		
+		size_t propStart = outputStr.size();
 		outputStr += newline;
 		for ( XMP_Index level = indent; level > 0; --level ) outputStr += indentStr;
 		outputStr += currProp->name;
 		outputStr += "=\"";
 		AppendNodeValue ( outputStr, currProp->value, kForAttribute );
 		outputStr += '"';
+		if ( propSizes != 0 ) propSizes[prop] = outputStr.size() - propStart;
 
 	}
 	
@@ -798,6 +958,9 @@ SerializeCompactRDFAttrProps ( const XMP_Node *	parentNode,
 //		<rdf:value> ... Property "value" following the unqualified forms ... </rdf:value>
 //		... Qualifiers looking like named struct fields
 //	</ns:QualifiedProperty>
+//
+// If propSizes is not null it has an entry for each child of the parent, the size of the property
+// elements written here is stored in it.
 
 // *** Consider numbered array items, but has compatibility problems.
 // *** Consider qualified form with rdf:Description and attributes.
@@ -807,7 +970,8 @@ SerializeCompactRDFElemProps ( const XMP_Node *	parentNode,
 							   XMP_VarString &	outputStr,
 							   XMP_StringPtr	newline,
 							   XMP_StringPtr	indentStr,
-							   XMP_Index		indent )
+							   XMP_Index		indent,
+							   size_t *			propSizes )
 {
 	XMP_Index level;
 
@@ -816,6 +980,7 @@ SerializeCompactRDFElemProps ( const XMP_Node *	parentNode,
 		const XMP_Node * propNode = parentNode->children[prop];
 		if ( CanBeRDFAttrProp ( propNode ) ) continue;
 
+		size_t propStart = outputStr.size();
 		bool emitEndTag = true;
 		bool indentEndTag = true;
 
@@ -915,7 +1080,7 @@ SerializeCompactRDFElemProps ( const XMP_Node *	parentNode,
 				EmitRDFArrayTag ( propForm, outputStr, newline, indentStr, indent+1, static_cast<XMP_Index>(propNode->children.size()), kIsStartTag );
 			
 				if ( XMP_ArrayIsAltText(propNode->options) ) NormalizeLangArray ( (XMP_Node*)propNode );
-				SerializeCompactRDFElemProps ( propNode, outputStr, newline, indentStr, indent+2 );
+				SerializeCompactRDFElemProps ( propNode, outputStr, newline, indentStr, indent+2, 0 );
 
 				EmitRDFArrayTag ( propForm, outputStr, newline, indentStr, indent+1, static_cast<XMP_Index>(propNode->children.size()), kIsEndTag );
 
@@ -956,7 +1121,7 @@ SerializeCompactRDFElemProps ( const XMP_Node *	parentNode,
 				} else if ( ! hasElemFields ) {
 
 					// All fields can be attributes, use the emptyPropertyElt form.
-					SerializeCompactRDFAttrProps ( propNode, outputStr, newline, indentStr, indent+1 );
+					SerializeCompactRDFAttrProps ( propNode, outputStr, newline, indentStr, indent+1, 0 );
 					outputStr += "/>";
 					outputStr += newline;
 					emitEndTag = false;
@@ -966,7 +1131,7 @@ SerializeCompactRDFElemProps ( const XMP_Node *	parentNode,
 					// All fields must be elements, use the parseTypeResourcePropertyElt form.
 					outputStr += " rdf:parseType=\"Resource\">";
 					outputStr += newline;
-					SerializeCompactRDFElemProps ( propNode, outputStr, newline, indentStr, indent+1 );
+					SerializeCompactRDFElemProps ( propNode, outputStr, newline, indentStr, indent+1, 0 );
 				
 				} else {
 				
@@ -975,10 +1140,10 @@ SerializeCompactRDFElemProps ( const XMP_Node *	parentNode,
 					outputStr += newline;
 					for ( level = indent+1; level > 0; --level ) outputStr += indentStr;
 					outputStr += "<rdf:Description";
-					SerializeCompactRDFAttrProps ( propNode, outputStr, newline, indentStr, indent+2 );
+					SerializeCompactRDFAttrProps ( propNode, outputStr, newline, indentStr, indent+2, 0 );
 					outputStr += ">";
 					outputStr += newline;
-					SerializeCompactRDFElemProps ( propNode, outputStr, newline, indentStr, indent+1 );
+					SerializeCompactRDFElemProps ( propNode, outputStr, newline, indentStr, indent+1, 0 );
 					for ( level = indent+1; level > 0; --level ) outputStr += indentStr;
 					outputStr += kRDF_StructEnd;
 					outputStr += newline;
@@ -1000,6 +1165,8 @@ SerializeCompactRDFElemProps ( const XMP_Node *	parentNode,
 			outputStr += newline;
 		}
 
+		if ( propSizes != 0 ) propSizes[prop] = outputStr.size() - propStart;
+
 	}
 	
 }	// SerializeCompactRDFElemProps
@@ -1022,24 +1189,43 @@ SerializeCompactRDFElemProps ( const XMP_Node *	parentNode,
 //		ns:UnqualifiedSimpleProperty="value" ... >
 //		... The remaining properties of the schema, see SerializeCompactRDFElemProps
 //	</rdf:Description>
+//
+// If compactSizes is not null the size of the namespace declarations and of each top level property
+// are stored in it.
 
 static void
 SerializeCompactRDFSchemas ( const XMP_Node & xmpTree,
 							 XMP_VarString &  outputStr,
 							 XMP_StringPtr	  newline,
 							 XMP_StringPtr	  indentStr,
-							 XMP_Index		  baseIndent )
+							 XMP_Index		  baseIndent,
+							 XMP_CompactRDFSizes * compactSizes )
 {
 	XMP_Index level;
 	size_t schema, schemaLim;
 	
-	StartOuterRDFDescription ( xmpTree, outputStr, newline, indentStr, baseIndent );
+	size_t nsDeclStart = 0;
+	StartOuterRDFDescription ( xmpTree, outputStr, newline, indentStr, baseIndent, 0, &nsDeclStart );
+
+	std::vector<size_t*> schemaSizes ( xmpTree.children.size(), (size_t*)0 );
+	if ( compactSizes != 0 ) {
+		compactSizes->nsDeclSize = outputStr.size() - nsDeclStart;
+		size_t propCount = 0;
+		for ( schema = 0, schemaLim = xmpTree.children.size(); schema != schemaLim; ++schema ) {
+			propCount += xmpTree.children[schema]->children.size();
+		}
+		compactSizes->propSizes.assign ( propCount, 0 );
+		for ( schema = 0, propCount = 0, schemaLim = xmpTree.children.size(); schema != schemaLim; ++schema ) {
+			if ( ! xmpTree.children[schema]->children.empty() ) schemaSizes[schema] = &compactSizes->propSizes[propCount];
+			propCount += xmpTree.children[schema]->children.size();
+		}
+	}
 	
 	// Write the top level "attrProps" and close the rdf:Description start tag.
 	bool allAreAttrs = true;
 	for ( schema = 0, schemaLim = xmpTree.children.size(); schema != schemaLim; ++schema ) {
 		const XMP_Node * currSchema = xmpTree.children[schema];
-		allAreAttrs &= SerializeCompactRDFAttrProps ( currSchema, outputStr, newline, indentStr, baseIndent+3 );
+		allAreAttrs &= SerializeCompactRDFAttrProps ( currSchema, outputStr, newline, indentStr, baseIndent+3, schemaSizes[schema] );
 	}
 	if ( ! allAreAttrs ) {
 		outputStr += ">";
@@ -1053,7 +1239,7 @@ SerializeCompactRDFSchemas ( const XMP_Node & xmpTree,
 	// Write the remaining properties for each schema.
 	for ( schema = 0, schemaLim = xmpTree.children.size(); schema != schemaLim; ++schema ) {
 		const XMP_Node * currSchema = xmpTree.children[schema];
-		SerializeCompactRDFElemProps ( currSchema, outputStr, newline, indentStr, baseIndent+3 );
+		SerializeCompactRDFElemProps ( currSchema, outputStr, newline, indentStr, baseIndent+3, schemaSizes[schema] );
 	}
 	
 	// Write the rdf:Description end tag.
@@ -1090,10 +1276,15 @@ SerializeAsRDF ( const XMPMeta & xmpObj,
 				 XMP_OptionBits	 options,
 				 XMP_StringPtr	 newline,
 				 XMP_StringPtr	 indentStr,
-				 XMP_Index		 baseIndent )
+				 XMP_Index		 baseIndent,
+				 XMP_RDFFragmentCache * fragmentCache,
+				 XMP_CompactRDFSizes * compactSizes )
 {
 	const size_t treeNameLen = xmpObj.tree.name.size();
 	const size_t indentLen   = strlen ( indentStr );
+	const bool useCanonicalRDF = XMP_OptionIsSet ( options, kXMP_UseCanonicalFormat );
+
+	if ( options & kXMP_UseCompactFormat ) fragmentCache = 0;	// The fragments are only for the canonical form.
 
 	// First estimate the worst case space and reserve room in the output string. This optimization
 	// avoids reallocating and copying the output as it grows. The initial count does not look at
@@ -1108,7 +1299,11 @@ SerializeAsRDF ( const XMPMeta & xmpObj,
 	for ( size_t schemaNum = 0, schemaLim = xmpObj.tree.children.size(); schemaNum < schemaLim; ++schemaNum ) {
 		const XMP_Node * currSchema = xmpObj.tree.children[schemaNum];
 		outputLen += 2*(baseIndent+2)*indentLen + strlen(kRDF_SchemaStart) + treeNameLen + strlen(kRDF_SchemaEnd) + 2;
-		outputLen += EstimateRDFSize ( currSchema, baseIndent+2, indentLen );
+		if ( fragmentCache == 0 ) outputLen += EstimateRDFSize ( currSchema, baseIndent+2, indentLen );
+	}
+	
+	if ( fragmentCache != 0 ) {
+		outputLen += PrepareRDFFragments ( xmpObj.tree, *fragmentCache, newline, indentStr, baseIndent, useCanonicalRDF );
 	}
 	
 	outputLen += (outputLen >> 2);	// Inflate by 1/4, an empirical fudge factor.
@@ -1127,10 +1322,9 @@ SerializeAsRDF ( const XMPMeta & xmpObj,
 	
 	// Write all of the properties.
 	if ( options & kXMP_UseCompactFormat ) {
-		SerializeCompactRDFSchemas ( xmpObj.tree, rdfstring, newline, indentStr, baseIndent );
+		SerializeCompactRDFSchemas ( xmpObj.tree, rdfstring, newline, indentStr, baseIndent, compactSizes );
 	} else {
-		bool useCanonicalRDF = XMP_OptionIsSet ( options, kXMP_UseCanonicalFormat );
-		SerializeCanonicalRDFSchemas ( xmpObj.tree, rdfstring, newline, indentStr, baseIndent, useCanonicalRDF );
+		SerializeCanonicalRDFSchemas ( xmpObj.tree, rdfstring, newline, indentStr, baseIndent, useCanonicalRDF, fragmentCache );
 	}
 
 	// Write the rdf:RDF end tag.
@@ -1197,23 +1391,19 @@ SerializeAsRDF ( const XMPMeta & xmpObj,
 
 
 // -------------------------------------------------------------------------------------------------
-// SerializeToBuffer
-// -----------------
+// CheckSerializeOptions
+// ---------------------
+//
+// Make sure the serialization options are consistent, fill in the default newline and indent, and
+// compute the padding to add. Returns the size of a Unicode code unit in the output encoding.
 
-void
-XMPMeta::SerializeToBuffer ( XMP_VarString * rdfString,
-							 XMP_OptionBits	 options,
-							 XMP_StringLen	 padding,
-							 XMP_StringPtr	 newline,
-							 XMP_StringPtr	 indentStr,
-							 XMP_Index		 baseIndent ) const
+static size_t
+CheckSerializeOptions ( const XMPMeta &	xmpObj,
+						XMP_OptionBits	options,
+						XMP_StringLen *	padding,
+						XMP_StringPtr *	newline,
+						XMP_StringPtr *	indentStr )
 {
-	XMP_Enforce( rdfString != 0 );
-	XMP_Assert ( (newline != 0) && (indentStr != 0) );
-	rdfString->erase();
-	
-	// Fix up some default parameters.
-	
 	enum { kDefaultPad = 2048 };
 	size_t unicodeUnitSize = 1;
 	XMP_OptionBits charEncoding = options & kXMP_EncodingMask;
@@ -1229,55 +1419,90 @@ XMPMeta::SerializeToBuffer ( XMP_VarString * rdfString,
 		}
 	}
 	
-	if ( options & kXMP_OmitAllFormatting ) {
-		newline = " ";	// ! Yes, a space for "newline". This ensures token separation.
-		indentStr = "";
-	} else {
-		if ( *newline == 0 ) newline = "\xA";	// Linefeed
-		if ( *indentStr == 0 ) {
-			indentStr = " ";
-			if ( ! (options & kXMP_UseCompactFormat) ) indentStr  = "   ";
-		}
-	}
+	ApplyFormattingDefaults ( options, newline, indentStr );
 	
 	if ( options & kXMP_ExactPacketLength ) {
 		if ( options & (kXMP_OmitPacketWrapper | kXMP_IncludeThumbnailPad) ) {
 			XMP_Throw ( "Inconsistent options for exact size serialize", kXMPErr_BadOptions );
 		}
-		if ( (padding & (unicodeUnitSize-1)) != 0 ) {
+		if ( (*padding & (unicodeUnitSize-1)) != 0 ) {
 			XMP_Throw ( "Exact size must be a multiple of the Unicode element", kXMPErr_BadOptions );
 		}
 	} else if ( options & kXMP_ReadOnlyPacket ) {
 		if ( options & (kXMP_OmitPacketWrapper | kXMP_IncludeThumbnailPad) ) {
 			XMP_Throw ( "Inconsistent options for read-only packet", kXMPErr_BadOptions );
 		}
-		padding = 0;
+		*padding = 0;
 	} else if ( options & kXMP_OmitPacketWrapper ) {
 		if ( options & kXMP_IncludeThumbnailPad ) {
 			XMP_Throw ( "Inconsistent options for non-packet serialize", kXMPErr_BadOptions );
 		}
-		padding = 0;
+		*padding = 0;
 	} else if ( options & kXMP_OmitXMPMetaElement ) {
 		if ( options & kXMP_IncludeRDFHash ) {
 			XMP_Throw ( "Inconsistent options for x:xmpmeta serialize", kXMPErr_BadOptions );
 		}
-		padding = 0;
+		*padding = 0;
 	} else {
-		if ( padding == 0 ) {
-			padding = static_cast<XMP_StringLen>(kDefaultPad * unicodeUnitSize);
-		} else if ( (padding >> 28) != 0 ) {
+		if ( *padding == 0 ) {
+			*padding = static_cast<XMP_StringLen>(kDefaultPad * unicodeUnitSize);
+		} else if ( (*padding >> 28) != 0 ) {
 			XMP_Throw ( "Outrageously large padding size", kXMPErr_BadOptions );	// Bigger than 256 MB.
 		}
 		if ( options & kXMP_IncludeThumbnailPad ) {
-			if ( ! this->DoesPropertyExist ( kXMP_NS_XMP, "Thumbnails" ) ) padding += (10000 * unicodeUnitSize);	// *** Need a better estimate.
+			if ( ! xmpObj.DoesPropertyExist ( kXMP_NS_XMP, "Thumbnails" ) ) *padding += (10000 * unicodeUnitSize);	// *** Need a better estimate.
 		}
 	}
 
-	// Serialize as UTF-8, then convert to UTF-16 or UTF-32 if necessary, and assemble with the padding and tail.
-	
-	std::string tailStr;
+	return unicodeUnitSize;
+
+}	// CheckSerializeOptions
+
+
+// -------------------------------------------------------------------------------------------------
+// EncodedSize
+// -----------
+//
+// The size in bytes of UTF-8 text once it is converted to the output encoding. The units are
+// counted from the UTF-8 lead bytes, nothing is converted. Characters outside the BMP take a
+// surrogate pair in UTF-16.
+
+static size_t
+EncodedSize ( const XMP_VarString & utf8Str, size_t unicodeUnitSize )
+{
+	if ( unicodeUnitSize == 1 ) return utf8Str.size();
 
-	SerializeAsRDF ( *this, *rdfString, tailStr, options, newline, indentStr, baseIndent );
+	size_t unitCount = 0;
+	const XMP_Uns8 * bytePtr = (const XMP_Uns8*) utf8Str.c_str();
+	const XMP_Uns8 * byteEnd = bytePtr + utf8Str.size();
+
+	for ( ; bytePtr < byteEnd; ++bytePtr ) {
+		XMP_Uns8 byte = *bytePtr;
+		if ( (byte & 0xC0) == 0x80 ) continue;	// Skip continuation bytes.
+		unitCount += 1;
+		if ( (byte >= 0xF0) && (unicodeUnitSize == 2) ) unitCount += 1;
+	}
+
+	return unitCount * unicodeUnitSize;
+
+}	// EncodedSize
+
+
+// -------------------------------------------------------------------------------------------------
+// AssemblePacket
+// --------------
+//
+// Convert the UTF-8 from SerializeAsRDF to UTF-16 or UTF-32 if necessary, then append the padding
+// and the tail. For kXMP_ExactPacketLength the padding is the overall packet length.
+
+static void
+AssemblePacket ( XMP_VarString * rdfString,
+				 std::string &	 tailStr,
+				 XMP_OptionBits	 options,
+				 XMP_StringLen	 padding,
+				 XMP_StringPtr	 newline )
+{
+	XMP_OptionBits charEncoding = options & kXMP_EncodingMask;
 
 	if ( charEncoding == kXMP_EncodeUTF8 ) {
 
@@ -1389,6 +1614,135 @@ XMPMeta::SerializeToBuffer ( XMP_VarString * rdfString,
 	
 	}
 
+}	// AssemblePacket
+
+
+// -------------------------------------------------------------------------------------------------
+// SerializeToBuffer
+// -----------------
+
+void
+XMPMeta::SerializeToBuffer ( XMP_VarString * rdfString,
+							 XMP_OptionBits	 options,
+							 XMP_StringLen	 padding,
+							 XMP_StringPtr	 newline,
+							 XMP_StringPtr	 indentStr,
+							 XMP_Index		 baseIndent ) const
+{
+	this->SerializeToBuffer ( rdfString, options, padding, newline, indentStr, baseIndent, 0, 0 );
+
+}	// SerializeToBuffer
+
+void
+XMPMeta::SerializeToBuffer ( XMP_VarString * rdfString,
+							 XMP_OptionBits	 options,
+							 XMP_StringLen	 padding,
+							 XMP_StringPtr	 newline,
+							 XMP_StringPtr	 indentStr,
+							 XMP_Index		 baseIndent,
+							 XMP_RDFFragmentCache * fragmentCache,
+							 XMP_CompactRDFSizes * compactSizes ) const
+{
+	XMP_Enforce( rdfString != 0 );
+	XMP_Assert ( (newline != 0) && (indentStr != 0) );
+	rdfString->erase();
+	
+	(void) CheckSerializeOptions ( *this, options, &padding, &newline, &indentStr );
+
+	// Serialize as UTF-8, then convert to UTF-16 or UTF-32 if necessary, and assemble with the padding and tail.
+	
+	std::string tailStr;
+
+	SerializeAsRDF ( *this, *rdfString, tailStr, options, newline, indentStr, baseIndent, fragmentCache, compactSizes );
+	AssemblePacket ( rdfString, tailStr, options, padding, newline );
+
 }	// SerializeToBuffer
 
+
+// -------------------------------------------------------------------------------------------------
+// GetSerializedSize
+// -----------------
+
+XMP_StringLen
+XMPMeta::GetSerializedSize ( XMP_OptionBits options,
+							 XMP_StringPtr	newline,
+							 XMP_StringPtr	indentStr,
+							 XMP_Index		baseIndent ) const
+{
+	XMP_Assert ( (newline != 0) && (indentStr != 0) );
+
+	options &= ~kXMP_ExactPacketLength;	// ! The padding is not wanted, just the checks.
+	XMP_StringLen padding = 0;
+	size_t unicodeUnitSize = CheckSerializeOptions ( *this, options, &padding, &newline, &indentStr );
+
+	std::string rdfString, tailStr;
+	SerializeAsRDF ( *this, rdfString, tailStr, options, newline, indentStr, baseIndent, 0, 0 );
+
+	return static_cast<XMP_StringLen>( EncodedSize ( rdfString, unicodeUnitSize ) + EncodedSize ( tailStr, unicodeUnitSize ) );
+
+}	// GetSerializedSize
+
+
+// -------------------------------------------------------------------------------------------------
+// SerializeToRegion
+// -----------------
+//
+// The RDF is serialized once as UTF-8. The exact fit is decided from the counted size, so the
+// kXMP_ExactPacketLength failure never has to be thrown and caught, and the same RDF is reused for
+// the normally padded overflow packet.
+
+bool
+XMPMeta::SerializeToRegion ( XMP_Uns8 *		 region,
+							 XMP_StringLen	 regionSize,
+							 XMP_VarString * overflow,
+							 XMP_OptionBits	 options,
+							 XMP_StringPtr	 newline,
+							 XMP_StringPtr	 indentStr,
+							 XMP_Index		 baseIndent ) const
+{
+	return this->SerializeToRegion ( region, regionSize, overflow, options, newline, indentStr, baseIndent, 0 );
+
+}	// SerializeToRegion
+
+bool
+XMPMeta::SerializeToRegion ( XMP_Uns8 *		 region,
+							 XMP_StringLen	 regionSize,
+							 XMP_VarString * overflow,
+							 XMP_OptionBits	 options,
+							 XMP_StringPtr	 newline,
+							 XMP_StringPtr	 indentStr,
+							 XMP_Index		 baseIndent,
+							 XMP_RDFFragmentCache * fragmentCache ) const
+{
+	XMP_Enforce ( (region != 0) || (regionSize == 0) );
+	XMP_Assert ( (newline != 0) && (indentStr != 0) );
+
+	XMP_OptionBits exactOptions = options | kXMP_ExactPacketLength;
+	XMP_StringLen padding = regionSize;
+	size_t unicodeUnitSize = CheckSerializeOptions ( *this, exactOptions, &padding, &newline, &indentStr );
+
+	std::string rdfString, tailStr;
+	SerializeAsRDF ( *this, rdfString, tailStr, options, newline, indentStr, baseIndent, fragmentCache, 0 );
+
+	size_t packetSize = EncodedSize ( rdfString, unicodeUnitSize ) + EncodedSize ( tailStr, unicodeUnitSize );
+
+	if ( packetSize <= regionSize ) {
+		AssemblePacket ( &rdfString, tailStr, exactOptions, regionSize, newline );
+		XMP_Assert ( rdfString.size() == regionSize );
+		memcpy ( region, rdfString.c_str(), regionSize );	// Safe: Checked above.
+		return true;
+	}
+
+	if ( overflow != 0 ) {
+		XMP_OptionBits padOptions = options & ~kXMP_ExactPacketLength;
+		padding = 0;
+		(void) CheckSerializeOptions ( *this, padOptions, &padding, &newline, &indentStr );
+		AssemblePacket ( &rdfString, tailStr, padOptions, padding, newline );
+		overflow->swap ( rdfString );
+	}
+
+	return false;
+
+}	// SerializeToRegion
+
 // =================================================================================================
@@ -687,7 +687,7 @@ RegisterStandardAliases()
 // ============
 
 
-XMPMeta::XMPMeta() : tree(XMP_Node(0,"",0)), clientRefs(0), xmlParser(0)
+XMPMeta::XMPMeta() : tree(0,"",0), clientRefs(0), xmlParser(0), updateCount(0)
 {
 	#if XMP_TraceCTorDTor
 		printf ( "Default construct XMPMeta @ %.8X\n", this );
@@ -704,6 +704,15 @@ XMPMeta::XMPMeta() : tree(XMP_Node(0,"",0)), clientRefs(0), xmlParser(0)
 
 // -------------------------------------------------------------------------------------------------
 
+static void
+ReleaseSpareNodes ( XMP_NodeOffspring * spareNodes )
+{
+	for ( size_t i = 0, lim = spareNodes->size(); i < lim; ++i ) delete ( (*spareNodes)[i] );
+	spareNodes->clear();
+}
+
+// -------------------------------------------------------------------------------------------------
+
 XMPMeta::~XMPMeta() RELEASE_NO_THROW
 {
 	#if XMP_TraceCTorDTor
@@ -713,6 +722,7 @@ XMPMeta::~XMPMeta() RELEASE_NO_THROW
 	XMP_Assert ( this->clientRefs <= 0 );
 	if ( xmlParser != 0 ) delete ( xmlParser );
 	xmlParser = 0;
+	ReleaseSpareNodes ( &this->spareNodes );
 
 }	// ~XMPMeta
 
@@ -1265,6 +1275,50 @@ XMPMeta::GetObjectOptions() const
 }	// GetObjectOptions
 
 
+// -------------------------------------------------------------------------------------------------
+// GetFingerprint
+// --------------
+//
+// Hashes the about URI and the tree. The node hashes stay cached until the next change through
+// the API, so asking again or comparing subtrees with CompareSubtrees is then cheap.
+
+XMP_Uns64
+XMPMeta::GetFingerprint() const
+{
+	XMP_Uns64 aboutHash = HashSubtreeString ( this->tree.name.c_str(), (XMP_StringLen)this->tree.name.size() );
+	return CombineSubtreeHash ( 0, aboutHash, this->tree.GetSubtreeHash() );
+
+}	// GetFingerprint
+
+
+// -------------------------------------------------------------------------------------------------
+// PrepareForUpdate
+// ----------------
+//
+// The cached node hashes are no longer valid once the tree changes. Iterators compare the update
+// count with the one they last saw before trusting their node pointers.
+
+void
+XMPMeta::PrepareForUpdate()
+{
+	this->tree.ForgetSubtreeHashes();
+	++this->updateCount;
+
+}	// PrepareForUpdate
+
+
+// -------------------------------------------------------------------------------------------------
+// PrepareForReplace
+// -----------------
+
+void
+XMPMeta::PrepareForReplace()
+{
+	this->PrepareForUpdate();
+
+}	// PrepareForReplace
+
+
 // -------------------------------------------------------------------------------------------------
 // SetObjectOptions
 // ----------------
@@ -1321,10 +1375,41 @@ XMPMeta::Erase()
 		this->xmlParser = 0;
 	}
 	this->tree.ClearNode();
+	ReleaseSpareNodes ( &this->spareNodes );
 
 }	// Erase
 
 
+// -------------------------------------------------------------------------------------------------
+// Reset
+// -----
+//
+// Like Erase, but the nodes are kept as spares for the next parse. Their strings and offspring keep
+// their capacity, so parsing a similar packet into a reset object allocates little or nothing. The
+// spares left from a previous reset were not needed by the parse since then, they are released to
+// bound the storage by the last tree. Resetting an empty object keeps the spares it has.
+
+void
+XMPMeta::Reset()
+{
+
+	if ( this->xmlParser != 0 ) {
+		delete ( this->xmlParser );
+		this->xmlParser = 0;
+	}
+
+	if ( ! (this->tree.children.empty() && this->tree.qualifiers.empty()) ) {
+		ReleaseSpareNodes ( &this->spareNodes );
+		this->tree.RecycleOffspring ( &this->spareNodes );
+	}
+
+	this->tree.options = 0;
+	this->tree.name.erase();
+	this->tree.value.erase();
+
+}	// Reset
+
+
 // -------------------------------------------------------------------------------------------------
 // Clone
 // -----
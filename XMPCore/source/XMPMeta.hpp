@@ -25,6 +25,61 @@ extern XMP_VarString * xdefaultName;	// Needed in XMPMeta-Parse.cpp, MoveExplici
 class XMPIterator;
 class XMPUtils;
 
+// -------------------------------------------------------------------------------------------------
+// XMP_RDFFragmentCache
+// --------------------
+//
+// The canonical RDF of the top level properties, kept between serializations by clients that write
+// the same tree many times. A fragment stays valid as long as its property node is neither modified
+// nor deleted, the client must erase the entry before doing either. All the fragments are discarded
+// by SerializeToBuffer when the formatting parameters change.
+//
+// A client can also render the fragments itself with SetRDFFragmentFormat and RenderRDFFragment. The
+// tree passed to SerializeToBuffer then only needs a stub node per property, its name and options,
+// as long as every one of them has a fragment.
+
+struct XMP_RDFFragment {
+	XMP_VarString rdf;		// The property element, indented for the outer rdf:Description.
+	XMP_VarString usedNS;	// The prefixes used below the property element, each with its colon.
+};
+
+typedef std::map < const XMP_Node *, XMP_RDFFragment > XMP_RDFFragmentMap;
+
+struct XMP_RDFFragmentCache {
+	XMP_VarString		newline;
+	XMP_VarString		indentStr;
+	XMP_Index			baseIndent;
+	bool				useCanonicalRDF;
+	XMP_RDFFragmentMap	fragments;
+	XMP_RDFFragmentCache() : baseIndent(-1), useCanonicalRDF(false) {};
+};
+
+bool
+SetRDFFragmentFormat ( XMP_RDFFragmentCache * fragmentCache,
+					   XMP_OptionBits		  options,
+					   XMP_StringPtr		  newline,
+					   XMP_StringPtr		  indentStr,
+					   XMP_Index			  baseIndent );
+
+void
+RenderRDFFragment ( const XMP_Node *			   propNode,
+					const XMP_RDFFragmentCache & fragmentCache,
+					XMP_RDFFragment *			   fragment );
+
+// -------------------------------------------------------------------------------------------------
+// XMP_CompactRDFSizes
+// -------------------
+//
+// What a compact serialization spent on the namespace declarations and on each top level property,
+// as the exact number of UTF-8 bytes. The property sizes are in schema and property order, each
+// includes the separator written before an attribute or the newline written after an element.
+
+struct XMP_CompactRDFSizes {
+	size_t				  nsDeclSize;
+	std::vector <size_t>  propSizes;
+	XMP_CompactRDFSizes() : nsDeclSize(0) {};
+};
+
 // -------------------------------------------------------------------------------------------------
 
 class XMPMeta {
@@ -310,6 +365,9 @@ public:
 	virtual void
 	Erase();
 
+	virtual void
+	Reset();
+
 	virtual void
 	Clone ( XMPMeta * clone, XMP_OptionBits options ) const;
 	
@@ -320,6 +378,17 @@ public:
 	virtual void
 	DumpObject ( XMP_TextOutputProc outProc,
 				 void *				refCon ) const;
+
+	virtual XMP_Uns64
+	GetFingerprint() const;
+
+	// Called by the write entry points before the tree is changed.
+	virtual void
+	PrepareForUpdate();
+
+	// Called instead of PrepareForUpdate by the entry points that discard the whole tree.
+	virtual void
+	PrepareForReplace();
 	
 	// ---------------------------------------------------------------------------------------------
 	
@@ -335,6 +404,46 @@ public:
 						XMP_StringPtr	newline,
 						XMP_StringPtr	indent,
 						XMP_Index		baseIndent ) const;
+
+	void
+	SerializeToBuffer ( XMP_VarString * rdfString,
+						XMP_OptionBits	options,
+						XMP_StringLen	padding,
+						XMP_StringPtr	newline,
+						XMP_StringPtr	indent,
+						XMP_Index		baseIndent,
+						XMP_RDFFragmentCache * fragmentCache,		// ! Only used for the canonical form.
+						XMP_CompactRDFSizes * compactSizes = 0 ) const;	// ! Only used for the compact form.
+
+	// The size of the packet SerializeToBuffer would produce with no padding, the smallest length
+	// that kXMP_ExactPacketLength accepts. Nothing is converted to UTF-16 or UTF-32 to get it.
+	virtual XMP_StringLen
+	GetSerializedSize ( XMP_OptionBits options,
+						XMP_StringPtr  newline,
+						XMP_StringPtr  indent,
+						XMP_Index	   baseIndent ) const;
+
+	// Serialize as an exact length packet directly into region. Returns false without touching the
+	// region if the packet does not fit, after putting a normally padded packet into overflow if
+	// that is not null. Either way the RDF is only serialized once.
+	virtual bool
+	SerializeToRegion ( XMP_Uns8 *	   region,
+						XMP_StringLen  regionSize,
+						XMP_VarString * overflow,
+						XMP_OptionBits options,
+						XMP_StringPtr  newline,
+						XMP_StringPtr  indent,
+						XMP_Index	   baseIndent ) const;
+
+	bool
+	SerializeToRegion ( XMP_Uns8 *	   region,
+						XMP_StringLen  regionSize,
+						XMP_VarString * overflow,
+						XMP_OptionBits options,
+						XMP_StringPtr  newline,
+						XMP_StringPtr  indent,
+						XMP_Index	   baseIndent,
+						XMP_RDFFragmentCache * fragmentCache ) const;	// ! Only used for the canonical form.
 	
 	// ---------------------------------------------------------------------------------------------
 
@@ -404,6 +513,8 @@ public:
 	XMP_Node tree;
 	XMLParserAdapter * xmlParser;
 	ErrorCallbackInfo errorCallback;
+	XMP_NodeOffspring spareNodes;	// Emptied nodes kept by Reset for the next parse, not cloned.
+	XMP_Uns32 updateCount;			// Bumped by PrepareForUpdate, lets iterators notice changes. Not cloned.
 	
 	friend class XMPIterator;
 	friend class XMPUtils;
@@ -411,7 +522,7 @@ public:
 private:
   
 	// ! These are hidden on purpose:
-	XMPMeta ( const XMPMeta & /* original */ ) : tree(XMP_Node(0,"",0)), clientRefs(0), xmlParser(0)
+	XMPMeta ( const XMPMeta & /* original */ ) : tree(0,"",0), clientRefs(0), xmlParser(0), updateCount(0)
 		{ XMP_Throw ( "Call to hidden constructor", kXMPErr_InternalFailure ); };
 	void operator= ( const XMPMeta & /* rhs */ )  
 		{ XMP_Throw ( "Call to hidden operator=", kXMPErr_InternalFailure ); };
@@ -135,7 +135,7 @@ AppendIXMPLangItem ( const spIArrayNode & arrayNode, XMP_StringPtr itemLang, XMP
 
 
 
-XMPMeta2::XMPMeta2()
+XMPMeta2::XMPMeta2() : mDOMHash ( 0 ), mDOMHashStamp ( 0 ), mSharesDOM ( false )
 {
 	mDOM = IMetadata::CreateMetadata();
 	mDOM->EnableFeature("alias", 5);
@@ -143,11 +143,112 @@ XMPMeta2::XMPMeta2()
 	spParser = spRegistry->GetParser( "rdf" );
 }
 
-XMPMeta2::~XMPMeta2() RELEASE_NO_THROW
+XMPMeta2::XMPMeta2 ( const spIMetadata & dom ) : mDOMHash ( 0 ), mDOMHashStamp ( 0 ), mSharesDOM ( false )
 {
+	if ( ! dom ) XMP_Throw ( "Null metadata pointer", kXMPErr_BadParam );
+	// The document belongs to the caller, its features are left alone. The alias support is enabled
+	// on the private copy made before the first change.
+	mDOM = dom;
+	(void) this->ShareDOM();
+	spRegistry = IDOMImplementationRegistry::GetDOMImplementationRegistry();
+	spParser = spRegistry->GetParser( "rdf" );
+}
 
+XMPMeta2::~XMPMeta2() RELEASE_NO_THROW
+{
+	// Another thread may be detaching this object right now, which needs the object lock. So the lock
+	// is not held while waiting for the document to let go of this object.
+	spIMetadata sharedDOM;
+	{
+		XMP_AutoLock objLock ( &this->lock, kXMP_WriteLock );
+		if ( mSharesDOM ) sharedDOM = mDOM;
+		mSharesDOM = false;
+	}
+	if ( sharedDOM ) sharedDOM->GetIMetadata_I()->DetachSharedView ( this, true );
 }
 
+// -------------------------------------------------------------------------------------------------
+// ShareDOM
+// --------
+//
+// Registers this object with its document, either side then makes a private copy before its first
+// change. The sharing is not part of the logical state of the object, so this is const. Called from
+// the converter while other threads may be reading or detaching, hence the write lock.
+
+spIMetadata
+XMPMeta2::ShareDOM() const
+{
+	XMP_AutoLock objLock ( &this->lock, kXMP_WriteLock );
+	if ( ! mSharesDOM ) {
+		mDOM->GetIMetadata_I()->AttachSharedView ( const_cast< XMPMeta2 * > ( this ) );
+		mSharesDOM = true;
+	}
+	return mDOM;
+}	// ShareDOM
+
+// -------------------------------------------------------------------------------------------------
+// ReleaseSharedDOM
+// ----------------
+
+void
+XMPMeta2::ReleaseSharedDOM()
+{
+	if ( ! mSharesDOM ) return;
+	mDOM->GetIMetadata_I()->DetachSharedView ( this );
+	mSharesDOM = false;
+}	// ReleaseSharedDOM
+
+// -------------------------------------------------------------------------------------------------
+// DetachFromSharedMetadata
+// ------------------------
+//
+// Called by the document before it is changed through the new DOM, after it has dropped this object.
+// That happens on the thread changing the document, so the object lock is taken to keep readers and
+// writers of this object off mDOM while it is replaced. A writer may have released the sharing and
+// made its own copy in the meantime.
+
+void
+XMPMeta2::DetachFromSharedMetadata()
+{
+	XMP_AutoLock objLock ( &this->lock, kXMP_WriteLock );
+	if ( ! mSharesDOM ) return;
+	mSharesDOM = false;
+	mDOM = mDOM->Clone()->ConvertToMetadata();
+	mDOM->EnableFeature ( "alias", 5 );
+}	// DetachFromSharedMetadata
+
+// -------------------------------------------------------------------------------------------------
+// PrepareForUpdate
+// ----------------
+
+void
+XMPMeta2::PrepareForUpdate()
+{
+	XMPMeta::PrepareForUpdate();
+	if ( ! mSharesDOM ) return;
+	// Copy before letting go, until then a change through the new DOM waits for this object's lock.
+	spIMetadata copy = mDOM->Clone()->ConvertToMetadata();
+	this->ReleaseSharedDOM();
+	mDOM = copy;
+	mDOM->EnableFeature ( "alias", 5 );
+}	// PrepareForUpdate
+
+// -------------------------------------------------------------------------------------------------
+// PrepareForReplace
+// -----------------
+//
+// Erase, Reset and ParseFromBuffer throw the old contents away, a shared document is simply let go.
+
+void
+XMPMeta2::PrepareForReplace()
+{
+	XMPMeta::PrepareForUpdate();
+	if ( ! mSharesDOM ) return;
+	this->ReleaseSharedDOM();
+	mDOM = IMetadata::CreateMetadata();
+	mDOM->EnableFeature ( "alias", 5 );
+}	// PrepareForReplace
+
 
 
 bool
@@ -389,6 +490,7 @@ void XMPMeta2::ParseFromBuffer ( XMP_StringPtr buffer, XMP_StringLen bufferSize,
 	}
 
 	spParser->GetIDOMParser_I()->SetErrorCallback(&errorCallback);
+	this->ReleaseSharedDOM();
 	mDOM = spParser->Parse( mBuffer->c_str(), mBuffer->size() );
 	mBuffer->clear();
 }
@@ -405,9 +507,52 @@ void XMPMeta2::SerializeToBuffer ( XMP_VarString * rdfString,
 	auto str = rdfSerializer->GetIDOMSerializer_I()->SerializeInternal( mDOM, options, padding, newline, indent, baseIndent);
 	rdfString->clear();
 	if (str)
-		rdfString->append( str->c_str() );
+		rdfString->append( str->c_str(), str->size() );	// ! UTF-16 and UTF-32 packets contain nulls.
 }
 
+// The DOM serializer only returns whole packets. The unpadded size is found by asking for the
+// smallest padding, one code unit, and taking it back off.
+
+XMP_StringLen
+XMPMeta2::GetSerializedSize ( XMP_OptionBits options,
+							  XMP_StringPtr  newline,
+							  XMP_StringPtr  indent,
+							  XMP_Index	     baseIndent ) const
+{
+	options &= ~kXMP_ExactPacketLength;
+
+	XMP_StringLen padding = 0;
+	if ( ! (options & (kXMP_ReadOnlyPacket | kXMP_OmitPacketWrapper | kXMP_OmitXMPMetaElement)) ) {
+		options &= ~kXMP_IncludeThumbnailPad;
+		padding = (options & _XMP_UTF32_Bit) ? 4 : ((options & _XMP_UTF16_Bit) ? 2 : 1);
+	}
+
+	XMP_VarString packet;
+	this->SerializeToBuffer ( &packet, options, padding, newline, indent, baseIndent );
+	return static_cast<XMP_StringLen>( packet.size() - padding );
+
+}	// GetSerializedSize
+
+// The RDF serializer serializes once, then copies the packet into the region or pads it normally
+// into overflow, see XMPMeta::SerializeToRegion.
+
+bool
+XMPMeta2::SerializeToRegion ( XMP_Uns8 *	  region,
+							  XMP_StringLen	  regionSize,
+							  XMP_VarString * overflow,
+							  XMP_OptionBits  options,
+							  XMP_StringPtr	  newline,
+							  XMP_StringPtr	  indent,
+							  XMP_Index		  baseIndent ) const
+{
+	XMP_Enforce ( (region != 0) || (regionSize == 0) );
+
+	auto registry = IDOMImplementationRegistry::GetDOMImplementationRegistry();
+	auto rdfSerializer = registry->GetSerializer( "rdf" );
+	return rdfSerializer->GetIDOMSerializer_I()->SerializeToRegionInternal ( mDOM, region, regionSize, overflow, options, newline, indent, baseIndent );
+
+}	// SerializeToRegion
+
 
 void
 XMPMeta2::Sort()
@@ -427,6 +572,15 @@ XMPMeta2::Erase()
 	}
 	mDOM->Clear();
 }	
+
+// The DOM manages its own node storage, a reset is an erase.
+
+void
+XMPMeta2::Reset()
+{
+	this->Erase();
+}
+
 // DoesPropertyExist
 // -----------------
 
@@ -597,8 +751,10 @@ XMPMeta2::Clone ( XMPMeta * clone, XMP_OptionBits options ) const
 	if (xmpMeta2Ptr== 0 ) XMP_Throw ( "Null clone pointer", kXMPErr_BadParam );
 	if ( options != 0 ) XMP_Throw ( "No options are defined yet", kXMPErr_BadOptions );
 	
-	xmpMeta2Ptr->mDOM->Clear();
+	// Rebind rather than clear, the old document may still be shared through IMetadataConverterUtils.
+	xmpMeta2Ptr->ReleaseSharedDOM();
 	xmpMeta2Ptr->mDOM = mDOM->Clone()->ConvertToMetadata();
+	xmpMeta2Ptr->mDOM->EnableFeature ( "alias", 5 );
 
 }	// Clone
 
@@ -617,7 +773,6 @@ XMPMeta2::DeleteProperty	( XMP_StringPtr	schemaNS,
 	XMP_ExpandedXPath	expPath;
 	ExpandXPath ( schemaNS, propName, &expPath );
 	
-	XMP_NodePtrPos ptrPos;
 	spINode propNode ;
 	XMP_OptionBits options = 0;
 	XMP_Index arrayIndex = 0;
@@ -1312,6 +1467,89 @@ XMPMeta2::DumpObject ( XMP_TextOutputProc outProc,
 }	// DumpObject
 
 
+// -------------------------------------------------------------------------------------------------
+// HashDOMSubtree
+// --------------
+//
+// The C++ DOM counterpart of XMP_Node::GetSubtreeHash. Struct fields and qualifiers are mixed with
+// their qualified names and summed, array items of any form are chained in order.
+
+static XMP_Uns64
+HashDOMSubtree ( pcINode node )
+{
+	XMP_Uns64 valueHash = node->GetNodeType();
+
+	switch ( node->GetNodeType() ) {
+		case INode::kNTSimple : {
+			spcISimpleNode simpleNode = node->ConvertToSimpleNode();
+			spcIUTF8String value = simpleNode->GetValue();
+			valueHash += HashSubtreeString ( value->c_str(), (XMP_StringLen)value->size() );
+			if ( simpleNode->IsURIType() ) valueHash = ~valueHash;
+			break;
+		}
+		case INode::kNTArray :
+			valueHash = CombineSubtreeHash ( 0, valueHash, node->ConvertToArrayNode()->GetArrayForm() );
+			break;
+		default :
+			break;
+	}
+
+	pcINode_I node_I = node->GetINode_I();
+
+	XMP_Uns64 qualHash = 0;
+	for ( pcINode qual = node_I->GetRawNextQualifierPointer ( NULL ); qual != NULL; qual = node_I->GetRawNextQualifierPointer ( qual ) ) {
+		spcIUTF8String nameSpace = qual->GetNameSpace(), name = qual->GetName();
+		XMP_Uns64 nameHash = CombineSubtreeHash ( HashSubtreeString ( nameSpace->c_str(), (XMP_StringLen)nameSpace->size() ), 0,
+												  HashSubtreeString ( name->c_str(), (XMP_StringLen)name->size() ) );
+		qualHash = CombineSubtreeHash ( qualHash, nameHash, HashDOMSubtree ( qual ) );
+	}
+
+	XMP_Uns64 childHash = 0;
+	bool isArray = (node->GetNodeType() == INode::kNTArray);
+	for ( pcINode child = node_I->GetRawNextChildPointer ( NULL ); child != NULL; child = node_I->GetRawNextChildPointer ( child ) ) {
+		if ( isArray ) {
+			childHash = CombineSubtreeHash ( 0, childHash, HashDOMSubtree ( child ) );
+		} else {
+			spcIUTF8String nameSpace = child->GetNameSpace(), name = child->GetName();
+			XMP_Uns64 nameHash = CombineSubtreeHash ( HashSubtreeString ( nameSpace->c_str(), (XMP_StringLen)nameSpace->size() ), 0,
+													  HashSubtreeString ( name->c_str(), (XMP_StringLen)name->size() ) );
+			childHash = CombineSubtreeHash ( childHash, nameHash, HashDOMSubtree ( child ) );
+		}
+	}
+
+	return FinishSubtreeHash ( valueHash, qualHash, childHash );
+
+}	// HashDOMSubtree
+
+
+// -------------------------------------------------------------------------------------------------
+// GetFingerprint
+// --------------
+//
+// The DOM hash is reused while the modification stamp of the DOM is unchanged. The hash is stored
+// before the stamp, so a concurrent reader that sees the stamp also sees the hash.
+
+XMP_Uns64
+XMPMeta2::GetFingerprint() const
+{
+	sizet stamp = mDOM->GetINode_I()->GetModificationStamp();
+	XMP_Uns64 domHash;
+
+	if ( stamp == mDOMHashStamp.load() ) {
+		domHash = mDOMHash.load();
+	} else {
+		domHash = HashDOMSubtree ( mDOM.get() );
+		mDOMHash.store ( domHash );
+		mDOMHashStamp.store ( stamp );
+	}
+
+	spcIUTF8String aboutURI = mDOM->GetAboutURI();
+	XMP_Uns64 aboutHash = HashSubtreeString ( aboutURI->c_str(), (XMP_StringLen)aboutURI->size() );
+	return CombineSubtreeHash ( 0, aboutHash, domHash );
+
+}	// GetFingerprint
+
+
 
 // -------------------------------------------------------------------------------------------------
 // SetErrorCallback
@@ -10,6 +10,7 @@
 #include "source/XMLParserAdapter.hpp"
 #include "XMPCore/source/XMPMeta.hpp"
 #include "XMPCore/XMPCoreFwdDeclarations_I.h"
+#include "XMPCore/Interfaces/IMetadata_I.h"
 
 #ifndef DumpXMLParseTree
 	#define DumpXMLParseTree 0
@@ -20,7 +21,7 @@ extern XMP_VarString * xdefaultName;	// Needed in XMPMeta-Parse.cpp, MoveExplici
 class XMPIterator;
 class XMPUtils;
 
-class XMPMeta2 : public XMPMeta {
+class XMPMeta2 : public XMPMeta, public AdobeXMPCore_Int::ISharedMetadataView_I {
 public:
 	
 
@@ -29,6 +30,10 @@ public:
 	// ---------------------------------------------------------------------------------------------
 
 	XMPMeta2();
+
+	// Binds the new object to an existing document instead of creating one. No copy is made until
+	// the first change through either API, whichever side changes first gets a private copy.
+	explicit XMPMeta2 ( const AdobeXMPCore::spIMetadata & dom );
 	
 	virtual ~XMPMeta2() RELEASE_NO_THROW;
 
@@ -133,6 +138,19 @@ public:
 						XMP_StringPtr	newline,
 						XMP_StringPtr	indent,
 						XMP_Index		baseIndent ) const;
+	virtual XMP_StringLen
+	GetSerializedSize ( XMP_OptionBits options,
+						XMP_StringPtr  newline,
+						XMP_StringPtr  indent,
+						XMP_Index	   baseIndent ) const;
+	virtual bool
+	SerializeToRegion ( XMP_Uns8 *	   region,
+						XMP_StringLen  regionSize,
+						XMP_VarString * overflow,
+						XMP_OptionBits options,
+						XMP_StringPtr  newline,
+						XMP_StringPtr  indent,
+						XMP_Index	   baseIndent ) const;
 	virtual void
 	Clone ( XMPMeta * clone, XMP_OptionBits options ) const;
 	virtual bool
@@ -141,6 +159,8 @@ public:
 	virtual void
 	Erase();
 	virtual void
+	Reset();
+	virtual void
 	Sort();
 	virtual XMP_Index
 	CountArrayItems ( XMP_StringPtr schemaNS,
@@ -151,6 +171,22 @@ public:
 	virtual void
 	DumpObject ( XMP_TextOutputProc outProc,
 				 void *				refCon ) const;
+	virtual XMP_Uns64
+	GetFingerprint() const;
+
+	virtual void
+	PrepareForUpdate();
+	virtual void
+	PrepareForReplace();
+
+	// Copy-on-write sharing of mDOM with the clients of the new DOM, see IMetadataConverterUtils.
+	// ShareDOM and DetachFromSharedMetadata are called without the object lock held, they take it.
+	AdobeXMPCore::spIMetadata
+	ShareDOM() const;
+	void
+	ReleaseSharedDOM();
+	virtual void
+	DetachFromSharedMetadata();
 
 	void
 		SetErrorCallback(XMPMeta_ErrorCallbackWrapper wrapperProc,
@@ -168,6 +204,15 @@ public:
 	AdobeXMPCore::spIDOMImplementationRegistry spRegistry;
 	AdobeXMPCore::spIDOMParser spParser;
 
+	// The hash of the last fingerprinted DOM and the modification stamp of that DOM, zero if none.
+	// Stamps are never reused, so an equal stamp means the DOM is the same and unchanged.
+	mutable std::atomic< XMP_Uns64 > mDOMHash;
+	mutable std::atomic< AdobeXMPCommon::sizet > mDOMHashStamp;
+
+	// True while mDOM is registered with the document as a shared view. Only changed, and mDOM only
+	// replaced, with the object lock held for writing.
+	mutable bool mSharesDOM;
+
 	friend class XMPIterator;
 	friend class XMPUtils;
 
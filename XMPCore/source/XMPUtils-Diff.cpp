@@ -0,0 +1,1176 @@
+// =================================================================================================
+// Copyright 2026 Adobe
+// All Rights Reserved.
+//
+// NOTICE:	Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it.
+// =================================================================================================
+
+#include "public/include/XMP_Environment.h"	// ! This must be the first include!
+#include "XMPCore/source/XMPCore_Impl.hpp"
+
+#include "XMPCore/XMPCoreDefines.h"
+#include "XMPCore/source/XMPUtils.hpp"
+
+#include <algorithm>
+#include <map>
+#include <set>
+
+#include <stdio.h>	// For snprintf.
+#include <stdlib.h>
+#include <string.h>
+
+#if XMP_WinBuild
+	#pragma warning ( disable : 4800 )	// forcing value to bool 'true' or 'false' (performance warning)
+#endif
+
+// =================================================================================================
+// The XMP diff format
+// ===================
+//
+// A diff is UTF-8 text, one operation per line. The first line names the format and carries the
+// fingerprints of the object the diff was made from and of the object it produces:
+//
+//	XMPDiff 1 <base fingerprint> <result fingerprint>
+//
+// The other lines are operations, applied in order:
+//
+//	N <prefix> <URI>			Declares a namespace prefix used in the paths that follow.
+//	A <value>					Sets the about URI (object name).
+//	- <path>					Removes the node and everything below it.
+//	+ <path> <options> <value>	Inserts a new node. An array item is inserted at the given index.
+//	= <path> <options> <value>	Replaces the value and options of an existing node.
+//	> <path> <index>			Moves an array item to the given index.
+//
+// Paths use the usual XMP path syntax limited to plain steps: "ns:prop", "/ns:field", "/?ns:qual",
+// and "[n]" for array items. Array indices refer to the array as it is when the operation is
+// applied. Options are hex, without the qualifier related bits. Those follow from the qualifiers
+// that are present. Values run to the end of the line with '\\', LF, and CR escaped as "\\\\",
+// "\\n", and "\\r".
+//
+// The diff is made by walking both trees together. Subtrees with equal hashes are skipped without
+// looking inside, so the cost follows the size of the change rather than the size of the trees.
+// Array items are aligned first by hash, then alt-text items by language, then by position. Items
+// that only changed place are moved, keeping a longest increasing run of items in place.
+
+// =================================================================================================
+// Local Types and Constants
+// =========================
+
+static const XMP_OptionBits kDiffDerivedOptions =
+	kXMP_PropHasQualifiers | kXMP_PropIsQualifier | kXMP_PropHasLang | kXMP_PropHasType |
+	kXMP_SchemaNode | kXMP_NewImplicitNode;
+
+static const XMP_OptionBits kDiffKindMask = kXMP_PropValueIsStruct | kXMP_PropValueIsArray;
+
+static const char * kDiffHeader = "XMPDiff 1";
+
+struct DiffWriter {
+	XMP_VarString *			diffStr;
+	XMP_VarString			path;
+	std::set<XMP_VarString>	declaredPrefixes;
+	DiffWriter ( XMP_VarString * _diffStr ) : diffStr(_diffStr) {};
+};
+
+enum {	// The kinds of parsed path steps.
+	kDiffStep_Field,
+	kDiffStep_Qualifier,
+	kDiffStep_ArrayItem
+};
+
+struct DiffStep {
+	XMP_Uns8		kind;
+	size_t			index;	// Only for array items, 1-based.
+	XMP_VarString	nsURI;	// Only for fields and qualifiers.
+	XMP_VarString	name;	// Only for fields and qualifiers, the local name until ResolveDiffNames adds the prefix.
+	DiffStep() : kind(kDiffStep_Field), index(0) {};
+};
+
+struct DiffOp {
+	char					op;
+	XMP_VarString			schemaURI;
+	std::vector<DiffStep>	steps;
+	XMP_OptionBits			options;
+	size_t					toIndex;	// Only for moves, 1-based.
+	XMP_VarString			value;
+	DiffOp() : op(0), options(0), toIndex(0) {};
+};
+
+typedef std::map<XMP_VarString,XMP_VarString> DiffPrefixMap;	// The diff's prefixes to their URIs.
+
+// =================================================================================================
+// Local Utilities
+// ===============
+
+// -------------------------------------------------------------------------------------------------
+// NodeNameLess
+// ------------
+
+static bool
+NodeNameLess ( const XMP_Node * left, const XMP_Node * right )
+{
+	return (left->name < right->name);
+}
+
+// -------------------------------------------------------------------------------------------------
+// SortedByName
+// ------------
+
+static void
+SortedByName ( const XMP_NodeOffspring & nodes, std::vector<const XMP_Node*> * sorted )
+{
+	sorted->assign ( nodes.begin(), nodes.end() );
+	std::sort ( sorted->begin(), sorted->end(), NodeNameLess );
+}
+
+// -------------------------------------------------------------------------------------------------
+// AppendEscapedValue
+// ------------------
+
+static void
+AppendEscapedValue ( XMP_VarString * diffStr, const XMP_VarString & value )
+{
+	size_t runStart = 0;
+	for ( size_t i = 0, limit = value.size(); i < limit; ++i ) {
+		const char ch = value[i];
+		if ( (ch != '\\') && (ch != '\n') && (ch != '\r') ) continue;
+		diffStr->append ( value, runStart, i - runStart );
+		diffStr->push_back ( '\\' );
+		diffStr->push_back ( (ch == '\\') ? '\\' : ((ch == '\n') ? 'n' : 'r') );
+		runStart = i + 1;
+	}
+	diffStr->append ( value, runStart, value.size() - runStart );
+}
+
+// -------------------------------------------------------------------------------------------------
+// DeclarePathPrefixes
+// -------------------
+//
+// Make sure every prefix used in the path has been declared with an N line. Each path segment
+// starts with a qualified name, optionally behind a '?'.
+
+static void
+DeclarePathPrefixes ( DiffWriter * writer, const XMP_VarString & path )
+{
+	size_t segStart = 0;
+
+	while ( segStart < path.size() ) {
+
+		if ( path[segStart] == '?' ) ++segStart;
+		size_t colonPos = path.find ( ':', segStart );
+		if ( colonPos == XMP_VarString::npos ) break;	// ! Should not happen, names are qualified.
+
+		XMP_VarString prefix ( path, segStart, colonPos - segStart );
+		if ( writer->declaredPrefixes.insert ( prefix ).second ) {
+			XMP_StringPtr uriPtr;
+			XMP_StringLen uriLen;
+			if ( ! XMPMeta::GetNamespaceURI ( prefix.c_str(), &uriPtr, &uriLen ) ) {
+				XMP_Throw ( "Unregistered namespace prefix in XMP tree", kXMPErr_InternalFailure );
+			}
+			writer->diffStr->append ( "N " );
+			writer->diffStr->append ( prefix );
+			writer->diffStr->push_back ( ' ' );
+			writer->diffStr->append ( uriPtr, uriLen );
+			writer->diffStr->push_back ( '\n' );
+		}
+
+		segStart = path.find ( '/', colonPos );
+		if ( segStart == XMP_VarString::npos ) break;
+		++segStart;
+
+	}
+
+}	// DeclarePathPrefixes
+
+// -------------------------------------------------------------------------------------------------
+// WriteRemoveOp
+// -------------
+
+static void
+WriteRemoveOp ( DiffWriter * writer )
+{
+	DeclarePathPrefixes ( writer, writer->path );
+	writer->diffStr->append ( "- " );
+	writer->diffStr->append ( writer->path );
+	writer->diffStr->push_back ( '\n' );
+}
+
+// -------------------------------------------------------------------------------------------------
+// WriteNodeOp
+// -----------
+
+static void
+WriteNodeOp ( DiffWriter * writer, char op, const XMP_Node * node )
+{
+	char buffer [32];	// AUDIT: Plenty of room for a space, 8 hex digits, and a space.
+
+	DeclarePathPrefixes ( writer, writer->path );
+	writer->diffStr->push_back ( op );
+	writer->diffStr->push_back ( ' ' );
+	writer->diffStr->append ( writer->path );
+	snprintf ( buffer, sizeof(buffer), " %X ", (unsigned int)(node->options & ~kDiffDerivedOptions) );	// AUDIT: Using sizeof for snprintf length is safe.
+	writer->diffStr->append ( buffer );
+	AppendEscapedValue ( writer->diffStr, node->value );
+	writer->diffStr->push_back ( '\n' );
+}
+
+// -------------------------------------------------------------------------------------------------
+// WriteMoveOp
+// -----------
+
+static void
+WriteMoveOp ( DiffWriter * writer, size_t toIndex )
+{
+	char buffer [32];	// AUDIT: Plenty of room for a space and a size_t in decimal.
+
+	DeclarePathPrefixes ( writer, writer->path );
+	writer->diffStr->append ( "> " );
+	writer->diffStr->append ( writer->path );
+	snprintf ( buffer, sizeof(buffer), " %lu\n", (unsigned long)toIndex );	// AUDIT: Using sizeof for snprintf length is safe.
+	writer->diffStr->append ( buffer );
+}
+
+// -------------------------------------------------------------------------------------------------
+// AppendNameStep and AppendItemStep
+// ---------------------------------
+
+static void
+AppendNameStep ( XMP_VarString * path, const XMP_VarString & name, bool isQual )
+{
+	if ( ! path->empty() ) path->push_back ( '/' );
+	if ( isQual ) path->push_back ( '?' );
+	path->append ( name );
+}
+
+static void
+AppendItemStep ( XMP_VarString * path, size_t index )
+{
+	char buffer [32];	// AUDIT: Plenty of room for "[n]" with a size_t.
+	snprintf ( buffer, sizeof(buffer), "[%lu]", (unsigned long)index );	// AUDIT: Using sizeof for snprintf length is safe.
+	path->append ( buffer );
+}
+
+// -------------------------------------------------------------------------------------------------
+// WriteSubtree
+// ------------
+//
+// Write the insertion of a whole subtree at the current path, the root first.
+
+static void
+WriteSubtree ( DiffWriter * writer, const XMP_Node * node )
+{
+	const size_t pathLen = writer->path.size();
+
+	WriteNodeOp ( writer, '+', node );
+
+	for ( size_t qualNum = 0, qualLim = node->qualifiers.size(); qualNum < qualLim; ++qualNum ) {
+		const XMP_Node * qual = node->qualifiers[qualNum];
+		AppendNameStep ( &writer->path, qual->name, true );
+		WriteSubtree ( writer, qual );
+		writer->path.resize ( pathLen );
+	}
+
+	const bool isArray = XMP_PropIsArray ( node->options );
+	for ( size_t childNum = 0, childLim = node->children.size(); childNum < childLim; ++childNum ) {
+		const XMP_Node * child = node->children[childNum];
+		if ( isArray ) {
+			AppendItemStep ( &writer->path, childNum+1 );
+		} else {
+			AppendNameStep ( &writer->path, child->name, false );
+		}
+		WriteSubtree ( writer, child );
+		writer->path.resize ( pathLen );
+	}
+
+}	// WriteSubtree
+
+// -------------------------------------------------------------------------------------------------
+// GetItemLang
+// -----------
+
+static const XMP_VarString *
+GetItemLang ( const XMP_Node * item )
+{
+	if ( ! (item->options & kXMP_PropHasLang) ) return 0;
+	XMP_Assert ( (! item->qualifiers.empty()) && (item->qualifiers[0]->name == "xml:lang") );
+	return &item->qualifiers[0]->value;
+}
+
+static void DiffNodes ( DiffWriter * writer, const XMP_Node * oldNode, const XMP_Node * newNode );
+
+// -------------------------------------------------------------------------------------------------
+// DiffNamedNodes
+// --------------
+//
+// Diff two sets of struct fields, top level properties, or qualifiers. They are matched by name,
+// the order does not matter. Usually most of the nodes are in the same place on both sides, those
+// at the front and back are paired directly, only the part in between is sorted.
+
+static void
+DiffNamedPair ( DiffWriter * writer, const XMP_Node * oldNode, const XMP_Node * newNode, bool isQual )
+{
+	if ( oldNode->GetSubtreeHash() == newNode->GetSubtreeHash() ) return;
+	const size_t pathLen = writer->path.size();
+	AppendNameStep ( &writer->path, newNode->name, isQual );
+	DiffNodes ( writer, oldNode, newNode );
+	writer->path.resize ( pathLen );
+}
+
+static void
+DiffNamedNodes ( DiffWriter * writer, const XMP_NodeOffspring & oldNodes, const XMP_NodeOffspring & newNodes, bool isQual )
+{
+	size_t oldLim = oldNodes.size(), newLim = newNodes.size();
+	size_t front = 0;
+
+	while ( (front < oldLim) && (front < newLim) && (oldNodes[front]->name == newNodes[front]->name) ) {
+		DiffNamedPair ( writer, oldNodes[front], newNodes[front], isQual );
+		++front;
+	}
+
+	while ( (front < oldLim) && (front < newLim) && (oldNodes[oldLim-1]->name == newNodes[newLim-1]->name) ) {
+		--oldLim;
+		--newLim;
+		DiffNamedPair ( writer, oldNodes[oldLim], newNodes[newLim], isQual );
+	}
+
+	if ( (front == oldLim) && (front == newLim) ) return;
+
+	std::vector<const XMP_Node*> oldSorted ( oldNodes.begin() + front, oldNodes.begin() + oldLim );
+	std::vector<const XMP_Node*> newSorted ( newNodes.begin() + front, newNodes.begin() + newLim );
+	std::sort ( oldSorted.begin(), oldSorted.end(), NodeNameLess );
+	std::sort ( newSorted.begin(), newSorted.end(), NodeNameLess );
+
+	const size_t pathLen = writer->path.size();
+	size_t oldNum = 0, newNum = 0;
+	oldLim = oldSorted.size();
+	newLim = newSorted.size();
+
+	while ( (oldNum < oldLim) || (newNum < newLim) ) {
+
+		int order;
+		if ( oldNum == oldLim ) {
+			order = 1;
+		} else if ( newNum == newLim ) {
+			order = -1;
+		} else {
+			order = oldSorted[oldNum]->name.compare ( newSorted[newNum]->name );
+		}
+
+		if ( order < 0 ) {
+			AppendNameStep ( &writer->path, oldSorted[oldNum]->name, isQual );
+			WriteRemoveOp ( writer );
+			writer->path.resize ( pathLen );
+			++oldNum;
+		} else if ( order > 0 ) {
+			AppendNameStep ( &writer->path, newSorted[newNum]->name, isQual );
+			WriteSubtree ( writer, newSorted[newNum] );
+			writer->path.resize ( pathLen );
+			++newNum;
+		} else {
+			DiffNamedPair ( writer, oldSorted[oldNum], newSorted[newNum], isQual );
+			++oldNum;
+			++newNum;
+		}
+
+	}
+
+}	// DiffNamedNodes
+
+// -------------------------------------------------------------------------------------------------
+// DiffArrayItems
+// --------------
+//
+// Equal items at both ends are skipped. The others are aligned first by hash, these need no further
+// work beyond perhaps a move. The rest are paired by language for alt-text arrays, then by position.
+// Paired items are diffed in place, old items left over are removed, and new items left over are
+// inserted.
+//
+// The removals come first, last item first. Then the survivors are put in order and the new items
+// inserted, from the last target position down. Each of these lands just before its already placed
+// successor, so the survivors never need an absolute position to be right. Survivors that form a
+// longest increasing run in the new order are left where they are. Last the paired items are diffed,
+// at their final index.
+
+static void
+DiffArrayItems ( DiffWriter * writer, const XMP_Node * oldArray, const XMP_Node * newArray )
+{
+	static const size_t kNoItem = (size_t)(-1);
+
+	const size_t pathLen = writer->path.size();
+
+	const XMP_NodeOffspring & oldAll = oldArray->children;
+	const XMP_NodeOffspring & newAll = newArray->children;
+	size_t oldEnd = oldAll.size(), newEnd = newAll.size();
+	size_t front = 0;
+
+	while ( (front < oldEnd) && (front < newEnd) && (oldAll[front]->GetSubtreeHash() == newAll[front]->GetSubtreeHash()) ) ++front;
+	while ( (front < oldEnd) && (front < newEnd) && (oldAll[oldEnd-1]->GetSubtreeHash() == newAll[newEnd-1]->GetSubtreeHash()) ) {
+		--oldEnd;
+		--newEnd;
+	}
+
+	const XMP_Node * const * oldItems = oldAll.empty() ? 0 : &oldAll[0] + front;
+	const XMP_Node * const * newItems = newAll.empty() ? 0 : &newAll[0] + front;
+	const size_t oldCount = oldEnd - front;
+	const size_t newCount = newEnd - front;
+	if ( (oldCount == 0) && (newCount == 0) ) return;
+
+	std::vector<size_t> newToOld ( newCount, kNoItem );
+	std::vector<size_t> oldToNew ( oldCount, kNoItem );
+	std::vector<bool> isPaired ( newCount, false );	// Matched, but not equal.
+
+	// Align equal items by hash, earlier old items first.
+
+	typedef std::multimap<XMP_Uns64,size_t> HashIndexMap;
+	HashIndexMap oldByHash;
+	for ( size_t oldNum = 0; oldNum < oldCount; ++oldNum ) {
+		oldByHash.insert ( HashIndexMap::value_type ( oldItems[oldNum]->GetSubtreeHash(), oldNum ) );
+	}
+
+	for ( size_t newNum = 0; newNum < newCount; ++newNum ) {
+		HashIndexMap::iterator pos = oldByHash.lower_bound ( newItems[newNum]->GetSubtreeHash() );
+		if ( (pos == oldByHash.end()) || (pos->first != newItems[newNum]->GetSubtreeHash()) ) continue;
+		newToOld[newNum] = pos->second;
+		oldToNew[pos->second] = newNum;
+		oldByHash.erase ( pos );
+	}
+
+	// Pair up the rest, by language for alt-text, then by position.
+
+	if ( newArray->options & kXMP_PropArrayIsAltText ) {
+		for ( size_t newNum = 0; newNum < newCount; ++newNum ) {
+			if ( newToOld[newNum] != kNoItem ) continue;
+			const XMP_VarString * newLang = GetItemLang ( newItems[newNum] );
+			if ( newLang == 0 ) continue;
+			for ( size_t oldNum = 0; oldNum < oldCount; ++oldNum ) {
+				if ( oldToNew[oldNum] != kNoItem ) continue;
+				const XMP_VarString * oldLang = GetItemLang ( oldItems[oldNum] );
+				if ( (oldLang == 0) || (*oldLang != *newLang) ) continue;
+				newToOld[newNum] = oldNum;
+				oldToNew[oldNum] = newNum;
+				isPaired[newNum] = true;
+				break;
+			}
+		}
+	}
+
+	for ( size_t newNum = 0, oldNum = 0; newNum < newCount; ++newNum ) {
+		if ( newToOld[newNum] != kNoItem ) continue;
+		while ( (oldNum < oldCount) && (oldToNew[oldNum] != kNoItem) ) ++oldNum;
+		if ( oldNum == oldCount ) break;
+		newToOld[newNum] = oldNum;
+		oldToNew[oldNum] = newNum;
+		isPaired[newNum] = true;
+	}
+
+	// Remove the old items that are not wanted, last first so the indices stay valid.
+
+	for ( size_t oldNum = oldCount; oldNum > 0; --oldNum ) {
+		if ( oldToNew[oldNum-1] != kNoItem ) continue;
+		AppendItemStep ( &writer->path, front + oldNum );
+		WriteRemoveOp ( writer );
+		writer->path.resize ( pathLen );
+	}
+
+	// The current order of the survivors, by their new index.
+
+	std::vector<size_t> current;
+	current.reserve ( newCount );
+	for ( size_t oldNum = 0; oldNum < oldCount; ++oldNum ) {
+		if ( oldToNew[oldNum] != kNoItem ) current.push_back ( oldToNew[oldNum] );
+	}
+
+	// Find a longest increasing run of survivors, these stay put.
+
+	std::vector<bool> keep ( newCount, false );
+	if ( ! current.empty() ) {
+		std::vector<size_t> tails;	// Index in current of the last element of the best run of each length.
+		std::vector<size_t> prev ( current.size(), kNoItem );
+		for ( size_t curNum = 0; curNum < current.size(); ++curNum ) {
+			size_t low = 0, high = tails.size();
+			while ( low < high ) {
+				size_t mid = (low + high) / 2;
+				if ( current[tails[mid]] < current[curNum] ) {
+					low = mid + 1;
+				} else {
+					high = mid;
+				}
+			}
+			if ( low > 0 ) prev[curNum] = tails[low-1];
+			if ( low == tails.size() ) {
+				tails.push_back ( curNum );
+			} else {
+				tails[low] = curNum;
+			}
+		}
+		for ( size_t curNum = tails.back(); curNum != kNoItem; curNum = prev[curNum] ) keep[current[curNum]] = true;
+	}
+
+	// Place everything else, last target first, just before its successor.
+
+	for ( size_t newNum = newCount; newNum > 0; ) {
+
+		--newNum;
+		if ( keep[newNum] ) continue;
+
+		size_t fromPos = kNoItem;
+		if ( newToOld[newNum] != kNoItem ) {
+			fromPos = std::find ( current.begin(), current.end(), newNum ) - current.begin();
+			current.erase ( current.begin() + fromPos );
+		}
+
+		size_t toPos = current.size();
+		if ( newNum+1 < newCount ) toPos = std::find ( current.begin(), current.end(), newNum+1 ) - current.begin();
+		current.insert ( current.begin() + toPos, newNum );
+
+		if ( fromPos == kNoItem ) {
+			AppendItemStep ( &writer->path, front + toPos + 1 );
+			WriteSubtree ( writer, newItems[newNum] );
+		} else if ( fromPos != toPos ) {
+			AppendItemStep ( &writer->path, front + fromPos + 1 );
+			WriteMoveOp ( writer, front + toPos + 1 );
+		}
+		writer->path.resize ( pathLen );
+
+	}
+
+	XMP_Assert ( current.size() == newCount );
+
+	// Diff the paired items in their final place.
+
+	for ( size_t newNum = 0; newNum < newCount; ++newNum ) {
+		if ( ! isPaired[newNum] ) continue;
+		const XMP_Node * oldItem = oldItems[newToOld[newNum]];
+		if ( oldItem->GetSubtreeHash() == newItems[newNum]->GetSubtreeHash() ) continue;
+		AppendItemStep ( &writer->path, front + newNum + 1 );
+		DiffNodes ( writer, oldItem, newItems[newNum] );
+		writer->path.resize ( pathLen );
+	}
+
+}	// DiffArrayItems
+
+// -------------------------------------------------------------------------------------------------
+// DiffNodes
+// ---------
+//
+// Diff two nodes at the current path whose subtree hashes differ. A change between simple, struct,
+// and array values replaces the whole node.
+
+static void
+DiffNodes ( DiffWriter * writer, const XMP_Node * oldNode, const XMP_Node * newNode )
+{
+
+	if ( (oldNode->options & kDiffKindMask) != (newNode->options & kDiffKindMask) ) {
+		WriteRemoveOp ( writer );
+		WriteSubtree ( writer, newNode );
+		return;
+	}
+
+	if ( (oldNode->value != newNode->value) ||
+		 ((oldNode->options & ~kDiffDerivedOptions) != (newNode->options & ~kDiffDerivedOptions)) ) {
+		WriteNodeOp ( writer, '=', newNode );
+	}
+
+	DiffNamedNodes ( writer, oldNode->qualifiers, newNode->qualifiers, true );
+
+	if ( newNode->options & kXMP_PropValueIsStruct ) {
+		DiffNamedNodes ( writer, oldNode->children, newNode->children, false );
+	} else if ( newNode->options & kXMP_PropValueIsArray ) {
+		DiffArrayItems ( writer, oldNode, newNode );
+	}
+
+}	// DiffNodes
+
+// -------------------------------------------------------------------------------------------------
+// DiffTrees
+// ---------
+
+static void
+DiffTrees ( const XMPMeta & oldXMP, const XMPMeta & newXMP, XMP_VarString * diffStr )
+{
+	char buffer [64];	// AUDIT: Plenty of room for the header.
+
+	const XMP_Node & oldTree = oldXMP.tree;
+	const XMP_Node & newTree = newXMP.tree;
+
+	snprintf ( buffer, sizeof(buffer), "%s %016llX %016llX\n", kDiffHeader,	// AUDIT: Using sizeof for snprintf length is safe.
+			   (unsigned long long)oldXMP.GetFingerprint(), (unsigned long long)newXMP.GetFingerprint() );
+	diffStr->assign ( buffer );
+
+	if ( oldTree.name != newTree.name ) {
+		diffStr->append ( "A " );
+		AppendEscapedValue ( diffStr, newTree.name );
+		diffStr->push_back ( '\n' );
+	}
+
+	if ( oldTree.GetSubtreeHash() == newTree.GetSubtreeHash() ) return;
+
+	// The schemas are matched by URI, their properties are diffed as one set of named nodes.
+
+	DiffWriter writer ( diffStr );
+	std::vector<const XMP_Node*> oldSchemas, newSchemas;
+	SortedByName ( oldTree.children, &oldSchemas );
+	SortedByName ( newTree.children, &newSchemas );
+
+	static const XMP_NodeOffspring kNoProps;
+	size_t oldNum = 0, newNum = 0;
+	const size_t oldLim = oldSchemas.size(), newLim = newSchemas.size();
+
+	while ( (oldNum < oldLim) || (newNum < newLim) ) {
+
+		const XMP_Node * oldSchema = 0;
+		const XMP_Node * newSchema = 0;
+
+		if ( oldNum == oldLim ) {
+			newSchema = newSchemas[newNum++];
+		} else if ( newNum == newLim ) {
+			oldSchema = oldSchemas[oldNum++];
+		} else {
+			int order = oldSchemas[oldNum]->name.compare ( newSchemas[newNum]->name );
+			if ( order <= 0 ) oldSchema = oldSchemas[oldNum++];
+			if ( order >= 0 ) newSchema = newSchemas[newNum++];
+		}
+
+		if ( (oldSchema != 0) && (newSchema != 0) && (oldSchema->GetSubtreeHash() == newSchema->GetSubtreeHash()) ) continue;
+
+		DiffNamedNodes ( &writer, ((oldSchema == 0) ? kNoProps : oldSchema->children),
+						 ((newSchema == 0) ? kNoProps : newSchema->children), false );
+
+	}
+
+}	// DiffTrees
+
+// -------------------------------------------------------------------------------------------------
+// ParseDiffPath
+// -------------
+//
+// Parse a path into steps, mapping the prefixes through the N lines seen so far. The names are left
+// without a prefix, the namespaces are only registered once the whole diff is known to apply.
+
+static void
+ParseDiffPath ( XMP_StringPtr pathStr, size_t pathLen, const DiffPrefixMap & prefixes, DiffOp * op )
+{
+	static const char * kBadPath = "Malformed path in XMP diff";
+
+	size_t pos = 0;
+
+	while ( pos < pathLen ) {
+
+		DiffStep step;
+
+		if ( pathStr[pos] == '[' ) {
+
+			if ( op->steps.empty() ) XMP_Throw ( kBadPath, kXMPErr_BadXPath );
+			step.kind = kDiffStep_ArrayItem;
+			++pos;
+			size_t digitStart = pos;
+			for ( ; (pos < pathLen) && ('0' <= pathStr[pos]) && (pathStr[pos] <= '9'); ++pos ) {
+				if ( step.index > 0x7FFFFFFF / 10 ) XMP_Throw ( kBadPath, kXMPErr_BadXPath );
+				step.index = (step.index * 10) + (pathStr[pos] - '0');
+			}
+			if ( (pos == digitStart) || (pos == pathLen) || (pathStr[pos] != ']') || (step.index == 0) ) {
+				XMP_Throw ( kBadPath, kXMPErr_BadXPath );
+			}
+			++pos;
+
+		} else {
+
+			if ( ! op->steps.empty() ) {
+				if ( pathStr[pos] != '/' ) XMP_Throw ( kBadPath, kXMPErr_BadXPath );
+				++pos;
+			}
+			if ( (pos < pathLen) && (pathStr[pos] == '?') ) {
+				if ( op->steps.empty() ) XMP_Throw ( kBadPath, kXMPErr_BadXPath );
+				step.kind = kDiffStep_Qualifier;
+				++pos;
+			}
+
+			size_t nameStart = pos;
+			while ( (pos < pathLen) && (pathStr[pos] != '/') && (pathStr[pos] != '[') ) ++pos;
+			const char * colon = (const char *) memchr ( pathStr + nameStart, ':', pos - nameStart );
+			if ( (colon == 0) || (colon == pathStr + nameStart) || (colon == pathStr + pos - 1) ) {
+				XMP_Throw ( kBadPath, kXMPErr_BadXPath );
+			}
+
+			XMP_VarString prefix ( pathStr + nameStart, colon - (pathStr + nameStart) );
+			DiffPrefixMap::const_iterator prefixPos = prefixes.find ( prefix );
+			if ( prefixPos == prefixes.end() ) XMP_Throw ( "Undeclared prefix in XMP diff", kXMPErr_BadXPath );
+
+			step.nsURI = prefixPos->second;
+			step.name.assign ( colon + 1, (pathStr + pos) - (colon + 1) );
+			if ( op->steps.empty() ) op->schemaURI = prefixPos->second;
+
+		}
+
+		op->steps.push_back ( step );
+
+	}
+
+	if ( op->steps.empty() ) XMP_Throw ( kBadPath, kXMPErr_BadXPath );
+
+}	// ParseDiffPath
+
+// -------------------------------------------------------------------------------------------------
+// ParseDiffValue
+// --------------
+
+static void
+ParseDiffValue ( XMP_StringPtr valueStr, size_t valueLen, XMP_VarString * value )
+{
+	value->clear();
+	value->reserve ( valueLen );
+
+	for ( size_t i = 0; i < valueLen; ++i ) {
+		char ch = valueStr[i];
+		if ( ch == '\\' ) {
+			++i;
+			if ( i == valueLen ) XMP_Throw ( "Malformed escape in XMP diff", kXMPErr_BadParam );
+			ch = valueStr[i];
+			if ( ch == 'n' ) {
+				ch = '\n';
+			} else if ( ch == 'r' ) {
+				ch = '\r';
+			} else if ( ch != '\\' ) {
+				XMP_Throw ( "Malformed escape in XMP diff", kXMPErr_BadParam );
+			}
+		}
+		value->push_back ( ch );
+	}
+
+}	// ParseDiffValue
+
+// -------------------------------------------------------------------------------------------------
+// NextDiffField
+// -------------
+//
+// Return the length of the field at the start of the line, up to a space or the end.
+
+static size_t
+NextDiffField ( XMP_StringPtr fieldStr, size_t lineLen )
+{
+	const char * space = (const char *) memchr ( fieldStr, ' ', lineLen );
+	return (space == 0) ? lineLen : (space - fieldStr);
+}
+
+// -------------------------------------------------------------------------------------------------
+// ParseDiff
+// ---------
+//
+// Parse the whole diff before anything is changed, so a malformed diff leaves the object alone. The
+// N lines are returned as URI and prefix pairs, nothing is registered here.
+
+static void
+ParseDiff ( XMP_StringPtr diffStr, XMP_StringLen diffLen, XMP_Uns64 * baseFingerprint, XMP_Uns64 * resultFingerprint,
+			std::vector<XMP_StringPair> * namespaces, std::vector<DiffOp> * ops )
+{
+	static const char * kBadDiff = "Malformed XMP diff";
+
+	DiffPrefixMap prefixes;
+	XMP_StringPtr diffEnd = diffStr + diffLen;
+	XMP_StringPtr lineStart = diffStr;
+	bool haveHeader = false;
+
+	while ( lineStart < diffEnd ) {
+
+		XMP_StringPtr lineEnd = (XMP_StringPtr) memchr ( lineStart, '\n', diffEnd - lineStart );
+		if ( lineEnd == 0 ) lineEnd = diffEnd;
+		size_t lineLen = lineEnd - lineStart;
+		XMP_StringPtr nextLine = lineEnd + ((lineEnd < diffEnd) ? 1 : 0);
+		if ( (lineLen > 0) && (lineStart[lineLen-1] == '\r') ) --lineLen;	// Tolerate CRLF line ends.
+
+		if ( ! haveHeader ) {
+
+			const size_t headerLen = strlen ( kDiffHeader );
+			if ( (lineLen != headerLen + 34) || (strncmp ( lineStart, kDiffHeader, headerLen ) != 0) ||
+				 (lineStart[headerLen] != ' ') || (lineStart[headerLen+17] != ' ') ) {
+				XMP_Throw ( "Not an XMP diff, or an unsupported version", kXMPErr_BadParam );
+			}
+			XMP_VarString fingerprint ( lineStart + headerLen + 1, 16 );
+			*baseFingerprint = strtoull ( fingerprint.c_str(), 0, 16 );
+			fingerprint.assign ( lineStart + headerLen + 18, 16 );
+			*resultFingerprint = strtoull ( fingerprint.c_str(), 0, 16 );
+			haveHeader = true;
+			lineStart = nextLine;
+			continue;
+
+		}
+
+		if ( lineLen == 0 ) {	// Ignore empty lines.
+			lineStart = nextLine;
+			continue;
+		}
+		if ( (lineLen < 2) || (lineStart[1] != ' ') ) XMP_Throw ( kBadDiff, kXMPErr_BadParam );
+
+		const char opChar = lineStart[0];
+		XMP_StringPtr fieldStr = lineStart + 2;
+		size_t restLen = lineLen - 2;
+
+		if ( opChar == 'N' ) {
+
+			size_t prefixLen = NextDiffField ( fieldStr, restLen );
+			if ( (prefixLen == 0) || (prefixLen + 1 >= restLen) ) XMP_Throw ( kBadDiff, kXMPErr_BadParam );
+			XMP_VarString prefix ( fieldStr, prefixLen );
+			XMP_VarString & uri = prefixes[prefix];
+			uri.assign ( fieldStr + prefixLen + 1, restLen - prefixLen - 1 );
+			namespaces->push_back ( XMP_StringPair ( uri, prefix ) );
+
+		} else if ( opChar == 'A' ) {
+
+			ops->push_back ( DiffOp() );
+			ops->back().op = opChar;
+			ParseDiffValue ( fieldStr, restLen, &ops->back().value );
+
+		} else if ( (opChar == '-') || (opChar == '+') || (opChar == '=') || (opChar == '>') ) {
+
+			ops->push_back ( DiffOp() );
+			DiffOp & op = ops->back();
+			op.op = opChar;
+
+			size_t pathLen = NextDiffField ( fieldStr, restLen );
+			ParseDiffPath ( fieldStr, pathLen, prefixes, &op );
+			fieldStr += pathLen;
+			restLen -= pathLen;
+
+			if ( opChar == '-' ) {
+
+				if ( restLen != 0 ) XMP_Throw ( kBadDiff, kXMPErr_BadParam );
+
+			} else {
+
+				if ( restLen < 2 ) XMP_Throw ( kBadDiff, kXMPErr_BadParam );
+				++fieldStr;	// Skip the space.
+				--restLen;
+				size_t numLen = NextDiffField ( fieldStr, restLen );
+				if ( (numLen == 0) || (numLen > 16) ) XMP_Throw ( kBadDiff, kXMPErr_BadParam );
+				XMP_VarString numStr ( fieldStr, numLen );
+				char * numEnd;
+				unsigned long long number = strtoull ( numStr.c_str(), &numEnd, ((opChar == '>') ? 10 : 16) );
+				if ( *numEnd != 0 ) XMP_Throw ( kBadDiff, kXMPErr_BadParam );
+				fieldStr += numLen;
+				restLen -= numLen;
+
+				if ( opChar == '>' ) {
+					if ( (restLen != 0) || (number == 0) || (number > 0x7FFFFFFF) ) XMP_Throw ( kBadDiff, kXMPErr_BadParam );
+					if ( op.steps.back().kind != kDiffStep_ArrayItem ) XMP_Throw ( "Move of a non-array item in XMP diff", kXMPErr_BadParam );
+					op.toIndex = (size_t)number;
+				} else {
+					if ( (restLen == 0) || (number > 0xFFFFFFFFUL) ) XMP_Throw ( kBadDiff, kXMPErr_BadParam );
+					op.options = (XMP_OptionBits)number & ~kDiffDerivedOptions;
+					ParseDiffValue ( fieldStr + 1, restLen - 1, &op.value );
+				}
+
+			}
+
+		} else {
+
+			XMP_Throw ( kBadDiff, kXMPErr_BadParam );
+
+		}
+
+		lineStart = nextLine;
+
+	}
+
+	if ( ! haveHeader ) XMP_Throw ( "Not an XMP diff, or an unsupported version", kXMPErr_BadParam );
+
+}	// ParseDiff
+
+// -------------------------------------------------------------------------------------------------
+// ResolveDiffNames
+// ----------------
+//
+// Register the diff's namespaces and give the field and qualifier names the registered prefixes.
+
+static void
+ResolveDiffNames ( const std::vector<XMP_StringPair> & namespaces, std::vector<DiffOp> * ops )
+{
+	std::map<XMP_VarString,XMP_VarString> uriPrefixes;	// Each URI to its registered prefix, with the colon.
+
+	for ( size_t nsNum = 0, nsLim = namespaces.size(); nsNum < nsLim; ++nsNum ) {
+		XMP_StringPtr regPrefix;
+		XMP_StringLen regLen;
+		(void) XMPMeta::RegisterNamespace ( namespaces[nsNum].first.c_str(), namespaces[nsNum].second.c_str(), &regPrefix, &regLen );
+		uriPrefixes[namespaces[nsNum].first].assign ( regPrefix, regLen );
+	}
+
+	for ( size_t opNum = 0, opLim = ops->size(); opNum < opLim; ++opNum ) {
+		std::vector<DiffStep> & steps = (*ops)[opNum].steps;
+		for ( size_t stepNum = 0, stepLim = steps.size(); stepNum < stepLim; ++stepNum ) {
+			if ( steps[stepNum].kind != kDiffStep_ArrayItem ) steps[stepNum].name.insert ( 0, uriPrefixes[steps[stepNum].nsURI] );
+		}
+	}
+
+}	// ResolveDiffNames
+
+// -------------------------------------------------------------------------------------------------
+// FindDiffNode
+// ------------
+//
+// Follow the first stepCount steps of the op's path. The schema is created if missing and asked for,
+// a missing node is an error since the diff does not fit the object.
+
+static XMP_Node *
+FindDiffNode ( XMP_Node * xmpTree, const DiffOp & op, size_t stepCount, bool createSchema, XMP_NodePtrPos * ptrPos = 0 )
+{
+	static const char * kNoMatch = "XMP diff does not match the object";
+
+	XMP_Node * schemaNode = FindSchemaNode ( xmpTree, op.schemaURI.c_str(), createSchema );
+	if ( schemaNode == 0 ) XMP_Throw ( kNoMatch, kXMPErr_BadParam );
+	if ( schemaNode->options & kXMP_NewImplicitNode ) schemaNode->options ^= kXMP_NewImplicitNode;
+
+	XMP_Node * currNode = schemaNode;
+
+	for ( size_t stepNum = 0; stepNum < stepCount; ++stepNum ) {
+
+		const DiffStep & step = op.steps[stepNum];
+		XMP_NodePtrPos currPos;
+
+		if ( step.kind == kDiffStep_ArrayItem ) {
+			if ( (! XMP_PropIsArray ( currNode->options )) || (step.index > currNode->children.size()) ) {
+				XMP_Throw ( kNoMatch, kXMPErr_BadParam );
+			}
+			currPos = currNode->children.begin() + (step.index - 1);
+			currNode = *currPos;
+		} else if ( step.kind == kDiffStep_Qualifier ) {
+			currNode = FindQualifierNode ( currNode, step.name.c_str(), kXMP_ExistingOnly, &currPos );
+		} else {
+			if ( ! (currNode->options & (kXMP_SchemaNode | kXMP_PropValueIsStruct)) ) XMP_Throw ( kNoMatch, kXMPErr_BadParam );
+			currNode = FindChildNode ( currNode, step.name.c_str(), kXMP_ExistingOnly, &currPos );
+		}
+
+		if ( currNode == 0 ) XMP_Throw ( kNoMatch, kXMPErr_BadParam );
+		if ( ptrPos != 0 ) *ptrPos = currPos;
+
+	}
+
+	return currNode;
+
+}	// FindDiffNode
+
+// -------------------------------------------------------------------------------------------------
+// ApplyDiffOp
+// -----------
+
+static void
+ApplyDiffOp ( XMP_Node * xmpTree, const DiffOp & op )
+{
+	static const char * kNoMatch = "XMP diff does not match the object";
+
+	const size_t stepCount = op.steps.size();
+
+	switch ( op.op ) {
+
+		case 'A' :
+			xmpTree->name = op.value;
+			break;
+
+		case '=' : {
+			XMP_Node * node = FindDiffNode ( xmpTree, op, stepCount, false );
+			node->value = op.value;
+			node->options = op.options | (node->options & kDiffDerivedOptions);
+			break;
+		}
+
+		case '-' : {
+			XMP_NodePtrPos nodePos;
+			XMP_Node * node = FindDiffNode ( xmpTree, op, stepCount, false, &nodePos );
+			XMP_Node * parent = node->parent;
+			DeleteSubtree ( nodePos );
+			DeleteEmptySchema ( parent );
+			break;
+		}
+
+		case '>' : {
+			XMP_NodePtrPos nodePos;
+			XMP_Node * item = FindDiffNode ( xmpTree, op, stepCount, false, &nodePos );
+			XMP_Node * array = item->parent;
+			if ( op.toIndex > array->children.size() ) XMP_Throw ( kNoMatch, kXMPErr_BadParam );
+			array->children.erase ( nodePos );
+			array->children.insert ( array->children.begin() + (op.toIndex - 1), item );
+			break;
+		}
+
+		case '+' : {
+
+			const DiffStep & lastStep = op.steps.back();
+			XMP_Node * parent = FindDiffNode ( xmpTree, op, stepCount-1, true );
+			XMP_Node * node = 0;
+
+			if ( lastStep.kind == kDiffStep_ArrayItem ) {
+
+				if ( (! XMP_PropIsArray ( parent->options )) || (lastStep.index > parent->children.size() + 1) ) {
+					XMP_Throw ( kNoMatch, kXMPErr_BadParam );
+				}
+				node = new XMP_Node ( parent, kXMP_ArrayItemName, op.value.c_str(), op.options );
+				parent->children.insert ( parent->children.begin() + (lastStep.index - 1), node );
+
+			} else if ( lastStep.kind == kDiffStep_Qualifier ) {
+
+				if ( FindQualifierNode ( parent, lastStep.name.c_str(), kXMP_ExistingOnly ) != 0 ) XMP_Throw ( kNoMatch, kXMPErr_BadParam );
+				node = FindQualifierNode ( parent, lastStep.name.c_str(), kXMP_CreateNodes );
+				node->value = op.value;
+				node->options = op.options | kXMP_PropIsQualifier;
+
+			} else {
+
+				if ( ! (parent->options & (kXMP_SchemaNode | kXMP_PropValueIsStruct)) ) XMP_Throw ( kNoMatch, kXMPErr_BadParam );
+				if ( FindChildNode ( parent, lastStep.name.c_str(), kXMP_ExistingOnly ) != 0 ) XMP_Throw ( kNoMatch, kXMPErr_BadParam );
+				node = FindChildNode ( parent, lastStep.name.c_str(), kXMP_CreateNodes );
+				node->value = op.value;
+				node->options = op.options;
+
+			}
+
+			break;
+
+		}
+
+		default :
+			XMP_Throw ( "Unknown XMP diff operation", kXMPErr_InternalFailure );
+
+	}
+
+}	// ApplyDiffOp
+
+// -------------------------------------------------------------------------------------------------
+// SwapTrees
+// ---------
+
+static void
+SwapTrees ( XMP_Node * left, XMP_Node * right )
+{
+	XMP_Assert ( (left->parent == 0) && (right->parent == 0) && left->qualifiers.empty() && right->qualifiers.empty() );
+
+	left->name.swap ( right->name );
+	left->value.swap ( right->value );
+	std::swap ( left->options, right->options );
+	left->children.swap ( right->children );
+	XMP_Uns64 leftHash = left->subtreeHash.load ( std::memory_order_relaxed );	// ! Each hash goes with its subtree.
+	left->subtreeHash.store ( right->subtreeHash.load ( std::memory_order_relaxed ), std::memory_order_relaxed );
+	right->subtreeHash.store ( leftHash, std::memory_order_relaxed );
+
+	for ( size_t schemaNum = 0, schemaLim = left->children.size(); schemaNum < schemaLim; ++schemaNum ) {
+		left->children[schemaNum]->parent = left;
+	}
+	for ( size_t schemaNum = 0, schemaLim = right->children.size(); schemaNum < schemaLim; ++schemaNum ) {
+		right->children[schemaNum]->parent = right;
+	}
+
+}	// SwapTrees
+
+// -------------------------------------------------------------------------------------------------
+// ApplyDiffToTree
+// ---------------
+//
+// The ops are applied to a copy, a diff that stops matching part way, or does not give the promised
+// result, leaves the object alone. Namespaces are only registered for a diff made from this object.
+
+static void
+ApplyDiffToTree ( XMPMeta * xmpObj, XMP_StringPtr diffStr, XMP_StringLen diffLen, XMP_OptionBits options )
+{
+	XMP_Uns64 baseFingerprint, resultFingerprint;
+	std::vector<XMP_StringPair> namespaces;
+	std::vector<DiffOp> ops;
+
+	ParseDiff ( diffStr, diffLen, &baseFingerprint, &resultFingerprint, &namespaces, &ops );
+
+	if ( (! (options & kXMPUtil_IgnoreDiffBase)) && (xmpObj->GetFingerprint() != baseFingerprint) ) {
+		XMP_Throw ( "XMP diff was made from a different object", kXMPErr_BadParam );
+	}
+
+	ResolveDiffNames ( namespaces, &ops );
+
+	XMPMeta work;
+	xmpObj->XMPMeta::Clone ( &work, 0 );
+	for ( size_t opNum = 0, opLim = ops.size(); opNum < opLim; ++opNum ) {
+		ApplyDiffOp ( &work.tree, ops[opNum] );
+	}
+
+	if ( (! (options & kXMPUtil_IgnoreDiffBase)) && (work.GetFingerprint() != resultFingerprint) ) {
+		XMP_Throw ( "XMP diff does not give the expected result", kXMPErr_BadParam );
+	}
+
+	xmpObj->PrepareForUpdate();
+	SwapTrees ( &xmpObj->tree, &work.tree );
+
+}	// ApplyDiffToTree
+
+#if ENABLE_CPP_DOM_MODEL
+
+// -------------------------------------------------------------------------------------------------
+// CopyToXMPTree
+// -------------
+//
+// The diff works on XMP_Node trees. With the C++ DOM APIs in use the object is copied into a plain
+// XMPMeta through its serialized form.
+
+static void
+CopyToXMPTree ( const XMPMeta & xmpObj, XMPMeta * treeObj )
+{
+	XMP_VarString rdfStr;
+	xmpObj.SerializeToBuffer ( &rdfStr, kXMP_OmitPacketWrapper, 0, "\n", " ", 0 );
+	treeObj->XMPMeta::ParseFromBuffer ( rdfStr.c_str(), (XMP_StringLen)rdfStr.size(), 0 );
+}
+
+#endif
+
+// =================================================================================================
+// Class Static Functions
+// ======================
+
+// -------------------------------------------------------------------------------------------------
+// DiffProperties
+// --------------
+
+/* class static */ void
+XMPUtils::DiffProperties ( const XMPMeta & oldXMP,
+						   const XMPMeta & newXMP,
+						   XMP_OptionBits  options,
+						   XMP_VarString * diffStr )
+{
+	if ( options != 0 ) XMP_Throw ( "Unrecognized options for DiffProperties", kXMPErr_BadOptions );
+
+#if ENABLE_CPP_DOM_MODEL
+	if ( sUseNewCoreAPIs ) {
+		XMPMeta oldTreeObj, newTreeObj;
+		CopyToXMPTree ( oldXMP, &oldTreeObj );
+		CopyToXMPTree ( newXMP, &newTreeObj );
+		DiffTrees ( oldTreeObj, newTreeObj, diffStr );
+		return;
+	}
+#endif
+
+	DiffTrees ( oldXMP, newXMP, diffStr );
+
+}	// DiffProperties
+
+// -------------------------------------------------------------------------------------------------
+// ApplyDiff
+// ---------
+
+/* class static */ void
+XMPUtils::ApplyDiff ( XMPMeta *		 xmpObj,
+					  XMP_StringPtr	 diffStr,
+					  XMP_StringLen	 diffLen,
+					  XMP_OptionBits options )
+{
+	if ( (options & ~kXMPUtil_IgnoreDiffBase) != 0 ) XMP_Throw ( "Unrecognized options for ApplyDiff", kXMPErr_BadOptions );
+
+#if ENABLE_CPP_DOM_MODEL
+	if ( sUseNewCoreAPIs ) {
+		XMPMeta treeObj;
+		CopyToXMPTree ( *xmpObj, &treeObj );
+		ApplyDiffToTree ( &treeObj, diffStr, diffLen, options );
+		XMP_VarString rdfStr;
+		treeObj.XMPMeta::SerializeToBuffer ( &rdfStr, kXMP_OmitPacketWrapper, 0, "\n", " ", 0 );
+		xmpObj->Erase();
+		xmpObj->ParseFromBuffer ( rdfStr.c_str(), (XMP_StringLen)rdfStr.size(), 0 );
+		return;
+	}
+#endif
+
+	ApplyDiffToTree ( xmpObj, diffStr, diffLen, options );
+
+}	// ApplyDiff
+
+// =================================================================================================
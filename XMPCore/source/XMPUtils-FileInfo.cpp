@@ -27,6 +27,11 @@
 	#include "XMPCommon/Interfaces/IUTF8String_I.h"
 #endif
 #include <algorithm>	// For binary_search.
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include <time.h>
 #include <string.h>
@@ -1534,36 +1539,125 @@ XMPUtils::SeparateArrayItems ( XMPMeta *	  xmpObj,
 
 
 // -------------------------------------------------------------------------------------------------
-// ApplyTemplate
-// -------------
+// CompiledTemplate
+// ----------------
+//
+// A template prepared for ApplyTemplate. The template schemas are indexed by URI and the property
+// names of each schema are sorted, so the per target lookups are binary searches. The internal
+// property filter is applied once to the template properties. The object points into the template
+// tree, which must stay read locked and unchanged while this is used. Apply is const and only reads
+// the template, one compiled template can be applied to several targets at once.
 
-/* class static */ void
-XMPUtils::ApplyTemplate ( XMPMeta *	      workingXMP,
-						  const XMPMeta & templateXMP,
-						  XMP_OptionBits  actions )
+class CompiledTemplate {
+public:
+
+	CompiledTemplate ( const XMPMeta & templateXMP, XMP_OptionBits actions );
+
+	void Apply ( XMPMeta * workingXMP ) const;
+
+private:
+
+	struct Schema {
+		const XMP_Node * node;
+		std::vector < const XMP_Node * >     props;	// The properties to append, in template order.
+		std::vector < const XMP_VarString * > names;	// All property names, sorted.
+	};
+
+	std::vector < Schema > schemas;	// In template order.
+	std::vector < size_t > sortedSchemas;	// Indices into schemas, sorted by URI.
+
+	bool doClear, doAdd, doReplace, deleteEmpty, doAll;
+
+	const Schema * FindSchema ( const XMP_VarString & schemaURI ) const;
+
+};
+
+// -------------------------------------------------------------------------------------------------
+
+static inline bool
+LessNamePtr ( const XMP_VarString * left, const XMP_VarString * right )
 {
+	return (*left < *right);
+}
+
+CompiledTemplate::CompiledTemplate ( const XMPMeta & templateXMP, XMP_OptionBits actions )
+{
+
+	this->doClear   = XMP_OptionIsSet ( actions, kXMPTemplate_ClearUnnamedProperties );
+	this->doAdd     = XMP_OptionIsSet ( actions, kXMPTemplate_AddNewProperties );
+	this->doReplace = XMP_OptionIsSet ( actions, kXMPTemplate_ReplaceExistingProperties );
+
+	this->deleteEmpty = XMP_OptionIsSet ( actions, kXMPTemplate_ReplaceWithDeleteEmpty );
+	this->doReplace |= this->deleteEmpty;	// Delete-empty implies Replace.
+	this->deleteEmpty &= (! this->doClear);	// Clear implies not delete-empty, but keep the implicit Replace. 
+
+	this->doAll = XMP_OptionIsSet ( actions, kXMPTemplate_IncludeInternalProperties );
+
+	const XMP_Node & templateTree = templateXMP.tree;
+	this->schemas.resize ( templateTree.children.size() );
+	this->sortedSchemas.resize ( templateTree.children.size() );
+
+	for ( size_t schemaNum = 0, schemaLim = templateTree.children.size(); schemaNum < schemaLim; ++schemaNum ) {
+
+		const XMP_Node * templateSchema = templateTree.children[schemaNum];
+		Schema & schema = this->schemas[schemaNum];
+		schema.node = templateSchema;
+		this->sortedSchemas[schemaNum] = schemaNum;
+
+		schema.props.reserve ( templateSchema->children.size() );
+		schema.names.reserve ( templateSchema->children.size() );
+		for ( size_t propNum = 0, propLim = templateSchema->children.size(); propNum < propLim; ++propNum ) {
+			const XMP_Node * templateProp = templateSchema->children[propNum];
+			schema.names.push_back ( &templateProp->name );
+			if ( this->doAll || IsExternalProperty ( templateSchema->name, templateProp->name ) ) {
+				schema.props.push_back ( templateProp );
+			}
+		}
+		std::sort ( schema.names.begin(), schema.names.end(), LessNamePtr );
 
-#if ENABLE_CPP_DOM_MODEL
-	if (sUseNewCoreAPIs) {
-		ApplyTemplate_v2(workingXMP, templateXMP, actions);
-		return;
 	}
-#endif
 
-	bool doClear   = XMP_OptionIsSet ( actions, kXMPTemplate_ClearUnnamedProperties );
-	bool doAdd     = XMP_OptionIsSet ( actions, kXMPTemplate_AddNewProperties );
-	bool doReplace = XMP_OptionIsSet ( actions, kXMPTemplate_ReplaceExistingProperties );
-	
-	bool deleteEmpty = XMP_OptionIsSet ( actions, kXMPTemplate_ReplaceWithDeleteEmpty );
-	doReplace |= deleteEmpty;	// Delete-empty implies Replace.
-	deleteEmpty &= (! doClear);	// Clear implies not delete-empty, but keep the implicit Replace. 
+	for ( size_t i = 1; i < this->sortedSchemas.size(); ++i ) {	// Few schemas, an insertion sort is fine.
+		size_t curr = this->sortedSchemas[i];
+		size_t j = i;
+		for ( ; (j > 0) && (this->schemas[curr].node->name < this->schemas[this->sortedSchemas[j-1]].node->name); --j ) {
+			this->sortedSchemas[j] = this->sortedSchemas[j-1];
+		}
+		this->sortedSchemas[j] = curr;
+	}
+
+}	// CompiledTemplate::CompiledTemplate
+
+// -------------------------------------------------------------------------------------------------
+
+const CompiledTemplate::Schema *
+CompiledTemplate::FindSchema ( const XMP_VarString & schemaURI ) const
+{
+	size_t low = 0, high = this->sortedSchemas.size();
+	while ( low < high ) {
+		size_t mid = low + (high - low) / 2;
+		const Schema & schema = this->schemas[this->sortedSchemas[mid]];
+		int order = schema.node->name.compare ( schemaURI );
+		if ( order == 0 ) return &schema;
+		if ( order < 0 ) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return 0;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void
+CompiledTemplate::Apply ( XMPMeta * workingXMP ) const
+{
 
-	bool doAll = XMP_OptionIsSet ( actions, kXMPTemplate_IncludeInternalProperties );
-	
 	// ! In several places we do loops backwards so that deletions do not perturb the remaining indices.
 	// ! These loops use ordinals (size .. 1), we must use a zero based index inside the loop.
 	
-	if ( doClear ) {
+	if ( this->doClear ) {
 	
 		// Visit the top level working properties, delete if not in the template.
 
@@ -1571,13 +1665,13 @@ XMPUtils::ApplyTemplate ( XMPMeta *	      workingXMP,
 	
 			size_t schemaNum = schemaOrdinal-1;	// ! Convert ordinal to index!
 			XMP_Node * workingSchema = workingXMP->tree.children[schemaNum];
-			const XMP_Node * templateSchema = FindConstSchema ( &templateXMP.tree, workingSchema->name.c_str() );
+			const Schema * templateSchema = this->FindSchema ( workingSchema->name );
 			
 			if ( templateSchema == 0 ) {
 			
 				// The schema is not in the template, delete all properties or just all external ones.
 
-				if ( doAll ) {
+				if ( this->doAll ) {
 
 					workingSchema->RemoveChildren();	// Remove the properties here, delete the schema below.
 
@@ -1601,8 +1695,9 @@ XMPUtils::ApplyTemplate ( XMPMeta *	      workingXMP,
 				for ( size_t propOrdinal = workingSchema->children.size(); propOrdinal > 0; --propOrdinal ) {
 					size_t propNum = propOrdinal-1;	// ! Convert ordinal to index!
 					XMP_Node * workingProp = workingSchema->children[propNum];
-					if ( (doAll || IsExternalProperty ( workingSchema->name, workingProp->name )) && 
-						 (FindConstChild ( templateSchema, workingProp->name.c_str() ) == 0) ) {
+					if ( (this->doAll || IsExternalProperty ( workingSchema->name, workingProp->name )) && 
+						 (! std::binary_search ( templateSchema->names.begin(), templateSchema->names.end(),
+						 						 &workingProp->name, LessNamePtr )) ) {
 						delete ( workingProp );
 						workingSchema->children.erase ( workingSchema->children.begin() + propNum );
 					}
@@ -1619,11 +1714,12 @@ XMPUtils::ApplyTemplate ( XMPMeta *	      workingXMP,
 		
 	}
 	
-	if ( doAdd | doReplace ) {
+	if ( this->doAdd | this->doReplace ) {
 
-		for ( size_t schemaNum = 0, schemaLim = templateXMP.tree.children.size(); schemaNum < schemaLim; ++schemaNum ) {
+		for ( size_t schemaNum = 0, schemaLim = this->schemas.size(); schemaNum < schemaLim; ++schemaNum ) {
 	
-			const XMP_Node * templateSchema = templateXMP.tree.children[schemaNum];
+			const XMP_Node * templateSchema = this->schemas[schemaNum].node;
+			const std::vector < const XMP_Node * > & templateProps = this->schemas[schemaNum].props;
 	
 			// Make sure we have an output schema node, then process the top level template properties.
 			
@@ -1636,11 +1732,8 @@ XMPUtils::ApplyTemplate ( XMPMeta *	      workingXMP,
 				workingSchemaPos = workingXMP->tree.children.end() - 1;
 			}
 			
-			for ( size_t propNum = 0, propLim = templateSchema->children.size(); propNum < propLim; ++propNum ) {
-				const XMP_Node * templateProp = templateSchema->children[propNum];
-				if ( doAll || IsExternalProperty ( templateSchema->name, templateProp->name ) ) {
-					AppendSubtree ( templateProp, workingSchema, doAdd, doReplace, deleteEmpty );
-				}
+			for ( size_t propNum = 0, propLim = templateProps.size(); propNum < propLim; ++propNum ) {
+				AppendSubtree ( templateProps[propNum], workingSchema, this->doAdd, this->doReplace, this->deleteEmpty );
 			}
 			
 			if ( workingSchema->children.empty() ) {
@@ -1652,31 +1745,174 @@ XMPUtils::ApplyTemplate ( XMPMeta *	      workingXMP,
 
 	}
 
-}	// ApplyTemplate
+}	// CompiledTemplate::Apply
+
+// -------------------------------------------------------------------------------------------------
+// ForEachInParallel
+// -----------------
+//
+// Calls action(n) for n in 0 .. count-1, using up to threadCount threads including the caller, zero
+// meaning one per hardware thread. The calls must be independent of each other. All calls are made
+// even if some throw. The exception of the lowest failing index is rethrown at the end, so the
+// outcome does not depend on the scheduling.
+
+template < class Action >
+static void
+ForEachInParallel ( size_t count, XMP_Index threadCount, const Action & action )
+{
+	size_t threadLim = (threadCount > 0) ? (size_t)threadCount : (size_t)std::thread::hardware_concurrency();
+	if ( threadLim > count ) threadLim = count;
+	if ( threadLim == 0 ) threadLim = 1;
+
+	std::atomic<size_t> nextIndex ( 0 );
+	std::mutex errorLock;
+	size_t errorIndex = count;
+	std::exception_ptr error;
+
+	auto worker = [&] () {
+		for ( size_t index = nextIndex++; index < count; index = nextIndex++ ) {
+			try {
+				action ( index );
+			} catch ( ... ) {
+				std::lock_guard<std::mutex> guard ( errorLock );
+				if ( index < errorIndex ) {
+					errorIndex = index;
+					error = std::current_exception();
+				}
+			}
+		}
+	};
+
+	std::vector < std::thread > threads;
+	threads.reserve ( threadLim - 1 );
+	try {
+		while ( threads.size() < (threadLim - 1) ) threads.push_back ( std::thread ( worker ) );
+	} catch ( ... ) {
+		// Could not start another thread, go on with those that did start.
+	}
 
+	worker();	// The calling thread takes part.
+	for ( size_t i = 0; i < threads.size(); ++i ) threads[i].join();
+
+	if ( error ) std::rethrow_exception ( error );
+
+}	// ForEachInParallel
 
 // -------------------------------------------------------------------------------------------------
-// RemoveProperties
-// ----------------
+// CheckBatchTargets
+// -----------------
+//
+// The targets of a batch are locked one at a time by the worker threads. Make sure there are no
+// null or repeated objects, and that the optional read locked source is not also a target.
+
+static void
+CheckBatchTargets ( XMPMeta * const * xmpObjs, size_t count, const XMPMeta * source )
+{
+	std::vector < const XMPMeta * > sorted ( xmpObjs, xmpObjs + count );
+	std::sort ( sorted.begin(), sorted.end() );
+	for ( size_t i = 0; i < count; ++i ) {
+		if ( sorted[i] == 0 ) XMP_Throw ( "Null XMP object in batch", kXMPErr_BadParam );
+		if ( (i > 0) && (sorted[i] == sorted[i-1]) ) XMP_Throw ( "Repeated XMP object in batch", kXMPErr_BadParam );
+		if ( sorted[i] == source ) XMP_Throw ( "Batch source is also a target", kXMPErr_BadParam );
+	}
+}	// CheckBatchTargets
+
+// -------------------------------------------------------------------------------------------------
+// ApplyTemplate
+// -------------
 
 /* class static */ void
-XMPUtils::RemoveProperties ( XMPMeta *		xmpObj,
-							 XMP_StringPtr	schemaNS,
-							 XMP_StringPtr	propName,
-							 XMP_OptionBits options )
+XMPUtils::ApplyTemplate ( XMPMeta *	      workingXMP,
+						  const XMPMeta & templateXMP,
+						  XMP_OptionBits  actions )
 {
 
 #if ENABLE_CPP_DOM_MODEL
 	if (sUseNewCoreAPIs) {
+		ApplyTemplate_v2(workingXMP, templateXMP, actions);
+		return;
+	}
+#endif
 
-		RemoveProperties_v2(xmpObj, schemaNS, propName, options);
+	CompiledTemplate compiled ( templateXMP, actions );
+	compiled.Apply ( workingXMP );
+
+}	// ApplyTemplate
+
+// -------------------------------------------------------------------------------------------------
+// BatchApplyTemplate
+// ------------------
+//
+// The template is compiled once and applied to the targets in parallel. Each target is write locked
+// by the thread applying to it, the template is read locked by the caller. The C++ DOM objects are
+// done one after the other by the regular ApplyTemplate.
+
+/* class static */ void
+XMPUtils::BatchApplyTemplate ( XMPMeta * const * workingXMPs,
+							   size_t			 count,
+							   const XMPMeta &	 templateXMP,
+							   XMP_OptionBits	 actions,
+							   XMP_Index		 threadCount )
+{
+	CheckBatchTargets ( workingXMPs, count, &templateXMP );
+
+#if ENABLE_CPP_DOM_MODEL
+	if (sUseNewCoreAPIs) {
+		for ( size_t i = 0; i < count; ++i ) {
+			XMP_AutoLock workingLock ( &workingXMPs[i]->lock, kXMP_WriteLock );
+			workingXMPs[i]->PrepareForUpdate();
+			ApplyTemplate_v2 ( workingXMPs[i], templateXMP, actions );
+		}
 		return;
 	}
 #endif
 
+	(void) IsInternalProperty ( kXMP_NS_DM, "" );	// ! Set up the lazy xmpDM table before starting threads.
+
+	CompiledTemplate compiled ( templateXMP, actions );
+
+	ForEachInParallel ( count, threadCount, [&] ( size_t index ) {
+		XMPMeta * workingXMP = workingXMPs[index];
+		XMP_AutoLock workingLock ( &workingXMP->lock, kXMP_WriteLock );
+		workingXMP->PrepareForUpdate();
+		compiled.Apply ( workingXMP );
+	} );
+
+}	// BatchApplyTemplate
+
+
+// -------------------------------------------------------------------------------------------------
+// PropertyRemoval
+// ---------------
+//
+// The checked and expanded parameters of RemoveProperties. The property path, and for a schema with
+// aliases the actual paths of its aliases, are found once. Apply is const, one removal can be applied
+// to several targets at once.
+
+class PropertyRemoval {
+public:
+
+	PropertyRemoval ( XMP_StringPtr schemaNS, XMP_StringPtr propName, XMP_OptionBits options );
+
+	void Apply ( XMPMeta * xmpObj ) const;
+
+private:
+
+	enum { kOneProperty, kOneSchema, kAllSchemas } kind;
+	bool doAll;
+	XMP_VarString schemaNS;
+	XMP_ExpandedXPath propPath;	// For kOneProperty.
+	std::vector < XMP_ExpandedXPath > aliasPaths;	// For kOneSchema, the actuals of the schema's aliases.
+
+};
+
+// -------------------------------------------------------------------------------------------------
+
+PropertyRemoval::PropertyRemoval ( XMP_StringPtr schemaNS, XMP_StringPtr propName, XMP_OptionBits options )
+{
 	XMP_Assert ( (schemaNS != 0) && (propName != 0) );	// ! Enforced by wrapper.
 	
-	const bool doAll = XMP_TestOption (options, kXMPUtil_DoAllProperties );
+	this->doAll = XMP_TestOption (options, kXMPUtil_DoAllProperties );
 	const bool includeAliases = XMP_TestOption ( options, kXMPUtil_IncludeAliases );
 	
 	if ( *propName != 0 ) {
@@ -1686,35 +1922,23 @@ XMPUtils::RemoveProperties ( XMPMeta *		xmpObj,
 		
 		if ( *schemaNS == 0 ) XMP_Throw ( "Property name requires schema namespace", kXMPErr_BadParam );
 		
-		XMP_ExpandedXPath expPath;
-		ExpandXPath ( schemaNS, propName, &expPath );
-		
-		XMP_NodePtrPos propPos;
-		XMP_Node * propNode = ::FindNode( &(xmpObj->tree), expPath, kXMP_ExistingOnly, kXMP_NoOptions, &propPos );
-		if ( propNode != 0 ) {
-			if ( doAll || IsExternalProperty ( expPath[kSchemaStep].step, expPath[kRootPropStep].step ) ) {
-				XMP_Node * parent = propNode->parent;	// *** Should have XMP_Node::RemoveChild(pos).
-				delete propNode;	// ! Both delete the node and erase the pointer from the parent.
-				parent->children.erase ( propPos );
-				DeleteEmptySchema ( parent );
-			}
-		}
+		this->kind = kOneProperty;
+		ExpandXPath ( schemaNS, propName, &this->propPath );
 	
 	} else if ( *schemaNS != 0 ) {
 	
 		// Remove all properties from the named schema. Optionally include aliases, in which case
 		// there might not be an actual schema node. 
 
-		XMP_NodePtrPos schemaPos;
-		XMP_Node * schemaNode = FindSchemaNode ( &xmpObj->tree, schemaNS, kXMP_ExistingOnly, &schemaPos );
-		if ( schemaNode != 0 ) RemoveSchemaChildren ( schemaPos, doAll );
+		this->kind = kOneSchema;
+		this->schemaNS = schemaNS;
 		
 		if ( includeAliases ) {
 		
 			// We're removing the aliases also. Look them up by their namespace prefix. Yes, the
 			// alias map is sorted so we could process just that portion. But that takes more code
 			// and the extra speed isn't worth it. (Plus this way we avoid a dependence on the map
-			// implementation.) Lookup the XMP node from the alias, to make sure the actual exists.
+			// implementation.)
 
 			XMP_StringPtr nsPrefix;
 			XMP_StringLen nsLen;
@@ -1725,23 +1949,63 @@ XMPUtils::RemoveProperties ( XMPMeta *		xmpObj,
 			
 			for ( ; currAlias != endAlias; ++currAlias ) {
 				if ( strncmp ( currAlias->first.c_str(), nsPrefix, nsLen ) == 0 ) {
-					XMP_NodePtrPos actualPos;
-					XMP_Node * actualProp = ::FindNode( &xmpObj->tree, currAlias->second, kXMP_ExistingOnly, kXMP_NoOptions, &actualPos );
-					if ( actualProp != 0 ) {
-						XMP_Node * rootProp = actualProp;
-						while ( ! XMP_NodeIsSchema ( rootProp->parent->options ) ) rootProp = rootProp->parent;
-						if ( doAll || IsExternalProperty ( rootProp->parent->name, rootProp->name ) ) {
-							XMP_Node * parent = actualProp->parent;
-							delete actualProp;	// ! Both delete the node and erase the pointer from the parent.
-							parent->children.erase ( actualPos );
-							DeleteEmptySchema ( parent );
-						}
-					}
+					this->aliasPaths.push_back ( currAlias->second );
 				}
 			}
 
 		}
 
+	} else {
+		
+		this->kind = kAllSchemas;
+	
+	}
+
+}	// PropertyRemoval::PropertyRemoval
+
+// -------------------------------------------------------------------------------------------------
+
+void
+PropertyRemoval::Apply ( XMPMeta * xmpObj ) const
+{
+	
+	if ( this->kind == kOneProperty ) {
+	
+		const XMP_ExpandedXPath & expPath = this->propPath;
+		XMP_NodePtrPos propPos;
+		XMP_Node * propNode = ::FindNode( &(xmpObj->tree), expPath, kXMP_ExistingOnly, kXMP_NoOptions, &propPos );
+		if ( propNode != 0 ) {
+			if ( this->doAll || IsExternalProperty ( expPath[kSchemaStep].step, expPath[kRootPropStep].step ) ) {
+				XMP_Node * parent = propNode->parent;	// *** Should have XMP_Node::RemoveChild(pos).
+				delete propNode;	// ! Both delete the node and erase the pointer from the parent.
+				parent->children.erase ( propPos );
+				DeleteEmptySchema ( parent );
+			}
+		}
+	
+	} else if ( this->kind == kOneSchema ) {
+	
+		XMP_NodePtrPos schemaPos;
+		XMP_Node * schemaNode = FindSchemaNode ( &xmpObj->tree, this->schemaNS.c_str(), kXMP_ExistingOnly, &schemaPos );
+		if ( schemaNode != 0 ) RemoveSchemaChildren ( schemaPos, this->doAll );
+		
+		// Lookup the XMP node from the alias, to make sure the actual exists.
+
+		for ( size_t aliasNum = 0, aliasLim = this->aliasPaths.size(); aliasNum < aliasLim; ++aliasNum ) {
+			XMP_NodePtrPos actualPos;
+			XMP_Node * actualProp = ::FindNode( &xmpObj->tree, this->aliasPaths[aliasNum], kXMP_ExistingOnly, kXMP_NoOptions, &actualPos );
+			if ( actualProp != 0 ) {
+				XMP_Node * rootProp = actualProp;
+				while ( ! XMP_NodeIsSchema ( rootProp->parent->options ) ) rootProp = rootProp->parent;
+				if ( this->doAll || IsExternalProperty ( rootProp->parent->name, rootProp->name ) ) {
+					XMP_Node * parent = actualProp->parent;
+					delete actualProp;	// ! Both delete the node and erase the pointer from the parent.
+					parent->children.erase ( actualPos );
+					DeleteEmptySchema ( parent );
+				}
+			}
+		}
+
 	} else {
 		
 		// Remove all appropriate properties from all schema. In this case we don't have to be
@@ -1755,13 +2019,77 @@ XMPUtils::RemoveProperties ( XMPMeta *		xmpObj,
 		
 		for ( size_t schemaNum = schemaCount-1, schemaLim = (size_t)(-1); schemaNum != schemaLim; --schemaNum ) {
 			XMP_NodePtrPos currSchema = beginPos + schemaNum;
-			RemoveSchemaChildren ( currSchema, doAll );
+			RemoveSchemaChildren ( currSchema, this->doAll );
 		}
 	
 	}
 
+}	// PropertyRemoval::Apply
+
+// -------------------------------------------------------------------------------------------------
+// RemoveProperties
+// ----------------
+
+/* class static */ void
+XMPUtils::RemoveProperties ( XMPMeta *		xmpObj,
+							 XMP_StringPtr	schemaNS,
+							 XMP_StringPtr	propName,
+							 XMP_OptionBits options )
+{
+
+#if ENABLE_CPP_DOM_MODEL
+	if (sUseNewCoreAPIs) {
+
+		RemoveProperties_v2(xmpObj, schemaNS, propName, options);
+		return;
+	}
+#endif
+
+	PropertyRemoval removal ( schemaNS, propName, options );
+	removal.Apply ( xmpObj );
+
 }	// RemoveProperties
 
+// -------------------------------------------------------------------------------------------------
+// BatchRemoveProperties
+// ---------------------
+//
+// Like BatchApplyTemplate, the removal is prepared once and applied to the objects in parallel.
+
+/* class static */ void
+XMPUtils::BatchRemoveProperties ( XMPMeta * const * xmpObjs,
+								  size_t			count,
+								  XMP_StringPtr		schemaNS,
+								  XMP_StringPtr		propName,
+								  XMP_OptionBits	options,
+								  XMP_Index			threadCount )
+{
+	CheckBatchTargets ( xmpObjs, count, 0 );
+
+#if ENABLE_CPP_DOM_MODEL
+	if (sUseNewCoreAPIs) {
+		for ( size_t i = 0; i < count; ++i ) {
+			XMP_AutoLock metaLock ( &xmpObjs[i]->lock, kXMP_WriteLock );
+			xmpObjs[i]->PrepareForUpdate();
+			RemoveProperties_v2 ( xmpObjs[i], schemaNS, propName, options );
+		}
+		return;
+	}
+#endif
+
+	(void) IsInternalProperty ( kXMP_NS_DM, "" );	// ! Set up the lazy xmpDM table before starting threads.
+
+	PropertyRemoval removal ( schemaNS, propName, options );
+
+	ForEachInParallel ( count, threadCount, [&] ( size_t index ) {
+		XMPMeta * xmpObj = xmpObjs[index];
+		XMP_AutoLock metaLock ( &xmpObj->lock, kXMP_WriteLock );
+		xmpObj->PrepareForUpdate();
+		removal.Apply ( xmpObj );
+	} );
+
+}	// BatchRemoveProperties
+
 
 // -------------------------------------------------------------------------------------------------
 // DuplicateSubtree
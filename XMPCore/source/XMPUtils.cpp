@@ -48,6 +48,63 @@ using namespace AdobeXMPCommon;
 // =========================
 
 static const char * sBase64Chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Lookup tables for base 64, filled in by XMPUtils::Initialize. The encoding table has the two
+// characters for each 12 bit value, so 3 raw bytes take two lookups. The decoding table has the
+// value of each data character, or one of the special codes below. The merge tables have the data
+// character values already shifted to their place in a group of 4 characters, with the high byte
+// set for anything else, so a whole group is decoded and checked with one merge.
+
+enum {
+	kBase64Space   = 0xFF,	// Space, tab, LF, and CR are ignored.
+	kBase64Pad     = 0xFE,	// The '=' padding at the end.
+	kBase64Invalid = 0xFD
+};
+
+static const XMP_Uns32 kBase64BadMerge = 0x01000000;
+static const size_t kBase64QuadsPerLine = 19;	// A linefeed is written after every 76 characters.
+
+static char		 sBase64Pairs [4096*2];
+static XMP_Uns8	 sBase64Values [256];
+static XMP_Uns32 sBase64Merge [4] [256];
+
+// The base 64 vector code is compiled with function level target attributes, as in source/CRC32.cpp,
+// so that no special compiler options are needed. SSSE3 is checked for when the tables are filled
+// in, NEON is always there on 64 bit ARM. Define XMP_Base64_UseHardware as 0 for only the portable
+// table code.
+
+#ifndef XMP_Base64_UseHardware
+	#define XMP_Base64_UseHardware 1
+#endif
+
+#define Base64_HaveSSSE3 0
+#define Base64_HaveNEON  0
+
+#if XMP_Base64_UseHardware
+
+	#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+		#undef  Base64_HaveSSSE3
+		#define Base64_HaveSSSE3 1
+		#define Base64_TargetSSSE3 __attribute__ ((target ( "ssse3" )))
+		#include <immintrin.h>
+	#elif (defined(_M_X64) || defined(_M_IX86)) && defined(_MSC_VER)
+		#undef  Base64_HaveSSSE3
+		#define Base64_HaveSSSE3 1
+		#define Base64_TargetSSSE3
+		#include <intrin.h>
+	#endif
+
+	#if defined(__aarch64__) || defined(_M_ARM64)
+		#undef  Base64_HaveNEON
+		#define Base64_HaveNEON 1
+		#include <arm_neon.h>
+	#endif
+
+#endif
+
+enum { kBase64UsePortable = 0, kBase64UseSSSE3 = 1, kBase64UseNEON = 2 };
+
+static int sBase64Selection = kBase64UsePortable;
 const XMP_VarString xmlNameSpace  = "http://www.w3.org/XML/1998/namespace";
 // =================================================================================================
 // Local Utilities
@@ -1514,35 +1571,362 @@ GatherInt ( XMP_StringPtr strValue, size_t * _pos, const char * errMsg )
 
 }	// GatherInt
 
+// -------------------------------------------------------------------------------------------------
+// GatherDigits
+// ------------
+//
+// Gather a fixed number of decimal digits. Returns false if any of them is not a digit.
+
+static inline bool
+GatherDigits ( XMP_StringPtr strValue, size_t count, XMP_Int32 * value )
+{
+	XMP_Int32 result = 0;
+
+	for ( size_t i = 0; i < count; ++i ) {
+		XMP_Uns32 digit = XMP_Uns32 ( (XMP_Uns8)strValue[i] ) - XMP_Uns32 ( '0' );
+		if ( digit > 9 ) return false;
+		result = (result * 10) + digit;
+	}
+
+	*value = result;
+	return true;
+
+}	// GatherDigits
+
+// -------------------------------------------------------------------------------------------------
+// FormatDecimal
+// -------------
+//
+// Format an integer the same as snprintf with "%.Nd", the digits are zero padded to at least N.
+// Returns the end of the output, no terminating nul is written.
+
+static char *
+FormatDecimal ( char * outPtr, XMP_Int64 value, size_t minDigits )
+{
+	char digits [24];
+	char * digitPtr = digits + sizeof(digits);
+
+	XMP_Uns64 magnitude = (value < 0) ? (XMP_Uns64(0) - XMP_Uns64(value)) : XMP_Uns64(value);
+	do {
+		*(--digitPtr) = char ( '0' + (magnitude % 10) );
+		magnitude /= 10;
+	} while ( magnitude != 0 );
+
+	size_t digitCount = (digits + sizeof(digits)) - digitPtr;
+	if ( value < 0 ) *outPtr++ = '-';
+	for ( ; minDigits > digitCount; --minDigits ) *outPtr++ = '0';
+	memcpy ( outPtr, digitPtr, digitCount );
+
+	return outPtr + digitCount;
+
+}	// FormatDecimal
+
 // -------------------------------------------------------------------------------------------------
 
 static void FormatFullDateTime ( XMP_DateTime & tempDate, char * buffer, size_t bufferLen )
 {
 
 	AdjustTimeOverflow ( &tempDate );	// Make sure all time parts are in range.
+	XMP_Assert ( bufferLen >= 64 );	// The longest has an 11 character year and 9 fraction digits.
+
+	// Output YYYY-MM-DDThh:mm:ss, then .s if there are fractional seconds, trimming excess digits.
+
+	char * outPtr = FormatDecimal ( buffer, tempDate.year, 4 );
+	*outPtr++ = '-';
+	outPtr = FormatDecimal ( outPtr, tempDate.month, 2 );
+	*outPtr++ = '-';
+	outPtr = FormatDecimal ( outPtr, tempDate.day, 2 );
+	*outPtr++ = 'T';
+	outPtr = FormatDecimal ( outPtr, tempDate.hour, 2 );
+	*outPtr++ = ':';
+	outPtr = FormatDecimal ( outPtr, tempDate.minute, 2 );
+	*outPtr++ = ':';
+	outPtr = FormatDecimal ( outPtr, tempDate.second, 2 );
+
+	if ( tempDate.nanoSecond != 0 ) {
+		*outPtr++ = '.';
+		outPtr = FormatDecimal ( outPtr, tempDate.nanoSecond, 9 );
+		while ( *(outPtr-1) == '0' ) --outPtr;	// Trim excess digits.
+	}
+
+	*outPtr = 0;
+
+}	// FormatFullDateTime
+
+#if Base64_HaveSSSE3
+
+// -------------------------------------------------------------------------------------------------
+// EncodeBase64SSSE3
+// -----------------
+//
+// Encode groups of 12 raw bytes into 16 characters, this is the method of Wojciech Muła's "Base64
+// encoding with SIMD instructions". The bytes of each 3 byte chunk are spread over a 32 bit lane,
+// the 6 bit values are moved in place with multiplies, and mapped to characters by adding an offset
+// looked up from the range of the value. Each step loads 16 bytes, so 4 bytes must be readable past
+// the 12 that are used. Returns the number of 4 character quads written, a multiple of 4.
+
+static Base64_TargetSSSE3 size_t
+EncodeBase64SSSE3 ( const XMP_Uns8 * rawPtr, size_t rawAvail, char * outPtr, size_t quadCount )
+{
+	const __m128i spread   = _mm_set_epi8 ( 10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1 );
+	const __m128i maskAC   = _mm_set1_epi32 ( 0x0FC0FC00 );
+	const __m128i multAC   = _mm_set1_epi32 ( 0x04000040 );
+	const __m128i maskBD   = _mm_set1_epi32 ( 0x003F03F0 );
+	const __m128i multBD   = _mm_set1_epi32 ( 0x01000010 );
+	const __m128i offsets  = _mm_setr_epi8 ( 'a'-26, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52,
+											 '0'-52, '0'-52, '0'-52, '+'-62, '/'-63, 'A', 0, 0 );
+	const __m128i fiftyOne = _mm_set1_epi8 ( 51 );
+	const __m128i twentySix = _mm_set1_epi8 ( 26 );
+	const __m128i thirteen = _mm_set1_epi8 ( 13 );
+
+	size_t done = 0;
+
+	for ( ; ((quadCount - done) >= 4) && (rawAvail >= 16); done += 4, rawPtr += 12, rawAvail -= 12, outPtr += 16 ) {
 
-	if ( tempDate.nanoSecond == 0  ) {
+		__m128i in = _mm_shuffle_epi8 ( _mm_loadu_si128 ( (const __m128i*)rawPtr ), spread );
+		__m128i indices = _mm_or_si128 ( _mm_mulhi_epu16 ( _mm_and_si128 ( in, maskAC ), multAC ),
+										 _mm_mullo_epi16 ( _mm_and_si128 ( in, maskBD ), multBD ) );
 
-		// Output YYYY-MM-DDThh:mm:ssTZD.
-		snprintf ( buffer, bufferLen, "%.4d-%02d-%02dT%02d:%02d:%02d",	// AUDIT: Callers pass sizeof(buffer).
-				   tempDate.year, tempDate.month, tempDate.day,
-				   tempDate.hour, tempDate.minute, tempDate.second );
+		__m128i range = _mm_subs_epu8 ( indices, fiftyOne );	// 1..12 for the digits, '+', and '/'.
+		range = _mm_or_si128 ( range, _mm_and_si128 ( _mm_cmpgt_epi8 ( twentySix, indices ), thirteen ) );
+		__m128i chars = _mm_add_epi8 ( indices, _mm_shuffle_epi8 ( offsets, range ) );
 
+		_mm_storeu_si128 ( (__m128i*)outPtr, chars );
+
+	}
+
+	return done;
+
+}	// EncodeBase64SSSE3
+
+// -------------------------------------------------------------------------------------------------
+// IsBase64DataSSSE3
+// -----------------
+//
+// Check that 16 characters are all data characters, with two lookups by nibble whose results have
+// a common bit for anything else. The high nibbles are returned for the decoding.
+
+static inline Base64_TargetSSSE3 bool
+IsBase64DataSSSE3 ( __m128i in, __m128i * hiNibbles )
+{
+	const __m128i checkLo = _mm_setr_epi8 ( 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+											0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A );
+	const __m128i checkHi = _mm_setr_epi8 ( 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+											0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 );
+	const __m128i nibble  = _mm_set1_epi8 ( 0x0F );
+
+	__m128i hi = _mm_and_si128 ( _mm_srli_epi32 ( in, 4 ), nibble );
+	__m128i lo = _mm_and_si128 ( in, nibble );
+	*hiNibbles = hi;
+
+	__m128i bad = _mm_and_si128 ( _mm_shuffle_epi8 ( checkLo, lo ), _mm_shuffle_epi8 ( checkHi, hi ) );
+	return _mm_movemask_epi8 ( _mm_cmpgt_epi8 ( bad, _mm_setzero_si128() ) ) == 0;
+
+}	// IsBase64DataSSSE3
+
+// -------------------------------------------------------------------------------------------------
+// SkipBase64DataSSSE3
+// -------------------
+//
+// Returns the length of the leading blocks of 16 characters that have only data characters.
+
+static Base64_TargetSSSE3 size_t
+SkipBase64DataSSSE3 ( const XMP_Uns8 * encodedStr, size_t encodedLen )
+{
+	size_t done = 0;
+	__m128i hi;
+
+	for ( ; ((encodedLen - done) >= 16); done += 16 ) {
+		if ( ! IsBase64DataSSSE3 ( _mm_loadu_si128 ( (const __m128i*)(encodedStr + done) ), &hi ) ) break;
+	}
+
+	return done;
+
+}	// SkipBase64DataSSSE3
+
+// -------------------------------------------------------------------------------------------------
+// DecodeBase64SSSE3
+// -----------------
+//
+// Decode 16 characters into 12 raw bytes, the reverse of EncodeBase64SSSE3. Anything other than
+// data characters makes this return false without writing, the caller then decodes a group with
+// the portable code. All 16 bytes of the result are stored if there is room for them, else the 12
+// used ones are copied.
+
+static Base64_TargetSSSE3 bool
+DecodeBase64SSSE3 ( const XMP_Uns8 * encodedStr, XMP_Uns8 * rawData, size_t rawRoom )
+{
+	const __m128i offsets = _mm_setr_epi8 ( 0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0 );
+
+	__m128i in = _mm_loadu_si128 ( (const __m128i*)encodedStr );
+	__m128i hi;
+	if ( ! IsBase64DataSSSE3 ( in, &hi ) ) return false;
+
+	__m128i isSlash = _mm_cmpeq_epi8 ( in, _mm_set1_epi8 ( '/' ) );
+	__m128i values = _mm_add_epi8 ( in, _mm_shuffle_epi8 ( offsets, _mm_add_epi8 ( isSlash, hi ) ) );
+
+	__m128i merged = _mm_maddubs_epi16 ( values, _mm_set1_epi32 ( 0x01400140 ) );
+	merged = _mm_madd_epi16 ( merged, _mm_set1_epi32 ( 0x00011000 ) );
+	merged = _mm_shuffle_epi8 ( merged, _mm_setr_epi8 ( 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1 ) );
+
+	if ( rawRoom >= 16 ) {
+		_mm_storeu_si128 ( (__m128i*)rawData, merged );
 	} else {
+		XMP_Uns8 temp [16];
+		_mm_storeu_si128 ( (__m128i*)temp, merged );
+		memcpy ( rawData, temp, 12 );
+	}
+
+	return true;
+
+}	// DecodeBase64SSSE3
+
+static bool HaveSSSE3()
+{
+	#if defined(_MSC_VER) && ! defined(__clang__)
+		int info[4];
+		__cpuid ( info, 1 );
+		return (info[2] & (1 << 9)) != 0;
+	#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports ( "ssse3" );
+	#endif
+}
+
+#endif	// Base64_HaveSSSE3
+
+#if Base64_HaveNEON
+
+// -------------------------------------------------------------------------------------------------
+// EncodeBase64NEON
+// ----------------
+//
+// Encode groups of 48 raw bytes into 64 characters. The structured loads split the bytes of the 3
+// byte chunks into separate vectors, the 6 bit values are shifted out and mapped to characters with
+// a 64 byte table lookup. Returns the number of 4 character quads written, a multiple of 16.
+
+static size_t
+EncodeBase64NEON ( const XMP_Uns8 * rawPtr, char * outPtr, size_t quadCount )
+{
+	const XMP_Uns8 * chars = (const XMP_Uns8*)sBase64Chars;
+	uint8x16x4_t table;
+	table.val[0] = vld1q_u8 ( chars );
+	table.val[1] = vld1q_u8 ( chars + 16 );
+	table.val[2] = vld1q_u8 ( chars + 32 );
+	table.val[3] = vld1q_u8 ( chars + 48 );
+
+	const uint8x16_t low6 = vdupq_n_u8 ( 0x3F );
+
+	size_t done = 0;
+
+	for ( ; (quadCount - done) >= 16; done += 16, rawPtr += 48, outPtr += 64 ) {
+
+		uint8x16x3_t in = vld3q_u8 ( rawPtr );
+		uint8x16x4_t out;
+
+		out.val[0] = vshrq_n_u8 ( in.val[0], 2 );
+		out.val[1] = vandq_u8 ( vorrq_u8 ( vshlq_n_u8 ( in.val[0], 4 ), vshrq_n_u8 ( in.val[1], 4 ) ), low6 );
+		out.val[2] = vandq_u8 ( vorrq_u8 ( vshlq_n_u8 ( in.val[1], 2 ), vshrq_n_u8 ( in.val[2], 6 ) ), low6 );
+		out.val[3] = vandq_u8 ( in.val[2], low6 );
+
+		out.val[0] = vqtbl4q_u8 ( table, out.val[0] );
+		out.val[1] = vqtbl4q_u8 ( table, out.val[1] );
+		out.val[2] = vqtbl4q_u8 ( table, out.val[2] );
+		out.val[3] = vqtbl4q_u8 ( table, out.val[3] );
+
+		vst4q_u8 ( (XMP_Uns8*)outPtr, out );
 
-		// Output YYYY-MM-DDThh:mm:ss.sTZD.
-		snprintf ( buffer, bufferLen, "%.4d-%02d-%02dT%02d:%02d:%02d.%09d", // AUDIT: Callers pass sizeof(buffer).
-				   tempDate.year, tempDate.month, tempDate.day,
-				   tempDate.hour, tempDate.minute, tempDate.second, tempDate.nanoSecond );
-		buffer[bufferLen - 1] = 0; // AUDIT warning C6053: make sure string is terminated. buffer is already filled with 0 from caller
-		for ( size_t i = strlen(buffer)-1; buffer[i] == '0'; --i ) buffer[i] = 0;	// Trim excess digits.
 	}
 
-}	// FormatFullDateTime
+	return done;
+
+}	// EncodeBase64NEON
+
+// -------------------------------------------------------------------------------------------------
+// Base64ValuesNEON
+// ----------------
+//
+// Map 16 characters through the low half of the decoding table, whose special codes all have the
+// high bit set. The high bit of the returned check is set for anything other than data characters,
+// including characters outside ASCII.
+
+struct Base64TablesNEON {
+	uint8x16x4_t lo, hi;
+	Base64TablesNEON()
+	{
+		for ( size_t i = 0; i < 4; ++i ) {
+			this->lo.val[i] = vld1q_u8 ( &sBase64Values[16*i] );
+			this->hi.val[i] = vld1q_u8 ( &sBase64Values[64 + 16*i] );
+		}
+	}
+};
+
+static inline uint8x16_t
+Base64ValuesNEON ( const Base64TablesNEON & tables, uint8x16_t in, uint8x16_t * check )
+{
+	uint8x16_t value = vqtbl4q_u8 ( tables.lo, in );	// 0 for 64 and up.
+	value = vqtbx4q_u8 ( value, tables.hi, vsubq_u8 ( in, vdupq_n_u8 ( 64 ) ) );	// Kept for below 64.
+	*check = vorrq_u8 ( *check, vorrq_u8 ( value, in ) );
+	return value;
+}
+
+// -------------------------------------------------------------------------------------------------
+// SkipBase64DataNEON
+// ------------------
+//
+// Returns the length of the leading blocks of 16 characters that have only data characters.
+
+static size_t
+SkipBase64DataNEON ( const XMP_Uns8 * encodedStr, size_t encodedLen )
+{
+	const Base64TablesNEON tables;
+	size_t done = 0;
+
+	for ( ; ((encodedLen - done) >= 16); done += 16 ) {
+		uint8x16_t check = vdupq_n_u8 ( 0 );
+		(void) Base64ValuesNEON ( tables, vld1q_u8 ( encodedStr + done ), &check );
+		if ( vmaxvq_u8 ( check ) >= 0x80 ) break;
+	}
+
+	return done;
+
+}	// SkipBase64DataNEON
 
 // -------------------------------------------------------------------------------------------------
-// DecodeBase64Char
+// DecodeBase64NEON
 // ----------------
+//
+// Decode 64 characters into 48 raw bytes. Anything other than data characters makes this return
+// false without writing, the caller then decodes a group with the portable code.
+
+static bool
+DecodeBase64NEON ( const XMP_Uns8 * encodedStr, XMP_Uns8 * rawData )
+{
+	const Base64TablesNEON tables;
+
+	uint8x16x4_t in = vld4q_u8 ( encodedStr );
+	uint8x16_t check = vdupq_n_u8 ( 0 );
+
+	for ( size_t i = 0; i < 4; ++i ) in.val[i] = Base64ValuesNEON ( tables, in.val[i], &check );
+
+	if ( vmaxvq_u8 ( check ) >= 0x80 ) return false;
+
+	uint8x16x3_t out;
+	out.val[0] = vorrq_u8 ( vshlq_n_u8 ( in.val[0], 2 ), vshrq_n_u8 ( in.val[1], 4 ) );
+	out.val[1] = vorrq_u8 ( vshlq_n_u8 ( in.val[1], 4 ), vshrq_n_u8 ( in.val[2], 2 ) );
+	out.val[2] = vorrq_u8 ( vshlq_n_u8 ( in.val[2], 6 ), in.val[3] );
+
+	vst3q_u8 ( rawData, out );
+
+	return true;
+
+}	// DecodeBase64NEON
+
+#endif	// Base64_HaveNEON
+
+// -------------------------------------------------------------------------------------------------
+// InitializeBase64Tables
+// ----------------------
 
 // The decode mapping:
 //
@@ -1555,76 +1939,193 @@ static void FormatFullDateTime ( XMP_DateTime & tempDate, char * buffer, size_t
 //	+			0x2B			62
 //	/			0x2F			63
 
-static unsigned char
-DecodeBase64Char ( XMP_Uns8 ch )
-{
-
-	if ( ('A' <= ch) && (ch <= 'Z') ) {
-		ch = ch - 'A';
-	} else if ( ('a' <= ch) && (ch <= 'z') ) {
-		ch = ch - 'a' + 26;
-	} else if ( ('0' <= ch) && (ch <= '9') ) {
-		ch = ch - '0' + 52;
-	} else if ( ch == '+' ) {
-		ch = 62;
-	} else if ( ch == '/' ) {
-		ch = 63;
-	} else if ( (ch == ' ') || (ch == kTab) || (ch == kLF) || (ch == kCR) ) {
-		ch = 0xFF;	// Will be ignored by the caller.
-	} else {
-		XMP_Throw ( "Invalid base-64 encoded character", kXMPErr_BadParam );
+static void
+InitializeBase64Tables()
+{
+
+	for ( size_t i = 0; i < 4096; ++i ) {
+		sBase64Pairs[2*i]   = sBase64Chars [ i >> 6 ];
+		sBase64Pairs[2*i+1] = sBase64Chars [ i & 0x3F ];
 	}
 
-	return ch;
+	memset ( sBase64Values, kBase64Invalid, sizeof(sBase64Values) );
+	for ( XMP_Uns8 i = 0; i < 64; ++i ) sBase64Values [ (XMP_Uns8)sBase64Chars[i] ] = i;
+	sBase64Values [ (XMP_Uns8)' ' ] = sBase64Values [ (XMP_Uns8)kTab ] = kBase64Space;
+	sBase64Values [ (XMP_Uns8)kLF ] = sBase64Values [ (XMP_Uns8)kCR ] = kBase64Space;
+	sBase64Values [ (XMP_Uns8)'=' ] = kBase64Pad;
 
-}	// DecodeBase64Char ();
+	for ( size_t ch = 0; ch < 256; ++ch ) {
+		XMP_Uns32 value = sBase64Values[ch];
+		for ( size_t pos = 0; pos < 4; ++pos ) {
+			sBase64Merge[pos][ch] = (value < 64) ? (value << (18 - 6*pos)) : kBase64BadMerge;
+		}
+	}
+
+	sBase64Selection = kBase64UsePortable;
+	#if Base64_HaveSSSE3
+		if ( HaveSSSE3() ) sBase64Selection = kBase64UseSSSE3;
+	#endif
+	#if Base64_HaveNEON
+		sBase64Selection = kBase64UseNEON;
+	#endif
+
+}	// InitializeBase64Tables
 
 // -------------------------------------------------------------------------------------------------
-// EstimateSizeForJPEG
-// -------------------
+// CountBase64Data
+// ---------------
 //
-// Estimate the serialized size for the subtree of an XMP_Node. Support for PackageForJPEG.
+// Check that a base 64 string has only data characters, whitespace, and up to 2 padding '=' at the
+// end, and that the data is a whole number of 4 character groups. Returns the exact raw length,
+// which is 0 if there are no data characters at all.
 
 static size_t
-EstimateSizeForJPEG ( const XMP_Node * xmpNode )
+CountBase64Data ( const XMP_Uns8 * encodedStr, size_t encodedLen, size_t * padding )
 {
+	size_t dataCount = 0;
+	size_t padCount  = 0;
 
-	size_t estSize = 0;
-	size_t nameSize = xmpNode->name.size();
-	bool   includeName = (! XMP_PropIsArray ( xmpNode->parent->options ));
+	// The vector code skips over runs of data characters, a block with anything else is done a
+	// character at a time.
 
-	if ( XMP_PropIsSimple ( xmpNode->options ) ) {
+	const XMP_Uns8 * encodedEnd = encodedStr + encodedLen;
 
-		if ( includeName ) estSize += (nameSize + 3);	// Assume attribute form.
-		estSize += xmpNode->value.size();
+	while ( encodedStr < encodedEnd ) {
 
-	} else if ( XMP_PropIsArray ( xmpNode->options ) ) {
+		size_t dataRun = 0;
+		#if Base64_HaveSSSE3
+			if ( sBase64Selection == kBase64UseSSSE3 ) dataRun = SkipBase64DataSSSE3 ( encodedStr, (encodedEnd - encodedStr) );
+		#endif
+		#if Base64_HaveNEON
+			if ( sBase64Selection == kBase64UseNEON ) dataRun = SkipBase64DataNEON ( encodedStr, (encodedEnd - encodedStr) );
+		#endif
+		if ( (dataRun != 0) && (padCount != 0) ) XMP_Throw ( "Invalid base-64 encoded character", kXMPErr_BadParam );
+		dataCount  += dataRun;
+		encodedStr += dataRun;
+
+		const XMP_Uns8 * blockEnd = ((encodedEnd - encodedStr) > 16) ? (encodedStr + 16) : encodedEnd;
+
+		for ( ; encodedStr < blockEnd; ++encodedStr ) {
+			XMP_Uns8 value = sBase64Values [ *encodedStr ];
+			if ( value < 64 ) {
+				if ( padCount != 0 ) XMP_Throw ( "Invalid base-64 encoded character", kXMPErr_BadParam );
+				++dataCount;
+			} else if ( value == kBase64Pad ) {
+				++padCount;
+			} else if ( value != kBase64Space ) {
+				XMP_Throw ( "Invalid base-64 encoded character", kXMPErr_BadParam );
+			}
+		}
 
-		// The form of the value portion is: <rdf:Xyz><rdf:li>...</rdf:li>...</rdf:Xyx>
-		if ( includeName ) estSize += (2*nameSize + 5);
-		size_t arraySize = xmpNode->children.size();
-		estSize += 9 + 10;	// The rdf:Xyz tags.
-		estSize += arraySize * (8 + 9);	// The rdf:li tags.
-		for ( size_t i = 0; i < arraySize; ++i ) {
-			estSize += EstimateSizeForJPEG ( xmpNode->children[i] );
+	}
+
+	*padding = 0;
+	if ( dataCount == 0 ) return 0;	// Nothing but whitespace and padding.
+	if ( (padCount > 2) || (((dataCount + padCount) & 3) != 0) ) XMP_Throw ( "Invalid encoded string", kXMPErr_BadParam );
+
+	*padding = padCount;
+	return ((dataCount + padCount) / 4) * 3 - padCount;
+
+}	// CountBase64Data
+
+// -------------------------------------------------------------------------------------------------
+// DecodeBase64Data
+// ----------------
+//
+// Decode a string already checked by CountBase64Data. Groups of 4 characters without whitespace,
+// which is nearly everything when the lines are a multiple of 4 long, are merged with one lookup
+// per character. Anything else is done a character at a time, skipping whitespace.
+
+static void
+DecodeBase64Data ( const XMP_Uns8 * encodedStr, size_t encodedLen, size_t padding, XMP_Uns8 * rawData, size_t rawLen )
+{
+	const XMP_Uns8 * encodedEnd = encodedStr + encodedLen;
+	#if Base64_HaveSSSE3
+		const XMP_Uns8 * rawEnd = rawData + rawLen;
+	#endif
+	XMP_Uns32 merge;
+	size_t portableGroups = 0;	// Groups to do with the portable code before trying a vector step again.
+
+	for ( size_t groupCount = rawLen / 3; groupCount > 0; --groupCount ) {
+
+		// A vector step decodes several whole groups, it is taken only if they have no whitespace.
+		// After a step fails, the groups it covered are done with the portable code.
+
+		if ( portableGroups > 0 ) {
+			--portableGroups;
+		} else {
+			#if Base64_HaveSSSE3
+				if ( (sBase64Selection == kBase64UseSSSE3) && (groupCount >= 4) && ((encodedEnd - encodedStr) >= 16) ) {
+					if ( DecodeBase64SSSE3 ( encodedStr, rawData, (rawEnd - rawData) ) ) {
+						encodedStr += 16;
+						rawData += 12;
+						groupCount -= 3;
+						continue;
+					}
+					portableGroups = 3;
+				}
+			#endif
+			#if Base64_HaveNEON
+				if ( (sBase64Selection == kBase64UseNEON) && (groupCount >= 16) && ((encodedEnd - encodedStr) >= 64) ) {
+					if ( DecodeBase64NEON ( encodedStr, rawData ) ) {
+						encodedStr += 64;
+						rawData += 48;
+						groupCount -= 15;
+						continue;
+					}
+					portableGroups = 15;
+				}
+			#endif
 		}
 
-	} else {
+		if ( (encodedEnd - encodedStr) >= 4 ) {
+			merge = sBase64Merge[0][encodedStr[0]] | sBase64Merge[1][encodedStr[1]] |
+					sBase64Merge[2][encodedStr[2]] | sBase64Merge[3][encodedStr[3]];
+			if ( merge < kBase64BadMerge ) {
+				rawData[0] = (XMP_Uns8) (merge >> 16);
+				rawData[1] = (XMP_Uns8) (merge >> 8);
+				rawData[2] = (XMP_Uns8) merge;
+				encodedStr += 4;
+				rawData += 3;
+				continue;
+			}
+		}
 
-		// The form is: <headTag rdf:parseType="Resource">...fields...</tailTag>
-		if ( includeName ) estSize += (2*nameSize + 5);
-		estSize += 25;	// The rdf:parseType="Resource" attribute.
-		size_t fieldCount = xmpNode->children.size();
-		for ( size_t i = 0; i < fieldCount; ++i ) {
-			estSize += EstimateSizeForJPEG ( xmpNode->children[i] );
+		merge = 0;
+		for ( size_t inChunk = 0; inChunk < 4; ++encodedStr ) {
+			XMP_Uns8 value = sBase64Values [ *encodedStr ];
+			if ( value >= 64 ) continue;	// Ignore whitespace.
+			merge = (merge << 6) + value;
+			++inChunk;
 		}
 
+		rawData[0] = (XMP_Uns8) (merge >> 16);
+		rawData[1] = (XMP_Uns8) (merge >> 8);
+		rawData[2] = (XMP_Uns8) merge;
+		rawData += 3;
+
 	}
 
-	return estSize;
+	// The number of padding '=' characters determines if the final chunk has 1 or 2 raw bytes.
 
-}	
+	if ( padding == 0 ) return;
+
+	merge = 0;
+	for ( size_t inChunk = 0; inChunk < 4-padding; ++encodedStr ) {
+		XMP_Uns8 value = sBase64Values [ *encodedStr ];
+		if ( value >= 64 ) continue;	// Ignore whitespace.
+		merge = (merge << 6) + value;
+		++inChunk;
+	}
 
+	if ( padding == 2 ) {
+		rawData[0] = (XMP_Uns8) (merge >> 4);
+	} else {
+		rawData[0] = (XMP_Uns8) (merge >> 10);
+		rawData[1] = (XMP_Uns8) (merge >> 2);
+	}
+
+}	// DecodeBase64Data
 
 #if ENABLE_CPP_DOM_MODEL
 // -------------------------------------------------------------------------------------------------
@@ -1754,42 +2255,9 @@ static bool MoveOneProperty(XMPMeta2 & stdXMP, XMPMeta2 * extXMP,
 	#define Trace_PackageForJPEG 0
 #endif
 
-typedef std::pair < XMP_VarString*, XMP_VarString* > StringPtrPair;
 typedef std::pair < const char *, const char * > StringPtrPair2;
-typedef std::multimap < size_t, StringPtrPair > PropSizeMap;
 typedef std::multimap < size_t, StringPtrPair2 > PropSizeMap2;
 
-static void CreateEstimatedSizeMap ( XMPMeta & stdXMP, PropSizeMap * propSizes )
-{
-	#if Trace_PackageForJPEG
-		printf ( "  Creating top level property map:\n" );
-	#endif
-
-	for ( size_t s = stdXMP.tree.children.size(); s > 0; --s ) {
-
-		XMP_Node * stdSchema = stdXMP.tree.children[s-1];
-
-		for ( size_t p = stdSchema->children.size(); p > 0; --p ) {
-
-			XMP_Node * stdProp = stdSchema->children[p-1];
-			if ( (stdSchema->name == kXMP_NS_XMP_Note) &&
-				 (stdProp->name == "xmpNote:HasExtendedXMP") ) continue;	// ! Don't move xmpNote:HasExtendedXMP.
-
-			size_t propSize = EstimateSizeForJPEG ( stdProp );
-			StringPtrPair namePair ( &stdSchema->name, &stdProp->name );
-			PropSizeMap::value_type mapValue ( propSize, namePair );
-
-			(void) propSizes->insert ( propSizes->upper_bound ( propSize ), mapValue );
-			#if Trace_PackageForJPEG
-				printf ( "    %d bytes, %s in %s\n", propSize, stdProp->name.c_str(), stdSchema->name.c_str() );
-			#endif
-
-		}
-
-	}
-
-}	// CreateEstimatedSizeMap
-
 #if ENABLE_CPP_DOM_MODEL
 static void CreateEstimatedSizeMap(XMPMeta2 & stdXMP, PropSizeMap2 * propSizes)
 {
@@ -1855,41 +2323,141 @@ static size_t MoveLargestProperty(XMPMeta2 & stdXMP, XMPMeta2 * extXMP, PropSize
 }	// MoveLargestProperty
 #endif
 
+// -------------------------------------------------------------------------------------------------
+// FindTopLevelProperty
+// --------------------
+
+static XMP_Node * FindTopLevelProperty ( XMPMeta & xmpObj, XMP_StringPtr schemaURI, XMP_StringPtr propName )
+{
+	XMP_Node * schemaNode = FindSchemaNode ( &xmpObj.tree, schemaURI, kXMP_ExistingOnly, 0 );
+	if ( schemaNode == 0 ) return 0;
+	return FindChildNode ( schemaNode, propName, kXMP_ExistingOnly, 0 );
+
+}	// FindTopLevelProperty
+
+// -------------------------------------------------------------------------------------------------
+// MapExactSizes
+// -------------
+//
+// Attach the sizes from a compact serialization to the top level properties of an XMPMeta object
+// that has the same shape as the one serialized, e.g. a clone of it.
+
+typedef std::map < const XMP_Node *, size_t > ExactSizeMap;
+
+static void MapExactSizes ( const XMPMeta & xmpObj, const XMP_CompactRDFSizes & compactSizes, ExactSizeMap * propSizes )
+{
+	size_t sizeNum = 0;
+
+	propSizes->clear();
+	for ( size_t s = 0, sLim = xmpObj.tree.children.size(); s < sLim; ++s ) {
+		const XMP_Node * currSchema = xmpObj.tree.children[s];
+		for ( size_t p = 0, pLim = currSchema->children.size(); p < pLim; ++p, ++sizeNum ) {
+			XMP_Assert ( sizeNum < compactSizes.propSizes.size() );
+			(*propSizes)[currSchema->children[p]] = compactSizes.propSizes[sizeNum];
+		}
+	}
+	XMP_Assert ( sizeNum == compactSizes.propSizes.size() );
+
+}	// MapExactSizes
+
+// -------------------------------------------------------------------------------------------------
+// ChoosePropertiesToKeep
+// ----------------------
+//
+// Pick the top level properties that stay in the standard XMP: the subset whose sizes add up to
+// the most bytes without going over the capacity. This is a 0/1 knapsack where the value of each
+// property is its size, which makes it a subset sum. A bit set records the totals that can be
+// reached, with the first property that reached each total. Walking those back from the largest
+// reachable total gives one subset that adds up to it.
+
+static void ChoosePropertiesToKeep ( const std::vector<size_t> & propSizes, size_t capacity, std::vector<bool> * keepProp )
+{
+	const size_t kWordBits = 64;
+	const size_t wordCount = (capacity / kWordBits) + 1;
+	const size_t lastBits  = (capacity + 1) % kWordBits;
+	const XMP_Uns64 lastMask = (lastBits == 0) ? ~XMP_Uns64(0) : ((XMP_Uns64(1) << lastBits) - 1);
+
+	std::vector<XMP_Uns64> reachable ( wordCount, 0 );
+	std::vector<XMP_Int32> firstProp ( capacity + 1, -1 );
+	reachable[0] = 1;	// The empty subset.
+
+	for ( size_t prop = 0, propLim = propSizes.size(); prop < propLim; ++prop ) {
+
+		const size_t propSize = propSizes[prop];
+		if ( (propSize == 0) || (propSize > capacity) ) continue;
+		const size_t wordShift = propSize / kWordBits;
+		const size_t bitShift  = propSize % kWordBits;
+
+		// Add the property to every total reached so far, from the top down so that each total
+		// is shifted before it is updated.
+		for ( size_t word = wordCount; word > wordShift; ) {
+			--word;
+			const size_t from = word - wordShift;
+			XMP_Uns64 shifted = reachable[from] << bitShift;
+			if ( (bitShift != 0) && (from > 0) ) shifted |= reachable[from-1] >> (kWordBits - bitShift);
+			if ( word == (wordCount - 1) ) shifted &= lastMask;
+			XMP_Uns64 added = shifted & ~reachable[word];
+			if ( added == 0 ) continue;
+			reachable[word] |= added;
+			for ( size_t bit = word * kWordBits; added != 0; ++bit, added >>= 1 ) {
+				if ( added & 1 ) firstProp[bit] = static_cast<XMP_Int32> ( prop );
+			}
+		}
+
+	}
+
+	size_t total = capacity;
+	while ( (reachable[total / kWordBits] & (XMP_Uns64(1) << (total % kWordBits))) == 0 ) --total;
+
+	keepProp->assign ( propSizes.size(), false );
+	while ( total > 0 ) {
+		XMP_Int32 prop = firstProp[total];
+		XMP_Assert ( (prop >= 0) && (! (*keepProp)[prop]) );
+		(*keepProp)[prop] = true;
+		total -= propSizes[prop];
+	}
+
+}	// ChoosePropertiesToKeep
+
 // -------------------------------------------------------------------------------------------------
 // MoveLargestProperty
 // -------------------
 
-static size_t MoveLargestProperty ( XMPMeta & stdXMP, XMPMeta * extXMP, PropSizeMap & propSizes )
+static size_t MoveLargestProperty ( XMPMeta & stdXMP, XMPMeta * extXMP, const ExactSizeMap & propSizes )
 {
-	XMP_Assert ( ! propSizes.empty() );
+	const XMP_Node * largestProp = 0;
+	size_t largestSize = 0;
 
-	#if 0
-		// *** Xocde 2.3 on Mac OS X 10.4.7 seems to have a bug where this does not pick the last
-		// *** item in the map. We'll just avoid it on all platforms until thoroughly tested.
-		PropSizeMap::iterator lastPos = propSizes.end();
-		--lastPos;	// Move to the actual last item.
-	#else
-		PropSizeMap::iterator lastPos = propSizes.begin();
-		PropSizeMap::iterator nextPos = lastPos;
-		for ( ++nextPos; nextPos != propSizes.end(); ++nextPos ) lastPos = nextPos;
-	#endif
+	for ( size_t s = 0, sLim = stdXMP.tree.children.size(); s < sLim; ++s ) {
+		const XMP_Node * stdSchema = stdXMP.tree.children[s];
+		for ( size_t p = 0, pLim = stdSchema->children.size(); p < pLim; ++p ) {
+			const XMP_Node * stdProp = stdSchema->children[p];
+			if ( (stdSchema->name == kXMP_NS_XMP_Note) &&
+				 (stdProp->name == "xmpNote:HasExtendedXMP") ) continue;	// ! Don't move xmpNote:HasExtendedXMP.
+			ExactSizeMap::const_iterator sizePos = propSizes.find ( stdProp );
+			size_t propSize = (sizePos == propSizes.end()) ? 0 : sizePos->second;
+			if ( (largestProp == 0) || (propSize > largestSize) ) {
+				largestProp = stdProp;
+				largestSize = propSize;
+			}
+		}
+	}
 
-	size_t propSize = lastPos->first;
-	const char * schemaURI = lastPos->second.first->c_str();
-	const char * propName  = lastPos->second.second->c_str();
+	if ( largestProp == 0 ) return 0;
+
+	XMP_VarString schemaURI ( largestProp->parent->name );	// ! Copy, the schema node might get deleted.
+	XMP_VarString propName ( largestProp->name );
 
 	#if Trace_PackageForJPEG
-		printf ( "  Move %s, %d bytes\n", propName, propSize );
+		printf ( "  Move %s, %d bytes\n", propName.c_str(), largestSize );
 	#endif
 
-	bool moved = MoveOneProperty ( stdXMP, extXMP, schemaURI, propName );
+	bool moved = MoveOneProperty ( stdXMP, extXMP, schemaURI.c_str(), propName.c_str() );
 	XMP_Assert ( moved );
 
-	propSizes.erase ( lastPos );
-	return propSize;
+	return (largestSize > 0) ? largestSize : 1;
 
 }	// MoveLargestProperty
-
 // =================================================================================================
 // Class Static Functions
 // ======================
@@ -1906,6 +2474,8 @@ XMPUtils::Initialize()
 		WhiteSpaceStrPtr = new std::string();
 		WhiteSpaceStrPtr->append( " \t\n\r" );
 	}
+
+	InitializeBase64Tables();
 	return true;
 
 }	// Initialize
@@ -2148,13 +2718,16 @@ XMPUtils::ConvertFromInt ( XMP_Int32	   binValue,
 	XMP_Assert ( (format != 0) && (strValue != 0) );	// Enforced by wrapper.
 
 	strValue->erase();
-	if ( *format == 0 ) format = "%d";
 
 	// AUDIT: Using sizeof(buffer) for the snprintf length is safe.
 	char buffer [32];	// Big enough for a 64-bit integer;
-	snprintf ( buffer, sizeof(buffer), format, binValue );
 
-	*strValue = buffer;
+	if ( (*format == 0) || (strcmp ( format, "%d" ) == 0) ) {
+		strValue->assign ( buffer, FormatDecimal ( buffer, binValue, 1 ) );	// Skip the format parsing for the default.
+	} else {
+		snprintf ( buffer, sizeof(buffer), format, binValue );
+		*strValue = buffer;
+	}
 
 }	// ConvertFromInt
 
@@ -2170,13 +2743,16 @@ XMPUtils::ConvertFromInt64 ( XMP_Int64	     binValue,
 	XMP_Assert ( (format != 0) && (strValue != 0) );	// Enforced by wrapper.
 
 	strValue->erase();
-	if ( *format == 0 ) format = "%lld";
 
 	// AUDIT: Using sizeof(buffer) for the snprintf length is safe.
 	char buffer [32];	// Big enough for a 64-bit integer;
-	snprintf ( buffer, sizeof(buffer), format, binValue );
 
-	*strValue = buffer;
+	if ( (*format == 0) || (strcmp ( format, "%lld" ) == 0) ) {
+		strValue->assign ( buffer, FormatDecimal ( buffer, binValue, 1 ) );	// Skip the format parsing for the default.
+	} else {
+		snprintf ( buffer, sizeof(buffer), format, binValue );
+		*strValue = buffer;
+	}
 
 }	// ConvertFromInt64
 
@@ -2237,7 +2813,7 @@ XMPUtils::ConvertFromDate ( const XMP_DateTime & _inValue,
 	char buffer [100];	// Plenty long enough.
 	memset( buffer, 0, 100);
 
-	// Pick the format, use snprintf to format into a local buffer, assign to static output string.
+	// Pick the format, format into a local buffer, assign to static output string.
 	// Don't use AdjustTimeOverflow at the start, that will wipe out zero month or day values.
 
 	// ! Photoshop 8 creates "time only" values with zeros for year, month, and day.
@@ -2268,7 +2844,7 @@ XMPUtils::ConvertFromDate ( const XMP_DateTime & _inValue,
 		// Output YYYY if all else is zero, otherwise output a full string for the quasi-bogus
 		// "time only" values from Photoshop CS.
 		if ( (binValue.day == 0) && (! binValue.hasTime) ) {
-			snprintf ( buffer, sizeof(buffer), "%.4d", binValue.year ); // AUDIT: Using sizeof for snprintf length is safe.
+			FormatDecimal ( buffer, binValue.year, 4 );	// The buffer is zero filled, no need to terminate.
 		} else if ( (binValue.year == 0) && (binValue.day == 0) ) {
 			FormatFullDateTime ( binValue, buffer, sizeof(buffer) );
 		} else {
@@ -2280,14 +2856,20 @@ XMPUtils::ConvertFromDate ( const XMP_DateTime & _inValue,
 		// Output YYYY-MM.
 		if ( (binValue.month < 1) || (binValue.month > 12) ) XMP_Throw ( "Month is out of range", kXMPErr_BadParam);
 		if ( binValue.hasTime ) XMP_Throw ( "Invalid partial date, non-zeros after zero month and day", kXMPErr_BadParam);
-		snprintf ( buffer, sizeof(buffer), "%.4d-%02d", binValue.year, binValue.month );	// AUDIT: Using sizeof for snprintf length is safe.
+		char * outPtr = FormatDecimal ( buffer, binValue.year, 4 );
+		*outPtr++ = '-';
+		FormatDecimal ( outPtr, binValue.month, 2 );
 
 	} else if ( ! binValue.hasTime ) {
 
 		// Output YYYY-MM-DD.
 		if ( (binValue.month < 1) || (binValue.month > 12) ) XMP_Throw ( "Month is out of range", kXMPErr_BadParam);
 		if ( (binValue.day < 1) || (binValue.day > 31) ) XMP_Throw ( "Day is out of range", kXMPErr_BadParam);
-		snprintf ( buffer, sizeof(buffer), "%.4d-%02d-%02d", binValue.year, binValue.month, binValue.day ); // AUDIT: Using sizeof for snprintf length is safe.
+		char * outPtr = FormatDecimal ( buffer, binValue.year, 4 );
+		*outPtr++ = '-';
+		outPtr = FormatDecimal ( outPtr, binValue.month, 2 );
+		*outPtr++ = '-';
+		FormatDecimal ( outPtr, binValue.day, 2 );
 
 	} else {
 
@@ -2309,9 +2891,11 @@ XMPUtils::ConvertFromDate ( const XMP_DateTime & _inValue,
 		if ( binValue.tzSign == 0 ) {
 			*strValue += 'Z';
 		} else {
-			snprintf ( buffer, sizeof(buffer), "+%02d:%02d", binValue.tzHour, binValue.tzMinute );	// AUDIT: Using sizeof for snprintf length is safe.
-			if ( binValue.tzSign < 0 ) buffer[0] = '-';
-			*strValue += buffer;
+			buffer[0] = (binValue.tzSign < 0) ? '-' : '+';
+			FormatDecimal ( &buffer[1], binValue.tzHour, 2 );
+			buffer[3] = ':';
+			FormatDecimal ( &buffer[4], binValue.tzMinute, 2 );
+			strValue->append ( buffer, 6 );
 		}
 
 	}
@@ -2350,27 +2934,266 @@ XMPUtils::ConvertToBool ( XMP_StringPtr strValue )
 }	// ConvertToBool
 
 // -------------------------------------------------------------------------------------------------
-// ConvertToInt
+// IsCSpace
+// --------
+//
+// The whitespace characters of the "C" locale, independent of the current locale.
+
+static inline bool
+IsCSpace ( char ch )
+{
+	return (ch == ' ') || ((kTab <= ch) && (ch <= kCR));
+}
+
+// -------------------------------------------------------------------------------------------------
+// ParseInteger
 // ------------
+//
+// Parse a whole string as an integer. A string starting with "0x" is hex, anything else is decimal
+// with optional leading whitespace and sign. Nothing may follow the digits. Decimal values beyond
+// the 64-bit range are clamped to it, hex values beyond it become all ones.
 
-/* class static */ XMP_Int32
-XMPUtils::ConvertToInt ( XMP_StringPtr strValue )
+static bool
+ParseInteger ( XMP_StringPtr strValue, XMP_Int64 * result )
 {
-	if ( (strValue == 0) || (*strValue == 0) ) XMP_Throw ( "Empty convert-from string", kXMPErr_BadValue );
+	XMP_StringPtr numPtr = strValue;
+	XMP_Uns64 magnitude = 0;
+	bool overflow = false;
+
+	if ( XMP_LitNMatch ( numPtr, "0x", 2 ) ) {
+
+		numPtr += 2;
+
+		for ( ; ; ++numPtr ) {
+			XMP_Uns32 digit = XMP_Uns32 ( (XMP_Uns8)*numPtr ) - XMP_Uns32 ( '0' );
+			if ( digit > 9 ) {
+				digit = XMP_Uns32 ( (XMP_Uns8)*numPtr | 0x20 ) - XMP_Uns32 ( 'a' );	// Fold to lower case.
+				if ( digit > 5 ) break;
+				digit += 10;
+			}
+			if ( magnitude > (~XMP_Uns64(0) >> 4) ) overflow = true;
+			magnitude = (magnitude << 4) | digit;
+		}
+
+		if ( *numPtr != 0 ) return false;	// A bare "0x" is taken as zero.
+		*result = overflow ? XMP_Int64(-1) : XMP_Int64(magnitude);
+		return true;
+
+	}
+
+	while ( IsCSpace ( *numPtr ) ) ++numPtr;
 
-	int count;
-	char nextCh;
-	XMP_Int32 result;
+	bool negative = (*numPtr == '-');
+	if ( (*numPtr == '-') || (*numPtr == '+') ) ++numPtr;
+	XMP_StringPtr digitStart = numPtr;
 
-	if ( ! XMP_LitNMatch ( strValue, "0x", 2 ) ) {
-		count = sscanf ( strValue, "%d%c", &result, &nextCh );
+	const XMP_Uns64 kMaxMagnitude = XMP_Uns64(1) << 63;	// The magnitude of the most negative value.
+
+	for ( ; ; ++numPtr ) {
+		XMP_Uns32 digit = XMP_Uns32 ( (XMP_Uns8)*numPtr ) - XMP_Uns32 ( '0' );
+		if ( digit > 9 ) break;
+		if ( magnitude > ((kMaxMagnitude - digit) / 10) ) overflow = true;
+		if ( ! overflow ) magnitude = (magnitude * 10) + digit;
+	}
+
+	if ( (numPtr == digitStart) || (*numPtr != 0) ) return false;
+
+	if ( negative ) {
+		*result = overflow ? XMP_Int64(kMaxMagnitude) : XMP_Int64 ( XMP_Uns64(0) - magnitude );
 	} else {
-		count = sscanf ( strValue, "%x%c", &result, &nextCh );
+		*result = (overflow || (magnitude == kMaxMagnitude)) ? XMP_Int64 ( kMaxMagnitude - 1 ) : XMP_Int64(magnitude);
 	}
 
-	if ( count != 1 ) XMP_Throw ( "Invalid integer string", kXMPErr_BadParam );
+	return true;
 
-	return result;
+}	// ParseInteger
+
+// -------------------------------------------------------------------------------------------------
+// ParseSimpleFloat
+// ----------------
+//
+// Fast and locale independent parsing of the common floating point forms, with optional leading
+// whitespace, sign, fraction, and exponent. The result is exact when the digits fit in 53 bits and
+// the power of 10 is at most 22, one multiply or divide of two exact doubles is then correctly
+// rounded. Returns false, leaving the real work to strtod, for anything else.
+
+static bool
+ParseSimpleFloat ( XMP_StringPtr strValue, double * result )
+{
+	static const double kPowersOf10[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+										  1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+										  1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+	const XMP_Int32 kMaxPower = 22;
+	const size_t kMaxDigits = 19;	// Any 19 digits fit in 64 bits.
+
+	XMP_StringPtr numPtr = strValue;
+	while ( IsCSpace ( *numPtr ) ) ++numPtr;
+
+	bool negative = (*numPtr == '-');
+	if ( (*numPtr == '-') || (*numPtr == '+') ) ++numPtr;
+
+	XMP_Uns64 mantissa = 0;
+	size_t mantissaDigits = 0;
+	XMP_Int32 exponent = 0;
+	bool haveDigits = false;
+	bool inFraction = false;
+
+	for ( ; ; ++numPtr ) {
+		if ( (*numPtr == '.') && (! inFraction) ) {
+			inFraction = true;
+			continue;
+		}
+		XMP_Uns32 digit = XMP_Uns32 ( (XMP_Uns8)*numPtr ) - XMP_Uns32 ( '0' );
+		if ( digit > 9 ) break;
+		haveDigits = true;
+		if ( inFraction ) --exponent;
+		if ( (mantissa == 0) && (digit == 0) ) continue;	// Leading zeroes don't count.
+		if ( mantissaDigits == kMaxDigits ) return false;
+		mantissa = (mantissa * 10) + digit;
+		++mantissaDigits;
+	}
+
+	if ( ! haveDigits ) return false;
+
+	if ( (*numPtr == 'e') || (*numPtr == 'E') ) {
+		++numPtr;
+		bool negativeExp = (*numPtr == '-');
+		if ( (*numPtr == '-') || (*numPtr == '+') ) ++numPtr;
+		XMP_Int32 expValue;
+		if ( ! GatherDigits ( numPtr, 1, &expValue ) ) return false;
+		for ( ++numPtr; ; ++numPtr ) {
+			XMP_Uns32 digit = XMP_Uns32 ( (XMP_Uns8)*numPtr ) - XMP_Uns32 ( '0' );
+			if ( digit > 9 ) break;
+			if ( expValue > 1000 ) return false;	// Way out of the fast range.
+			expValue = (expValue * 10) + digit;
+		}
+		exponent += negativeExp ? -expValue : expValue;
+	}
+
+	if ( (*numPtr != 0) || (mantissa > (XMP_Uns64(1) << 53)) ) return false;
+	if ( (exponent < -kMaxPower) || (exponent > kMaxPower) ) {
+		if ( mantissa != 0 ) return false;
+		exponent = 0;	// Zero with any exponent is still zero.
+	}
+
+	double value = double ( mantissa );
+	if ( exponent < 0 ) {
+		value /= kPowersOf10[-exponent];
+	} else {
+		value *= kPowersOf10[exponent];
+	}
+
+	*result = negative ? -value : value;
+	return true;
+
+}	// ParseSimpleFloat
+
+// -------------------------------------------------------------------------------------------------
+// ParseFixedWidthDate
+// -------------------
+//
+// Fast path for ConvertToDate, handling the fixed width forms that XMP itself writes:
+//	YYYY
+//	YYYY-MM
+//	YYYY-MM-DD
+//	YYYY-MM-DDThh:mmTZD
+//	YYYY-MM-DDThh:mm:ssTZD
+//	YYYY-MM-DDThh:mm:ss.sTZD	(1 to 9 fraction digits)
+// The TZD is optional. Out of range values are fixed the same as in the general parsing. Returns
+// false, leaving binValue alone, for anything else.
+
+static bool
+ParseFixedWidthDate ( XMP_StringPtr strValue, size_t strSize, XMP_DateTime * binValue )
+{
+	XMP_DateTime date;
+	date = XMP_DateTime();
+
+	if ( (strSize < 4) || (! GatherDigits ( strValue, 4, &date.year )) ) return false;
+	date.hasDate = true;
+
+	if ( strSize > 4 ) {
+		if ( (strSize < 7) || (strValue[4] != '-') || (! GatherDigits ( &strValue[5], 2, &date.month )) ) return false;
+		if ( (date.year != 0) && (date.month < 1) ) date.month = 1;
+		if ( date.month > 12 ) date.month = 12;
+	}
+
+	if ( strSize > 7 ) {
+		if ( (strSize < 10) || (strValue[7] != '-') || (! GatherDigits ( &strValue[8], 2, &date.day )) ) return false;
+		if ( date.day > 31 ) date.day = 31;
+	}
+
+	if ( strSize > 10 ) {
+
+		if ( (strSize < 16) || (strValue[10] != 'T') || (strValue[13] != ':') ||
+			 (! GatherDigits ( &strValue[11], 2, &date.hour )) ||
+			 (! GatherDigits ( &strValue[14], 2, &date.minute )) ) return false;
+
+		if ( (date.year != 0) || (date.month != 0) || (date.day != 0) ) {
+			if ( date.month < 1 ) date.month = 1;
+			if ( date.day < 1 ) date.day = 1;
+		}
+		date.hasTime = true;
+		if ( date.hour > 23 ) date.hour = 23;
+		if ( date.minute > 59 ) date.minute = 59;
+
+		size_t pos = 16;
+
+		if ( strValue[pos] == ':' ) {
+			if ( (strSize < pos+3) || (! GatherDigits ( &strValue[pos+1], 2, &date.second )) ) return false;
+			if ( date.second > 59 ) date.second = 59;
+			pos += 3;
+			if ( strValue[pos] == '.' ) {
+				size_t fracStart = ++pos;
+				for ( ; (pos < strSize) && ('0' <= strValue[pos]) && (strValue[pos] <= '9'); ++pos ) {
+					if ( pos - fracStart == 9 ) return false;
+					date.nanoSecond = (date.nanoSecond * 10) + (strValue[pos] - '0');
+				}
+				if ( pos == fracStart ) return false;
+				for ( size_t digits = pos - fracStart; digits < 9; ++digits ) date.nanoSecond *= 10;
+			}
+		}
+
+		if ( pos < strSize ) {
+			date.hasTimeZone = true;
+			if ( strValue[pos] == 'Z' ) {
+				++pos;
+			} else {
+				if ( strValue[pos] == '+' ) {
+					date.tzSign = kXMP_TimeEastOfUTC;
+				} else if ( strValue[pos] == '-' ) {
+					date.tzSign = kXMP_TimeWestOfUTC;
+				} else {
+					return false;
+				}
+				if ( (strSize < pos+6) || (strValue[pos+3] != ':') ||
+					 (! GatherDigits ( &strValue[pos+1], 2, &date.tzHour )) ||
+					 (! GatherDigits ( &strValue[pos+4], 2, &date.tzMinute )) ||
+					 (date.tzHour > 23) || (date.tzMinute > 59) ) return false;
+				pos += 6;
+			}
+			if ( pos != strSize ) return false;
+		}
+
+	}
+
+	*binValue = date;
+	return true;
+
+}	// ParseFixedWidthDate
+
+// -------------------------------------------------------------------------------------------------
+// ConvertToInt
+// ------------
+
+/* class static */ XMP_Int32
+XMPUtils::ConvertToInt ( XMP_StringPtr strValue )
+{
+	if ( (strValue == 0) || (*strValue == 0) ) XMP_Throw ( "Empty convert-from string", kXMPErr_BadValue );
+
+	XMP_Int64 result;
+	if ( ! ParseInteger ( strValue, &result ) ) XMP_Throw ( "Invalid integer string", kXMPErr_BadParam );
+
+	return XMP_Int32 ( result );	// Out of range values are truncated.
 
 }	// ConvertToInt
 
@@ -2383,17 +3206,8 @@ XMPUtils::ConvertToInt64 ( XMP_StringPtr strValue )
 {
 	if ( (strValue == 0) || (*strValue == 0) ) XMP_Throw ( "Empty convert-from string", kXMPErr_BadValue );
 
-	int count;
-	char nextCh;
 	XMP_Int64 result;
-
-	if ( ! XMP_LitNMatch ( strValue, "0x", 2 ) ) {
-		count = sscanf ( strValue, "%lld%c", &result, &nextCh );
-	} else {
-		count = sscanf ( strValue, "%llx%c", &result, &nextCh );
-	}
-
-	if ( count != 1 ) XMP_Throw ( "Invalid integer string", kXMPErr_BadParam );
+	if ( ! ParseInteger ( strValue, &result ) ) XMP_Throw ( "Invalid integer string", kXMPErr_BadParam );
 
 	return result;
 
@@ -2408,6 +3222,9 @@ XMPUtils::ConvertToFloat ( XMP_StringPtr strValue )
 {
 	if ( (strValue == 0) || (*strValue == 0) ) XMP_Throw ( "Empty convert-from string", kXMPErr_BadValue );
 
+	double result;
+	if ( ParseSimpleFloat ( strValue, &result ) ) return result;	// Avoid the locale juggling when possible.
+
 	XMP_VarString oldLocale;	// Try to make sure number conversion uses '.' as the decimal point.
 	XMP_StringPtr oldLocalePtr = setlocale ( LC_ALL, 0 );
 	if ( oldLocalePtr != 0 ) {
@@ -2417,7 +3234,7 @@ XMPUtils::ConvertToFloat ( XMP_StringPtr strValue )
 
 	errno = 0;
 	char * numEnd;
-	double result = strtod ( strValue, &numEnd );
+	result = strtod ( strValue, &numEnd );
 	int errnoSave = errno;	// The setlocale call below might change errno.
 
 	if ( ! oldLocale.empty() ) setlocale ( LC_ALL, oldLocale.c_str() );	// ! Reset locale before possible throw!
@@ -2468,6 +3285,8 @@ XMPUtils::ConvertToDate ( XMP_StringPtr	 strValue,
 	(void) memset ( binValue, 0, sizeof(*binValue) );	// AUDIT: Safe, using sizeof destination.
 
 	size_t strSize = strlen ( strValue );
+	if ( ParseFixedWidthDate ( strValue, strSize, binValue ) ) return;	// The usual forms, with no surprises.
+
 	bool timeOnly = ( (strValue[0] == 'T') ||
 					  ((strSize >= 2) && (strValue[1] == ':')) ||
 					  ((strSize >= 3) && (strValue[2] == ':')) );
@@ -2627,39 +3446,60 @@ XMPUtils::EncodeToBase64 ( XMP_StringPtr   rawStr,
 	encodedStr->erase();
 	if ( rawLen == 0 ) return;
 
-	char	encChunk[4];
+	// ----------------------------------------------------------------------------------------
+	// Each 6 bits of input produces 8 bits of output, so 3 input bytes become 4 output bytes.
+	// The output size is known exactly, including the linefeeds between lines, so the string
+	// is sized once and written in place.
 
-	unsigned long	in, out;
-	unsigned char	c1, c2, c3;
-	unsigned long	merge;
+	const size_t remainder = rawLen % 3;
+	const size_t quadCount = (rawLen + 2) / 3;
+	const size_t lineCount = (quadCount + kBase64QuadsPerLine - 1) / kBase64QuadsPerLine;
 
-	const size_t	outputSize	= (rawLen / 3) * 4; // Approximate, might be  small.
+	encodedStr->resize ( quadCount*4 + (lineCount-1) );
 
-	encodedStr->reserve ( outputSize );
+	const XMP_Uns8 * rawPtr = (const XMP_Uns8*) rawStr;
+	#if Base64_HaveSSSE3
+		const XMP_Uns8 * rawEnd = rawPtr + rawLen;
+	#endif
+	char * outPtr = &(*encodedStr)[0];
+	XMP_Uns32 merge;
 
-	// ----------------------------------------------------------------------------------------
-	// Each 6 bits of input produces 8 bits of output, so 3 input bytes become 4 output bytes.
-	// Process the whole chunks of 3 bytes first, then deal with any remainder. Be careful with
-	// the loop comparison, size-2 could be negative!
+	// Process the whole chunks of 3 bytes first, a line at a time, then deal with any remainder.
+	// The vector code does what it can of a line, the rest of the chunks are split into two 12 bit
+	// halves that give 2 output characters each.
 
-	for ( in = 0, out = 0; (in+2) < rawLen; in += 3, out += 4 ) {
+	size_t wholeQuads = rawLen / 3;
+	size_t lineQuads  = kBase64QuadsPerLine;
 
-		c1	= rawStr[in];
-		c2	= rawStr[in+1];
-		c3	= rawStr[in+2];
+	while ( wholeQuads > 0 ) {
 
-		merge	= (c1 << 16) + (c2 << 8) + c3;
+		size_t runQuads = (wholeQuads < lineQuads) ? wholeQuads : lineQuads;
+		wholeQuads -= runQuads;
+		lineQuads  -= runQuads;
 
-		encChunk[0] = sBase64Chars [ merge >> 18 ];
-		encChunk[1] = sBase64Chars [ (merge >> 12) & 0x3F ];
-		encChunk[2] = sBase64Chars [ (merge >> 6) & 0x3F ];
-		encChunk[3] = sBase64Chars [ merge & 0x3F ];
+		size_t vectorQuads = 0;
+		#if Base64_HaveSSSE3
+			if ( sBase64Selection == kBase64UseSSSE3 ) {
+				vectorQuads = EncodeBase64SSSE3 ( rawPtr, (rawEnd - rawPtr), outPtr, runQuads );
+			}
+		#endif
+		#if Base64_HaveNEON
+			if ( sBase64Selection == kBase64UseNEON ) vectorQuads = EncodeBase64NEON ( rawPtr, outPtr, runQuads );
+		#endif
+		runQuads -= vectorQuads;
+		rawPtr += 3 * vectorQuads;
+		outPtr += 4 * vectorQuads;
+
+		for ( ; runQuads > 0; --runQuads, rawPtr += 3, outPtr += 4 ) {
+			merge = (rawPtr[0] << 16) | (rawPtr[1] << 8) | rawPtr[2];
+			memcpy ( outPtr,   &sBase64Pairs [ 2 * (merge >> 12) ], 2 );
+			memcpy ( outPtr+2, &sBase64Pairs [ 2 * (merge & 0xFFF) ], 2 );
+		}
 
-		if ( out >= 76 ) {
-			encodedStr->append ( 1, kLF );
-			out = 0;
+		if ( lineQuads == 0 ) {
+			if ( (wholeQuads > 0) || (remainder > 0) ) *outPtr++ = kLF;
+			lineQuads = kBase64QuadsPerLine;
 		}
-		encodedStr->append ( encChunk, 4 );
 
 	}
 
@@ -2668,41 +3508,24 @@ XMPUtils::EncodeToBase64 ( XMP_StringPtr   rawStr,
 	// we need to create another chunk. Zero pad with bits to a 6 bit multiple, then add one or
 	// two '=' characters to pad out to 4 bytes.
 
-	switch ( rawLen - in ) {
-
-		case 0:		// Done, no remainder.
-			break;
-
-		case 1:		// One input byte remains.
+	if ( remainder > 0 ) {
 
-			c1	= rawStr[in];
-			merge	= c1 << 16;
+		merge = rawPtr[0] << 16;
+		if ( remainder == 2 ) merge |= rawPtr[1] << 8;
 
-			encChunk[0] = sBase64Chars [ merge >> 18 ];
-			encChunk[1] = sBase64Chars [ (merge >> 12) & 0x3F ];
-			encChunk[2] = encChunk[3] = '=';
-
-			if ( out >= 76 ) encodedStr->append ( 1, kLF );
-			encodedStr->append ( encChunk, 4 );
-			break;
-
-		case 2:		// Two input bytes remain.
-
-			c1	= rawStr[in];
-			c2	= rawStr[in+1];
-			merge	= (c1 << 16) + (c2 << 8);
-
-			encChunk[0] = sBase64Chars [ merge >> 18 ];
-			encChunk[1] = sBase64Chars [ (merge >> 12) & 0x3F ];
-			encChunk[2] = sBase64Chars [ (merge >> 6) & 0x3F ];
-			encChunk[3] = '=';
-
-			if ( out >= 76 ) encodedStr->append ( 1, kLF );
-			encodedStr->append ( encChunk, 4 );
-			break;
+		memcpy ( outPtr, &sBase64Pairs [ 2 * (merge >> 12) ], 2 );
+		if ( remainder == 2 ) {
+			outPtr[2] = sBase64Chars [ (merge >> 6) & 0x3F ];
+		} else {
+			outPtr[2] = '=';
+		}
+		outPtr[3] = '=';
+		outPtr += 4;
 
 	}
 
+	XMP_Assert ( outPtr == (encodedStr->c_str() + encodedStr->size()) );
+
 }	// EncodeToBase64
 
 // -------------------------------------------------------------------------------------------------
@@ -2725,99 +3548,41 @@ XMPUtils::DecodeFromBase64 ( XMP_StringPtr	 encodedStr,
 	rawStr->erase();
 	if ( encodedLen == 0 ) return;
 
-	unsigned char	ch, rawChunk[3];
-	unsigned long	inStr, inChunk, inLimit, merge, padding;
+	// Check the input and get the exact output size first, then decode straight into the string.
 
-	XMP_StringLen	outputSize	= (encodedLen / 4) * 3; // Only a close approximation.
-
-	rawStr->reserve ( outputSize );
-
-
-	// ----------------------------------------------------------------------------------------
-	// Each 8 bits of input produces 6 bits of output, so 4 input bytes become 3 output bytes.
-	// Process all but the last 4 data bytes first, then deal with the final chunk. Whitespace
-	// in the input must be ignored. The first loop finds where the last 4 data bytes start and
-	// counts the number of padding equal signs.
-
-	padding = 0;
-	for ( inStr = 0, inLimit = encodedLen; (inStr < 4) && (inLimit > 0); ) {
-		inLimit -= 1;	// ! Don't do in the loop control, the decr/test order is wrong.
-		ch = encodedStr[inLimit];
-		if ( ch == '=' ) {
-			padding += 1;	// The equal sign padding is a data byte.
-		} else if ( DecodeBase64Char(ch) == 0xFF ) {
-			continue;	// Ignore whitespace, don't increment inStr.
-		} else {
-			inStr += 1;
-		}
-	}
-
-	// ! Be careful to count whitespace that is immediately before the final data. Otherwise
-	// ! middle portion will absorb the final data and mess up the final chunk processing.
-
-	while ( (inLimit > 0) && (DecodeBase64Char(encodedStr[inLimit-1]) == 0xFF) ) --inLimit;
-
-	if ( inStr == 0 ) return;	// Nothing but whitespace.
-	if ( padding > 2 ) XMP_Throw ( "Invalid encoded string", kXMPErr_BadParam );
-
-	// -------------------------------------------------------------------------------------------
-	// Now process all but the last chunk. The limit ensures that we have at least 4 data bytes
-	// left when entering the output loop, so the inner loop will succeed without overrunning the
-	// end of the data. At the end of the outer loop we might be past inLimit though.
-
-	inStr = 0;
-	while ( inStr < inLimit ) {
-
-		merge = 0;
-		for ( inChunk = 0; inChunk < 4; ++inStr ) { // ! Yes, increment inStr on each pass.
-			ch = DecodeBase64Char ( encodedStr [inStr] );
-			if ( ch == 0xFF ) continue; // Ignore whitespace.
-			merge = (merge << 6) + ch;
-			inChunk += 1;
-		}
-
-		rawChunk[0] = (unsigned char) (merge >> 16);
-		rawChunk[1] = (unsigned char) ((merge >> 8) & 0xFF);
-		rawChunk[2] = (unsigned char) (merge & 0xFF);
+	size_t padding;
+	size_t rawLen = CountBase64Data ( (const XMP_Uns8*)encodedStr, encodedLen, &padding );
+	if ( rawLen == 0 ) return;
 
-		rawStr->append ( (char*)rawChunk, 3 );
+	rawStr->resize ( rawLen );
+	DecodeBase64Data ( (const XMP_Uns8*)encodedStr, encodedLen, padding, (XMP_Uns8*)&(*rawStr)[0], rawLen );
 
-	}
+}	// DecodeFromBase64
 
-	// -------------------------------------------------------------------------------------------
-	// Process the final, possibly partial, chunk of data. The input is always a multiple 4 bytes,
-	// but the raw data can be any length. The number of padding '=' characters determines if the
-	// final chunk has 1, 2, or 3 raw data bytes.
+// -------------------------------------------------------------------------------------------------
+// DecodeFromBase64
+// ----------------
+//
+// Decode into a buffer provided by the caller, the decoded data is written only if it fits. Returns
+// the exact length of the decoded data in any case, passing a null buffer just gets the length.
+
+/* class static */ XMP_StringLen
+XMPUtils::DecodeFromBase64 ( XMP_StringPtr	encodedStr,
+							 XMP_StringLen	encodedLen,
+							 void *			rawBuffer,
+							 XMP_StringLen	bufferSize )
+{
+	if ( (encodedStr == 0) && (encodedLen != 0) ) XMP_Throw ( "Null encoded data buffer", kXMPErr_BadParam );
+	if ( encodedLen == 0 ) return 0;
 
-	XMP_Assert ( inStr < encodedLen );
+	size_t padding;
+	size_t rawLen = CountBase64Data ( (const XMP_Uns8*)encodedStr, encodedLen, &padding );
 
-	merge = 0;
-	for ( inChunk = 0; inChunk < 4-padding; ++inStr ) { // ! Yes, increment inStr on each pass.
-		ch = DecodeBase64Char ( encodedStr[inStr] );
-		if ( ch == 0xFF ) continue; // Ignore whitespace.
-		merge = (merge << 6) + ch;
-		inChunk += 1;
+	if ( (rawBuffer != 0) && (rawLen <= bufferSize) ) {
+		DecodeBase64Data ( (const XMP_Uns8*)encodedStr, encodedLen, padding, (XMP_Uns8*)rawBuffer, rawLen );
 	}
 
-	if ( padding == 2 ) {
-
-		rawChunk[0] = (unsigned char) (merge >> 4);
-		rawStr->append ( (char*)rawChunk, 1 );
-
-	} else if ( padding == 1 ) {
-
-		rawChunk[0] = (unsigned char) (merge >> 10);
-		rawChunk[1] = (unsigned char) ((merge >> 2) & 0xFF);
-		rawStr->append ( (char*)rawChunk, 2 );
-
-	} else {
-
-		rawChunk[0] = (unsigned char) (merge >> 16);
-		rawChunk[1] = (unsigned char) ((merge >> 8) & 0xFF);
-		rawChunk[2] = (unsigned char) (merge & 0xFF);
-		rawStr->append ( (char*)rawChunk, 3 );
-
-	}
+	return static_cast<XMP_StringLen> ( rawLen );
 
 }	// DecodeFromBase64
 
@@ -2848,135 +3613,163 @@ XMPUtils::PackageForJPEG ( const XMPMeta & origXMP,
 	XMP_VarString tempStr;
 	XMPMeta stdXMP, extXMP;
 	XMP_OptionBits keepItSmall = kXMP_UseCompactFormat | kXMP_OmitAllFormatting;
+	static const char * kDigestPlaceholder = "123456789-123456789-123456789-12";	// ! Same length as the digest.
 
 	stdStr->erase();
 	extStr->erase();
 	digestStr->erase();
 
-	// Try to serialize everything. Note that we're making internal calls to SerializeToBuffer, so
-	// we'll be getting back the pointer and length for its internal string.
+	// Try to serialize everything, keeping the exact size of every top level property. Those let
+	// the split between standard and extended XMP be worked out without serializing again. Note
+	// that we're making internal calls to SerializeToBuffer, so we'll be getting back the pointer
+	// and length for its internal string.
 
-	origXMP.SerializeToBuffer ( &tempStr, keepItSmall, 1, "", "", 0 );
+	XMP_CompactRDFSizes compactSizes;
+	origXMP.SerializeToBuffer ( &tempStr, keepItSmall, 1, "", "", 0, 0, &compactSizes );
 	#if Trace_PackageForJPEG
 		printf ( "\nXMPUtils::PackageForJPEG - Full serialize %d bytes\n", tempStr.size() );
 	#endif
 
 	if ( tempStr.size() > kStdXMPLimit ) {
 
-		// Couldn't fit everything, make a copy of the input XMP and make sure there is no xmp:Thumbnails property.
+		// Couldn't fit everything, make a copy of the input XMP. The property sizes are tracked for
+		// the copy, the standard XMP is serialized again only once it is known to fit. The size of
+		// everything else in the packet stays the same, except that the namespace declarations can
+		// only get smaller, so stdSize is an upper bound for what stdXMP would serialize to.
 
 		stdXMP.tree.options = origXMP.tree.options;
 		stdXMP.tree.name    = origXMP.tree.name;
 		stdXMP.tree.value   = origXMP.tree.value;
 		CloneOffspring ( &origXMP.tree, &stdXMP.tree );
 
-		if ( stdXMP.DoesPropertyExist ( kXMP_NS_XMP, "Thumbnails" ) ) {
-			stdXMP.DeleteProperty ( kXMP_NS_XMP, "Thumbnails" );
-			stdXMP.SerializeToBuffer ( &tempStr, keepItSmall, 1, "", "", 0 );
-			#if Trace_PackageForJPEG
-				printf ( "  Delete xmp:Thumbnails, %d bytes left\n", tempStr.size() );
-			#endif
-		}
-
-	}
-
-	if ( tempStr.size() > kStdXMPLimit ) {
-
-		// Still doesn't fit, move all of the Camera Raw namespace. Add a dummy value for xmpNote:HasExtendedXMP.
+		ExactSizeMap propSizes;
+		MapExactSizes ( stdXMP, compactSizes, &propSizes );
+		size_t stdSize = tempStr.size();
+		bool stdIsSerialized = true;	// True if tempStr is the serialization of stdXMP.
 
-		stdXMP.SetProperty ( kXMP_NS_XMP_Note, "HasExtendedXMP", "123456789-123456789-123456789-12", 0 );
+		// Make sure there is no xmp:Thumbnails property. Reserialize if that might be enough, which
+		// also gets exact sizes again.
 
-		XMP_NodePtrPos crSchemaPos;
-		XMP_Node * crSchema = FindSchemaNode ( &stdXMP.tree, kXMP_NS_CameraRaw, kXMP_ExistingOnly, &crSchemaPos );
+		XMP_Node * thumbsNode = FindTopLevelProperty ( stdXMP, kXMP_NS_XMP, "xmp:Thumbnails" );
 
-		if ( crSchema != 0 ) {
-			crSchema->parent = &extXMP.tree;
-			extXMP.tree.children.push_back ( crSchema );
-			stdXMP.tree.children.erase ( crSchemaPos );
-			stdXMP.SerializeToBuffer ( &tempStr, keepItSmall, 1, "", "", 0 );
+		if ( thumbsNode != 0 ) {
+			stdSize -= propSizes[thumbsNode];
+			stdXMP.DeleteProperty ( kXMP_NS_XMP, "Thumbnails" );
+			stdIsSerialized = false;
+			if ( (stdSize - compactSizes.nsDeclSize) <= kStdXMPLimit ) {
+				stdXMP.SerializeToBuffer ( &tempStr, keepItSmall, 1, "", "", 0, 0, &compactSizes );
+				MapExactSizes ( stdXMP, compactSizes, &propSizes );
+				stdSize = tempStr.size();
+				stdIsSerialized = true;
+			}
 			#if Trace_PackageForJPEG
-				printf ( "  Move Camera Raw schema, %d bytes left\n", tempStr.size() );
+				printf ( "  Delete xmp:Thumbnails, %d bytes left\n", stdSize );
 			#endif
 		}
 
-	}
+		if ( stdSize > kStdXMPLimit ) {
 
-	if ( tempStr.size() > kStdXMPLimit ) {
+			// Still doesn't fit, move all of the Camera Raw namespace. Add a dummy value for
+			// xmpNote:HasExtendedXMP, it gets written as an attribute of the rdf:Description.
 
-		// Still doesn't fit, move photoshop:History.
+			XMP_Node * noteNode = FindTopLevelProperty ( stdXMP, kXMP_NS_XMP_Note, "xmpNote:HasExtendedXMP" );
+			if ( noteNode != 0 ) stdSize -= propSizes[noteNode];
+			bool newNoteSchema = (FindSchemaNode ( &stdXMP.tree, kXMP_NS_XMP_Note, kXMP_ExistingOnly, 0 ) == 0);
 
-		bool moved = MoveOneProperty ( stdXMP, &extXMP, kXMP_NS_Photoshop, "photoshop:History" );
+			stdXMP.SetProperty ( kXMP_NS_XMP_Note, "HasExtendedXMP", kDigestPlaceholder, 0 );
+			stdSize += strlen ( " xmpNote:HasExtendedXMP=\"\"" ) + strlen ( kDigestPlaceholder );
+			if ( newNoteSchema ) stdSize += strlen ( " xmlns:xmpNote=\"\"" ) + strlen ( kXMP_NS_XMP_Note );
+			stdIsSerialized = false;
 
-		if ( moved ) {
-			stdXMP.SerializeToBuffer ( &tempStr, keepItSmall, 1, "", "", 0 );
-			#if Trace_PackageForJPEG
-				printf ( "  Move photoshop:History, %d bytes left\n", tempStr.size() );
-			#endif
-		}
+			XMP_NodePtrPos crSchemaPos;
+			XMP_Node * crSchema = FindSchemaNode ( &stdXMP.tree, kXMP_NS_CameraRaw, kXMP_ExistingOnly, &crSchemaPos );
 
-	}
+			if ( crSchema != 0 ) {
+				for ( size_t p = 0, pLim = crSchema->children.size(); p < pLim; ++p ) stdSize -= propSizes[crSchema->children[p]];
+				crSchema->parent = &extXMP.tree;
+				extXMP.tree.children.push_back ( crSchema );
+				stdXMP.tree.children.erase ( crSchemaPos );
+				#if Trace_PackageForJPEG
+					printf ( "  Move Camera Raw schema, %d bytes left\n", stdSize );
+				#endif
+			}
 
-	if ( tempStr.size() > kStdXMPLimit ) {
+		}
 
-		// Still doesn't fit, move top level properties in order of estimated size. This is done by
-		// creating a multi-map that maps the serialized size to the string pair for the schema URI
-		// and top level property name. Since maps are inherently ordered, a reverse iteration of
-		// the map can be done to move the largest things first. We use a double loop to keep going
-		// until the serialization actually fits, in case the estimates are off.
+		if ( stdSize > kStdXMPLimit ) {
 
-		PropSizeMap propSizes;
-		CreateEstimatedSizeMap ( stdXMP, &propSizes );
+			// Still doesn't fit, move photoshop:History.
 
-		#if Trace_PackageForJPEG
-		if ( ! propSizes.empty() ) {
-			printf ( "  Top level property map, smallest to largest:\n" );
-			PropSizeMap::iterator mapPos = propSizes.begin();
-			PropSizeMap::iterator mapEnd = propSizes.end();
-			for ( ; mapPos != mapEnd; ++mapPos ) {
-				size_t propSize = mapPos->first;
-				const char * schemaName = mapPos->second.first->c_str();
-				const char * propName   = mapPos->second.second->c_str();
-				printf ( "    %d bytes, %s in %s\n", propSize, propName, schemaName );
-			}
-		}
-		#endif
+			XMP_Node * historyNode = FindTopLevelProperty ( stdXMP, kXMP_NS_Photoshop, "photoshop:History" );
 
-		#if 0	// Trace_PackageForJPEG		*** Xcode 2.3 on 10.4.7 has bugs in backwards iteration
-		if ( ! propSizes.empty() ) {
-			printf ( "  Top level property map, largest to smallest:\n" );
-			PropSizeMap::iterator mapPos   = propSizes.end();
-			PropSizeMap::iterator mapBegin = propSizes.begin();
-			for ( --mapPos; true; --mapPos ) {
-				size_t propSize = mapPos->first;
-				const char * schemaName = mapPos->second.first->c_str();
-				const char * propName   = mapPos->second.second->c_str();
-				printf ( "    %d bytes, %s in %s\n", propSize, propName, schemaName );
-				if ( mapPos == mapBegin ) break;
+			if ( historyNode != 0 ) {
+				stdSize -= propSizes[historyNode];
+				bool moved = MoveOneProperty ( stdXMP, &extXMP, kXMP_NS_Photoshop, "photoshop:History" );
+				XMP_Enforce ( moved );
+				#if Trace_PackageForJPEG
+					printf ( "  Move photoshop:History, %d bytes left\n", stdSize );
+				#endif
 			}
-		}
-		#endif
-
-		// Outer loop to make sure enough is actually moved.
 
-		while ( (tempStr.size() > kStdXMPLimit) && (! propSizes.empty()) ) {
+		}
 
-			// Inner loop, move what seems to be enough according to the estimates.
+		if ( stdSize > kStdXMPLimit ) {
+
+			// Still doesn't fit, pick the top level properties to keep so that as much as possible
+			// stays in the standard XMP, and move the rest.
+
+			std::vector<const XMP_Node *> candidates;
+			std::vector<size_t> candidateSizes;
+			size_t candidatesSize = 0;
+
+			for ( size_t s = 0, sLim = stdXMP.tree.children.size(); s < sLim; ++s ) {
+				const XMP_Node * stdSchema = stdXMP.tree.children[s];
+				for ( size_t p = 0, pLim = stdSchema->children.size(); p < pLim; ++p ) {
+					const XMP_Node * stdProp = stdSchema->children[p];
+					if ( (stdSchema->name == kXMP_NS_XMP_Note) &&
+						 (stdProp->name == "xmpNote:HasExtendedXMP") ) continue;	// ! Don't move xmpNote:HasExtendedXMP.
+					size_t propSize = propSizes[stdProp];
+					candidates.push_back ( stdProp );
+					candidateSizes.push_back ( propSize );
+					candidatesSize += propSize;
+				}
+			}
 
-			size_t tempLen = tempStr.size();
-			while ( (tempLen > kStdXMPLimit) && (! propSizes.empty()) ) {
+			size_t fixedSize = stdSize - candidatesSize;
+			size_t capacity = (fixedSize < kStdXMPLimit) ? (kStdXMPLimit - fixedSize) : 0;
 
-				size_t propSize = MoveLargestProperty ( stdXMP, &extXMP, propSizes );
-				XMP_Assert ( propSize > 0 );
+			std::vector<bool> keepProp;
+			ChoosePropertiesToKeep ( candidateSizes, capacity, &keepProp );
 
-				if ( propSize > tempLen ) propSize = tempLen;	// ! Don't go negative.
-				tempLen -= propSize;
+			std::vector < std::pair < XMP_VarString, XMP_VarString > > movedProps;
+			for ( size_t i = 0, iLim = candidates.size(); i < iLim; ++i ) {
+				if ( keepProp[i] ) continue;
+				movedProps.push_back ( std::make_pair ( candidates[i]->parent->name, candidates[i]->name ) );
+				stdSize -= candidateSizes[i];
+				#if Trace_PackageForJPEG
+					printf ( "  Move %s, %d bytes\n", candidates[i]->name.c_str(), candidateSizes[i] );
+				#endif
+			}
 
+			for ( size_t i = 0, iLim = movedProps.size(); i < iLim; ++i ) {
+				bool moved = MoveOneProperty ( stdXMP, &extXMP, movedProps[i].first.c_str(), movedProps[i].second.c_str() );
+				XMP_Enforce ( moved );
 			}
+			if ( ! movedProps.empty() ) stdIsSerialized = false;
 
-			// Reserialize the remaining standard XMP.
+		}
+
+		if ( ! stdIsSerialized ) {
+			stdXMP.SerializeToBuffer ( &tempStr, keepItSmall, 1, "", "", 0, 0, &compactSizes );
+			MapExactSizes ( stdXMP, compactSizes, &propSizes );
+		}
 
-			stdXMP.SerializeToBuffer ( &tempStr, keepItSmall, 1, "", "", 0 );
+		// The sizes are exact, this loop is only a safety net in case they are not.
 
+		while ( tempStr.size() > kStdXMPLimit ) {
+			if ( MoveLargestProperty ( stdXMP, &extXMP, propSizes ) == 0 ) break;
+			stdXMP.SerializeToBuffer ( &tempStr, keepItSmall, 1, "", "", 0, 0, &compactSizes );
+			MapExactSizes ( stdXMP, compactSizes, &propSizes );
 		}
 
 	}
@@ -2992,20 +3785,20 @@ XMPUtils::PackageForJPEG ( const XMPMeta & origXMP,
 	if ( extXMP.tree.children.empty() ) {
 
 		// Just have the standard XMP.
-		*stdStr = tempStr;
+		stdStr->swap ( tempStr );
 
 	} else {
 
-		// Have extended XMP. Serialize it, compute the digest, reset xmpNote:HasExtendedXMP, and
-		// reserialize the standard XMP.
+		// Have extended XMP. Serialize it and compute the digest. The standard XMP has the dummy
+		// xmpNote:HasExtendedXMP value of the same length, overwrite it instead of reserializing.
 
-		extXMP.SerializeToBuffer ( &tempStr, (keepItSmall | kXMP_OmitPacketWrapper), 0, "", "", 0 );
-		*extStr = tempStr;
+		stdStr->swap ( tempStr );
+		extXMP.SerializeToBuffer ( extStr, (keepItSmall | kXMP_OmitPacketWrapper), 0, "", "", 0 );
 
 		MD5_CTX  context;
 		XMP_Uns8 digest [16];
 		MD5Init ( &context );
-		MD5Update ( &context, (XMP_Uns8*)tempStr.c_str(), (XMP_Uns32)tempStr.size() );
+		MD5Update ( &context, (XMP_Uns8*)extStr->c_str(), (XMP_Uns32)extStr->size() );
 		MD5Final ( digest, &context );
 
 		digestStr->reserve ( 32 );
@@ -3015,9 +3808,16 @@ XMPUtils::PackageForJPEG ( const XMPMeta & origXMP,
 			digestStr->push_back ( kHexDigits [ byte&0xF ] );
 		}
 
-		stdXMP.SetProperty ( kXMP_NS_XMP_Note, "HasExtendedXMP", digestStr->c_str(), 0 );
-		stdXMP.SerializeToBuffer ( &tempStr, keepItSmall, 1, "", "", 0 );
-		*stdStr = tempStr;
+		XMP_VarString dummyAttr ( "xmpNote:HasExtendedXMP=\"" );
+		dummyAttr += kDigestPlaceholder;
+		size_t dummyPos = stdStr->find ( dummyAttr );
+
+		if ( dummyPos != XMP_VarString::npos ) {
+			stdStr->replace ( dummyPos + dummyAttr.size() - digestStr->size(), digestStr->size(), *digestStr );
+		} else {
+			stdXMP.SetProperty ( kXMP_NS_XMP_Note, "HasExtendedXMP", digestStr->c_str(), 0 );
+			stdXMP.SerializeToBuffer ( stdStr, keepItSmall, 1, "", "", 0 );
+		}
 
 	}
 
@@ -181,6 +181,12 @@ public:
 		XMP_StringLen   encodedLen,
 		XMP_VarString * rawStr);
 
+	static XMP_StringLen
+		DecodeFromBase64(XMP_StringPtr   encodedStr,
+		XMP_StringLen   encodedLen,
+		void *          rawBuffer,
+		XMP_StringLen   bufferSize);
+
 	// ---------------------------------------------------------------------------------------------
 
 	static void
@@ -234,6 +240,23 @@ public:
 		XMP_StringPtr  propName,
 		XMP_OptionBits options);
 
+	// The batch forms lock each target themselves, the caller locks the template.
+
+	static void
+		BatchApplyTemplate(XMPMeta * const * workingXMPs,
+		size_t          count,
+		const XMPMeta & templateXMP,
+		XMP_OptionBits  actions,
+		XMP_Index       threadCount);
+
+	static void
+		BatchRemoveProperties(XMPMeta * const * xmpObjs,
+		size_t          count,
+		XMP_StringPtr   schemaNS,
+		XMP_StringPtr   propName,
+		XMP_OptionBits  options,
+		XMP_Index       threadCount);
+
 
 	static void
 		DuplicateSubtree(const XMPMeta & source,
@@ -244,6 +267,18 @@ public:
 		XMP_StringPtr   destRoot,
 		XMP_OptionBits  options);
 
+	static void
+		DiffProperties(const XMPMeta & oldXMP,
+		const XMPMeta & newXMP,
+		XMP_OptionBits  options,
+		XMP_VarString * diffStr);
+
+	static void
+		ApplyDiff(XMPMeta *       xmpObj,
+		XMP_StringPtr   diffStr,
+		XMP_StringLen   diffLen,
+		XMP_OptionBits  options);
+
 
 	// ---------------------------------------------------------------------------------------------
 
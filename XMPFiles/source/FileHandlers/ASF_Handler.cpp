@@ -18,6 +18,8 @@
 
 #include "XMPFiles/source/FileHandlers/ASF_Handler.hpp"
 
+#include "XMPFiles/source/FormatSupport/PaddingReserve.hpp"
+
 // =================================================================================================
 /// \file ASF_Handler.hpp
 /// \brief File format handler for ASF.
@@ -157,6 +159,184 @@ void ASF_MetaHandler::ProcessXMP()
 
 }	// ASF_MetaHandler::ProcessXMP
 
+// =================================================================================================
+// kASF_PaddingPolicy
+// ==================
+//
+// The padding left in a header or XMP object that has to grow, so that later edits fit in place. A
+// reserve in the header must hold a padding object. Define the macros to change the limits, setting
+// the maximum to 0 turns the reserve off.
+
+#ifndef ASF_MinPaddingReserve
+	#define ASF_MinPaddingReserve (8*1024)
+#endif
+
+#ifndef ASF_MaxPaddingReserve
+	#define ASF_MaxPaddingReserve (256*1024)
+#endif
+
+#ifndef ASF_PaddingReservePercent
+	#define ASF_PaddingReservePercent 5
+#endif
+
+static const PaddingPolicy kASF_PaddingPolicy = { ASF_MinPaddingReserve, ASF_MaxPaddingReserve,
+												   ASF_PaddingReservePercent, kASF_ObjectBaseLen, 0 };
+
+// =================================================================================================
+// ASF_MetaHandler::UpdateInPlace
+// ==============================
+//
+// Grow the header and XMP objects within the live file, instead of copying it. The top level objects
+// keep their order and are shifted as needed, the XMP object is placed right after the data object
+// as in WriteTempFile. ASF has no absolute file offsets except for the file size, index entries are
+// relative to the data object. A grown object gets a padding reserve for later edits. Returns false
+// without touching the file if the layout is unexpected, the caller then does a safe update.
+
+bool ASF_MetaHandler::UpdateInPlace ( ASF_Support & support, ASF_Support::ObjectState & objectState )
+{
+	XMP_IO* fileRef = this->parent->ioRef;
+	XMP_AbortProc abortProc = this->parent->abortProc;
+	void * abortArg = this->parent->abortArg;
+	XMP_ProgressTracker* progressTracker = this->parent->progressTracker;
+
+	const ASF_Support::ObjectVector & objects = objectState.objects;
+	const size_t objectCount = objects.size();
+
+	if ( (objectCount == 0) || (! IsEqualGUID ( ASF_Header_Object, objects[0].guid )) ) return false;
+
+	// Check for one data object and contiguous objects that cover the whole file.
+
+	size_t dataIndex = objectCount;
+	XMP_Uns64 nextPos = 0;
+
+	for ( size_t i = 0; i < objectCount; ++i ) {
+		if ( (objects[i].pos != nextPos) || (objects[i].len < kASF_ObjectBaseLen) ) return false;
+		nextPos += objects[i].len;
+		if ( IsEqualGUID ( ASF_Data_Object, objects[i].guid ) ) {
+			if ( dataIndex != objectCount ) return false;
+			dataIndex = i;
+		}
+	}
+
+	XMP_Uns64 oldFileLength = fileRef->Length();
+	if ( (dataIndex == objectCount) || (nextPos != oldFileLength) ) return false;
+
+	// Compose the new header, filling the old space or growing by a padding reserve. A remainder
+	// too small for a padding object also means growing.
+
+	const ASF_Support::ObjectData & headerObject = objects[0];
+	bool newHeaderObject = this->legacyManager.hasLegacyChanged();
+	std::string header;
+
+	if ( newHeaderObject ) {
+		if ( ! support.ComposeHeaderObject ( fileRef, headerObject, this->legacyManager, true, 0, &header ) ) return false;
+		XMP_Uns64 minLength = headerObject.len;
+		if ( (header.size() != minLength) && ((header.size() + kASF_ObjectBaseLen) > minLength) ) {
+			minLength = header.size() + PaddingReserve ( kASF_PaddingPolicy, header.size() );
+		}
+		if ( header.size() != minLength ) {
+			if ( ! support.ComposeHeaderObject ( fileRef, headerObject, this->legacyManager, true, minLength, &header ) ) return false;
+		}
+		if ( header.size() != minLength ) return false;	// Sanity check, should not happen.
+	}
+
+	// Serialize the XMP to fill the old object, else with a padding reserve.
+
+	XMP_Uns64 oldPacketLen = objectState.xmpLen;
+	if ( this->xmpPacket.size() != oldPacketLen ) {
+		bool packetFits = false;
+		if ( this->xmpPacket.size() < oldPacketLen ) {
+			try {
+				XMP_OptionBits compactExact = (kXMP_UseCompactFormat | kXMP_ExactPacketLength);
+				this->xmpObj.SerializeToBuffer ( &this->xmpPacket, compactExact, XMP_StringLen(oldPacketLen) );
+				packetFits = true;
+			} catch ( ... ) {
+				// Fall through and grow the XMP object.
+			}
+		}
+		if ( ! packetFits ) {
+			XMP_StringLen padding = (XMP_StringLen) PaddingReserve ( kASF_PaddingPolicy, this->xmpPacket.size() );
+			this->xmpObj.SerializeToBuffer ( &this->xmpPacket, kXMP_UseCompactFormat, padding );
+		}
+	}
+
+	XMP_StringPtr packetStr = this->xmpPacket.c_str();
+	XMP_StringLen packetLen = (XMP_StringLen)this->xmpPacket.size();
+
+	// Lay out the new file. The new header and XMP objects are written from memory, the others
+	// are moved if their offset changes.
+
+	struct ObjectMove { XMP_Uns64 oldPos, newPos, len; };
+	std::vector<ObjectMove> moves;
+
+	XMP_Uns64 newPos = 0;
+	XMP_Uns64 xmpObjectPos = 0;
+	float totalWork = 0;
+
+	for ( size_t i = 0; i < objectCount; ++i ) {
+
+		const ASF_Support::ObjectData & object = objects[i];
+		if ( object.xmp ) continue;
+
+		if ( (i == 0) && newHeaderObject ) {
+			newPos += header.size();
+			totalWork += (float)header.size();
+		} else {
+			if ( object.pos != newPos ) {
+				ObjectMove move = { object.pos, newPos, object.len };
+				moves.push_back ( move );
+				totalWork += (float)object.len;
+			}
+			newPos += object.len;
+		}
+
+		if ( i == dataIndex ) {
+			xmpObjectPos = newPos;
+			newPos += kASF_ObjectBaseLen + packetLen;
+			totalWork += (float)(kASF_ObjectBaseLen + packetLen);
+		}
+
+	}
+
+	XMP_Uns64 newFileLength = newPos;
+
+	if ( progressTracker != 0 ) progressTracker->BeginWork ( totalWork );
+
+	// Move up from the end, then move down from the start. Neither pass overwrites anything that is
+	// still to be moved, the objects keep their order. An abort is only honored before the first
+	// move, the moves are not abortable as an interrupted one would leave the file damaged.
+
+	if ( (abortProc != 0) && abortProc ( abortArg ) ) {
+		XMP_Throw ( "ASF_MetaHandler::UpdateInPlace - User abort", kXMPErr_UserAbort );
+	}
+
+	for ( size_t i = moves.size(); i > 0; --i ) {
+		const ObjectMove & move = moves[i-1];
+		if ( move.newPos > move.oldPos ) XIO::Move ( fileRef, move.oldPos, fileRef, move.newPos, move.len, 0, 0 );
+	}
+
+	for ( size_t i = 0; i < moves.size(); ++i ) {
+		const ObjectMove & move = moves[i];
+		if ( move.newPos < move.oldPos ) XIO::Move ( fileRef, move.oldPos, fileRef, move.newPos, move.len, 0, 0 );
+	}
+
+	if ( newHeaderObject ) {
+		fileRef->Seek ( 0, kXMP_SeekFromStart );
+		fileRef->Write ( header.c_str(), (XMP_Uns32)header.size() );
+	}
+
+	fileRef->Seek ( xmpObjectPos, kXMP_SeekFromStart );
+	if ( ! ASF_Support::WriteXMPObject ( fileRef, packetLen, packetStr ) ) XMP_Throw ( "Failure writing ASF XMP object", kXMPErr_InternalFailure );
+
+	if ( newFileLength < oldFileLength ) fileRef->Truncate ( newFileLength );
+	if ( ! support.UpdateFileSize ( fileRef ) ) XMP_Throw ( "Failure updating ASF file size", kXMPErr_InternalFailure );
+
+	if ( progressTracker != 0 ) progressTracker->WorkComplete();
+
+	return true;
+
+}	// ASF_MetaHandler::UpdateInPlace
+
 // =================================================================================================
 // ASF_MetaHandler::UpdateFile
 // ============================
@@ -216,7 +396,7 @@ void ASF_MetaHandler::UpdateFile ( bool doSafeUpdate )
 	bool legacyGrows = ( this->legacyManager.hasLegacyChanged() &&
 						 (this->legacyManager.getLegacyDiff() > (this->legacyManager.GetPadding() - paddingTolerance)) );
 
-	if ( doSafeUpdate || legacyGrows || xmpGrows ) {
+	if ( doSafeUpdate ) {
 
 		// do a safe update in any case
 		updated = SafeWriteFile();
@@ -225,9 +405,11 @@ void ASF_MetaHandler::UpdateFile ( bool doSafeUpdate )
 
 		// possibly we can do an in-place update
 
-		if ( objectState.xmpLen < packetLen ) {
+		if ( legacyGrows || xmpGrows || (objectState.xmpLen < packetLen) ) {
 
-			updated = SafeWriteFile();
+			// the header or XMP object has to grow, shift the following objects within the file
+			updated = this->UpdateInPlace ( support, objectState );
+			if ( ! updated ) updated = SafeWriteFile();
 
 		} else {
 			
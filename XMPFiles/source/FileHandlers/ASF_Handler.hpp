@@ -56,6 +56,8 @@ public:
 
 private:
 
+	bool UpdateInPlace ( ASF_Support & support, ASF_Support::ObjectState & objectState );
+
 	ASF_LegacyManager legacyManager;
 
 };	// ASF_MetaHandler
@@ -337,9 +337,10 @@ void JPEG_MetaHandler::CacheFileData()
 				 CheckBytes ( &buffer[0], kPSIRSignatureString, kPSIRSignatureLength ) ) {
 
 				size_t psirLen = contentLen - kPSIRSignatureLength;
+				size_t psirOffset = this->psirContents.size();
+				this->psirContents.resize ( psirOffset + psirLen );	// Read straight into the cached contents.
 				fileRef->Seek ( (contentOrigin + kPSIRSignatureLength), kXMP_SeekFromStart );
-				fileRef->ReadAll ( buffer, (XMP_Int32)psirLen );
-				this->psirContents.append( (char *) buffer, psirLen );
+				fileRef->ReadAll ( &this->psirContents[psirOffset], (XMP_Int32)psirLen );
 				continue;	// Move on to the next marker.
 
 			}
@@ -358,9 +359,10 @@ void JPEG_MetaHandler::CacheFileData()
 				  CheckBytes ( &buffer[0], kExifSignatureAltStr, kExifSignatureLength )) ) {
 
 				size_t exifLen = contentLen - kExifSignatureLength;
+				size_t exifOffset = this->exifContents.size();
+				this->exifContents.resize ( exifOffset + exifLen );	// Read straight into the cached contents.
 				fileRef->Seek ( (contentOrigin + kExifSignatureLength), kXMP_SeekFromStart );
-				fileRef->ReadAll ( buffer, (XMP_Int32)exifLen );
-				this->exifContents.append ( (char*)buffer, exifLen );
+				fileRef->ReadAll ( &this->exifContents[exifOffset], (XMP_Int32)exifLen );
 				continue;	// Move on to the next marker.
 
 			}
@@ -371,8 +373,8 @@ void JPEG_MetaHandler::CacheFileData()
 				this->containsXMP = true;	// Found the standard XMP packet.
 				size_t xmpLen = contentLen - kMainXMPSignatureLength;
 				fileRef->Seek ( (contentOrigin + kMainXMPSignatureLength), kXMP_SeekFromStart );
-				fileRef->ReadAll ( buffer, (XMP_Int32)xmpLen );
-				this->xmpPacket.assign ( (char*)buffer, xmpLen );
+				this->xmpPacket.resize ( xmpLen );
+				fileRef->ReadAll ( &this->xmpPacket[0], (XMP_Int32)xmpLen );
 				this->packetInfo.offset = contentOrigin + kMainXMPSignatureLength;
 				this->packetInfo.length = (XMP_Int32)xmpLen;
 				this->packetInfo.padSize   = 0;	// Assume the rest for now, set later in ProcessXMP.
@@ -565,14 +567,18 @@ void JPEG_MetaHandler::ProcessXMP()
 	PSIR_Manager & psir = *this->psirMgr;
 	IPTC_Manager & iptc = *this->iptcMgr;
 
+	// The Exif and PSIR managers borrow the cached segment contents instead of copying them. The
+	// strings live as long as the managers and are not used otherwise once parsed. A TIFF_MemoryReader
+	// tweaks the IFD entries in place, the writers copy the stream when it is updated.
+
 	bool haveExif = (! this->exifContents.empty());
 	if ( haveExif ) {
-		exif.ParseMemoryStream ( this->exifContents.c_str(), (XMP_Uns32)this->exifContents.size() );
+		exif.ParseMemoryStream ( &this->exifContents[0], (XMP_Uns32)this->exifContents.size(), false /* don't copy */ );
 	}
 
 	bool havePSIR = (! this->psirContents.empty());
 	if ( havePSIR ) {
-		psir.ParseMemoryResources ( this->psirContents.c_str(), (XMP_Uns32)this->psirContents.size() );
+		psir.ParseMemoryResources ( &this->psirContents[0], (XMP_Uns32)this->psirContents.size(), false /* don't copy */ );
 	}
 
 	PSIR_Manager::ImgRsrcInfo iptcInfo;
@@ -682,12 +688,16 @@ void JPEG_MetaHandler::UpdateFile ( bool doSafeUpdate )
 
 	ExportPhotoData ( kXMP_JPEGFile, &this->xmpObj, this->exifMgr, this->iptcMgr, this->psirMgr );
 
-	try {
-		XMP_OptionBits options = kXMP_UseCompactFormat;
-		if ( fileHadXMP ) options |= kXMP_ExactPacketLength;
-		this->xmpObj.SerializeToBuffer ( &this->xmpPacket, options, oldPacketLength );
-	} catch ( ... ) {
+	// Serialize to the old packet length if the new packet fits, else with normal padding. Either
+	// way the XMP is only serialized once.
+
+	if ( ! fileHadXMP ) {
 		this->xmpObj.SerializeToBuffer ( &this->xmpPacket, kXMP_UseCompactFormat );
+	} else {
+		std::string overflowPacket;
+		this->xmpPacket.assign ( oldPacketLength, ' ' );
+		bool packetFits = this->xmpObj.SerializeToRegion ( &this->xmpPacket[0], (XMP_StringLen)oldPacketLength, &overflowPacket, kXMP_UseCompactFormat );
+		if ( ! packetFits ) this->xmpPacket.swap ( overflowPacket );
 	}
 
 	// Decide whether to do an in-place update. This can only happen if all of the following are true:
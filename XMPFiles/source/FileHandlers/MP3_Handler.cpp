@@ -14,6 +14,7 @@
 
 #include "XMPFiles/source/XMPFiles_Impl.hpp"
 #include "XMPFiles/source/FormatSupport/Reconcile_Impl.hpp"
+#include "XMPFiles/source/FormatSupport/PaddingReserve.hpp"
 #include "source/UnicodeConversions.hpp"
 #include "source/XMPFiles_IO.hpp"
 #include "source/XIO.hpp"
@@ -160,6 +161,34 @@ MP3_MetaHandler::~MP3_MetaHandler()
 	}
 }
 
+// =================================================================================================
+// Padding support
+// ===============
+//
+// The padding is checked and written in blocks, compared against and copied from a zero block.
+
+static const XMP_Uns32 kPaddingBlockSize = 16*1024;
+static const XMP_Uns8  kZeroPadding [kPaddingBlockSize] = { 0 };
+
+// The padding left in the tag when it has to be rewritten, so that later edits fit without shifting
+// the audio. The reserve is a percentage of the frames. Define the macros to change the limits,
+// setting the maximum to 0 turns the reserve off.
+
+#ifndef MP3_MinPaddingReserve
+	#define MP3_MinPaddingReserve (2*1024)
+#endif
+
+#ifndef MP3_MaxPaddingReserve
+	#define MP3_MaxPaddingReserve (256*1024)
+#endif
+
+#ifndef MP3_PaddingReservePercent
+	#define MP3_PaddingReservePercent 10
+#endif
+
+static const PaddingPolicy kMP3_PaddingPolicy = { MP3_MinPaddingReserve, MP3_MaxPaddingReserve,
+												   MP3_PaddingReservePercent, 0, 0 };
+
 // =================================================================================================
 // MP3_MetaHandler::CacheFileData
 // ==============================
@@ -271,14 +300,13 @@ void MP3_MetaHandler::CacheFileData()
 
 	XMP_Validate ( (this->oldPadding >= 0), "illegal oldTagSize or padding value", kXMPErr_BadFileFormat );
 
+	XMP_Uns8 padBuffer [kPaddingBlockSize];	// Check the padding a block at a time.
 	for ( XMP_Int64 i = this->oldPadding; i > 0; ) {
-		if ( i >= 8 ) {
-			if ( XIO::ReadInt64_BE(file) != 0 ) XMP_Throw ( "padding not nulled out", kXMPErr_BadFileFormat );
-			i -= 8;
-			continue;
-		}
-		if ( XIO::ReadUns8(file) != 0) XMP_Throw ( "padding(2) not nulled out", kXMPErr_BadFileFormat );
-		i--;
+		XMP_Uns32 ioCount = kPaddingBlockSize;
+		if ( i < kPaddingBlockSize ) ioCount = (XMP_Uns32)i;
+		file->ReadAll ( padBuffer, ioCount );
+		if ( memcmp ( padBuffer, kZeroPadding, ioCount ) != 0 ) XMP_Throw ( "padding not nulled out", kXMPErr_BadFileFormat );
+		i -= ioCount;
 	}
 
 	//// read ID3v1 tag
@@ -733,24 +761,36 @@ void MP3_MetaHandler::UpdateFile ( bool doSafeUpdate )
 		if ( framesVector[i]->active ) newFramesSize += (frameHeaderSize + framesVector[i]->contentSize);
 	}
 
-	mustShift = (newFramesSize > (XMP_Int64)(oldTagSize - ID3Header::kID3_TagHeaderSize)) ||
-	//optimization: If more than 8K can be saved by rewriting the MP3, go do it:
-				((newFramesSize + 8*1024) < oldTagSize );
+	XMP_Int64 oldSpace = oldTagSize - ID3Header::kID3_TagHeaderSize;	// Frames plus padding.
+	XMP_Int64 growth = (this->hasID3Tag ? (newFramesSize - oldFramesSize) : 0);
+	XMP_Int64 reserve = (XMP_Int64) PaddingReserve ( kMP3_PaddingPolicy, newFramesSize, ((growth > 0) ? growth : 0) );
+
+	mustShift = (newFramesSize > oldSpace) ||
+	//optimization: Give space back if the padding is well beyond the policy and more than 8K can be
+	//saved. Not any earlier, or a shrink is likely followed by a shift to grow again on the next edit.
+				((oldSpace - newFramesSize) > (2*reserve + 8*1024));
 
 	if ( ! mustShift )	{	// fill what we got
 		newTagSize = oldTagSize;
-	} else { // if need to shift anyway, get some nice 2K padding
-		newTagSize = newFramesSize + 2048 + ID3Header::kID3_TagHeaderSize;
+	} else { // if need to shift anyway, leave room for the next edits
+		newTagSize = newFramesSize + reserve + ID3Header::kID3_TagHeaderSize;
 	}
 	newPadding = newTagSize - ID3Header::kID3_TagHeaderSize - newFramesSize;
 
 	// shifting needed? -> shift
 	if ( mustShift ) {
+		// An abort is only honored before the shift, a shift interrupted in place would damage the file.
+		XMP_AbortProc abortProc = this->parent->abortProc;
+		void * abortArg = this->parent->abortArg;
+		if ( (abortProc != 0) && abortProc ( abortArg ) ) {
+			XMP_Throw ( "MP3_MetaHandler::UpdateFile - User abort", kXMPErr_UserAbort );
+		}
 		XMP_Int64 filesize = file ->Length();
 		if ( this->hasID3Tag ) {
-			XIO::Move ( file, oldTagSize, file, newTagSize, filesize - oldTagSize ); //fix [2338569]
+			XIO::Move ( file, oldTagSize, file, newTagSize, filesize - oldTagSize, 0, 0 ); //fix [2338569]
+			if ( newTagSize < oldTagSize ) file->Truncate ( filesize - (oldTagSize - newTagSize) );
 		} else {
-			XIO::Move ( file, 0, file, newTagSize, filesize ); // move entire file up.
+			XIO::Move ( file, 0, file, newTagSize, filesize, 0, 0 ); // move entire file up.
 		}
 	}
 
@@ -765,14 +805,10 @@ void MP3_MetaHandler::UpdateFile ( bool doSafeUpdate )
 
 	// write out padding:
 	for ( XMP_Int64 i = newPadding; i > 0; ) {
-		const XMP_Uns64 zero = 0;
-		if ( i >= 8 ) {
-			file->Write ( &zero, 8  );
-			i -= 8;
-			continue;
-		}
-		file->Write ( &zero, 1  );
-		i--;
+		XMP_Uns32 ioCount = kPaddingBlockSize;
+		if ( i < kPaddingBlockSize ) ioCount = (XMP_Uns32)i;
+		file->Write ( kZeroPadding, ioCount );
+		i -= ioCount;
 	}
 
 	// check end of file for ID3v1 tag
@@ -20,6 +20,7 @@
 
 #include "XMPFiles/source/FormatSupport/ISOBaseMedia_Support.hpp"
 #include "XMPFiles/source/FormatSupport/MOOV_Support.hpp"
+#include "XMPFiles/source/FormatSupport/PaddingReserve.hpp"
 
 #include "source/XMP_ProgressTracker.hpp"
 #include "source/UnicodeConversions.hpp"
@@ -1943,8 +1944,9 @@ static void CheckFinalBox ( XMP_IO* fileRef, XMP_AbortProc abortProc, void * abo
 //
 // There are 3 file variants: normal ISO Base Media, modern QuickTime, and classic QuickTime. The
 // XMP is placed differently between the ISO and two QuickTime forms, and there is different but not
-// colliding native metadata. The entire 'moov' subtree is cached, along with the top level 'uuid'
-// box of XMP if present.
+// colliding native metadata. The 'moov' subtree is cached, along with the top level 'uuid' box of
+// XMP if present. Large sample tables are left in the file, nothing we import or export needs them.
+// The full 'moov' size limit only matters for updates, reading checks the cached size.
 
 void MPEG4_MetaHandler::CacheFileData()
 {
@@ -1995,13 +1997,11 @@ void MPEG4_MetaHandler::CacheFileData()
 		if ( (! moovFound) && (currBox.boxType == ISOMedia::k_moov) ) {
 
 			XMP_Uns64 fullMoovSize = currBox.headerSize + currBox.contentSize;
-			if ( fullMoovSize > TopBoxSizeLimit) {	// From here on we know 32-bit offsets are safe.
+			if ( isUpdate && (fullMoovSize > TopBoxSizeLimit) ) {	// From here on we know 32-bit offsets are safe.
 				XMP_Throw ( "Oversize 'moov' box", kXMPErr_EnforceFailure );
 			}
 
-			this->moovMgr.fullSubtree.assign ( (XMP_Uns32)fullMoovSize, 0 );
-			fileRef->Seek ( boxPos, kXMP_SeekFromStart );
-			fileRef->Read ( &this->moovMgr.fullSubtree[0], (XMP_Uns32)fullMoovSize );
+			this->moovMgr.ReadSubtree ( fileRef, boxPos, fullMoovSize, true );
 
 			this->moovBoxPos = boxPos;
 			this->moovBoxSize = (XMP_Uns32)fullMoovSize;
@@ -2085,7 +2085,7 @@ void MPEG4_MetaHandler::ProcessXMP()
 
 		if ( (xmpRef != 0) && (xmpInfo.contentSize != 0) ) {
 
-			this->xmpBoxPos = this->moovBoxPos + this->moovMgr.GetParsedOffset ( xmpRef );
+			this->xmpBoxPos = this->moovBoxPos + this->moovMgr.GetOriginalOffset ( xmpRef );
 			this->packetInfo.offset = this->xmpBoxPos + this->moovMgr.GetHeaderSize ( xmpRef );
 			this->packetInfo.length = xmpInfo.contentSize;
 
@@ -2149,6 +2149,38 @@ void MPEG4_MetaHandler::ProcessXMP()
 
 }	// MPEG4_MetaHandler::ProcessXMP
 
+// =================================================================================================
+// LoadTimecodeTable
+// =================
+//
+// Make sure a timecode track sample table is in memory. Only unusually large tables are left in the
+// file by CacheFileData.
+
+static void LoadTimecodeTable ( XMPFiles * parent, MOOV_Manager * moovMgr,
+								MOOV_Manager::BoxRef tableRef, MOOV_Manager::BoxInfo * tableInfo )
+{
+	if ( (tableInfo->content != 0) || (tableInfo->contentSize == 0) ) return;
+
+	XMPFiles_IO* localFile = 0;
+
+	if ( parent->ioRef == 0 ) {	// Local read-only files get closed in CacheFileData.
+		XMP_Assert ( parent->UsesLocalIO() );
+		localFile = XMPFiles_IO::New_XMPFiles_IO ( parent->GetFilePath().c_str(), Host_IO::openReadOnly, &parent->errorCallback );
+		XMP_Enforce ( localFile != 0 );
+		parent->ioRef = localFile;
+	}
+
+	moovMgr->LoadDeferredContent ( parent->ioRef, tableRef );
+	moovMgr->GetBoxInfo ( tableRef, tableInfo );
+
+	if ( localFile != 0 ) {
+		localFile->Close();
+		delete localFile;
+		parent->ioRef = 0;
+	}
+
+}	// LoadTimecodeTable
+
 // =================================================================================================
 // MPEG4_MetaHandler::ParseTimecodeTrack
 // =====================================
@@ -2288,6 +2320,7 @@ bool MPEG4_MetaHandler::ParseTimecodeTrack()
 
 		tempRef = this->moovMgr.GetTypeChild ( stblRef, ISOMedia::k_stsc, &tempInfo );
 		if ( tempRef == 0 ) return false;
+		LoadTimecodeTable ( this->parent, &this->moovMgr, tempRef, &tempInfo );
 		if ( tempInfo.contentSize < (8 + sizeof ( MOOV_Manager::Content_stsc_entry )) ) return false;
 		if ( GetUns32BE ( tempInfo.content + 4 ) == 0 ) return false;	// Make sure the entry count is non-zero.
 
@@ -2297,6 +2330,7 @@ bool MPEG4_MetaHandler::ParseTimecodeTrack()
 
 		if ( tempRef != 0 ) {
 
+			LoadTimecodeTable ( this->parent, &this->moovMgr, tempRef, &tempInfo );
 			if ( tempInfo.contentSize < (8 + 4) ) return false;
 			XMP_Uns32 stcoCount = GetUns32BE ( tempInfo.content + 4 );
 			if ( stcoCount < firstChunkNumber ) return false;
@@ -2307,6 +2341,7 @@ bool MPEG4_MetaHandler::ParseTimecodeTrack()
 
 			tempRef = this->moovMgr.GetTypeChild ( stblRef, ISOMedia::k_co64, &tempInfo );
 			if ( (tempRef == 0) || (tempInfo.contentSize < (8 + 8)) ) return false;
+			LoadTimecodeTable ( this->parent, &this->moovMgr, tempRef, &tempInfo );
 			XMP_Uns32 co64Count = GetUns32BE ( tempInfo.content + 4 );
 			if ( co64Count < firstChunkNumber ) return false;
 			XMP_Uns64 * co64Ptr = (XMP_Uns64*) (tempInfo.content + 8);
@@ -2371,6 +2406,29 @@ bool MPEG4_MetaHandler::ParseTimecodeTrack()
 
 }	// MPEG4_MetaHandler::ParseTimecodeTrack
 
+// =================================================================================================
+// kMPEG4_PaddingPolicy
+// ====================
+//
+// The size of the 'free' box left after a top level box that had to grow at the end of the file or
+// be appended. Later growth is then absorbed in place, instead of moving the box again. Define the
+// macros to change the limits, setting the maximum to 0 turns the reserve off.
+
+#ifndef MPEG4_MinPaddingReserve
+	#define MPEG4_MinPaddingReserve (8*1024)
+#endif
+
+#ifndef MPEG4_MaxPaddingReserve
+	#define MPEG4_MaxPaddingReserve (256*1024)
+#endif
+
+#ifndef MPEG4_PaddingReservePercent
+	#define MPEG4_PaddingReservePercent 5
+#endif
+
+static const PaddingPolicy kMPEG4_PaddingPolicy = { MPEG4_MinPaddingReserve, MPEG4_MaxPaddingReserve,
+													 MPEG4_PaddingReservePercent, 8 /* A 'free' box header. */, 0 };
+
 // =================================================================================================
 // MPEG4_MetaHandler::UpdateTopLevelBox
 // ====================================
@@ -2396,10 +2454,14 @@ void MPEG4_MetaHandler::UpdateTopLevelBox ( XMP_Uns64 oldOffset, XMP_Uns32 oldSi
 
 	} else if ( (oldOffset + oldSize) == oldFileSize ) {
 
-		// The old box was at the end, write the new and truncate the file if necessary.
+		// The old box was at the end, write the new and truncate the file if necessary. Reserve
+		// padding if the box grew, other boxes might get appended behind it.
 		fileRef->Seek ( oldOffset, kXMP_SeekFromStart );
 		fileRef->Write ( newBox, newSize );
-		fileRef->Truncate ( (oldOffset + newSize) );	// Does nothing if new size is bigger.
+		XMP_Uns32 reserve = 0;
+		if ( newSize > oldSize ) reserve = (XMP_Uns32) PaddingReserve ( kMPEG4_PaddingPolicy, newSize );
+		if ( reserve != 0 ) this->moovMgr.WipeBoxFree ( fileRef, (oldOffset + newSize), reserve );
+		fileRef->Truncate ( (oldOffset + newSize + reserve) );	// Does nothing if new size is bigger.
 
 	} else if ( (newSize < oldSize) && ((oldSize - newSize) >= 8) ) {
 
@@ -2410,17 +2472,27 @@ void MPEG4_MetaHandler::UpdateTopLevelBox ( XMP_Uns64 oldOffset, XMP_Uns32 oldSi
 
 	} else {
 
-		// Look for a trailing free box with enough space. If not found, consider any free space.
-		// If still not found, append the new box and make the old one free.
+		// Look for trailing free boxes with enough space, usually the padding reserved by an earlier
+		// update. If not found, consider any free space. If still not found, append the new box,
+		// reserve padding after it, and make the old one free.
 
 		ISOMedia::BoxInfo nextBoxInfo;
-		(void) ISOMedia::GetBoxInfo ( fileRef, (oldOffset + oldSize), oldFileSize, &nextBoxInfo, true /* throw errors */ );
+		XMP_Uns64 totalRoom = oldSize;
+		XMP_Uns64 nextPos = oldOffset + oldSize;
 
-		XMP_Uns64 totalRoom = oldSize + nextBoxInfo.headerSize + nextBoxInfo.contentSize;
+		bool nextIsFree = false;
+		bool haveEnoughRoom = false;
 
-		bool nextIsFree = (nextBoxInfo.boxType == ISOMedia::k_free) || (nextBoxInfo.boxType == ISOMedia::k_skip);
-		bool haveEnoughRoom = (newSize == totalRoom) ||
-							  ( (newSize < totalRoom) && ((totalRoom - newSize) >= 8) );
+		while ( (nextPos < oldFileSize) && (! haveEnoughRoom) ) {
+			XMP_Uns64 followingPos = ISOMedia::GetBoxInfo ( fileRef, nextPos, oldFileSize, &nextBoxInfo, true /* doSeek */ );
+			if ( (nextBoxInfo.boxType != ISOMedia::k_free) && (nextBoxInfo.boxType != ISOMedia::k_skip) ) break;
+			if ( nextBoxInfo.headerSize < 8 ) break;
+			nextIsFree = true;
+			totalRoom += nextBoxInfo.headerSize + nextBoxInfo.contentSize;
+			nextPos = followingPos;
+			haveEnoughRoom = (newSize == totalRoom) ||
+							 ( (newSize < totalRoom) && ((totalRoom - newSize) >= 8) );
+		}
 
 		if ( nextIsFree & haveEnoughRoom ) {
 
@@ -2452,10 +2524,12 @@ void MPEG4_MetaHandler::UpdateTopLevelBox ( XMP_Uns64 oldOffset, XMP_Uns32 oldSi
 
 			if ( freeSlot == spaceList.size() ) {
 
-				// No available free space, append the new box.
+				// No available free space, append the new box and the padding reserve.
 				CheckFinalBox ( fileRef, abortProc, abortArg );
-				fileRef->ToEOF();
+				XMP_Uns64 newOffset = fileRef->ToEOF();
 				fileRef->Write ( newBox, newSize );
+				XMP_Uns32 reserve = (XMP_Uns32) PaddingReserve ( kMPEG4_PaddingPolicy, newSize );
+				if ( reserve != 0 ) this->moovMgr.WipeBoxFree ( fileRef, (newOffset + newSize), reserve );
 				this->moovMgr.WipeBoxFree ( fileRef, oldOffset, oldSize );
 
 			} else {
@@ -2518,11 +2592,12 @@ void MPEG4_MetaHandler::UpdateTopLevelBox ( XMP_Uns64 oldOffset, XMP_Uns32 oldSi
 }	// MPEG4_MetaHandler::UpdateTopLevelBox
 
 // =================================================================================================
-// AdjustOffset
-// ============
+// FindOldBox
+// ==========
 //
-// A utility for OptimizeFileLayout, adjusts a 'stco' or 'co64' table entry for the new layout. The
-// map is keyed by the original box's last content offset, so that map.lower_bound does what we want.
+// A utility for OptimizeFileLayout, finds the original top level box holding a 'stco' or 'co64'
+// table entry. The map is keyed by the original box's last content offset, so that map.lower_bound
+// does what we want.
 
 struct LayoutInfo {
 	XMP_Uns32 boxType;
@@ -2536,11 +2611,11 @@ struct LayoutInfo {
 typedef std::vector < LayoutInfo > LayoutVector;
 typedef std::map < XMP_Uns64, LayoutInfo* > LayoutMap;
 
-static XMP_Uns64 AdjustOffset ( XMP_Uns64 oldOffset, const LayoutMap & newMap , GenericErrorCallback * ec)
+static const LayoutInfo * FindOldBox ( XMP_Uns64 oldOffset, const LayoutMap & oldEndMap , GenericErrorCallback * ec)
 {
 
-	LayoutMap::const_iterator mapEntry = newMap.lower_bound ( oldOffset );
-	if ( (mapEntry == newMap.end()) || (oldOffset < mapEntry->second->oldOffset) ) {
+	LayoutMap::const_iterator mapEntry = oldEndMap.lower_bound ( oldOffset );
+	if ( (mapEntry == oldEndMap.end()) || (oldOffset < mapEntry->second->oldOffset) ) {
 		XMP_Error error ( kXMPErr_BadFileFormat,"Offset from 'stco' or 'co64' is not into kept box" );
 		XMPFileHandler::NotifyClient(ec, kXMPErrSev_FileFatal, error);
 	}
@@ -2548,9 +2623,314 @@ static XMP_Uns64 AdjustOffset ( XMP_Uns64 oldOffset, const LayoutMap & newMap ,
 	XMP_Assert ( (mapEntry->second->oldOffset <= oldOffset) &&
 				 (oldOffset <= (mapEntry->second->oldOffset + mapEntry->second->boxSize)) );
 
-	return mapEntry->second->newOffset + (oldOffset - mapEntry->second->oldOffset);
+	return mapEntry->second;
+
+}	// FindOldBox
+
+// =================================================================================================
+// RelocateBlock
+// =============
+//
+// Utilities for RelocateChunkOffsets, translate a block of big endian 'stco' or 'co64' entries by a
+// fixed delta and return the smallest and largest old offsets. The caller checks the range after the
+// fact and redoes the block if it is not entirely within one box. The vector code is compiled with
+// function level target attributes, as in source/CRC32.cpp. SSE4.2 is needed for the unsigned 32 bit
+// min and max and the 64 bit compare, NEON is always there on 64 bit ARM. Define
+// XMP_MPEG4_Relocate_UseHardware as 0 for only the portable code.
+
+#ifndef XMP_MPEG4_Relocate_UseHardware
+	#define XMP_MPEG4_Relocate_UseHardware 1
+#endif
+
+#define Relocate_HaveSSE42 0
+#define Relocate_HaveNEON  0
+
+#if XMP_MPEG4_Relocate_UseHardware
+
+	#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+		#undef  Relocate_HaveSSE42
+		#define Relocate_HaveSSE42 1
+		#define Relocate_TargetSSE42 __attribute__ ((target ( "sse4.2" )))
+		#include <immintrin.h>
+	#elif (defined(_M_X64) || defined(_M_IX86)) && defined(_MSC_VER)
+		#undef  Relocate_HaveSSE42
+		#define Relocate_HaveSSE42 1
+		#define Relocate_TargetSSE42
+		#include <intrin.h>
+	#endif
+
+	#if defined(__aarch64__) || defined(_M_ARM64)
+		#undef  Relocate_HaveNEON
+		#define Relocate_HaveNEON 1
+		#include <arm_neon.h>
+	#endif
+
+#endif
+
+static inline XMP_Uns32 GetChunkOffset ( const XMP_Uns8 * entry, XMP_Uns32 * ) { return GetUns32BE ( entry ); }
+static inline XMP_Uns64 GetChunkOffset ( const XMP_Uns8 * entry, XMP_Uns64 * ) { return GetUns64BE ( entry ); }
+
+static inline void PutChunkOffset ( XMP_Uns32 offset, XMP_Uns8 * entry ) { PutUns32BE ( offset, entry ); }
+static inline void PutChunkOffset ( XMP_Uns64 offset, XMP_Uns8 * entry ) { PutUns64BE ( offset, entry ); }
+
+template < typename EntryType >
+static void RelocateBlockPortable ( const XMP_Uns8 * oldBlock, XMP_Uns32 count, EntryType delta, XMP_Uns8 * newBlock,
+									EntryType * minOffset, EntryType * maxOffset )
+{
+	const size_t entrySize = sizeof ( EntryType );
+	EntryType * typeTag = 0;	// Selects the GetChunkOffset overload.
+	EntryType minValue = *minOffset, maxValue = *maxOffset;	// ! Locals, the outputs could alias newBlock.
+
+	for ( XMP_Uns32 i = 0; i < count; ++i ) {
+		EntryType oldOffset = GetChunkOffset ( oldBlock + (i * entrySize), typeTag );
+		minValue = (oldOffset < minValue) ? oldOffset : minValue;
+		maxValue = (oldOffset > maxValue) ? oldOffset : maxValue;
+		PutChunkOffset ( (EntryType)(oldOffset + delta), newBlock + (i * entrySize) );	// ! Modulo arithmetic.
+	}
+
+	*minOffset = minValue;
+	*maxOffset = maxValue;
+
+}	// RelocateBlockPortable
+
+#if Relocate_HaveSSE42
+
+Relocate_TargetSSE42
+static XMP_Uns32 RelocateBlockSSE42 ( const XMP_Uns8 * oldBlock, XMP_Uns32 count, XMP_Uns32 delta, XMP_Uns8 * newBlock,
+									  XMP_Uns32 * minOffset, XMP_Uns32 * maxOffset )
+{
+	const __m128i swap = _mm_setr_epi8 ( 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 );
+	const __m128i add  = _mm_set1_epi32 ( (int)delta );
+	__m128i vMin = _mm_set1_epi32 ( (int)*minOffset );
+	__m128i vMax = _mm_set1_epi32 ( (int)*maxOffset );
+
+	XMP_Uns32 done = 0;
+	for ( ; (count - done) >= 4; done += 4 ) {
+		__m128i offsets = _mm_shuffle_epi8 ( _mm_loadu_si128 ( (const __m128i*)(oldBlock + done*4) ), swap );
+		vMin = _mm_min_epu32 ( vMin, offsets );
+		vMax = _mm_max_epu32 ( vMax, offsets );
+		offsets = _mm_shuffle_epi8 ( _mm_add_epi32 ( offsets, add ), swap );
+		_mm_storeu_si128 ( (__m128i*)(newBlock + done*4), offsets );
+	}
+
+	vMin = _mm_min_epu32 ( vMin, _mm_shuffle_epi32 ( vMin, _MM_SHUFFLE ( 1, 0, 3, 2 ) ) );
+	vMin = _mm_min_epu32 ( vMin, _mm_shuffle_epi32 ( vMin, _MM_SHUFFLE ( 2, 3, 0, 1 ) ) );
+	vMax = _mm_max_epu32 ( vMax, _mm_shuffle_epi32 ( vMax, _MM_SHUFFLE ( 1, 0, 3, 2 ) ) );
+	vMax = _mm_max_epu32 ( vMax, _mm_shuffle_epi32 ( vMax, _MM_SHUFFLE ( 2, 3, 0, 1 ) ) );
+	*minOffset = (XMP_Uns32) _mm_cvtsi128_si32 ( vMin );
+	*maxOffset = (XMP_Uns32) _mm_cvtsi128_si32 ( vMax );
+
+	return done;
+
+}	// RelocateBlockSSE42
+
+Relocate_TargetSSE42
+static XMP_Uns32 RelocateBlockSSE42 ( const XMP_Uns8 * oldBlock, XMP_Uns32 count, XMP_Uns64 delta, XMP_Uns8 * newBlock,
+									  XMP_Uns64 * minOffset, XMP_Uns64 * maxOffset )
+{
+	// There is no unsigned 64 bit compare, flip the sign bits and use the signed one.
+	const __m128i swap = _mm_setr_epi8 ( 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 );
+	const __m128i add  = _mm_set1_epi64x ( (long long)delta );
+	const __m128i sign = _mm_set1_epi64x ( (long long)0x8000000000000000ULL );
+	__m128i vMin = _mm_xor_si128 ( _mm_set1_epi64x ( (long long)*minOffset ), sign );
+	__m128i vMax = _mm_xor_si128 ( _mm_set1_epi64x ( (long long)*maxOffset ), sign );
+
+	XMP_Uns32 done = 0;
+	for ( ; (count - done) >= 2; done += 2 ) {
+		__m128i offsets = _mm_shuffle_epi8 ( _mm_loadu_si128 ( (const __m128i*)(oldBlock + done*8) ), swap );
+		__m128i flipped = _mm_xor_si128 ( offsets, sign );
+		vMin = _mm_blendv_epi8 ( vMin, flipped, _mm_cmpgt_epi64 ( vMin, flipped ) );
+		vMax = _mm_blendv_epi8 ( vMax, flipped, _mm_cmpgt_epi64 ( flipped, vMax ) );
+		offsets = _mm_shuffle_epi8 ( _mm_add_epi64 ( offsets, add ), swap );
+		_mm_storeu_si128 ( (__m128i*)(newBlock + done*8), offsets );
+	}
+
+	XMP_Uns64 lanes [2];
+	_mm_storeu_si128 ( (__m128i*)lanes, _mm_xor_si128 ( vMin, sign ) );
+	*minOffset = (lanes[0] < lanes[1]) ? lanes[0] : lanes[1];
+	_mm_storeu_si128 ( (__m128i*)lanes, _mm_xor_si128 ( vMax, sign ) );
+	*maxOffset = (lanes[0] > lanes[1]) ? lanes[0] : lanes[1];
+
+	return done;
+
+}	// RelocateBlockSSE42
+
+static bool HaveSSE42()
+{
+	#if defined(_MSC_VER) && ! defined(__clang__)
+		int info[4];
+		__cpuid ( info, 1 );
+		return ((info[2] & (1 << 20)) != 0);	// SSE4.2, which implies SSSE3 and SSE4.1.
+	#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports ( "sse4.2" );
+	#endif
+}
+
+#endif	// Relocate_HaveSSE42
+
+#if Relocate_HaveNEON
+
+static XMP_Uns32 RelocateBlockNEON ( const XMP_Uns8 * oldBlock, XMP_Uns32 count, XMP_Uns32 delta, XMP_Uns8 * newBlock,
+									 XMP_Uns32 * minOffset, XMP_Uns32 * maxOffset )
+{
+	const uint32x4_t add = vdupq_n_u32 ( delta );
+	uint32x4_t vMin = vdupq_n_u32 ( *minOffset );
+	uint32x4_t vMax = vdupq_n_u32 ( *maxOffset );
+
+	XMP_Uns32 done = 0;
+	for ( ; (count - done) >= 4; done += 4 ) {
+		uint32x4_t offsets = vreinterpretq_u32_u8 ( vrev32q_u8 ( vld1q_u8 ( oldBlock + done*4 ) ) );
+		vMin = vminq_u32 ( vMin, offsets );
+		vMax = vmaxq_u32 ( vMax, offsets );
+		offsets = vaddq_u32 ( offsets, add );
+		vst1q_u8 ( newBlock + done*4, vrev32q_u8 ( vreinterpretq_u8_u32 ( offsets ) ) );
+	}
+
+	*minOffset = vminvq_u32 ( vMin );
+	*maxOffset = vmaxvq_u32 ( vMax );
+
+	return done;
+
+}	// RelocateBlockNEON
+
+static XMP_Uns32 RelocateBlockNEON ( const XMP_Uns8 * oldBlock, XMP_Uns32 count, XMP_Uns64 delta, XMP_Uns8 * newBlock,
+									 XMP_Uns64 * minOffset, XMP_Uns64 * maxOffset )
+{
+	const uint64x2_t add = vdupq_n_u64 ( delta );
+	uint64x2_t vMin = vdupq_n_u64 ( *minOffset );
+	uint64x2_t vMax = vdupq_n_u64 ( *maxOffset );
+
+	XMP_Uns32 done = 0;
+	for ( ; (count - done) >= 2; done += 2 ) {
+		uint64x2_t offsets = vreinterpretq_u64_u8 ( vrev64q_u8 ( vld1q_u8 ( oldBlock + done*8 ) ) );
+		vMin = vbslq_u64 ( vcgtq_u64 ( vMin, offsets ), offsets, vMin );
+		vMax = vbslq_u64 ( vcgtq_u64 ( offsets, vMax ), offsets, vMax );
+		offsets = vaddq_u64 ( offsets, add );
+		vst1q_u8 ( newBlock + done*8, vrev64q_u8 ( vreinterpretq_u8_u64 ( offsets ) ) );
+	}
+
+	XMP_Uns64 lane0 = vgetq_lane_u64 ( vMin, 0 ), lane1 = vgetq_lane_u64 ( vMin, 1 );
+	*minOffset = (lane0 < lane1) ? lane0 : lane1;
+	lane0 = vgetq_lane_u64 ( vMax, 0 );
+	lane1 = vgetq_lane_u64 ( vMax, 1 );
+	*maxOffset = (lane0 > lane1) ? lane0 : lane1;
+
+	return done;
+
+}	// RelocateBlockNEON
+
+#endif	// Relocate_HaveNEON
+
+enum { kRelocateUsePortable = 0, kRelocateUseSSE42 = 1, kRelocateUseNEON = 2 };
+
+static int SelectRelocateBlock()
+{
+	#if Relocate_HaveSSE42
+		if ( HaveSSE42() ) return kRelocateUseSSE42;
+	#endif
+	#if Relocate_HaveNEON
+		return kRelocateUseNEON;
+	#endif
+	return kRelocateUsePortable;
+}
+
+template < typename EntryType >
+static void RelocateBlock ( const XMP_Uns8 * oldBlock, XMP_Uns32 count, EntryType delta, XMP_Uns8 * newBlock,
+							EntryType * minOffset, EntryType * maxOffset )
+{
+	static const int sSelection = SelectRelocateBlock();	// ! Checked once, thread safe in C++11.
+
+	const size_t entrySize = sizeof ( EntryType );
+	XMP_Uns32 done = 0;
+
+	*minOffset = (EntryType)(-1);
+	*maxOffset = 0;
+
+	switch ( sSelection ) {
+		#if Relocate_HaveSSE42
+		case kRelocateUseSSE42 :
+			done = RelocateBlockSSE42 ( oldBlock, count, delta, newBlock, minOffset, maxOffset );
+			break;
+		#endif
+		#if Relocate_HaveNEON
+		case kRelocateUseNEON :
+			done = RelocateBlockNEON ( oldBlock, count, delta, newBlock, minOffset, maxOffset );
+			break;
+		#endif
+		default :
+			break;
+	}
+
+	RelocateBlockPortable ( oldBlock + (done * entrySize), (count - done), delta, newBlock + (done * entrySize),
+							minOffset, maxOffset );
+
+}	// RelocateBlock
+
+// =================================================================================================
+// RelocateChunkOffsets
+// ====================
+//
+// A utility for OptimizeFileLayout, translates a whole 'stco' or 'co64' table to big endian offsets
+// for the new layout. The offsets in a table almost always stay in one 'mdat' box for long runs, so
+// the table is done in blocks. If the previous entry was in a known box, the block is translated by
+// that box's delta with RelocateBlock. If the block turns out to not be entirely within that box,
+// it is redone looking up the box for each entry. Returns false if a new offset does not fit in an
+// entry.
+
+static const XMP_Uns32 kRelocateBlockCount = 256;
+
+template < typename EntryType >
+static bool RelocateChunkOffsets ( const XMP_Uns8 * oldTable, XMP_Uns32 offsetCount, XMP_Uns8 * newTable,
+								   const LayoutMap & oldEndMap, GenericErrorCallback * ec )
+{
+	const size_t entrySize = sizeof ( EntryType );
+	const XMP_Uns64 entryLimit = (EntryType)(-1);
+	EntryType * typeTag = 0;	// Selects the GetChunkOffset overload.
+
+	const LayoutInfo * currBox = 0;
+	XMP_Uns64 boxFirst = 0, boxLast = 0;	// The range of old offsets in currBox.
+
+	XMP_Uns32 blockStart = 0;
+	while ( blockStart < offsetCount ) {
 
-}	// AdjustOffset
+		XMP_Uns32 blockCount = offsetCount - blockStart;
+		if ( blockCount > kRelocateBlockCount ) blockCount = kRelocateBlockCount;
+
+		const XMP_Uns8 * oldBlock = oldTable + (blockStart * entrySize);
+		XMP_Uns8 * newBlock = newTable + (blockStart * entrySize);
+		blockStart += blockCount;
+
+		if ( currBox != 0 ) {
+
+			EntryType minOffset, maxOffset;
+			EntryType delta = (EntryType) (currBox->newOffset - currBox->oldOffset);	// ! Modulo arithmetic.
+			RelocateBlock ( oldBlock, blockCount, delta, newBlock, &minOffset, &maxOffset );
+
+			if ( (boxFirst <= minOffset) && (maxOffset <= boxLast) ) {
+				if ( (currBox->newOffset + (maxOffset - currBox->oldOffset)) > entryLimit ) return false;
+				continue;
+			}
+
+		}
+
+		for ( XMP_Uns32 i = 0; i < blockCount; ++i ) {
+			XMP_Uns64 oldOffset = GetChunkOffset ( oldBlock + (i * entrySize), typeTag );
+			if ( (currBox == 0) || (oldOffset < boxFirst) || (boxLast < oldOffset) ) {
+				currBox = FindOldBox ( oldOffset, oldEndMap, ec );
+				boxFirst = currBox->oldOffset;
+				boxLast  = currBox->oldOffset + currBox->boxSize - 1;
+			}
+			XMP_Uns64 newOffset = currBox->newOffset + (oldOffset - currBox->oldOffset);
+			if ( newOffset > entryLimit ) return false;
+			PutChunkOffset ( (EntryType)newOffset, newBlock + (i * entrySize) );
+		}
+
+	}
+
+	return true;
+
+}	// RelocateChunkOffsets
 
 // =================================================================================================
 // MPEG4_MetaHandler::OptimizeFileLayout
@@ -2576,6 +2956,7 @@ void MPEG4_MetaHandler::OptimizeFileLayout()
 
 	size_t boxCount = 0;
 	size_t moovIndex = 0, xmpIndex = 0;
+	XMP_Uns64 moovPos = 0, moovSize = 0;
 
 	// Go through the top level boxes to see if the file layout needs to be optimized. Look until
 	// we find both the 'moov' and XMP 'uuid' boxes, saving their relative index in the file.
@@ -2601,6 +2982,8 @@ void MPEG4_MetaHandler::OptimizeFileLayout()
 
 			moovFound = true;
 			moovIndex = boxCount-1;	// Need later for optimization.
+			moovPos = currPos;
+			moovSize = currBox.headerSize + currBox.contentSize;
 			needsOptimization = mdatFound;
 			if ( xmpFound ) break;	// Don't need to look further.
 
@@ -2617,39 +3000,12 @@ void MPEG4_MetaHandler::OptimizeFileLayout()
 
 	if ( ! needsOptimization ) return;
 
-	// The file needs to be optimized. Make sure that a file over 4 GB has 'co64', not 'stco' boxes.
-	// These are needed to hold 64-bit offsets. We don't go to the effort of changing from 'stco'
-	// to 'co64', the file needs to be OK from the start. (Yes, this eliminates a marginal case of
-	// a file growing beyond 4 GB due to metadata growth.)
-
-	if ( originalSize >= 0xFFFFFFFF ) {
-
-		MOOV_Manager::BoxRef  moovRef, trakRef, tempRef, stcoRef;
-		MOOV_Manager::BoxInfo boxInfo;
-
-		moovRef = this->moovMgr.GetBox ( "moov", &boxInfo );
-		XMP_Enforce ( moovRef != 0 );
-
-		for ( size_t i = 0, limit = boxInfo.childCount; i < limit; ++i ) {
-
-			trakRef = this->moovMgr.GetNthChild ( moovRef, i, &boxInfo );
-			if ( boxInfo.boxType != ISOMedia::k_trak ) continue;
-
-			tempRef = this->moovMgr.GetTypeChild ( trakRef, ISOMedia::k_mdia, 0 );
-			if ( tempRef == 0 ) continue;
-			tempRef = this->moovMgr.GetTypeChild ( tempRef, ISOMedia::k_minf, 0 );
-			if ( tempRef == 0 ) continue;
-			tempRef = this->moovMgr.GetTypeChild ( tempRef, ISOMedia::k_stbl, 0 );
-			if ( tempRef == 0 ) continue;
-
-			stcoRef = this->moovMgr.GetTypeChild ( tempRef, ISOMedia::k_stco, 0 );
-			if ( stcoRef != 0 ) {
-				XMP_Error error ( kXMPErr_BadFileFormat,"Large MPEG-4 file must use 'co64' boxes" );
-				XMPFileHandler::NotifyClient(&parent->errorCallback, kXMPErrSev_FileFatal, error);
-			}
-
-		}
+	// The 'stco' and 'co64' tables are rewritten at their offsets within the 'moov' box. If the
+	// 'moov' box was not rewritten by UpdateFile the cached tree is lazy, reread the whole box.
 
+	if ( moovFound && this->moovMgr.HasDeferredContent() ) {
+		this->moovMgr.ReadSubtree ( originalFile, moovPos, moovSize, false );
+		this->moovMgr.ParseMemoryTree ( this->fileMode );
 	}
 
 	// Build a vector of info for the top level boxes, ignoring 'free', 'skip', and 'wide' boxes.
@@ -2711,33 +3067,11 @@ void MPEG4_MetaHandler::OptimizeFileLayout()
 		newSize += fileBoxes[currIndex].boxSize;
 	}
 	
-	// Adjust the progress tracking if necessary.
-	
-	XMP_ProgressTracker * progressTracker = this->parent->progressTracker;
-	if ( progressTracker != 0 ) {
-		XMP_Assert ( progressTracker->WorkInProgress() );
-		progressTracker->AddTotalWork ( (float) newSize );
-	}
-
-	// Create a temp file for the optimized layout, write it, update the offset tables.
-
-	XMP_IO* tempFile = originalFile->DeriveTemp();
-	XMP_Enforce ( tempFile != 0 );
-
-	// Iterate the map and write the new layout.
-
-	LayoutMap::iterator layoutPos = optLayout.begin();
-	LayoutMap::iterator layoutEnd = optLayout.end();
-
-	for ( ; layoutPos != layoutEnd; ++layoutPos ) {
-		LayoutInfo * pCurrBox = layoutPos->second;
-		XMP_Assert ( (XMP_Int64)pCurrBox->newOffset == tempFile->Length() );
-		originalFile->Seek ( pCurrBox->oldOffset, kXMP_SeekFromStart );
-		XIO::Copy ( originalFile, tempFile, pCurrBox->boxSize, abortProc, abortArg );
-	}
-
-	// Update the offset tables in the temp file. Create a layout map ordered by the last actual
-	// offset of the old box's content to enable fast lookup within AdjustOffset.
+	// Translate the 'stco' and 'co64' tables before copying anything. Create a layout map ordered by
+	// the last actual offset of the old box's content to enable fast lookup within FindOldBox. We
+	// don't go to the effort of changing from 'stco' to 'co64', the new offsets for a 'stco' box
+	// must fit in 32 bits. (Yes, this eliminates a marginal case of a file growing beyond 4 GB due
+	// to metadata growth.)
 
 	LayoutMap oldEndMap;
 	for ( size_t i = 0, nlimit = fileBoxes.size(); i < nlimit; ++i ) {
@@ -2745,6 +3079,9 @@ void MPEG4_MetaHandler::OptimizeFileLayout()
 		oldEndMap.insert ( oldEndMap.end(), LayoutMap::value_type ( oldEnd, &fileBoxes[i] ) );
 	}
 
+	std::vector < XMP_Uns64 > newTableOffsets;
+	std::vector < RawDataBlock > newTables;
+
 	MOOV_Manager::BoxRef moovRef, trakRef, tempRef, stcoRef, co64Ref;
 	MOOV_Manager::BoxInfo boxInfo;
 
@@ -2772,42 +3109,73 @@ void MPEG4_MetaHandler::OptimizeFileLayout()
 			entrySize = 8;
 		}
 
+		if ( boxInfo.contentSize < (4+4) ) {
+			XMP_Error error ( kXMPErr_BadFileFormat, "Bad 'stco' size or count" );
+			XMPFileHandler::NotifyClient(&parent->errorCallback, kXMPErrSev_FileFatal, error);
+		}
+
 		XMP_Uns32 offsetCount = GetUns32BE ( boxInfo.content + 4 );
-		if ( boxInfo.contentSize < (4+4 + entrySize*offsetCount) ) {
+		if ( ((boxInfo.contentSize - (4+4)) / entrySize) < offsetCount ) {
 			XMP_Error error ( kXMPErr_BadFileFormat, "Bad 'stco' size or count" );
 			XMPFileHandler::NotifyClient(&parent->errorCallback, kXMPErrSev_FileFatal, error);
 		}
 
+		MOOV_Manager::BoxRef tableRef = ( (stcoRef != 0) ? stcoRef : co64Ref );
+		newTableOffsets.push_back ( fileBoxes[moovIndex].newOffset +
+									(XMP_Uns64) this->moovMgr.GetParsedOffset ( tableRef ) +
+									(XMP_Uns64) this->moovMgr.GetHeaderSize ( tableRef ) + 4+4 );
+		newTables.push_back ( RawDataBlock() );
+		RawDataBlock & newTable = newTables.back();
+		if ( offsetCount == 0 ) continue;
+		newTable.assign ( (offsetCount * entrySize), 0 );
+
+		bool tableFits;
 		if ( stcoRef != 0 ) {
+			tableFits = RelocateChunkOffsets<XMP_Uns32> ( (boxInfo.content + 4+4), offsetCount, &newTable[0],
+														  oldEndMap, &parent->errorCallback );
+		} else {
+			tableFits = RelocateChunkOffsets<XMP_Uns64> ( (boxInfo.content + 4+4), offsetCount, &newTable[0],
+														  oldEndMap, &parent->errorCallback );
+		}
 
-			XMP_Uns64 stcoTableOffset = fileBoxes[moovIndex].newOffset +
-										(XMP_Uns64) this->moovMgr.GetParsedOffset ( stcoRef ) +
-										(XMP_Uns64) this->moovMgr.GetHeaderSize ( stcoRef ) + 4+4;
-			tempFile->Seek ( stcoTableOffset, kXMP_SeekFromStart );
+		if ( ! tableFits ) {
+			XMP_Error error ( kXMPErr_BadFileFormat,"Large MPEG-4 file must use 'co64' boxes" );
+			XMPFileHandler::NotifyClient(&parent->errorCallback, kXMPErrSev_FileFatal, error);
+		}
 
-			XMP_Uns32 * rawOldU32 = (XMP_Uns32*) (boxInfo.content + 4+4);
-			for ( XMP_Uns32 j = 0; j < offsetCount; ++j, ++rawOldU32 ) {
-				XMP_Uns64 newOffset = AdjustOffset ( (XMP_Uns64)GetUns32BE(rawOldU32), oldEndMap,&parent->errorCallback );
-				XMP_Uns32 u32 = MakeUns32BE ( (XMP_Uns32)newOffset );
-				tempFile->Write ( &u32, 4 );
-			}
+	}
 
-		} else {
+	// Adjust the progress tracking if necessary.
+	
+	XMP_ProgressTracker * progressTracker = this->parent->progressTracker;
+	if ( progressTracker != 0 ) {
+		XMP_Assert ( progressTracker->WorkInProgress() );
+		progressTracker->AddTotalWork ( (float) newSize );
+	}
 
-			XMP_Uns64 co64TableOffset = fileBoxes[moovIndex].newOffset +
-										(XMP_Uns64) this->moovMgr.GetParsedOffset ( co64Ref ) +
-										(XMP_Uns64) this->moovMgr.GetHeaderSize ( co64Ref ) + 4+4;
-			tempFile->Seek ( co64TableOffset, kXMP_SeekFromStart );
+	// Create a temp file for the optimized layout, write it, update the offset tables.
 
-			XMP_Uns64 * rawOldU64 = (XMP_Uns64*) (boxInfo.content + 4+4);
-			for ( XMP_Uns32 j = 0; j < offsetCount; ++j, ++rawOldU64 ) {
-				XMP_Uns64 newOffset = AdjustOffset ( GetUns64BE(rawOldU64), oldEndMap,&parent->errorCallback );
-				XMP_Uns64 u64 = MakeUns64BE ( newOffset );
-				tempFile->Write ( &u64, 8 );
-			}
+	XMP_IO* tempFile = originalFile->DeriveTemp();
+	XMP_Enforce ( tempFile != 0 );
 
-		}
+	// Iterate the map and write the new layout.
+
+	LayoutMap::iterator layoutPos = optLayout.begin();
+	LayoutMap::iterator layoutEnd = optLayout.end();
+
+	for ( ; layoutPos != layoutEnd; ++layoutPos ) {
+		LayoutInfo * pCurrBox = layoutPos->second;
+		XMP_Assert ( (XMP_Int64)pCurrBox->newOffset == tempFile->Length() );
+		originalFile->Seek ( pCurrBox->oldOffset, kXMP_SeekFromStart );
+		XIO::Copy ( originalFile, tempFile, pCurrBox->boxSize, abortProc, abortArg );
+	}
+
+	// Write the translated offset tables into the temp file.
 
+	for ( size_t i = 0, nlimit = newTables.size(); i < nlimit; ++i ) {
+		if ( newTables[i].empty() ) continue;
+		tempFile->Seek ( newTableOffsets[i], kXMP_SeekFromStart );
+		tempFile->Write ( &newTables[i][0], (XMP_Uns32)newTables[i].size() );
 	}
 
 	// Swap the temp and original files.
@@ -2952,7 +3320,7 @@ void MPEG4_MetaHandler::UpdateFile ( bool doSafeUpdate )
 	// Update the 'moov' subtree if necessary, and finally update the timecode sample.
 
 	if ( this->moovMgr.IsChanged() ) {
-		this->moovMgr.UpdateMemoryTree();
+		this->moovMgr.UpdateMemoryTree ( fileRef );
 		if ( progressTracker != 0 ) {
 			progressTracker->AddTotalWork ( (float)this->moovMgr.fullSubtree.size() );
 		}
@@ -14,7 +14,6 @@
 
 #include "XMPFiles/source/FormatSupport/MOOV_Support.hpp"
 #include "XMPFiles/source/FormatSupport/QuickTime_Support.hpp"
-#include "XMPFiles/source/FormatSupport/META_Support.hpp"
 
 
 //  ================================================================================================
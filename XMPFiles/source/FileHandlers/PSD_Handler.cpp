@@ -21,6 +21,7 @@
 #include "XMPFiles/source/FormatSupport/IPTC_Support.hpp"
 #include "XMPFiles/source/FormatSupport/ReconcileLegacy.hpp"
 #include "XMPFiles/source/FormatSupport/Reconcile_Impl.hpp"
+#include "XMPFiles/source/FormatSupport/PaddingReserve.hpp"
 
 #include "third-party/zuid/interfaces/MD5.h"
 
@@ -81,7 +82,8 @@ XMPFileHandler * PSD_MetaHandlerCTor ( XMPFiles * parent )
 // PSD_MetaHandler::PSD_MetaHandler
 // ================================
 
-PSD_MetaHandler::PSD_MetaHandler ( XMPFiles * _parent ) : iptcMgr(0), exifMgr(0), skipReconcile(false),imageWidth(0),imageHeight(0)
+PSD_MetaHandler::PSD_MetaHandler ( XMPFiles * _parent ) : iptcMgr(0), exifMgr(0), skipReconcile(false),imageWidth(0),imageHeight(0),
+															psirOffset(0), psirLength(0)
 {
 	this->parent = _parent;
 	this->handlerFlags = kPSD_HandlerFlags;
@@ -155,6 +157,8 @@ void PSD_MetaHandler::CacheFileData()
 	XMP_Uns32 psirLen = XIO::ReadUns32_BE ( fileRef );
 
 	this->psirMgr.ParseFileResources ( fileRef, psirLen );
+	this->psirOffset = psirOrigin;
+	this->psirLength = psirLen;
 
 	PSIR_Manager::ImgRsrcInfo xmpInfo;
 	bool found = this->psirMgr.GetImgRsrc(kPSIR_XMP, &xmpInfo);
@@ -216,7 +220,7 @@ void PSD_MetaHandler::ProcessXMP()
 	bool haveExif = psir.GetImgRsrc ( kPSIR_Exif, &exifInfo );
 	int iptcDigestState = kDigestMatches;
 
-	if ( haveExif ) exif.ParseMemoryStream ( exifInfo.dataPtr, exifInfo.dataLen );
+	if ( haveExif ) exif.ParseMemoryStream ( exifInfo.dataPtr, exifInfo.dataLen, false /* don't copy */ );	// ! Borrows the PSIR's copy.
 
 	if ( haveIPTC ) {
 
@@ -264,6 +268,121 @@ void PSD_MetaHandler::ProcessXMP()
 
 }	// PSD_MetaHandler::ProcessXMP
 
+// =================================================================================================
+// kPSD_PaddingPolicy
+// ==================
+//
+// The XMP padding reserved when the image resource section is written or has to grow. Later growth
+// of the XMP or the legacy resources is then absorbed by the padding, instead of shifting the layer
+// and image data. The XMP packet padding is the only slack a PSD can legally carry in its image
+// resources. The reserve is even to keep the section length even. Define the macros to change the
+// limits, setting the maximum to 0 turns the reserve off.
+
+#ifndef PSD_MinPaddingReserve
+	#define PSD_MinPaddingReserve (8*1024)
+#endif
+
+#ifndef PSD_MaxPaddingReserve
+	#define PSD_MaxPaddingReserve (256*1024)
+#endif
+
+#ifndef PSD_PaddingReservePercent
+	#define PSD_PaddingReservePercent 5
+#endif
+
+static const PaddingPolicy kPSD_PaddingPolicy = { PSD_MinPaddingReserve, PSD_MaxPaddingReserve,
+												   PSD_PaddingReservePercent, 0, 2 };
+
+// =================================================================================================
+// PSD_MetaHandler::UpdateImageResources
+// =====================================
+//
+// Rewrite the image resource section in the live file. The XMP packet is padded so that the section
+// keeps its old length, the layer and image data are then left alone. If the new resources do not
+// fit the section grows by a padding reserve and the tail of the file is shifted up in place. A
+// section with a lot of unused space is shrunk to a reserve, shifting the tail down. Returns false
+// if the section can't be handled this way, the caller then falls back to a copy update.
+
+#ifndef PSD_MaxInPlaceSection
+	#define PSD_MaxInPlaceSection (64*1024*1024)	// The new section is composed in memory.
+#endif
+
+bool PSD_MetaHandler::UpdateImageResources()
+{
+	if ( this->psirOffset == 0 ) return false;
+	if ( (this->psirLength & 1) != 0 ) return false;	// ! Resources are even, so must be the section.
+
+	XMP_IO* liveFile = this->parent->ioRef;
+	XMP_AbortProc abortProc  = this->parent->abortProc;
+	void *        abortArg   = this->parent->abortArg;
+	XMP_ProgressTracker* progressTracker = this->parent->progressTracker;
+
+	XMP_Int64 fileLength = liveFile->Length();
+	XMP_Int64 tailOffset = this->psirOffset + 4 + this->psirLength;
+	if ( tailOffset > fileLength ) return false;	// Let the copy update cope with a damaged file.
+	XMP_Int64 tailLength = fileLength - tailOffset;
+
+	this->psirMgr.SetImgRsrc ( kPSIR_XMP, this->xmpPacket.c_str(), (XMP_StringLen)this->xmpPacket.size() );
+	XMP_Uns32 newLength = this->psirMgr.GetUpdatedLength();
+	if ( newLength > PSD_MaxInPlaceSection ) return false;
+
+	XMP_Uns32 sectionLength = this->psirLength;
+	if ( (newLength > sectionLength) || ((sectionLength - newLength) > kPSD_PaddingPolicy.maxReserve) ) {
+		sectionLength = newLength + (XMP_Uns32) PaddingReserve ( kPSD_PaddingPolicy, newLength );
+	}
+
+	// Pad the XMP to take up the slack. This is even, the old and new sections both are.
+
+	XMP_Uns32 extra = sectionLength - newLength;
+	if ( extra > 0 ) {
+		XMP_StringLen packetLength = (XMP_StringLen) (this->xmpPacket.size() + extra);
+		this->xmpObj.SerializeToBuffer ( &this->xmpPacket, (kXMP_UseCompactFormat | kXMP_ExactPacketLength), packetLength );
+		this->psirMgr.SetImgRsrc ( kPSIR_XMP, this->xmpPacket.c_str(), (XMP_StringLen)this->xmpPacket.size() );
+		XMP_Enforce ( this->psirMgr.GetUpdatedLength() == sectionLength );
+	}
+
+	XMP_Int64 newTailOffset = this->psirOffset + 4 + sectionLength;
+	bool moveTail = (newTailOffset != tailOffset) && (tailLength > 0);
+
+	if ( progressTracker != 0 ) {
+		float totalWork = (float)sectionLength;
+		if ( moveTail ) totalWork += (float)tailLength;
+		progressTracker->BeginWork ( totalWork );
+	}
+
+	// Grow by shifting the tail up first, shrink by shifting it down after writing the section. The
+	// resources that were not captured are read from the old section, that must still be intact.
+	// An abort is only honored before anything is written, an interrupted shift would damage the file.
+
+	if ( (abortProc != 0) && abortProc ( abortArg ) ) {
+		XMP_Throw ( "PSD_MetaHandler::UpdateImageResources - User abort", kXMPErr_UserAbort );
+	}
+
+	if ( moveTail && (newTailOffset > tailOffset) ) {
+		XIO::Move ( liveFile, tailOffset, liveFile, newTailOffset, tailLength, 0, 0 );
+	}
+
+	this->psirMgr.UpdateFileResourcesInPlace ( liveFile, this->psirOffset );
+
+	if ( newTailOffset < tailOffset ) {
+		if ( moveTail ) XIO::Move ( liveFile, tailOffset, liveFile, newTailOffset, tailLength, 0, 0 );
+		liveFile->Truncate ( newTailOffset + tailLength );
+	}
+
+	this->psirLength = sectionLength;
+
+	PSIR_Manager::ImgRsrcInfo xmpInfo;
+	this->psirMgr.GetImgRsrc ( kPSIR_XMP, &xmpInfo );
+	this->packetInfo.offset = xmpInfo.origOffset;
+	this->packetInfo.length = (XMP_Int32)this->xmpPacket.size();
+	FillPacketInfo ( this->xmpPacket, &this->packetInfo );
+
+	if ( progressTracker != 0 ) progressTracker->WorkComplete();
+
+	return true;
+
+}	// PSD_MetaHandler::UpdateImageResources
+
 // =================================================================================================
 // PSD_MetaHandler::UpdateFile
 // ===========================
@@ -285,12 +404,16 @@ void PSD_MetaHandler::UpdateFile ( bool doSafeUpdate )
 
 	ExportPhotoData ( kXMP_PhotoshopFile, &this->xmpObj, this->exifMgr, this->iptcMgr, &this->psirMgr );
 
-	try {
-		XMP_OptionBits options = kXMP_UseCompactFormat;
-		if ( fileHadXMP ) options |= kXMP_ExactPacketLength;
-		this->xmpObj.SerializeToBuffer ( &this->xmpPacket, options, oldPacketLength );
-	} catch ( ... ) {
+	// Serialize to the old packet length if the new packet fits, else with normal padding. Either
+	// way the XMP is only serialized once.
+
+	if ( ! fileHadXMP ) {
 		this->xmpObj.SerializeToBuffer ( &this->xmpPacket, kXMP_UseCompactFormat );
+	} else {
+		std::string overflowPacket;
+		this->xmpPacket.assign ( oldPacketLength, ' ' );
+		bool packetFits = this->xmpObj.SerializeToRegion ( &this->xmpPacket[0], (XMP_StringLen)oldPacketLength, &overflowPacket, kXMP_UseCompactFormat );
+		if ( ! packetFits ) this->xmpPacket.swap ( overflowPacket );
 	}
 
 	// Decide whether to do an in-place update. This can only happen if all of the following are true:
@@ -325,6 +448,14 @@ void PSD_MetaHandler::UpdateFile ( bool doSafeUpdate )
 
 	} else {
 
+		if ( this->UpdateImageResources() ) {
+			#if GatherPerformanceData
+				sAPIPerf->back().extraInfo += ", PSD image resource update";
+			#endif
+			this->needsUpdate = false;
+			return;
+		}
+
 		#if GatherPerformanceData
 			sAPIPerf->back().extraInfo += ", PSD copy update";
 		#endif
@@ -344,6 +475,7 @@ void PSD_MetaHandler::UpdateFile ( bool doSafeUpdate )
 		}
 
 		origRef->AbsorbTemp();
+		this->psirOffset = 0;	// ! The PSIR offsets still refer to the old file.
 
 	}
 
@@ -380,7 +512,11 @@ void PSD_MetaHandler::WriteTempFile ( XMP_IO* tempRef )
 		this->xmpObj.SerializeToBuffer ( &this->xmpPacket, kXMP_UseCompactFormat );
 	}
 
-	this->xmpObj.SerializeToBuffer ( &this->xmpPacket, kXMP_UseCompactFormat );
+	// Reserve padding in proportion to the image resources, so that later updates can be done in
+	// place. The resources are counted with the old XMP, a close enough basis for the policy.
+
+	XMP_Uns32 padding = (XMP_Uns32) PaddingReserve ( kPSD_PaddingPolicy, this->psirMgr.GetUpdatedLength() );
+	this->xmpObj.SerializeToBuffer ( &this->xmpPacket, kXMP_UseCompactFormat, padding );
 	this->packetInfo.offset = kXMPFiles_UnknownOffset;
 	this->packetInfo.length = (XMP_StringLen)this->xmpPacket.size();
 	FillPacketInfo ( this->xmpPacket, &this->packetInfo );
@@ -58,7 +58,9 @@ public:
 
 private:
 
-	PSD_MetaHandler() : iptcMgr(0), exifMgr(0), skipReconcile(false) {};	// Hidden on purpose.
+	PSD_MetaHandler() : iptcMgr(0), exifMgr(0), skipReconcile(false), psirOffset(0), psirLength(0) {};	// Hidden on purpose.
+
+	bool UpdateImageResources();
 
 	PSIR_FileWriter psirMgr;	// Don't need a pointer, the PSIR part is always file-based.
 	IPTC_Manager *  iptcMgr;	// Need to use pointers so we can properly select between read-only
@@ -66,6 +68,9 @@ private:
 
 	XMP_Uns32 imageWidth, imageHeight;	// Pixel dimensions, used with thumbnail info.
 
+	XMP_Int64 psirOffset;	// The file offset of the image resource section's length field, 0 if unknown.
+	XMP_Uns32 psirLength;	// The length of the image resource section, not including the length field.
+
 };	// PSD_MetaHandler
 
 // =================================================================================================
@@ -286,6 +286,7 @@ void TIFF_MetaHandler::ProcessXMP()
 // There is very little to do directly in UpdateFile. ExportXMPtoJTP takes care of setting all of
 // the necessary TIFF tags, including things like the 2nd copy of the IPTC in the Photoshop image
 // resources in tag 34377. TIFF_FileWriter::UpdateFileStream does all of the update-by-append I/O.
+// With kXMPFiles_OptimizeFileLayout it also reuses the space given up by growing tags.
 
 // *** Need to pass the abort proc and arg to TIFF_FileWriter::UpdateFileStream.
 
@@ -310,12 +311,16 @@ void TIFF_MetaHandler::UpdateFile ( bool doSafeUpdate )
 
 	ExportPhotoData ( kXMP_TIFFFile, &this->xmpObj, &this->tiffMgr, this->iptcMgr, this->psirMgr );
 
-	try {
-		XMP_OptionBits options = kXMP_UseCompactFormat;
-		if ( fileHadXMP ) options |= kXMP_ExactPacketLength;
-		this->xmpObj.SerializeToBuffer ( &this->xmpPacket, options, oldPacketLength );
-	} catch ( ... ) {
+	// Serialize to the old packet length if the new packet fits, else with normal padding. Either
+	// way the XMP is only serialized once.
+
+	if ( ! fileHadXMP ) {
 		this->xmpObj.SerializeToBuffer ( &this->xmpPacket, kXMP_UseCompactFormat );
+	} else {
+		std::string overflowPacket;
+		this->xmpPacket.assign ( oldPacketLength, ' ' );
+		bool packetFits = this->xmpObj.SerializeToRegion ( &this->xmpPacket[0], (XMP_StringLen)oldPacketLength, &overflowPacket, kXMP_UseCompactFormat );
+		if ( ! packetFits ) this->xmpPacket.swap ( overflowPacket );
 	}
 
 	// Decide whether to do an in-place update. This can only happen if all of the following are true:
@@ -341,7 +346,8 @@ void TIFF_MetaHandler::UpdateFile ( bool doSafeUpdate )
 		}
 
 		this->tiffMgr.SetTag ( kTIFF_PrimaryIFD, kTIFF_XMP, kTIFF_UndefinedType, (XMP_Uns32)this->xmpPacket.size(), this->xmpPacket.c_str() );
-		this->tiffMgr.UpdateFileStream ( destRef, progressTracker );
+		bool compactFile = XMP_OptionIsSet ( this->parent->openFlags, kXMPFiles_OptimizeFileLayout );
+		this->tiffMgr.UpdateFileStream ( destRef, progressTracker, compactFile );
 
 	} else {
 
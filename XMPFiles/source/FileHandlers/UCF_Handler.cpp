@@ -15,6 +15,7 @@
 #include "XMPFiles/source/XMPFiles_Impl.hpp"
 #include "source/XMPFiles_IO.hpp"
 #include "source/XIO.hpp"
+#include "source/CRC32.hpp"
 
 #include "XMPFiles/source/FileHandlers/UCF_Handler.hpp"
 
@@ -628,7 +629,7 @@ void UCF_MetaHandler::UpdateFile ( bool doSafeUpdate )
 
 	////////////////////////////////////////////////////////////////////////////////////////////////
 	// CRC (always of uncompressed data)
-	XMP_Uns32 crc = (XMP_Uns32)crc32( 0 , (Bytef*)uncomprPacketStr, uncomprPacketLen );
+	XMP_Uns32 crc = CRC32::Compute ( uncomprPacketStr, uncomprPacketLen );
 	PutUns32LE( crc, &xmpFileHeader.fields[FileHeader::o_crc32] );
 
 	////////////////////////////////////////////////////////////////////////////////////////////////
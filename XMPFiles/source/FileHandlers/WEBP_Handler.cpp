@@ -125,8 +125,10 @@ void WEBP_MetaHandler::ProcessXMP()
             WEBP::Chunk* exifChunk = this->mainChunk->getExifChunk();
             if (exifChunk != NULL) {
                 haveExif = true;
+                // Borrow the chunk data, it is kept until the handler is deleted.
                 this->exifMgr->ParseMemoryStream(exifChunk->data.data(),
-                                                 exifChunk->data.size());
+                                                 exifChunk->data.size(),
+                                                 false);
             }
         }
     }
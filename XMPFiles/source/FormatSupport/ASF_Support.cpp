@@ -304,7 +304,8 @@ bool ASF_Support::ReadHeaderObject ( XMP_IO* fileRef, ObjectState& inOutObjectSt
 
 // =============================================================================================
 
-bool ASF_Support::WriteHeaderObject ( XMP_IO* sourceRef, XMP_IO* destRef, const ObjectData& object, ASF_LegacyManager& _legacyManager, bool usePadding )
+bool ASF_Support::ComposeHeaderObject ( XMP_IO* sourceRef, const ObjectData& object, ASF_LegacyManager& _legacyManager,
+										 bool usePadding, XMP_Uns64 minLength, std::string* newHeader )
 {
 	if ( ! IsEqualGUID ( ASF_Header_Object, object.guid ) ) return false;
 
@@ -643,8 +644,8 @@ bool ASF_Support::WriteHeaderObject ( XMP_IO* sourceRef, XMP_IO* destRef, const
 		}
 
 		// create padding object ?
-		if ( usePadding && (header.size ( ) < object.len ) ) {
-			ASF_Support::CreatePaddingObject ( &header, (object.len - header.size()) );
+		if ( usePadding && (header.size ( ) < minLength ) ) {
+			ASF_Support::CreatePaddingObject ( &header, (minLength - header.size()) );
 			writtenObjects ++;
 		}
 
@@ -658,6 +659,28 @@ bool ASF_Support::WriteHeaderObject ( XMP_IO* sourceRef, XMP_IO* destRef, const
 		newValue = std::string ( (const char*)&valueUns32LE, 4 );
 		ReplaceString ( header, newValue, 24, 4 );
 
+		newHeader->swap ( header );
+
+	} catch ( ... ) {
+
+		return false;
+
+	}
+
+	return true;
+
+}
+
+// =============================================================================================
+
+bool ASF_Support::WriteHeaderObject ( XMP_IO* sourceRef, XMP_IO* destRef, const ObjectData& object, ASF_LegacyManager& _legacyManager, bool usePadding )
+{
+	std::string header;
+
+	if ( ! this->ComposeHeaderObject ( sourceRef, object, _legacyManager, usePadding, object.len, &header ) ) return false;
+
+	try {
+
 		// if we are operating on the same file (in-place update), place pointer before writing
 		if ( sourceRef == destRef ) destRef->Seek ( object.pos, kXMP_SeekFromStart );
 		if ( this->progressTracker != 0 ) 
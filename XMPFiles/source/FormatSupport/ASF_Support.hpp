@@ -197,6 +197,8 @@ public:
 
 	bool ReadHeaderObject ( XMP_IO* fileRef, ObjectState& inOutObjectState, const ObjectData& newObject );
 	bool WriteHeaderObject ( XMP_IO* sourceRef, XMP_IO* destRef, const ObjectData& object, ASF_LegacyManager& legacyManager, bool usePadding );
+	bool ComposeHeaderObject ( XMP_IO* sourceRef, const ObjectData& object, ASF_LegacyManager& legacyManager,
+							   bool usePadding, XMP_Uns64 minLength, std::string* newHeader );	// Pads to minLength if usePadding.
 	bool UpdateHeaderObject ( XMP_IO* fileRef, const ObjectData& object, ASF_LegacyManager& legacyManager );
 
 	bool UpdateFileSize ( XMP_IO* fileRef );
@@ -232,7 +232,7 @@ void ISOBaseMedia_Manager::FillBoxInfo(const BoxNode & node, BoxInfo * info) con
 // ===========================
 XMP_Uns8 * ISOBaseMedia_Manager::PickContentPtr(const BoxNode & node) const
 {
-	if (node.contentSize == 0) {
+	if ((node.contentSize == 0) || (node.deferredOffset != 0)) {
 		return 0;
 	}
 	else if (node.changed && node.changedContent.size()>0) {
@@ -334,7 +334,7 @@ void ISOBaseMedia_Manager::SetBox(BoxRef theBox, const void* dataPtr, XMP_Uns32
 	XMP_Enforce(size < TopBoxSizeLimit);
 	BoxNode * node = (BoxNode*)theBox;
 
-	if (node->contentSize == size) {
+	if ((node->contentSize == size) && (node->deferredOffset == 0)) {
 		if (node->boxType == ISOMedia::k_uuid && idUUID != 0)
 		{
 			memcpy(node->idUUID, idUUID, 16);
@@ -357,6 +357,7 @@ void ISOBaseMedia_Manager::SetBox(BoxRef theBox, const void* dataPtr, XMP_Uns32
 		memcpy(&node->changedContent[0], dataPtr, size);
 		node->contentSize = size;
 		node->changed = true;
+		node->deferredOffset = 0;
 		if (node->boxType == ISOMedia::k_uuid && idUUID != 0)
 			memcpy(node->idUUID, idUUID, 16);
 		this->subtreeRootNode.changed = true;
@@ -74,6 +74,12 @@ namespace ISOMedia {
 	ISOboxType(k_stsc,0x73747363UL)SEPARATOR \
 	ISOboxType(k_stco,0x7374636FUL)SEPARATOR \
 	ISOboxType(k_co64,0x636F3634UL)SEPARATOR \
+	ISOboxType(k_stts,0x73747473UL)SEPARATOR /* Sample tables, only cached when small.*/ \
+	ISOboxType(k_ctts,0x63747473UL)SEPARATOR \
+	ISOboxType(k_stss,0x73747373UL)SEPARATOR \
+	ISOboxType(k_stsz,0x7374737AUL)SEPARATOR \
+	ISOboxType(k_stz2,0x73747A32UL)SEPARATOR \
+	ISOboxType(k_sdtp,0x73647470UL)SEPARATOR \
 	ISOboxType(k_dinf,0x64696E66UL)SEPARATOR \
 	ISOboxType(k_dref,0x64726566UL)SEPARATOR \
 	ISOboxType(k_alis,0x616C6973UL)SEPARATOR \
@@ -164,7 +170,7 @@ public:
 		XMP_Uns32 boxType;			// In memory as native endian, compares work with ISOMedia::k_* constants.
 		XMP_Uns32 childCount;		// ! A 'meta' box has both content (version/flags) and children!
 		XMP_Uns32 contentSize;		// Does not include the size of nested boxes.
-		const XMP_Uns8 * content;	// Null if contentSize is zero.
+		const XMP_Uns8 * content;	// Null if contentSize is zero or the content is still in the file.
 		XMP_Uns8 idUUID[16];		// ID of the uuid atom if present
 		BoxInfo() : boxType(0), childCount(0), contentSize(0), content(0)
 		{ 
@@ -250,18 +256,19 @@ public:
 		XMP_Uns8 idUUID[16];
 		RawDataBlock changedContent;	// Might be empty even if changed is true.
 		bool changed;	// If true, the content is in changedContent, else in fullSubtree.
+		XMP_Uns64 deferredOffset;	// The file offset of content that was not read, 0 if in memory.
 
-		BoxNode() : offset(0), boxType(0), headerSize(0), contentSize(0), changed(false)
+		BoxNode() : offset(0), boxType(0), headerSize(0), contentSize(0), changed(false), deferredOffset(0)
 		{
 			memset(idUUID, 0, 16);
 		};
 		BoxNode(XMP_Uns32 _offset, XMP_Uns32 _boxType, XMP_Uns32 _headerSize, XMP_Uns32 _contentSize)
-			: offset(_offset), boxType(_boxType), headerSize(_headerSize), contentSize(_contentSize), changed(false)
+			: offset(_offset), boxType(_boxType), headerSize(_headerSize), contentSize(_contentSize), changed(false), deferredOffset(0)
 		{
 			memset(idUUID, 0, 16);
 		};
 		BoxNode(XMP_Uns32 _offset, XMP_Uns32 _boxType, XMP_Uns32 _headerSize, const XMP_Uns8 * _idUUID, XMP_Uns32 _contentSize)
-			: offset(_offset), boxType(_boxType), headerSize(_headerSize), contentSize(_contentSize), changed(false)
+			: offset(_offset), boxType(_boxType), headerSize(_headerSize), contentSize(_contentSize), changed(false), deferredOffset(0)
 		{
 			memcpy(idUUID, _idUUID, 16);
 		};
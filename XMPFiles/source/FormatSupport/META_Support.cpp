@@ -263,6 +263,13 @@ void Meta_Manager::UpdateIlocBoxContent() {
 	XMP_Uns8 ilocVersion = ilocInfo.content[0];
 	if (ilocVersion > 2) //other versions not allowed
 		return;
+
+	// Each field size must be 0, 32, or 64 bits, else the entries would be written with a wrong layout.
+	const size_t fieldSizes[4] = { ilocByteSizesStruct.offsetSize, ilocByteSizesStruct.lengthSize,
+								   ilocByteSizesStruct.baseOffsetSize, ilocByteSizesStruct.indexSize };
+	for (size_t i = 0; i < 4; ++i) {
+		if ((fieldSizes[i] != 0) && (fieldSizes[i] != 32) && (fieldSizes[i] != 64)) return;
+	}
 	
 	// To know the size of changed content
 	XMP_Uns32 newSize = 0;
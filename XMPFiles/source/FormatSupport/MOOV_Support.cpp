@@ -146,6 +146,14 @@ void MOOV_Manager::ParseNestedBoxes ( BoxNode * parentNode, const std::string &
 		else
 			parentNode->children.push_back ( BoxNode ( childOffset, isoInfo.boxType, isoInfo.headerSize, (XMP_Uns32)isoInfo.contentSize ) );
 		BoxNode * newChild = &parentNode->children.back();
+
+		if ( ! this->lazySegments.empty() ) {
+			const LazySegment & segment = this->FindLazySegment ( childOffset );
+			if ( (segment.parsedOffset == childOffset) && (segment.deferredSize != 0) ) {
+				newChild->contentSize = segment.deferredSize;
+				newChild->deferredOffset = segment.fileOffset + isoInfo.headerSize;
+			}
+		}
 		
 		#if TraceParseMoovTree
 			size_t depth = (parentPath.size()+1) / 5;
@@ -178,6 +186,198 @@ void MOOV_Manager::ParseNestedBoxes ( BoxNode * parentNode, const std::string &
 
 }	// MOOV_Manager::ParseNestedBoxes
 
+// =================================================================================================
+// MOOV_Manager::ReadSubtree
+// =========================
+//
+// Fill in fullSubtree from the 'moov' box in the file. The lazy form walks the moov/trak/mdia/minf/
+// stbl path and caches everything else verbatim, except for sample tables that are big enough to be
+// worth leaving in the file. Those are cached as a bare header, ParseNestedBoxes restores the real
+// content size and notes where the content is. The caller has checked the full size if it matters.
+
+static const XMP_Uns32 kMinDeferredSize = 4*1024;	// Smaller sample tables are simply cached.
+
+void MOOV_Manager::ReadSubtree ( XMP_IO* fileRef, XMP_Uns64 moovOffset, XMP_Uns64 moovSize, bool deferSampleTables )
+{
+	this->fullSubtree.clear();
+	this->lazySegments.clear();
+
+	if ( ! deferSampleTables ) {
+		XMP_Enforce ( moovSize < TopBoxSizeLimit );
+		this->fullSubtree.assign ( (XMP_Uns32)moovSize, 0 );
+		fileRef->Seek ( moovOffset, kXMP_SeekFromStart );
+		fileRef->Read ( &this->fullSubtree[0], (XMP_Uns32)moovSize );
+		return;
+	}
+
+	(void) this->AppendLazyBox ( fileRef, moovOffset, (moovOffset + moovSize), 0 );
+
+	#if TraceParseMoovTree
+		fprintf ( stderr, "Read 'moov' subtree, %d of %lld bytes in %d segments\n",
+				  this->fullSubtree.size(), moovSize, this->lazySegments.size() );
+	#endif
+
+}	// MOOV_Manager::ReadSubtree
+
+// =================================================================================================
+// MOOV_Manager::AppendLazyBox
+// ===========================
+//
+// Append one box from the file to fullSubtree, returning the file offset of the following box. The
+// containers leading to the sample tables are rebuilt from their children, so their size field is
+// patched once the children are appended.
+
+static bool IsSampleTable ( XMP_Uns32 boxType )
+{
+	switch ( boxType ) {
+		case ISOMedia::k_stts :
+		case ISOMedia::k_ctts :
+		case ISOMedia::k_stss :
+		case ISOMedia::k_stsz :
+		case ISOMedia::k_stz2 :
+		case ISOMedia::k_stsc :
+		case ISOMedia::k_stco :
+		case ISOMedia::k_co64 :
+		case ISOMedia::k_sdtp : return true;
+		default               : return false;
+	}
+}	// IsSampleTable
+
+XMP_Uns64 MOOV_Manager::AppendLazyBox ( XMP_IO* fileRef, XMP_Uns64 boxOffset, XMP_Uns64 boxLimit, XMP_Uns32 parentType )
+{
+	ISOMedia::BoxInfo isoInfo;
+	XMP_Uns64 nextOffset = ISOMedia::GetBoxInfo ( fileRef, boxOffset, boxLimit, &isoInfo );
+	XMP_Uns32 parsedOffset = (XMP_Uns32) this->fullSubtree.size();
+
+	bool isContainer = false;
+	if ( isoInfo.headerSize >= 8 ) {
+		switch ( isoInfo.boxType ) {
+			case ISOMedia::k_moov : isContainer = (parentType == 0); break;
+			case ISOMedia::k_trak : isContainer = (parentType == ISOMedia::k_moov); break;
+			case ISOMedia::k_mdia : isContainer = (parentType == ISOMedia::k_trak); break;
+			case ISOMedia::k_minf : isContainer = (parentType == ISOMedia::k_mdia); break;
+			case ISOMedia::k_stbl : isContainer = (parentType == ISOMedia::k_minf); break;
+		}
+	}
+
+	bool isDeferred = (parentType == ISOMedia::k_stbl) && (isoInfo.headerSize == 8) &&
+					  IsSampleTable ( isoInfo.boxType ) &&
+					  (kMinDeferredSize <= isoInfo.contentSize) && (isoInfo.contentSize < TopBoxSizeLimit);
+
+	if ( isDeferred ) {
+
+		this->lazySegments.push_back ( LazySegment ( parsedOffset, (XMP_Uns32)isoInfo.contentSize, boxOffset ) );
+		this->fullSubtree.insert ( this->fullSubtree.end(), 8, 0 );
+		PutUns32BE ( 8, &this->fullSubtree[parsedOffset] );
+		PutUns32BE ( isoInfo.boxType, &this->fullSubtree[parsedOffset+4] );
+
+		return nextOffset;
+
+	}
+
+	// Read the whole box, or just the header of a container. Start a new segment unless the bytes
+	// are contiguous in the file with the previous segment.
+
+	XMP_Uns64 readSize = (isContainer ? isoInfo.headerSize : (nextOffset - boxOffset));
+	XMP_Enforce ( (parsedOffset + readSize) < TopBoxSizeLimit );
+
+	bool isContiguous = false;
+	if ( ! this->lazySegments.empty() ) {
+		const LazySegment & prevSegment = this->lazySegments.back();
+		isContiguous = (prevSegment.deferredSize == 0) &&
+					   ((prevSegment.fileOffset + (parsedOffset - prevSegment.parsedOffset)) == boxOffset);
+	}
+	if ( ! isContiguous ) this->lazySegments.push_back ( LazySegment ( parsedOffset, 0, boxOffset ) );
+
+	this->fullSubtree.insert ( this->fullSubtree.end(), (size_t)readSize, 0 );
+	fileRef->Seek ( boxOffset, kXMP_SeekFromStart );
+	fileRef->ReadAll ( &this->fullSubtree[parsedOffset], (XMP_Uns32)readSize );
+
+	if ( isContainer ) {
+
+		XMP_Uns64 childOffset = boxOffset + isoInfo.headerSize;
+		while ( childOffset < nextOffset ) {
+			childOffset = this->AppendLazyBox ( fileRef, childOffset, nextOffset, isoInfo.boxType );
+		}
+
+		XMP_Uns32 newSize = (XMP_Uns32)this->fullSubtree.size() - parsedOffset;
+		if ( isoInfo.headerSize == 8 ) {
+			PutUns32BE ( newSize, &this->fullSubtree[parsedOffset] );
+		} else {
+			XMP_Assert ( isoInfo.headerSize == 16 );
+			PutUns64BE ( newSize, &this->fullSubtree[parsedOffset+8] );
+		}
+
+	}
+
+	return nextOffset;
+
+}	// MOOV_Manager::AppendLazyBox
+
+// =================================================================================================
+// MOOV_Manager::FindLazySegment
+// =============================
+//
+// Find the last segment starting at or before the parsed offset. The first segment is always the
+// 'moov' header at offset 0.
+
+const MOOV_Manager::LazySegment & MOOV_Manager::FindLazySegment ( XMP_Uns32 parsedOffset ) const
+{
+	XMP_Assert ( (! this->lazySegments.empty()) && (this->lazySegments[0].parsedOffset == 0) );
+
+	size_t low = 0, high = this->lazySegments.size();
+	while ( (high - low) > 1 ) {
+		size_t mid = low + (high - low) / 2;
+		if ( this->lazySegments[mid].parsedOffset <= parsedOffset ) {
+			low = mid;
+		} else {
+			high = mid;
+		}
+	}
+
+	return this->lazySegments[low];
+
+}	// MOOV_Manager::FindLazySegment
+
+// =================================================================================================
+// MOOV_Manager::LoadDeferredContent
+// =================================
+//
+// Read content that was left in the file. It goes into changedContent, without marking the subtree
+// as changed.
+
+void MOOV_Manager::LoadDeferredContent ( XMP_IO* fileRef, BoxRef theBox )
+{
+	XMP_Assert ( theBox != 0 );
+	BoxNode * node = (BoxNode*)theBox;
+	if ( node->deferredOffset == 0 ) return;
+
+	node->changedContent.assign ( node->contentSize, 0 );
+	fileRef->Seek ( node->deferredOffset, kXMP_SeekFromStart );
+	fileRef->ReadAll ( &node->changedContent[0], node->contentSize );
+
+	node->changed = true;
+	node->deferredOffset = 0;
+
+}	// MOOV_Manager::LoadDeferredContent
+
+// =================================================================================================
+// MOOV_Manager::GetOriginalOffset
+// ===============================
+
+XMP_Uns64 MOOV_Manager::GetOriginalOffset ( BoxRef ref ) const
+{
+	XMP_Assert ( ref != 0 );
+	const BoxNode & node = *((BoxNode*)ref);
+
+	if ( node.changed ) return 0;
+	if ( this->lazySegments.empty() ) return node.offset;
+
+	const LazySegment & segment = this->FindLazySegment ( node.offset );
+	return (segment.fileOffset - this->lazySegments[0].fileOffset) + (node.offset - segment.parsedOffset);
+
+}	// MOOV_Manager::GetOriginalOffset
+
 
 
 
@@ -263,7 +463,7 @@ XMP_Uns32 MOOV_Manager::NewSubtreeSize ( const BoxNode & node, const std::string
 #endif
 
 XMP_Uns8 * MOOV_Manager::AppendNewSubtree ( const BoxNode & node, const std::string & parentPath,
-											XMP_Uns8 * newPtr, XMP_Uns8 * newEnd )
+											XMP_Uns8 * newPtr, XMP_Uns8 * newEnd, XMP_IO* fileRef )
 {
 	if ( (node.boxType == ISOMedia::k_free) || (node.boxType == ISOMedia::k_wide) ) {
 	}
@@ -293,8 +493,14 @@ XMP_Uns8 * MOOV_Manager::AppendNewSubtree ( const BoxNode & node, const std::str
 		IncrNewPtr ( 16 );
 	}
 	if ( node.contentSize != 0 ) {
-		const XMP_Uns8 * content = PickContentPtr( node );
-		memcpy ( newPtr, content, node.contentSize );
+		if ( node.deferredOffset != 0 ) {
+			XMP_Enforce ( fileRef != 0 );	// Copy content that was left in the file.
+			fileRef->Seek ( node.deferredOffset, kXMP_SeekFromStart );
+			fileRef->ReadAll ( newPtr, node.contentSize );
+		} else {
+			const XMP_Uns8 * content = PickContentPtr( node );
+			memcpy ( newPtr, content, node.contentSize );
+		}
 		IncrNewPtr ( node.contentSize );
 	}
 	
@@ -309,7 +515,7 @@ XMP_Uns8 * MOOV_Manager::AppendNewSubtree ( const BoxNode & node, const std::str
 		std::string nodePath = parentPath + suffix;
 		
 		for ( size_t i = 0, limit = node.children.size(); i < limit; ++i ) {
-			newPtr = this->AppendNewSubtree ( node.children[i], nodePath, newPtr, newEnd );
+			newPtr = this->AppendNewSubtree ( node.children[i], nodePath, newPtr, newEnd, fileRef );
 		}
 
 	}
@@ -325,8 +531,10 @@ XMP_Uns8 * MOOV_Manager::AppendNewSubtree ( const BoxNode & node, const std::str
 // =================================================================================================
 // MOOV_Manager::UpdateMemoryTree
 // ==============================
+//
+// Content left in the file by ReadSubtree is copied from fileRef, the new fullSubtree is complete.
 
-void MOOV_Manager::UpdateMemoryTree()
+void MOOV_Manager::UpdateMemoryTree ( XMP_IO* fileRef /* = 0 */ )
 {
 	if ( ! this->IsChanged() ) return;
 	
@@ -344,10 +552,11 @@ void MOOV_Manager::UpdateMemoryTree()
 		newOrigin = newPtr;
 	#endif
 	
-	XMP_Uns8 * trueEnd = this->AppendNewSubtree ( this->subtreeRootNode, "", newPtr, newEnd );
+	XMP_Uns8 * trueEnd = this->AppendNewSubtree ( this->subtreeRootNode, "", newPtr, newEnd, fileRef );
 	XMP_Enforce ( trueEnd == newEnd );
 	
 	this->fullSubtree.swap ( newData );
+	this->lazySegments.clear();
 	this->ParseMemoryTree ( this->fileMode );
 	
 }	// MOOV_Manager::UpdateMemoryTree
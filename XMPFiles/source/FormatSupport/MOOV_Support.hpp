@@ -53,10 +53,22 @@ public:
 
 
 	// ---------------------------------------------------------------------------------------------
+	// ReadSubtree - Fill in fullSubtree from the file. If deferSampleTables is true, large 'stbl'
+	//   sample tables are left in the file and only their headers are cached.
+	// LoadDeferredContent - Read the content of a box that was left in the file.
+	// GetOriginalOffset - Get the box's offset within the 'moov' box in the file, 0 if changed.
 
+	void ReadSubtree ( XMP_IO* fileRef, XMP_Uns64 moovOffset, XMP_Uns64 moovSize, bool deferSampleTables );
+	void LoadDeferredContent ( XMP_IO* fileRef, BoxRef theBox );
+	bool HasDeferredContent() const { return (! this->lazySegments.empty()); };
+
+	XMP_Uns64 GetOriginalOffset ( BoxRef ref ) const;
+
+	// ---------------------------------------------------------------------------------------------
+	// The fileRef is needed by UpdateMemoryTree if any content was left in the file.
 
 	void ParseMemoryTree ( XMP_Uns8 fileMode );
-	void UpdateMemoryTree();
+	void UpdateMemoryTree ( XMP_IO* fileRef = 0 );
 
 	// ---------------------------------------------------------------------------------------------
 
@@ -136,12 +148,29 @@ private:
 
 	
 	XMP_Uns8 fileMode;
-	
+
+	// A lazily read fullSubtree is a sequence of segments, each mapping a run of cached bytes back
+	// to the file. A deferred segment is just the header of a box whose content stayed in the file.
+	// The vector is empty if fullSubtree is a straight copy of the 'moov' box.
+
+	struct LazySegment {
+		XMP_Uns32 parsedOffset;	// The offset in fullSubtree.
+		XMP_Uns32 deferredSize;	// The content size left in the file, 0 if the bytes were read.
+		XMP_Uns64 fileOffset;	// The offset of the same bytes in the file.
+		LazySegment ( XMP_Uns32 _parsedOffset, XMP_Uns32 _deferredSize, XMP_Uns64 _fileOffset )
+			: parsedOffset(_parsedOffset), deferredSize(_deferredSize), fileOffset(_fileOffset) {};
+	};
+
+	std::vector<LazySegment> lazySegments;
+
+	XMP_Uns64 AppendLazyBox ( XMP_IO* fileRef, XMP_Uns64 boxOffset, XMP_Uns64 boxLimit, XMP_Uns32 parentType );
+	const LazySegment & FindLazySegment ( XMP_Uns32 parsedOffset ) const;
+
 	void ParseNestedBoxes ( BoxNode * parentNode, const std::string & parentPath, bool ignoreMetaBoxes );
 
 	XMP_Uns32  NewSubtreeSize ( const BoxNode & node, const std::string & parentPath );
 	XMP_Uns8 * AppendNewSubtree ( const BoxNode & node, const std::string & parentPath,
-										 XMP_Uns8 * newPtr, XMP_Uns8 * newEnd );
+										 XMP_Uns8 * newPtr, XMP_Uns8 * newEnd, XMP_IO* fileRef );
 
 };	// MOOV_Manager
 
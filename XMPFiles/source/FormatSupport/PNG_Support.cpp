@@ -12,97 +12,35 @@
 #include "XMPFiles/source/FormatSupport/PNG_Support.hpp"
 
 #include "source/XIO.hpp"
+#include "source/CRC32.hpp"
 
 #include <string.h>
 
 typedef std::basic_string<unsigned char> filebuffer;
 
-namespace CRC
-{
-    /* Table of CRCs of all 8-bit messages. */
-    static unsigned long crc_table[256];
-    
-    /* Flag: has the table been computed? Initially false. */
-    static int crc_table_computed = 0;
-    
-    /* Make the table for a fast CRC. */
-    static void make_crc_table(void)
-    {
-        unsigned long c;
-        int n, k;
-        
-        for (n = 0; n < 256; n++)
-        {
-            c = (unsigned long) n;
-            for (k = 0; k < 8; k++)
-            {
-                if (c & 1)
-                {
-                    c = 0xedb88320L ^ (c >> 1);
-                }
-                else
-                {
-                    c = c >> 1;
-                }
-            }
-            crc_table[n] = c;
-        }
-        crc_table_computed = 1;
-    }
-    
-    /* Update a running CRC with the bytes buf[0..len-1]--the CRC
-     should be initialized to all 1's, and the transmitted value
-     is the 1's complement of the final running CRC (see the
-     crc() routine below). */
-    
-    static unsigned long update_crc(unsigned long crc, unsigned char *buf, int len)
-    {
-        unsigned long c = crc;
-        int n;
-        
-        if (!crc_table_computed)
-        {
-            make_crc_table();
-        }
-        
-        for (n = 0; n < len; n++)
-        {
-            c = crc_table[(c ^ buf[n]) & 0xff] ^ (c >> 8);
-        }
-        
-        return c;
-    }
-    
-    /* Return the CRC of the bytes buf[0..len-1]. */
-    static unsigned long crc(unsigned char *buf, int len)
-    {
-        return update_crc(0xffffffffL, buf, len) ^ 0xffffffffL;
-    }
-} // namespace CRC
-
 namespace PNG_Support
 {
     enum chunkType {
         // Critical chunks - (shall appear in this order, except PLTE is optional)
-        IHDR = *((const char*)"IHDR"),
-        PLTE = *((const char*)"PLTE"),
-        IDAT = *((const char*)"IDAT"),
-        IEND = *((const char*)"IEND"),
+        IHDR = 0x49484452,	// "IHDR"
+        PLTE = 0x504C5445,	// "PLTE"
+        IDAT = 0x49444154,	// "IDAT"
+        IEND = 0x49454E44,	// "IEND"
         // Ancillary chunks - (need not appear in this order)
-        cHRM = *((const char*)"cHRM"),
-        gAMA = *((const char*)"gAMA"),
-        iCCP = *((const char*)"iCCP"),
-        sBIT = *((const char*)"sBIT"),
-        sRGB = *((const char*)"sRGB"),
-        bKGD = *((const char*)"bKGD"),
-        hIST = *((const char*)"hIST"),
-        tRNS = *((const char*)"tRNS"),
-        pHYs = *((const char*)"pHYs"),
-        sPLT = *((const char*)"sPLT"),
-        tIME = *((const char*)"tIME"),
-        iTXt = *((const char*)"iTXt"),
-        tEXt = *((const char*)"tEXt"),
-        zTXt = *((const char*)"zTXt")
+        cHRM = 0x6348524D,	// "cHRM"
+        gAMA = 0x67414D41,	// "gAMA"
+        iCCP = 0x69434350,	// "iCCP"
+        sBIT = 0x73424954,	// "sBIT"
+        sRGB = 0x73524742,	// "sRGB"
+        bKGD = 0x624B4744,	// "bKGD"
+        hIST = 0x68495354,	// "hIST"
+        tRNS = 0x74524E53,	// "tRNS"
+        pHYs = 0x70485973,	// "pHYs"
+        sPLT = 0x73504C54,	// "sPLT"
+        tIME = 0x74494D45,	// "tIME"
+        iTXt = 0x69545874,	// "iTXt"
+        tEXt = 0x74455874,	// "tEXt"
+        zTXt = 0x7A545874	// "zTXt"
         
     };
     
@@ -304,6 +242,7 @@ namespace PNG_Support
         if(bufferLength >= chunkLength)
         {
             packetStr.assign((char*)buffer , chunkLength);
+            xmpOffset = filePosition + 8 + ITXT_HEADER_LEN;
         }
         else
         {
@@ -504,7 +443,7 @@ namespace PNG_Support
     
     unsigned long CalculateCRC( unsigned char* inBuffer, XMP_Uns32 len )
     {
-        return CRC::update_crc(0xffffffffL, inBuffer, len) ^ 0xffffffffL;
+        return CRC32::Compute ( inBuffer, len );
     }
     
 } // namespace PNG_Support
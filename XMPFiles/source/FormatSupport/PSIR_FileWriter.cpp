@@ -379,19 +379,15 @@ void PSIR_FileWriter::ParseFileResources ( XMP_IO* fileRef, XMP_Uns32 length )
 }	// PSIR_FileWriter::ParseFileResources
 
 // =================================================================================================
-// PSIR_FileWriter::UpdateMemoryResources
-// ======================================
+// PSIR_FileWriter::GetUpdatedLength
+// =================================
 
-XMP_Uns32 PSIR_FileWriter::UpdateMemoryResources ( void** dataPtr )
+XMP_Uns32 PSIR_FileWriter::GetUpdatedLength() const
 {
-	if ( this->fileParsed ) XMP_Throw ( "Not memory based", kXMPErr_EnforceFailure );
-
-	// Compute the size and allocate the new image resource block.
-
 	XMP_Uns32 newLength = 0;
 
-	InternalRsrcMap::iterator irPos = this->imgRsrcs.begin();
-	InternalRsrcMap::iterator irEnd = this->imgRsrcs.end();
+	InternalRsrcMap::const_iterator irPos = this->imgRsrcs.begin();
+	InternalRsrcMap::const_iterator irEnd = this->imgRsrcs.end();
 
 	for ( ; irPos != irEnd; ++irPos ) {	// Add in the lengths for the 8BIM resources.
 		const InternalRsrcInfo & rsrcInfo = irPos->second;
@@ -409,6 +405,25 @@ XMP_Uns32 PSIR_FileWriter::UpdateMemoryResources ( void** dataPtr )
 		newLength += this->otherRsrcs[i].rsrcLength;
 	}
 
+	return newLength;
+
+}	// PSIR_FileWriter::GetUpdatedLength
+
+// =================================================================================================
+// PSIR_FileWriter::UpdateMemoryResources
+// ======================================
+
+XMP_Uns32 PSIR_FileWriter::UpdateMemoryResources ( void** dataPtr )
+{
+	if ( this->fileParsed ) XMP_Throw ( "Not memory based", kXMPErr_EnforceFailure );
+
+	// Compute the size and allocate the new image resource block.
+
+	XMP_Uns32 newLength = this->GetUpdatedLength();
+
+	InternalRsrcMap::iterator irPos;
+	InternalRsrcMap::iterator irEnd = this->imgRsrcs.end();
+
 	XMP_Uns8* newContent = (XMP_Uns8*) malloc ( newLength );
 	if ( newContent == 0 ) XMP_Throw ( "Out of memory", kXMPErr_NoMemory );
 
@@ -607,3 +622,83 @@ XMP_Uns32 PSIR_FileWriter::UpdateFileResources ( XMP_IO* sourceRef, XMP_IO* dest
 	return destLength;
 
 }	// PSIR_FileWriter::UpdateFileResources
+
+// =================================================================================================
+// PSIR_FileWriter::UpdateFileResourcesInPlace
+// ===========================================
+//
+// The new section is composed in memory, including the length field, and written with one call.
+// This keeps the resource order of UpdateFileResources, the 8BIM resources by ID then the others.
+// The internal map is kept with the new offsets instead of being reparsed, the captured data stays
+// put. That matters, the Exif in a PSD is parsed from the PSIR's copy without being copied.
+
+void PSIR_FileWriter::UpdateFileResourcesInPlace ( XMP_IO* fileRef, XMP_Int64 sectionOffset )
+{
+	if ( this->memParsed ) XMP_Throw ( "Not file based", kXMPErr_EnforceFailure );
+
+	XMP_Uns32 newLength = this->GetUpdatedLength();
+	RawDataBlock newSection ( 4 + newLength );
+	XMP_Uns8* sectionPtr = &newSection[0];
+	XMP_Uns8* rsrcPtr = sectionPtr;
+
+	PutUns32BE ( newLength, rsrcPtr );
+	rsrcPtr += 4;
+
+	InternalRsrcMap::iterator rsrcPos = this->imgRsrcs.begin();
+	InternalRsrcMap::iterator rsrcEnd = this->imgRsrcs.end();
+
+	for ( ; rsrcPos != rsrcEnd; ++rsrcPos ) {
+
+		InternalRsrcInfo& currRsrc = rsrcPos->second;
+
+		PutUns32BE ( k8BIM, rsrcPtr );
+		PutUns16BE ( currRsrc.id, rsrcPtr+4 );
+		rsrcPtr += 6;
+
+		if ( currRsrc.rsrcName == 0 ) {
+			PutUns16BE ( 0, rsrcPtr );
+			rsrcPtr += 2;
+		} else {
+			XMP_Uns16 nameLen = currRsrc.rsrcName[0];
+			XMP_Assert ( nameLen > 0 );
+			XMP_Uns16 paddedLen = (nameLen + 2) & 0xFFFE;	// ! Round up to an even total. Yes, +2!
+			memcpy ( rsrcPtr, currRsrc.rsrcName, paddedLen );	// AUDIT: Safe, counted by GetUpdatedLength.
+			rsrcPtr += paddedLen;
+		}
+
+		PutUns32BE ( currRsrc.dataLen, rsrcPtr );
+		rsrcPtr += 4;
+
+		if ( currRsrc.dataPtr != 0 ) {
+			memcpy ( rsrcPtr, currRsrc.dataPtr, currRsrc.dataLen );	// AUDIT: Safe, counted by GetUpdatedLength.
+		} else {
+			fileRef->Seek ( currRsrc.origOffset, kXMP_SeekFromStart );
+			fileRef->ReadAll ( rsrcPtr, currRsrc.dataLen );
+		}
+		currRsrc.origOffset = (XMP_Uns32) (sectionOffset + (rsrcPtr - sectionPtr));
+		currRsrc.changed = false;
+		rsrcPtr += currRsrc.dataLen;
+
+		if ( (currRsrc.dataLen & 1) != 0 ) {
+			*rsrcPtr = 0;	// ! Pad the data to an even length.
+			++rsrcPtr;
+		}
+
+	}
+
+	for ( size_t i = 0; i < this->otherRsrcs.size(); ++i ) {	// Alignment padding is already included.
+		fileRef->Seek ( this->otherRsrcs[i].rsrcOffset, kXMP_SeekFromStart );
+		fileRef->ReadAll ( rsrcPtr, this->otherRsrcs[i].rsrcLength );
+		this->otherRsrcs[i].rsrcOffset = (XMP_Uns32) (sectionOffset + (rsrcPtr - sectionPtr));
+		rsrcPtr += this->otherRsrcs[i].rsrcLength;
+	}
+
+	XMP_Assert ( rsrcPtr == (sectionPtr + newSection.size()) );
+
+	fileRef->Seek ( sectionOffset, kXMP_SeekFromStart );
+	fileRef->Write ( sectionPtr, (XMP_Uns32)newSection.size() );
+
+	this->changed = false;
+	this->legacyDeleted = false;
+
+}	// PSIR_FileWriter::UpdateFileResourcesInPlace
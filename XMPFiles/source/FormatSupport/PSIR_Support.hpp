@@ -236,6 +236,16 @@ public:
 									  XMP_AbortProc abortProc, void * abortArg,
 									  XMP_ProgressTracker* progressTracker );
 
+	// GetUpdatedLength returns the length the image resources will have after an update, without
+	// the section's length field. UpdateFileResourcesInPlace rewrites the image resources of a file
+	// parse where they are, sectionOffset is the offset of the section's length field. The client
+	// must have made room for any growth. Resources can shift within the section, those that were
+	// not captured are read from their old place first. Afterwards the offsets describe the new
+	// layout and nothing is marked as changed.
+
+	XMP_Uns32 GetUpdatedLength() const;
+	void      UpdateFileResourcesInPlace ( XMP_IO* fileRef, XMP_Int64 sectionOffset );
+
 	PSIR_FileWriter() : changed(false), legacyDeleted(false), memParsed(false), fileParsed(false),
 						ownedContent(false), memLength(0), memContent(0) {};
 
@@ -0,0 +1,28 @@
+// =================================================================================================
+// Copyright Adobe
+// Copyright 2024 Adobe
+// All Rights Reserved
+//
+// NOTICE:  Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it. 
+// =================================================================================================
+
+#include "public/include/XMP_Environment.h"	// ! XMP_Environment.h must be the first included header.
+#include "public/include/XMP_Const.h"
+
+#include "XMPFiles/source/FormatSupport/PaddingReserve.hpp"
+
+// =================================================================================================
+// PaddingReserve
+// ==============
+
+XMP_Uns64 PaddingReserve ( const PaddingPolicy & policy, XMP_Uns64 size, XMP_Uns64 growth )
+{
+	XMP_Uns64 reserve = (size / 100) * policy.percent + ((size % 100) * policy.percent) / 100;
+	if ( reserve < 2*growth ) reserve = 2*growth;
+	if ( reserve < policy.minReserve ) reserve = policy.minReserve;
+	if ( reserve > policy.maxReserve ) reserve = policy.maxReserve;
+	if ( policy.granule > 1 ) reserve -= (reserve % policy.granule);
+	if ( reserve < policy.minUsable ) reserve = 0;
+	return reserve;
+}	// PaddingReserve
@@ -0,0 +1,37 @@
+#ifndef __PaddingReserve_hpp__
+#define __PaddingReserve_hpp__ 1
+
+// =================================================================================================
+// Copyright Adobe
+// Copyright 2024 Adobe
+// All Rights Reserved
+//
+// NOTICE:  Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it. 
+// =================================================================================================
+
+#include "public/include/XMP_Environment.h"	// ! XMP_Environment.h must be the first included header.
+#include "public/include/XMP_Const.h"
+
+// =================================================================================================
+/// \file PaddingReserve.hpp
+/// \brief The padding reserved when metadata is rewritten in place and has to grow.
+///
+/// A handler that has to grow its metadata within the live file leaves padding behind it, so that
+/// later edits are absorbed in place instead of moving the file contents again. The reserve is a
+/// percentage of the metadata size, at least twice the growth of the current edit so that metadata
+/// that keeps growing gets more room each time, and within a minimum and maximum. Each format has
+/// its own policy.
+// =================================================================================================
+
+struct PaddingPolicy {
+	XMP_Uns64 minReserve;	// The reserve is at least this.
+	XMP_Uns64 maxReserve;	// The reserve is at most this, 0 turns the reserve off.
+	XMP_Uns32 percent;		// The percentage of the metadata size.
+	XMP_Uns32 minUsable;	// A smaller reserve is dropped, e.g. if it can't hold a padding object.
+	XMP_Uns32 granule;		// The reserve is a multiple of this, 0 or 1 for any size.
+};
+
+XMP_Uns64 PaddingReserve ( const PaddingPolicy & policy, XMP_Uns64 size, XMP_Uns64 growth = 0 );
+
+#endif	// __PaddingReserve_hpp__
@@ -1279,10 +1279,165 @@ XMP_Uns32 TIFF_FileWriter::DetermineVisibleLength()
 // An IFD grows if it has more tags than before.
 #define DoesIFDGrow(ifd)	(this->containedIFDs[ifd].origCount < this->containedIFDs[ifd].tagMap.size())
 
+// =================================================================================================
+// AddFreeExtent, RemoveUsedExtent, and TakeFreeExtent
+// ===================================================
+//
+// Utilities for the map of holes used by UpdateFileStream. Adjacent or overlapping holes are
+// merged. TakeFreeExtent does a best fit and returns an even offset, as TIFF requires.
+
+static void AddFreeExtent ( TIFF_FileWriter::FreeExtentMap * freeExtents, XMP_Uns32 offset, XMP_Uns32 length )
+{
+	if ( length == 0 ) return;
+	XMP_Uns32 limit = offset + length;
+
+	TIFF_FileWriter::FreeExtentMap::iterator nextHole = freeExtents->lower_bound ( offset );
+
+	if ( nextHole != freeExtents->begin() ) {
+		TIFF_FileWriter::FreeExtentMap::iterator prevHole = nextHole;
+		--prevHole;
+		XMP_Uns32 prevLimit = prevHole->first + prevHole->second;
+		if ( prevLimit >= offset ) {
+			offset = prevHole->first;
+			if ( prevLimit > limit ) limit = prevLimit;
+			freeExtents->erase ( prevHole );
+		}
+	}
+
+	while ( (nextHole != freeExtents->end()) && (nextHole->first <= limit) ) {
+		XMP_Uns32 nextLimit = nextHole->first + nextHole->second;
+		if ( nextLimit > limit ) limit = nextLimit;
+		freeExtents->erase ( nextHole++ );
+	}
+
+	(*freeExtents)[offset] = limit - offset;
+
+}	// AddFreeExtent
+
+static void RemoveUsedExtent ( TIFF_FileWriter::FreeExtentMap * freeExtents, XMP_Uns32 offset, XMP_Uns32 length )
+{
+	if ( length == 0 ) return;
+	XMP_Uns32 limit = offset + length;
+
+	TIFF_FileWriter::FreeExtentMap::iterator holePos = freeExtents->upper_bound ( offset );
+	if ( holePos != freeExtents->begin() ) --holePos;
+
+	while ( (holePos != freeExtents->end()) && (holePos->first < limit) ) {
+		XMP_Uns32 holeOffset = holePos->first;
+		XMP_Uns32 holeLimit = holeOffset + holePos->second;
+		if ( holeLimit <= offset ) {
+			++holePos;
+			continue;
+		}
+		freeExtents->erase ( holePos++ );
+		if ( holeOffset < offset ) (*freeExtents)[holeOffset] = offset - holeOffset;
+		if ( holeLimit > limit ) (*freeExtents)[limit] = holeLimit - limit;
+	}
+
+}	// RemoveUsedExtent
+
+static bool TakeFreeExtent ( TIFF_FileWriter::FreeExtentMap * freeExtents, XMP_Uns32 length, XMP_Uns32 * offset )
+{
+	TIFF_FileWriter::FreeExtentMap::iterator bestHole = freeExtents->end();
+	XMP_Uns32 bestSlack = 0xFFFFFFFFUL;
+
+	TIFF_FileWriter::FreeExtentMap::iterator holePos = freeExtents->begin();
+	TIFF_FileWriter::FreeExtentMap::iterator holeEnd = freeExtents->end();
+
+	for ( ; holePos != holeEnd; ++holePos ) {
+		XMP_Uns32 skip = holePos->first & 1;	// Skip a byte to get to an even offset.
+		if ( holePos->second < (length + skip) ) continue;
+		XMP_Uns32 slack = holePos->second - (length + skip);
+		if ( slack < bestSlack ) {
+			bestHole = holePos;
+			bestSlack = slack;
+			if ( slack == 0 ) break;
+		}
+	}
+
+	if ( bestHole == holeEnd ) return false;
+
+	XMP_Uns32 holeOffset = bestHole->first;
+	XMP_Uns32 holeLimit = holeOffset + bestHole->second;
+	XMP_Uns32 newOffset = (holeOffset + 1) & 0xFFFFFFFEUL;
+
+	freeExtents->erase ( bestHole );
+	if ( (newOffset + length) < holeLimit ) (*freeExtents)[newOffset + length] = holeLimit - (newOffset + length);
+
+	*offset = newOffset;
+	return true;
+
+}	// TakeFreeExtent
+
+// =================================================================================================
+// TIFF_FileWriter::DetermineFreeExtents
+// =====================================
+//
+// Find the space given up by a file update, using the same decisions as DetermineAppendInfo. This
+// is the old space of growing IFDs and values, of large values that become small, and the unused
+// tail of values that shrink. The thumbnail IFD is found through the primary IFD's link, which is
+// not rewritten, so its old space is not given up. Neither is a MakerNote's, it might contain
+// offsets to itself. Anything still in use is then removed from the holes, in case the file shares
+// space between values.
+
+void TIFF_FileWriter::DetermineFreeExtents ( FreeExtentMap * freeExtents )
+{
+	bool freedIFDs[kTIFF_KnownIFDCount];
+
+	for ( int ifd = 0; ifd < kTIFF_KnownIFDCount; ++ifd ) {
+
+		InternalIFDInfo & thisIFD = this->containedIFDs[ifd];
+
+		freedIFDs[ifd] = (thisIFD.changed && (ifd != kTIFF_TNailIFD) && (thisIFD.origCount > 0) && DoesIFDGrow ( ifd ));
+		if ( freedIFDs[ifd] ) AddFreeExtent ( freeExtents, thisIFD.origIFDOffset, (6 + 12 * thisIFD.origCount) );
+
+		InternalTagMap::iterator tagPos;
+		InternalTagMap::iterator tagEnd = thisIFD.tagMap.end();
+
+		for ( tagPos = thisIFD.tagMap.begin(); tagPos != tagEnd; ++tagPos ) {
+			InternalTagInfo & thisTag = tagPos->second;
+			if ( (! thisTag.changed) || (thisTag.origDataLen <= 4) || (thisTag.id == kTIFF_MakerNote) ) continue;
+			XMP_Uns32 origSpace = (thisTag.origDataLen + 1) & 0xFFFFFFFEUL;	// ! Include the pad byte.
+			if ( (thisTag.dataLen <= 4) || (thisTag.dataLen > thisTag.origDataLen) ) {
+				AddFreeExtent ( freeExtents, thisTag.origDataOffset, origSpace );
+			} else {
+				AddFreeExtent ( freeExtents, (thisTag.origDataOffset + thisTag.dataLen), (origSpace - thisTag.dataLen) );
+			}
+		}
+
+	}
+
+	if ( freeExtents->empty() ) return;
+
+	RemoveUsedExtent ( freeExtents, 0, 8 );	// The TIFF header.
+
+	for ( int ifd = 0; ifd < kTIFF_KnownIFDCount; ++ifd ) {
+
+		InternalIFDInfo & thisIFD = this->containedIFDs[ifd];
+		if ( ! freedIFDs[ifd] ) RemoveUsedExtent ( freeExtents, thisIFD.origIFDOffset, (6 + 12 * thisIFD.origCount) );
+
+		InternalTagMap::iterator tagPos;
+		InternalTagMap::iterator tagEnd = thisIFD.tagMap.end();
+
+		for ( tagPos = thisIFD.tagMap.begin(); tagPos != tagEnd; ++tagPos ) {
+			InternalTagInfo & thisTag = tagPos->second;
+			if ( thisTag.origDataLen <= 4 ) continue;
+			if ( ! thisTag.changed ) {
+				RemoveUsedExtent ( freeExtents, thisTag.origDataOffset, thisTag.origDataLen );
+			} else if ( (thisTag.dataLen > 4) && (thisTag.dataLen <= thisTag.origDataLen) ) {
+				RemoveUsedExtent ( freeExtents, thisTag.origDataOffset, thisTag.dataLen );
+			}
+		}
+
+	}
+
+}	// TIFF_FileWriter::DetermineFreeExtents
+
 XMP_Uns32 TIFF_FileWriter::DetermineAppendInfo ( XMP_Uns32 appendedOrigin,
 												 bool      appendedIFDs[kTIFF_KnownIFDCount],
 												 XMP_Uns32 newIFDOffsets[kTIFF_KnownIFDCount],
-												 bool      appendAll /* = false */ )
+												 bool      appendAll /* = false */,
+												 FreeExtentMap * freeExtents /* = 0 */ )
 {
 	XMP_Uns32 appendedLength = 0;
 	XMP_Assert ( (appendedOrigin & 1) == 0 );	// Make sure it is even.
@@ -1356,8 +1511,11 @@ XMP_Uns32 TIFF_FileWriter::DetermineAppendInfo ( XMP_Uns32 appendedOrigin,
 		if ( tagCount == 0 ) continue;
 
 		if ( appendedIFDs[ifd] ) {
-			newIFDOffsets[ifd] = appendedOrigin + appendedLength;
-			appendedLength += (XMP_Uns32)( 6 + (12 * tagCount) );
+			XMP_Uns32 ifdLength = (XMP_Uns32)( 6 + (12 * tagCount) );
+			if ( (freeExtents == 0) || (! TakeFreeExtent ( freeExtents, ifdLength, &newIFDOffsets[ifd] )) ) {
+				newIFDOffsets[ifd] = appendedOrigin + appendedLength;
+				appendedLength += ifdLength;
+			}
 		}
 
 		InternalTagMap::iterator tagPos = ifdInfo.tagMap.begin();
@@ -1371,8 +1529,13 @@ XMP_Uns32 TIFF_FileWriter::DetermineAppendInfo ( XMP_Uns32 appendedOrigin,
 			if ( (currTag.dataLen <= currTag.origDataLen) && (! appendAll) ) {
 				this->PutUns32 ( currTag.origDataOffset, &currTag.smallValue );	// Reuse the old space.
 			} else {
-				this->PutUns32 ( (appendedOrigin + appendedLength), &currTag.smallValue );	// Set the appended offset.
-				appendedLength += ((currTag.dataLen + 1) & 0xFFFFFFFEUL);	// Round to an even size.
+				XMP_Uns32 valueLength = ((currTag.dataLen + 1) & 0xFFFFFFFEUL);	// Round to an even size.
+				XMP_Uns32 valueOffset;
+				if ( (freeExtents == 0) || (! TakeFreeExtent ( freeExtents, valueLength, &valueOffset )) ) {
+					valueOffset = appendedOrigin + appendedLength;
+					appendedLength += valueLength;
+				}
+				this->PutUns32 ( valueOffset, &currTag.smallValue );	// Set the new or appended offset.
 			}
 
 		}
@@ -1826,6 +1989,11 @@ XMP_Uns32 TIFF_FileWriter::UpdateMemoryStream ( void** dataPtr, bool condenseStr
 //
 // The file being updated must match the file that was previously parsed. Offsets and lengths saved
 // when parsing are used to decide if something can be updated in-place or must be appended.
+//
+// The space given up by growing IFDs and values is tracked in a map of holes. A hole at the end of
+// the file is where the appended part starts, so the last thing in the file grows in-place and the
+// file is truncated if it ends up shorter. When compacting, the other holes are reused for growing
+// IFDs and values before anything is appended. Repeated edits then stop bloating the file.
 
 // *** The general linked structure of TIFF makes it very difficult to process the file in a single
 // *** sequential pass. This implementation uses a simple seek/write model for the in-place updates.
@@ -1840,7 +2008,7 @@ XMP_Uns32 TIFF_FileWriter::UpdateMemoryStream ( void** dataPtr, bool condenseStr
 	#define Trace_UpdateFileStream 0
 #endif
 
-void TIFF_FileWriter::UpdateFileStream ( XMP_IO* fileRef, XMP_ProgressTracker* progressTracker )
+void TIFF_FileWriter::UpdateFileStream ( XMP_IO* fileRef, XMP_ProgressTracker* progressTracker, bool compactFile /* = false */ )
 {
 	if ( this->memParsed ) XMP_Throw ( "Not file based", kXMPErr_EnforceFailure );
 	if ( ! this->changed ) return;
@@ -1855,16 +2023,29 @@ void TIFF_FileWriter::UpdateFileStream ( XMP_IO* fileRef, XMP_ProgressTracker* p
 		printf ( "\nStarting update of TIFF file stream\n" );
 	#endif
 
+	this->PreflightIFDLinkage();
+
+	FreeExtentMap freeExtents;
+	this->DetermineFreeExtents ( &freeExtents );
+
 	XMP_Uns32 appendedOrigin = (XMP_Uns32)origDataLength;
+	if ( ! freeExtents.empty() ) {
+		FreeExtentMap::iterator lastHole = freeExtents.end();
+		--lastHole;
+		if ( (lastHole->first + lastHole->second) == appendedOrigin ) {
+			appendedOrigin = lastHole->first;	// Append over the hole at the end of the file.
+			freeExtents.erase ( lastHole );
+		}
+	}
+	if ( ! compactFile ) freeExtents.clear();
+
 	if ( (appendedOrigin & 1) != 0 ) {
-		++appendedOrigin;	// Start at an even offset.
-		fileRef->Seek ( 0, kXMP_SeekFromEnd  );
+		fileRef->Seek ( appendedOrigin, kXMP_SeekFromStart  );
 		fileRef->Write ( "\0", 1 );
+		++appendedOrigin;	// Start at an even offset.
 	}
 
-	this->PreflightIFDLinkage();
-
-	XMP_Uns32 appendedLength = DetermineAppendInfo ( appendedOrigin, appendedIFDs, newIFDOffsets );
+	XMP_Uns32 appendedLength = DetermineAppendInfo ( appendedOrigin, appendedIFDs, newIFDOffsets, false, &freeExtents );
 	if ( appendedLength > (0xFFFFFFFFUL - appendedOrigin) ) XMP_Throw ( "TIFF files can't exceed 4GB", kXMPErr_BadTIFF );
 
 	if ( progressTracker != 0 ) {
@@ -1931,10 +2112,8 @@ void TIFF_FileWriter::UpdateFileStream ( XMP_IO* fileRef, XMP_ProgressTracker* p
 
 	}
 
-	// Append the IFDs and tag values that grow.
-
-	XMP_Int64 fileEnd = fileRef->Seek ( 0, kXMP_SeekFromEnd  );
-	XMP_Assert ( fileEnd == appendedOrigin );
+	// Append the IFDs and tag values that grow, or put them in holes. The appended ones are written
+	// in order, each one at or before the current end of file.
 
 	for ( int ifd = 0; ifd < kTIFF_KnownIFDCount; ++ifd ) {
 
@@ -1945,7 +2124,8 @@ void TIFF_FileWriter::UpdateFileStream ( XMP_IO* fileRef, XMP_ProgressTracker* p
 			#if Trace_UpdateFileStream
 				printf ( "  Updating IFD %d by append at offset %d (0x%X)\n", ifd, newIFDOffsets[ifd], newIFDOffsets[ifd] );
 			#endif
-			XMP_Assert ( newIFDOffsets[ifd] == fileRef->Length() );
+			XMP_Assert ( newIFDOffsets[ifd] <= fileRef->Length() );
+			fileRef->Seek ( newIFDOffsets[ifd], kXMP_SeekFromStart  );
 			this->WriteFileIFD ( fileRef, thisIFD );
 		}
 
@@ -1955,11 +2135,12 @@ void TIFF_FileWriter::UpdateFileStream ( XMP_IO* fileRef, XMP_ProgressTracker* p
 		for ( tagPos = thisIFD.tagMap.begin(); tagPos != tagEnd; ++tagPos ) {
 			InternalTagInfo & thisTag = tagPos->second;
 			if ( (! thisTag.changed) || (thisTag.dataLen <= 4) || (thisTag.dataLen <= thisTag.origDataLen) ) continue;
+			XMP_Uns32 newOffset = this->GetUns32 ( &thisTag.smallValue );
 			#if Trace_UpdateFileStream
-				XMP_Uns32 newOffset = this->GetUns32(&thisTag.origDataOffset);
 				printf ( "    Updating tag %d in IFD %d by append at offset %d (0x%X)\n", thisTag.id, ifd, newOffset, newOffset );
 			#endif
-			XMP_Assert ( this->GetUns32(&thisTag.smallValue) == fileRef->Length() );
+			XMP_Assert ( newOffset <= fileRef->Length() );
+			fileRef->Seek ( newOffset, kXMP_SeekFromStart  );
 			fileRef->Write ( thisTag.dataPtr, thisTag.dataLen );
 			if ( (thisTag.dataLen & 1) != 0 ) fileRef->Write ( "\0", 1 );
 		}
@@ -2004,6 +2185,11 @@ void TIFF_FileWriter::UpdateFileStream ( XMP_IO* fileRef, XMP_ProgressTracker* p
 
 	}
 
+	// Drop what is left of a hole at the end of the file.
+
+	XMP_Uns32 newDataLength = appendedOrigin + appendedLength;
+	if ( newDataLength < origDataLength ) fileRef->Truncate ( newDataLength );
+
 	this->tiffLength = (XMP_Uns32) fileRef->Length();
 	fileRef->Seek ( 0, kXMP_SeekFromEnd  );	// Can't hurt.
 
@@ -2017,11 +2203,17 @@ void TIFF_FileWriter::UpdateFileStream ( XMP_IO* fileRef, XMP_ProgressTracker* p
 // TIFF_FileWriter::WriteFileIFD
 // =============================
 
+//
+// The IFD is composed in memory and written with one call.
+
 void TIFF_FileWriter::WriteFileIFD ( XMP_IO* fileRef, InternalIFDInfo & thisIFD )
 {
-	XMP_Uns16 tagCount;
-	this->PutUns16 ( (XMP_Uns16)thisIFD.tagMap.size(), &tagCount );
-	fileRef->Write ( &tagCount, 2 );
+	XMP_Uns16 tagCount = (XMP_Uns16)thisIFD.tagMap.size();
+	std::vector<XMP_Uns8> ifdBuffer ( 2 + (12 * tagCount) + 4 );
+	XMP_Uns8* ifdPtr = &ifdBuffer[0];
+
+	this->PutUns16 ( tagCount, ifdPtr );
+	ifdPtr += 2;
 
 	InternalTagMap::iterator tagPos;
 	InternalTagMap::iterator tagEnd = thisIFD.tagMap.end();
@@ -2036,13 +2228,13 @@ void TIFF_FileWriter::WriteFileIFD ( XMP_IO* fileRef, InternalIFDInfo & thisIFD
 		this->PutUns32 ( thisTag.count, &ifdEntry.count );
 		ifdEntry.dataOrOffset = thisTag.smallValue;	// ! Already in stream endianness.
 
-		fileRef->Write ( &ifdEntry, sizeof(ifdEntry) );
 		XMP_Assert ( sizeof(ifdEntry) == 12 );
+		memcpy ( ifdPtr, &ifdEntry, 12 );	// AUDIT: Safe, the buffer has 12 bytes per tag.
+		ifdPtr += 12;
 
 	}
 
-	XMP_Uns32 nextIFD;
-	this->PutUns32 ( thisIFD.origNextIFD, &nextIFD );
-	fileRef->Write ( &nextIFD, 4 );
+	this->PutUns32 ( thisIFD.origNextIFD, ifdPtr );
+	fileRef->Write ( &ifdBuffer[0], (XMP_Uns32)ifdBuffer.size() );
 
 }	// TIFF_FileWriter::WriteFileIFD
@@ -675,10 +675,18 @@ public:
 	// file-based TIFF is the end of the file. This update-by-append model has the advantage of not
 	// perturbing any hidden offsets, a common feature of proprietary MakerNotes.
 	//
+	// \c UpdateFileStream grows things at the end of the file in-place. The compactFile parameter
+	// makes it also put growing IFDs and values into the holes left by this update, instead of
+	// appending them. The space of MakerNotes and chained IFDs is never reused.
+	//
 	// The condenseStream parameter to UpdateMemoryStream can be used to rewrite the full stream
 	// instead of appending. This will discard any MakerNote tags and risks breaking offsets that
 	// are hidden. This can be necessary though to try to make the TIFF fit in a JPEG file.
 	
+	// With copyData false the stream is borrowed and must stay valid as long as the TIFF_Manager. A
+	// TIFF_MemoryReader tweaks the IFD entries of the stream in place, a TIFF_FileWriter copies the
+	// stream if it is updated.
+	//
 	// isAlredyLittle is provided for case when data contain no information about Endianess, So need not to check for header
 	virtual void ParseMemoryStream ( const void* data, XMP_Uns32 length, bool copyData = true, bool isAlreadyLittle = false ) = 0;
 	virtual void ParseFileStream   ( XMP_IO* fileRef ) = 0;
@@ -686,7 +694,7 @@ public:
 	virtual void IntegrateFromPShop6 ( const void * buriedPtr, size_t buriedLen ) = 0;
 
 	virtual XMP_Uns32 UpdateMemoryStream ( void** dataPtr, bool condenseStream = false ) = 0;
-	virtual void      UpdateFileStream   ( XMP_IO* fileRef, XMP_ProgressTracker* progressTracker ) = 0;
+	virtual void      UpdateFileStream   ( XMP_IO* fileRef, XMP_ProgressTracker* progressTracker, bool compactFile = false ) = 0;
 
 	// ---------------------------------------------------------------------------------------------
 
@@ -786,7 +794,7 @@ public:
 	void IntegrateFromPShop6 ( const void * buriedPtr, size_t buriedLen ) { NotAppropriate(); };
 
 	XMP_Uns32 UpdateMemoryStream ( void** dataPtr, bool condenseStream = false ) { if ( dataPtr != 0 ) *dataPtr = tiffStream; return tiffLength; };
-	void      UpdateFileStream   ( XMP_IO* fileRef, XMP_ProgressTracker* progressTracker ) { NotAppropriate(); };
+	void      UpdateFileStream   ( XMP_IO* fileRef, XMP_ProgressTracker* progressTracker, bool compactFile = false ) { NotAppropriate(); };
 
 	TIFF_MemoryReader() : ownedStream(false), tiffStream(0), tiffLength(0) { 
         checkTagLength = true;
@@ -902,7 +910,9 @@ public:
 	void IntegrateFromPShop6 ( const void * buriedPtr, size_t buriedLen );
 
 	XMP_Uns32 UpdateMemoryStream ( void** dataPtr, bool condenseStream = false );
-	void      UpdateFileStream   ( XMP_IO* fileRef, XMP_ProgressTracker* progressTracker );
+	void      UpdateFileStream   ( XMP_IO* fileRef, XMP_ProgressTracker* progressTracker, bool compactFile = false );
+
+	typedef std::map<XMP_Uns32,XMP_Uns32> FreeExtentMap;	// Maps the offset of a hole to its length.
 
 	TIFF_FileWriter();
 
@@ -1011,10 +1021,13 @@ private:
 
 	XMP_Uns32 DetermineVisibleLength();
 
+	void DetermineFreeExtents ( FreeExtentMap * freeExtents );
+
 	XMP_Uns32 DetermineAppendInfo ( XMP_Uns32 appendedOrigin,
 									bool      appendedIFDs[kTIFF_KnownIFDCount],
 									XMP_Uns32 newIFDOffsets[kTIFF_KnownIFDCount],
-									bool      appendAll = false );
+									bool      appendAll = false,
+									FreeExtentMap * freeExtents = 0 );
 
 	void UpdateMemByAppend  ( XMP_Uns8** newStream_out, XMP_Uns32* newLength_out,
 							  bool appendAll = false, XMP_Uns32 extraSpace = 0 );
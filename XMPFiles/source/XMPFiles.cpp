@@ -1583,10 +1583,20 @@ DoPutXMP ( XMPFiles * thiz, const SXMPMeta & xmpObj, const bool doIt )
 
 	if ( handlerFlags & kXMPFiles_UsesSidecarXMP ) tryInPlace = false;
 
+	bool havePacket = false;
+
 	if ( tryInPlace ) {
 		try {
-			xmpObj.SerializeToBuffer ( &xmpPacket, (options | kXMP_ExactPacketLength), (XMP_StringLen) oldPacketLength );
-			XMP_Assert ( xmpPacket.size() == oldPacketLength );
+			std::string overflowPacket;	// ! Only wanted if an out of place update is the fallback.
+			xmpPacket.assign ( oldPacketLength, ' ' );
+			havePacket = xmpObj.SerializeToRegion ( &xmpPacket[0], (XMP_StringLen) oldPacketLength,
+													(preferInPlace ? &overflowPacket : 0), options );
+			if ( ! havePacket ) {
+				if ( ! preferInPlace ) XMP_Throw ( "Can't fit into specified packet size", kXMPErr_BadSerialize );
+				tryInPlace = false;	// ! Out of place this time, the overflow packet is already padded.
+				xmpPacket.swap ( overflowPacket );
+				havePacket = true;
+			}
 		} catch ( ... ) {
 			if ( preferInPlace ) {
 				tryInPlace = false;	// ! Try again, out of place this time.
@@ -1597,7 +1607,7 @@ DoPutXMP ( XMPFiles * thiz, const SXMPMeta & xmpObj, const bool doIt )
 		}
 	}
 
-	if ( ! tryInPlace ) {
+	if ( ! havePacket ) {
 		try {
 			xmpObj.SerializeToBuffer ( &xmpPacket, options );
 		} catch ( ... ) {
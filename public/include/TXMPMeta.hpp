@@ -1519,6 +1519,69 @@ public:
 							 XMP_OptionBits options = 0,
 							 XMP_StringLen  padding = 0 ) const;
 
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c GetSerializedSize() computes the size of the serialized packet without returning it.
+    ///
+    /// The result is the size in bytes of the packet \c SerializeToBuffer() would produce with no
+    /// padding, in the encoding selected by the options. This is the smallest packet length that
+    /// \c #kXMP_ExactPacketLength accepts. When the options call for no padding, such as
+    /// \c #kXMP_OmitPacketWrapper or \c #kXMP_ReadOnlyPacket, it is the size of the serialized
+    /// output. No UTF-16 or UTF-32 conversion is done to compute the size.
+    ///
+    /// @param options The serialization options, as for \c SerializeToBuffer(). The
+    /// \c #kXMP_ExactPacketLength option is ignored.
+    ///
+    /// @param newline The string to be used as a line terminator, as for \c SerializeToBuffer().
+    ///
+    /// @param indent The string to be used for each level of indentation, as for \c SerializeToBuffer().
+    ///
+    /// @param baseIndent The number of levels of indentation for the outermost XML element.
+    ///
+    /// @return The serialized size in bytes.
+
+    XMP_StringLen GetSerializedSize ( XMP_OptionBits options = 0,
+									  XMP_StringPtr  newline = "",
+									  XMP_StringPtr  indent = "",
+									  XMP_Index      baseIndent = 0 ) const;
+
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c SerializeToRegion() serializes into an exact-size region in one pass.
+    ///
+    /// This is the no-exception form of \c SerializeToBuffer() with \c #kXMP_ExactPacketLength,
+    /// meant for in-place file updates. If the packet fits, exactly \c regionSize bytes of packet,
+    /// including padding, are written to the region. If it does not fit the region is not changed,
+    /// and a normally padded packet is returned in \c overflowPacket if that is not null. The RDF
+    /// is serialized only once either way, so a caller can decide between an in-place and a full
+    /// rewrite without a second serialization.
+    ///
+    /// @param region [out] The writable memory to fill. Must not be null unless \c regionSize is zero.
+    ///
+    /// @param regionSize The size of the region in bytes. Must be a multiple of the Unicode code
+    /// unit of the encoding.
+    ///
+    /// @param overflowPacket [out] A string object that receives the packet with default padding
+    /// when it does not fit. Can be null.
+    ///
+    /// @param options The serialization options, as for \c SerializeToBuffer(). The
+    /// \c #kXMP_ExactPacketLength option is implied. The \c #kXMP_OmitPacketWrapper and
+    /// \c #kXMP_IncludeThumbnailPad options are not allowed.
+    ///
+    /// @param newline The string to be used as a line terminator, as for \c SerializeToBuffer().
+    ///
+    /// @param indent The string to be used for each level of indentation, as for \c SerializeToBuffer().
+    ///
+    /// @param baseIndent The number of levels of indentation for the outermost XML element.
+    ///
+    /// @return True if the packet was written to the region, false if it did not fit.
+
+    bool SerializeToRegion ( void *         region,
+							 XMP_StringLen  regionSize,
+							 tStringObj *   overflowPacket = 0,
+							 XMP_OptionBits options = 0,
+							 XMP_StringPtr  newline = "",
+							 XMP_StringPtr  indent = "",
+							 XMP_Index      baseIndent = 0 ) const;
+
     /// @}
     // =============================================================================================
     // Miscellaneous Member Functions
@@ -1609,6 +1672,18 @@ public:
     
     void Erase();
     
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c Reset() restores the object to a "just constructed" state, keeping its storage.
+    ///
+    /// Use this function instead of \c Erase() when the object will be reused for another parse,
+    /// for example by a server handling one packet per request. The property nodes and the capacity
+    /// of their strings are kept and reused by the next \c ParseFromBuffer(), so parsing packets of
+    /// a similar size allocates little or nothing after the first. The storage kept is bounded by
+    /// the last tree that was reset, \c Erase() and the destructor release it. See
+    /// \c TXMPMetaPool for a per-thread pool of reset objects.
+    
+    void Reset();
+    
     // ---------------------------------------------------------------------------------------------
     /// @brief \c Clone() creates a deep copy of an XMP object.
     ///
@@ -1674,6 +1749,23 @@ public:
     /// \brief Not implemented
     void SetObjectOptions ( XMP_OptionBits options );
 
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c GetFingerprint() computes a 64-bit hash of the content of this XMP object.
+    ///
+    /// The fingerprint covers the about URI and every property with its value, options, qualifiers,
+    /// fields, and items. Objects with the same content have the same fingerprint, even if their
+    /// schemas, properties, struct fields, qualifiers, or alt-text items are in a different order.
+    /// A different fingerprint means the content differs, so a client can keep the fingerprint of
+    /// the XMP it read and skip writing the file back if nothing changed. Equal fingerprints are
+    /// not absolute proof of equal content.
+    ///
+    /// The hashes are cached in the object until it is next modified, asking again is cheap.
+    /// Fingerprints are only comparable when computed by the same version of the library.
+    ///
+    /// @return The fingerprint.
+
+    XMP_Uns64 GetFingerprint() const;
+
     /// @}
 
     // =============================================================================================
@@ -1750,4 +1842,83 @@ private:
 
 };  // class TXMPMeta
 
+// =================================================================================================
+/// \class TXMPMetaPool TXMPMeta.hpp
+/// \brief A per-thread pool of reusable XMP objects.
+///
+/// \c TXMPMetaPool keeps XMP objects that were reset with \c TXMPMeta::Reset(), so that a thread
+/// parsing one packet after another reuses the same node storage instead of allocating it again.
+/// Each thread has its own pool, no locking is done. Access these functions through the concrete
+/// class, \c SXMPMetaPool.
+///
+/// \code
+///	{
+///		SXMPMetaPool::Lease meta;
+///		meta->ParseFromBuffer ( packet, packetLen );
+///		meta->GetProperty ( kXMP_NS_XMP, "CreatorTool", &tool, 0 );
+///	}	// The object is reset and returned to the pool here.
+/// \endcode
+///
+/// The objects still pooled when a thread ends are deleted then. Call \c Clear() on every thread
+/// that used the pool before calling \c SXMPMeta::Terminate(), in particular the main thread.
+// =================================================================================================
+
+template <class tStringObj> class TXMPMetaPool {
+
+public:
+
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c Acquire() returns an empty XMP object, from this thread's pool when possible.
+    ///
+    /// @return A pointer to an empty XMP object owned by the caller. Give it back with \c Release().
+
+    static TXMPMeta<tStringObj> * Acquire();
+
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c Release() resets an XMP object and keeps it in this thread's pool.
+    ///
+    /// The object is deleted instead if the pool is at its limit. Do not keep copies of a released
+    /// object, the copies share the internal object that will be reset and reused.
+    ///
+    /// @param xmpObj An object from \c Acquire() or \c new. Null is allowed and ignored.
+
+    static void Release ( TXMPMeta<tStringObj> * xmpObj );
+
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c SetLimit() sets the number of objects kept by this thread's pool, default 16.
+    ///
+    /// @param limit The new limit. Objects over the limit are deleted right away.
+
+    static void SetLimit ( size_t limit );
+
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c Clear() deletes the objects kept by this thread's pool.
+
+    static void Clear();
+
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c Lease holds an object from \c Acquire() and releases it when destroyed.
+
+    class Lease {
+    public:
+        Lease() : xmpObj ( TXMPMetaPool::Acquire() ) {};
+        ~Lease() { TXMPMetaPool::Release ( this->xmpObj ); };
+        TXMPMeta<tStringObj> & operator* () const { return *this->xmpObj; };
+        TXMPMeta<tStringObj> * operator-> () const { return this->xmpObj; };
+        TXMPMeta<tStringObj> * Get() const { return this->xmpObj; };
+    private:
+        TXMPMeta<tStringObj> * xmpObj;
+        Lease ( const Lease & );	// ! Hidden on purpose.
+        void operator= ( const Lease & );
+    };
+
+private:
+
+    class ThreadPool;
+    static ThreadPool & GetThreadPool();
+
+    TXMPMetaPool();	// ! Hidden on purpose, all functions are static.
+
+};  // class TXMPMetaPool
+
 #endif  // __TXMPMeta_hpp__
@@ -680,6 +680,29 @@ public:
     static void DecodeFromBase64 ( const tStringObj & encodedStr,
 								   tStringObj *       rawStr );
 
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c  DecodeFromBase64() Decodes a Base64-encoded string into a buffer provided by the client.
+    ///
+    /// Avoids the intermediate string when the decoded data, such as a thumbnail image, is going
+    /// to be copied somewhere else anyway. The decoded data is written only if it fits in the
+    /// buffer. The exact length of the decoded data is returned in any case, so a first call with
+    /// a null buffer can be used to size the buffer.
+    ///
+    /// @param encodedStr An \c #XMP_StringPtr (char *) string containing the encoded data to be converted.
+    ///
+    /// @param encodedLen The number of characters of encoded data to be converted.
+    ///
+    /// @param rawBuffer [out] The buffer in which to return the decoded data, can be null.
+    ///
+    /// @param bufferSize The size in bytes of the buffer.
+    ///
+    /// @return The length in bytes of the decoded data.
+
+    static XMP_StringLen DecodeFromBase64 ( XMP_StringPtr encodedStr,
+											XMP_StringLen encodedLen,
+											void *        rawBuffer,
+											XMP_StringLen bufferSize );
+
     /// @}
 
     // =============================================================================================
@@ -922,6 +945,60 @@ public:
 								   XMP_StringPtr          propName = 0,
 								   XMP_OptionBits         options = 0 );
 
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c BatchApplyTemplate() applies one template to many XMP objects in parallel.
+    ///
+    /// The result for each object is the same as from \c ApplyTemplate(), whatever the number of
+    /// threads. The template is prepared once, its schemas and property names are indexed for the
+    /// lookups made for each object. The objects are worked on by up to \c threadCount threads,
+    /// including the calling thread, each object locked by the thread modifying it.
+    ///
+    /// All of the objects are processed even if some fail. If any fail the exception for the first
+    /// failing object in the array is thrown at the end, the other objects are complete.
+    ///
+    /// @param workingXMPs The destination XMP objects. They must be distinct, and must not include
+    /// the template.
+    ///
+    /// @param count The number of objects in \c workingXMPs.
+    ///
+    /// @param templateXMP The template to apply to the destination XMP objects.
+    ///
+    /// @param actions Option flags to control the copying, see \c ApplyTemplate().
+    ///
+    /// @param threadCount The most threads to use. The default of zero means one per processor.
+
+    static void BatchApplyTemplate ( TXMPMeta<tStringObj> * const * workingXMPs,
+                                     XMP_Index                      count,
+                                     const TXMPMeta<tStringObj> &   templateXMP,
+                                     XMP_OptionBits                 actions,
+                                     XMP_Index                      threadCount = 0 );
+
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c BatchRemoveProperties() removes the same properties from many XMP objects in parallel.
+    ///
+    /// The result for each object is the same as from \c RemoveProperties(). The parameters are
+    /// checked and the paths expanded once. Threads and errors are handled as for
+    /// \c BatchApplyTemplate().
+    ///
+    /// @param xmpObjs The XMP objects containing the properties to be removed. They must be distinct.
+    ///
+    /// @param count The number of objects in \c xmpObjs.
+    ///
+    /// @param schemaNS Optional schema namespace URI for the properties to be removed.
+    ///
+    /// @param propName Optional path expression for the property to be removed.
+    ///
+    /// @param options Option flags to control the deletion operation, see \c RemoveProperties().
+    ///
+    /// @param threadCount The most threads to use. The default of zero means one per processor.
+
+    static void BatchRemoveProperties ( TXMPMeta<tStringObj> * const * xmpObjs,
+                                        XMP_Index                      count,
+                                        XMP_StringPtr                  schemaNS = 0,
+                                        XMP_StringPtr                  propName = 0,
+                                        XMP_OptionBits                 options = 0,
+                                        XMP_Index                      threadCount = 0 );
+
     // ---------------------------------------------------------------------------------------------
     /// @brief \c DuplicateSubtree() replicates a subtree from one XMP object into another.
     ///
@@ -952,6 +1029,79 @@ public:
 								   XMP_StringPtr                destRoot = 0,
 								   XMP_OptionBits               options = 0 );
 
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c DiffProperties() describes the changes from one XMP object to another as text.
+    ///
+    /// The diff is a compact edit script of removals, insertions, value replacements, and array
+    /// item moves, each addressed by path and covering qualifiers as well. Applying it to the old
+    /// object with \c ApplyDiff() gives an object that compares equal to the new one. A diff can be
+    /// stored or sent in place of the whole packet.
+    ///
+    /// Both trees are walked together and subtrees with equal hashes are skipped without looking
+    /// inside. The hashes are cached, see \c TXMPMeta::GetFingerprint(), so repeated diffs against
+    /// an unchanged object cost little more than the size of the change. Array items are aligned by
+    /// content, so an item that only moved is reported as a move. The order of struct fields,
+    /// qualifiers, and alt-text items is not significant and is not reported.
+    ///
+    /// The first line of the diff holds the fingerprints of both objects, the other lines are one
+    /// operation each. A diff with no operations means the objects are equivalent.
+    ///
+    /// @param oldXMP The XMP object the diff starts from.
+    ///
+    /// @param newXMP The XMP object the diff leads to.
+    ///
+    /// @param diffStr [out] A string object in which to return the diff.
+    ///
+    /// @param options Option flags to control the diff. None are defined yet, must be 0.
+
+    static void DiffProperties ( const TXMPMeta<tStringObj> & oldXMP,
+								 const TXMPMeta<tStringObj> & newXMP,
+								 tStringObj *                 diffStr,
+								 XMP_OptionBits               options = 0 );
+
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c ApplyDiff() applies a diff made by \c DiffProperties() to an XMP object.
+    ///
+    /// The object must be equivalent to the one the diff was made from, as checked with its
+    /// fingerprint, unless \c #kXMPUtil_IgnoreDiffBase is passed. The diff is checked for syntax
+    /// before the object is changed. If a path of the diff is missing from the object, or the
+    /// result does not have the fingerprint recorded in the diff, an exception is thrown and the
+    /// object is left unchanged.
+    ///
+    /// Namespaces used by the diff are registered if needed, once the fingerprint check passed. If
+    /// a namespace URI is already registered with another prefix, the local prefix is used.
+    ///
+    /// @param xmpObj The XMP object to update.
+    ///
+    /// @param diffStr The diff text.
+    ///
+    /// @param diffLen The length in bytes of the diff text. Default is \c #kXMP_UseNullTermination.
+    ///
+    /// @param options Option flags to control the operation. A logical OR of these bit-flag
+    /// constants:
+    ///   \li \c #kXMPUtil_IgnoreDiffBase - Apply the diff even if the object is not the one the
+    ///   diff was made from.
+
+    static void ApplyDiff ( TXMPMeta<tStringObj> * xmpObj,
+							XMP_StringPtr          diffStr,
+							XMP_StringLen          diffLen = kXMP_UseNullTermination,
+							XMP_OptionBits         options = 0 );
+
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c ApplyDiff() applies a diff held in a string object.
+    ///
+    /// Overloads \c ApplyDiff() to take the diff as a string object.
+    ///
+    /// @param xmpObj The XMP object to update.
+    ///
+    /// @param diffStr The diff text.
+    ///
+    /// @param options Option flags to control the operation, as for the basic form.
+
+    static void ApplyDiff ( TXMPMeta<tStringObj> * xmpObj,
+							const tStringObj &     diffStr,
+							XMP_OptionBits         options = 0 );
+
     /// @}
 
     // =============================================================================================
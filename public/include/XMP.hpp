@@ -71,6 +71,7 @@
     typedef class TXMPMeta <TXMP_STRING_TYPE>     SXMPMeta;       // For client convenience.
     typedef class TXMPIterator <TXMP_STRING_TYPE> SXMPIterator;
     typedef class TXMPUtils <TXMP_STRING_TYPE>    SXMPUtils;
+    typedef class TXMPMetaPool <TXMP_STRING_TYPE> SXMPMetaPool;
     #if TXMP_EXPAND_INLINE
     	#error "TXMP_EXPAND_INLINE is not working at present. Please don't use it."
         #include "client-glue/TXMPMeta.incl_cpp"
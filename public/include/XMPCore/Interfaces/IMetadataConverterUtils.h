@@ -34,12 +34,21 @@ namespace AdobeXMPCore {
         
         //!
         //! @brief Converts SXMPMeta object to IMetadata object.
+        //! \details When the SXMPMeta is backed by the new DOM the returned IMetadata shares its data instead
+        //! of copying it. The sharing is copy-on-write: the first change made through either object gives the
+        //! SXMPMeta a private copy, so a change through one object is never seen through the other. The
+        //! SXMPMeta is not modified by the conversion. Using the two objects from different threads needs
+        //! external synchronization, as the copy is made on the thread doing the first change.
         //! \return An shared pointer of type AdobeXMPCore::spIMetadata indicating converted meta object.
         //!
         static spIMetadata ConvertXMPMetatoIMetadata(const SXMPMeta* inOldXMP);
         
         //!
         //! @brief Converts IMetadata object to SXMPMeta object.
+        //! \details When the old API is backed by the new DOM and the IMetadata already is in the form the
+        //! SXMPMeta parser produces, the returned SXMPMeta shares its data copy-on-write, in the same way as
+        //! ConvertXMPMetatoIMetadata. Otherwise a deep copy is made and cleaned up like a parsed packet. The
+        //! features enabled on the IMetadata are left unchanged.
         //! \return SXMPMeta object indicating converted meta object.
         //!
         static SXMPMeta ConvertIMetadatatoXMPMeta(AdobeXMPCore::spIMetadata inNewXMP);
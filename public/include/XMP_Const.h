@@ -868,6 +868,14 @@ enum {
 
 };
 
+/// @brief Option bit flags for \c TXMPUtils::ApplyDiff().
+enum {
+
+	/// Apply the diff even if the object is not the one the diff was made from.
+    kXMPUtil_IgnoreDiffBase    = 0x0001UL
+
+};
+
 // =================================================================================================
 // Types and Constants for XMPFiles
 // ================================
@@ -169,12 +169,18 @@ static inline XMP_Bool WrapErrorNotify ( XMPMeta_ErrorCallbackProc proc, void *
 #define zXMPMeta_SetObjectOptions_1(options) \
     WXMPMeta_SetObjectOptions_1 ( this->xmpRef, options, &wResult )
 
+#define zXMPMeta_GetFingerprint_1() \
+    WXMPMeta_GetFingerprint_1 ( this->xmpRef, &wResult )
+
 #define zXMPMeta_Sort_1() \
     WXMPMeta_Sort_1 ( this->xmpRef, &wResult )
 
 #define zXMPMeta_Erase_1() \
     WXMPMeta_Erase_1 ( this->xmpRef, &wResult )
 
+#define zXMPMeta_Reset_1() \
+    WXMPMeta_Reset_1 ( this->xmpRef, &wResult )
+
 #define zXMPMeta_Clone_1(options) \
     WXMPMeta_Clone_1 ( this->xmpRef, options, &wResult )
 
@@ -190,6 +196,12 @@ static inline XMP_Bool WrapErrorNotify ( XMPMeta_ErrorCallbackProc proc, void *
 #define zXMPMeta_SerializeToBuffer_1(pktString,options,padding,newline,indent,baseIndent,SetClientString) \
     WXMPMeta_SerializeToBuffer_1 ( this->xmpRef, pktString, options, padding, newline, indent, baseIndent, SetClientString, &wResult )
 
+#define zXMPMeta_GetSerializedSize_1(options,newline,indent,baseIndent) \
+    WXMPMeta_GetSerializedSize_1 ( this->xmpRef, options, newline, indent, baseIndent, &wResult )
+
+#define zXMPMeta_SerializeToRegion_1(region,regionSize,overflowPacket,options,newline,indent,baseIndent,SetClientString) \
+    WXMPMeta_SerializeToRegion_1 ( this->xmpRef, region, regionSize, overflowPacket, options, newline, indent, baseIndent, SetClientString, &wResult )
+
 #define zXMPMeta_SetDefaultErrorCallback_1(proc,context,limit) \
 	WXMPMeta_SetDefaultErrorCallback_1 ( WrapErrorNotify, proc, context, limit, &wResult )
 	
@@ -559,6 +571,10 @@ XMP_PUBLIC WXMPMeta_SetObjectOptions_1 ( XMPMetaRef     xmpRef,
                               XMP_OptionBits options,
                               WXMP_Result *  wResult );
 
+extern void
+XMP_PUBLIC WXMPMeta_GetFingerprint_1 ( XMPMetaRef    xmpRef,
+                              WXMP_Result * wResult ) /* const */ ;
+
 extern void
 XMP_PUBLIC WXMPMeta_Sort_1 ( XMPMetaRef    xmpRef,
                   WXMP_Result * wResult );
@@ -567,6 +583,10 @@ extern void
 XMP_PUBLIC WXMPMeta_Erase_1 ( XMPMetaRef    xmpRef,
                    WXMP_Result * wResult );
 
+extern void
+XMP_PUBLIC WXMPMeta_Reset_1 ( XMPMetaRef    xmpRef,
+                   WXMP_Result * wResult );
+
 extern void
 XMP_PUBLIC WXMPMeta_Clone_1 ( XMPMetaRef     xmpRef,
                    XMP_OptionBits options,
@@ -604,6 +624,26 @@ XMP_PUBLIC WXMPMeta_SerializeToBuffer_1 ( XMPMetaRef     xmpRef,
                                SetClientStringProc SetClientString,
                                WXMP_Result *  wResult ) /* const */ ;
 
+extern void
+XMP_PUBLIC WXMPMeta_GetSerializedSize_1 ( XMPMetaRef     xmpRef,
+                               XMP_OptionBits options,
+                               XMP_StringPtr  newline,
+                               XMP_StringPtr  indent,
+                               XMP_Index      baseIndent,
+                               WXMP_Result *  wResult ) /* const */ ;
+
+extern void
+XMP_PUBLIC WXMPMeta_SerializeToRegion_1 ( XMPMetaRef     xmpRef,
+                               void *         region,
+                               XMP_StringLen  regionSize,
+                               void *         overflowPacket,
+                               XMP_OptionBits options,
+                               XMP_StringPtr  newline,
+                               XMP_StringPtr  indent,
+                               XMP_Index      baseIndent,
+                               SetClientStringProc SetClientString,
+                               WXMP_Result *  wResult ) /* const */ ;
+
 // -------------------------------------------------------------------------------------------------
 
 extern void
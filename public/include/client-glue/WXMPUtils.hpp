@@ -82,6 +82,9 @@ extern "C" {
 #define zXMPUtils_DecodeFromBase64_1(encodedStr,encodedLen,rawStr,SetClientString) \
     WXMPUtils_DecodeFromBase64_1 ( encodedStr, encodedLen, rawStr, SetClientString, &wResult );
 
+#define zXMPUtils_DecodeFromBase64ToBuffer_1(encodedStr,encodedLen,rawBuffer,bufferSize) \
+    WXMPUtils_DecodeFromBase64ToBuffer_1 ( encodedStr, encodedLen, rawBuffer, bufferSize, &wResult );
+
 #define zXMPUtils_PackageForJPEG_1(xmpObj,stdStr,extStr,digestStr,SetClientString) \
     WXMPUtils_PackageForJPEG_1 ( xmpObj, stdStr, extStr, digestStr, SetClientString, &wResult );
 
@@ -100,9 +103,21 @@ extern "C" {
 #define zXMPUtils_RemoveProperties_1(xmpObj,schemaNS,propName,options) \
     WXMPUtils_RemoveProperties_1 ( xmpObj, schemaNS, propName, options, &wResult );
 
+#define zXMPUtils_BatchApplyTemplate_1(workingXMPs,count,templateXMP,actions,threadCount) \
+    WXMPUtils_BatchApplyTemplate_1 ( workingXMPs, count, templateXMP, actions, threadCount, &wResult );
+
+#define zXMPUtils_BatchRemoveProperties_1(xmpObjs,count,schemaNS,propName,options,threadCount) \
+    WXMPUtils_BatchRemoveProperties_1 ( xmpObjs, count, schemaNS, propName, options, threadCount, &wResult );
+
 #define zXMPUtils_DuplicateSubtree_1(source,dest,sourceNS,sourceRoot,destNS,destRoot,options) \
     WXMPUtils_DuplicateSubtree_1 ( source, dest, sourceNS, sourceRoot, destNS, destRoot, options, &wResult );
 
+#define zXMPUtils_DiffProperties_1(oldXMP,newXMP,diffStr,options,SetClientString) \
+    WXMPUtils_DiffProperties_1 ( oldXMP, newXMP, diffStr, options, SetClientString, &wResult );
+
+#define zXMPUtils_ApplyDiff_1(xmpObj,diffStr,diffLen,options) \
+    WXMPUtils_ApplyDiff_1 ( xmpObj, diffStr, diffLen, options, &wResult );
+
 // =================================================================================================
 
 extern void
@@ -246,6 +261,13 @@ XMP_PUBLIC WXMPUtils_DecodeFromBase64_1 ( XMP_StringPtr encodedStr,
                                SetClientStringProc SetClientString,
                                WXMP_Result * wResult );
 
+extern void
+XMP_PUBLIC WXMPUtils_DecodeFromBase64ToBuffer_1 ( XMP_StringPtr encodedStr,
+                                       XMP_StringLen encodedLen,
+                                       void *        rawBuffer,
+                                       XMP_StringLen bufferSize,
+                                       WXMP_Result * wResult );
+
 // -------------------------------------------------------------------------------------------------
 
 extern void
@@ -295,6 +317,23 @@ XMP_PUBLIC WXMPUtils_RemoveProperties_1 ( XMPMetaRef     xmpObj,
                                XMP_OptionBits options,
                                WXMP_Result *  wResult );
 
+extern void
+XMP_PUBLIC WXMPUtils_BatchApplyTemplate_1 ( const XMPMetaRef * workingXMPs,
+                                 XMP_Index          count,
+                                 XMPMetaRef         templateXMP,
+                                 XMP_OptionBits     actions,
+                                 XMP_Index          threadCount,
+                                 WXMP_Result *      wResult );
+
+extern void
+XMP_PUBLIC WXMPUtils_BatchRemoveProperties_1 ( const XMPMetaRef * xmpObjs,
+                                    XMP_Index          count,
+                                    XMP_StringPtr      schemaNS,
+                                    XMP_StringPtr      propName,
+                                    XMP_OptionBits     options,
+                                    XMP_Index          threadCount,
+                                    WXMP_Result *      wResult );
+
 extern void
 XMP_PUBLIC WXMPUtils_DuplicateSubtree_1 ( XMPMetaRef     source,
                                XMPMetaRef     dest,
@@ -305,6 +344,21 @@ XMP_PUBLIC WXMPUtils_DuplicateSubtree_1 ( XMPMetaRef     source,
                                XMP_OptionBits options,
                                WXMP_Result *  wResult );
 
+extern void
+XMP_PUBLIC WXMPUtils_DiffProperties_1 ( XMPMetaRef     oldXMP,
+                             XMPMetaRef     newXMP,
+                             void *         diffStr,
+                             XMP_OptionBits options,
+                             SetClientStringProc SetClientString,
+                             WXMP_Result *  wResult );
+
+extern void
+XMP_PUBLIC WXMPUtils_ApplyDiff_1 ( XMPMetaRef     xmpObj,
+                        XMP_StringPtr  diffStr,
+                        XMP_StringLen  diffLen,
+                        XMP_OptionBits options,
+                        WXMP_Result *  wResult );
+
 // =================================================================================================
 
 #if __cplusplus
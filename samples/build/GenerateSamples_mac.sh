@@ -87,6 +87,31 @@ then
 rm -rf cmake/XMPIterations/universal
 fi
 
+if [ -e cmake/ConversionPerformance/universal ]
+then
+rm -rf cmake/ConversionPerformance/universal
+fi
+
+if [ -e cmake/CRC32Performance/universal ]
+then
+rm -rf cmake/CRC32Performance/universal
+fi
+
+if [ -e cmake/IterationPerformance/universal ]
+then
+rm -rf cmake/IterationPerformance/universal
+fi
+
+if [ -e cmake/RoundTripCorrectness/universal ]
+then
+rm -rf cmake/RoundTripCorrectness/universal
+fi
+
+if [ -e cmake/NewDOMCorrectness/universal ]
+then
+rm -rf cmake/NewDOMCorrectness/universal
+fi
+
 if [ -e cmake/UnicodeCorrectness/universal ]
 then
 rm -rf cmake/UnicodeCorrectness/universal
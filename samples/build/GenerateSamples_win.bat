@@ -70,6 +70,16 @@ if exist cmake\XMPFilesCoverage\build_x64 rmdir /S /Q cmake\XMPFilesCoverage\bui
 if exist cmake\XMPFilesCoverage\build rmdir /S /Q cmake\XMPFilesCoverage\build
 if exist cmake\XMPIterations\build_x64 rmdir /S /Q cmake\XMPIterations\build_x64
 if exist cmake\XMPIterations\build rmdir /S /Q cmake\XMPIterations\build
+if exist cmake\ConversionPerformance\build_x64 rmdir /S /Q cmake\ConversionPerformance\build_x64
+if exist cmake\ConversionPerformance\build rmdir /S /Q cmake\ConversionPerformance\build
+if exist cmake\CRC32Performance\build_x64 rmdir /S /Q cmake\CRC32Performance\build_x64
+if exist cmake\CRC32Performance\build rmdir /S /Q cmake\CRC32Performance\build
+if exist cmake\IterationPerformance\build_x64 rmdir /S /Q cmake\IterationPerformance\build_x64
+if exist cmake\IterationPerformance\build rmdir /S /Q cmake\IterationPerformance\build
+if exist cmake\RoundTripCorrectness\build_x64 rmdir /S /Q cmake\RoundTripCorrectness\build_x64
+if exist cmake\RoundTripCorrectness\build rmdir /S /Q cmake\RoundTripCorrectness\build
+if exist cmake\NewDOMCorrectness\build_x64 rmdir /S /Q cmake\NewDOMCorrectness\build_x64
+if exist cmake\NewDOMCorrectness\build rmdir /S /Q cmake\NewDOMCorrectness\build
 if exist cmake\UnicodeCorrectness\build_x64 rmdir /S /Q cmake\UnicodeCorrectness\build_x64
 if exist cmake\UnicodeCorrectness\build rmdir /S /Q cmake\UnicodeCorrectness\build
 if exist cmake\UnicodeParseSerialize\build_x64 rmdir /S /Q cmake\UnicodeParseSerialize\build_x64
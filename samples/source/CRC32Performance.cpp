@@ -0,0 +1,157 @@
+// =================================================================================================
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+using namespace std;
+
+// =================================================================================================
+
+#include "public/include/XMP_Environment.h"
+#include "public/include/XMP_Const.h"
+
+#include "source/CRC32.hpp"
+#include "source/CRC32.cpp"
+
+// =================================================================================================
+
+#define kBufferSize (16*1024*1024)
+
+static XMP_Uns8 sBuffer [kBufferSize + 16];
+
+// =================================================================================================
+
+static XMP_Uns32 BytewiseCRC ( XMP_Uns32 crc, const XMP_Uns8 * data, size_t length )
+{
+	crc = ~crc;
+	for ( ; length > 0; ++data, --length ) {
+		crc ^= *data;
+		for ( int k = 0; k < 8; ++k ) crc = (crc & 1) ? (0xEDB88320UL ^ (crc >> 1)) : (crc >> 1);
+	}
+	return ~crc;
+}	// BytewiseCRC
+
+// =================================================================================================
+
+static void CheckResults ( FILE * log )
+{
+	size_t errors = 0;
+
+	if ( CRC32::Compute ( "123456789", 9 ) != 0xCBF43926UL ) {
+		fprintf ( log, "    *** Check value error, 0x%.8X\n", CRC32::Compute ( "123456789", 9 ) );
+		++errors;
+	}
+
+	for ( size_t offset = 0; offset < 16; ++offset ) {	// Cover the alignment and tail cases.
+		for ( size_t length = 0; length <= 1024; ++length ) {
+			XMP_Uns32 expected = BytewiseCRC ( 0x12345678UL, &sBuffer[offset], length );
+			XMP_Uns32 actual   = CRC32::Update ( 0x12345678UL, &sBuffer[offset], length );
+			XMP_Uns32 portable = CRC32::UpdatePortable ( 0x12345678UL, &sBuffer[offset], length );
+			if ( (actual != expected) || (portable != expected) ) {
+				if ( errors < 10 ) fprintf ( log, "    *** Mismatch at offset %d, length %d\n", (int)offset, (int)length );
+				++errors;
+			}
+		}
+	}
+
+	fprintf ( log, "\n  Checked %s and slicing-by-8 against bytewise code, %d errors\n",
+			  CRC32::GetImplementation(), (int)errors );
+
+}	// CheckResults
+
+// =================================================================================================
+
+static void ReportPerformance ( FILE * log, const char * content, size_t length, size_t cycles )
+{
+	size_t i;
+	clock_t start, end;
+	double elapsed, megabytes;
+	XMP_Uns32 crc = 0;
+
+	megabytes = (double(length) * cycles) / (1024.0 * 1024.0);
+	fprintf ( log, "\n  CRC-32 over %s, %.0f MB total\n", content, megabytes );
+
+	start = clock();
+	for ( i = 0; i < cycles; ++i ) crc ^= CRC32::Update ( 0, sBuffer, length );
+	end = clock();
+	elapsed = double(end-start) / CLOCKS_PER_SEC;
+	fprintf ( log, "    %-14s : %.3f seconds, %.0f MB/s\n", CRC32::GetImplementation(), elapsed, (elapsed > 0 ? megabytes/elapsed : 0) );
+
+	start = clock();
+	for ( i = 0; i < cycles; ++i ) crc ^= CRC32::UpdatePortable ( 0, sBuffer, length );
+	end = clock();
+	elapsed = double(end-start) / CLOCKS_PER_SEC;
+	fprintf ( log, "    %-14s : %.3f seconds, %.0f MB/s\n", "slicing-by-8", elapsed, (elapsed > 0 ? megabytes/elapsed : 0) );
+
+	cycles = (cycles + 15) / 16;	// The bytewise code is slow, measure less.
+	megabytes = (double(length) * cycles) / (1024.0 * 1024.0);
+	start = clock();
+	for ( i = 0; i < cycles; ++i ) crc ^= BytewiseCRC ( 0, sBuffer, length );
+	end = clock();
+	elapsed = double(end-start) / CLOCKS_PER_SEC;
+	fprintf ( log, "    %-14s : %.3f seconds, %.0f MB/s\n", "bytewise", elapsed, (elapsed > 0 ? megabytes/elapsed : 0) );
+
+	if ( crc == 1 ) fprintf ( log, "\n" );	// ! Keep the loops from being optimized away.
+
+}	// ReportPerformance
+
+// =================================================================================================
+
+static void DoTest ( FILE * log )
+{
+
+	srand ( 1 );
+	for ( size_t i = 0; i < sizeof(sBuffer); ++i ) sBuffer[i] = (XMP_Uns8)rand();
+
+	CheckResults ( log );
+
+	ReportPerformance ( log, "a 16 MB buffer", kBufferSize, 32 );
+	ReportPerformance ( log, "64 KB buffers, a large text chunk", 64*1024, 8*1024 );
+	ReportPerformance ( log, "100 byte buffers, a typical chunk header", 100, 5*1024*1024 );
+
+}	// DoTest
+
+// =================================================================================================
+
+extern "C" int main ( void )
+{
+	char buffer [1000];
+
+	#if !XMP_AutomatedTestBuild
+		FILE * log = stdout;
+	#else
+		FILE * log = fopen ( "TestCRC32.out", "wb" );
+	#endif
+
+	time_t now;
+	time ( &now );
+	sprintf ( buffer, "// Starting test for CRC-32 performance, %s", ctime ( &now ) );
+
+	fprintf ( log, "// " );
+	for ( size_t i = 4; i < strlen(buffer); ++i ) fprintf ( log, "=" );
+	fprintf ( log, "\n%s", buffer );
+
+	try {
+
+		DoTest ( log );
+
+	} catch ( ... ) {
+
+		fprintf ( log, "\n## Caught unexpected exception\n" );
+		return -1;
+
+	}
+
+	time ( &now );
+	sprintf ( buffer, "// Finished test for CRC-32 performance, %s", ctime ( &now ) );
+
+	fprintf ( log, "\n// " );
+	for ( size_t i = 4; i < strlen(buffer); ++i ) fprintf ( log, "=" );
+	fprintf ( log, "\n%s\n", buffer );
+
+	fclose ( log );
+	return 0;
+
+}
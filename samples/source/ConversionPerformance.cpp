@@ -0,0 +1,170 @@
+// =================================================================================================
+// Copyright 2026 Adobe
+// All Rights Reserved.
+//
+// NOTICE:  Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it.
+// =================================================================================================
+
+/**
+ * Times the value conversion utilities of XMPCore, converting typical strings to binary values and
+ * back many times over. The results are written to stdout, or to the file named on the command line.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+// Must be defined to instantiate template classes
+#define TXMP_STRING_TYPE std::string
+
+// Ensure XMP templates are instantiated
+#include "public/include/XMP.incl_cpp"
+
+// Provide access to the API
+#include "public/include/XMP.hpp"
+
+using namespace std;
+
+// =================================================================================================
+
+static const size_t kCycles = 1000000;
+
+static const char * kIntStrings[]   = { "0", "7", "-42", "65535", "2147483647", "0x1F", "-123456" };
+static const char * kInt64Strings[] = { "0", "1099511627776", "-9223372036854775807", "0xFFFFFFFFFF" };
+static const char * kFloatStrings[] = { "0", "1.5", "-0.25", "3.14159", "72.0", "1.2e-5", "2.2250738585072014e-308" };
+static const char * kDateStrings[]  = { "2024", "2024-05", "2024-05-17", "2024-05-17T10:20+02:00",
+										"2024-05-17T10:20:30Z", "2024-05-17T10:20:30.125-08:00",
+										"2024-05-17T10:20:30.123456789" };
+
+#define CountOf(array) (sizeof(array) / sizeof(array[0]))
+
+// =================================================================================================
+
+static void ReportTime ( FILE * log, const char * name, clock_t start, size_t checkSum )
+{
+	double elapsed = double ( clock() - start ) / CLOCKS_PER_SEC;
+	fprintf ( log, "  %-16s : %.3f seconds, %.1f ns per call (check %lu)\n",
+			  name, elapsed, (elapsed * 1.0e9) / kCycles, (unsigned long)checkSum );
+}
+
+// =================================================================================================
+
+static void ConvertToValues ( FILE * log )
+{
+	size_t i, checkSum;
+	clock_t start;
+
+	fprintf ( log, "\nString to binary conversions, %lu calls each\n", (unsigned long)kCycles );
+
+	checkSum = 0;
+	start = clock();
+	for ( i = 0; i < kCycles; ++i ) checkSum += SXMPUtils::ConvertToInt ( kIntStrings [i % CountOf(kIntStrings)] );
+	ReportTime ( log, "ConvertToInt", start, checkSum );
+
+	checkSum = 0;
+	start = clock();
+	for ( i = 0; i < kCycles; ++i ) checkSum += (size_t) SXMPUtils::ConvertToInt64 ( kInt64Strings [i % CountOf(kInt64Strings)] );
+	ReportTime ( log, "ConvertToInt64", start, checkSum );
+
+	checkSum = 0;
+	start = clock();
+	for ( i = 0; i < kCycles; ++i ) checkSum += (size_t) (1000.0 * SXMPUtils::ConvertToFloat ( kFloatStrings [i % CountOf(kFloatStrings)] ));
+	ReportTime ( log, "ConvertToFloat", start, checkSum );
+
+	checkSum = 0;
+	start = clock();
+	for ( i = 0; i < kCycles; ++i ) {
+		XMP_DateTime date;
+		SXMPUtils::ConvertToDate ( kDateStrings [i % CountOf(kDateStrings)], &date );
+		checkSum += date.year + date.month + date.day + date.hour + date.minute + date.second + date.tzHour;
+	}
+	ReportTime ( log, "ConvertToDate", start, checkSum );
+
+}	// ConvertToValues
+
+// =================================================================================================
+
+static void ConvertFromValues ( FILE * log )
+{
+	size_t i, checkSum;
+	clock_t start;
+	string value;
+
+	fprintf ( log, "\nBinary to string conversions, %lu calls each\n", (unsigned long)kCycles );
+
+	checkSum = 0;
+	start = clock();
+	for ( i = 0; i < kCycles; ++i ) {
+		SXMPUtils::ConvertFromInt ( XMP_Int32(i) - 500000, "", &value );
+		checkSum += value.size();
+	}
+	ReportTime ( log, "ConvertFromInt", start, checkSum );
+
+	checkSum = 0;
+	start = clock();
+	for ( i = 0; i < kCycles; ++i ) {
+		SXMPUtils::ConvertFromInt64 ( XMP_Int64(i) * 1234567891LL, "", &value );
+		checkSum += value.size();
+	}
+	ReportTime ( log, "ConvertFromInt64", start, checkSum );
+
+	checkSum = 0;
+	start = clock();
+	for ( i = 0; i < kCycles; ++i ) {
+		SXMPUtils::ConvertFromFloat ( double(i) / 8.0, "", &value );
+		checkSum += value.size();
+	}
+	ReportTime ( log, "ConvertFromFloat", start, checkSum );
+
+	XMP_DateTime dates [CountOf(kDateStrings)];
+	for ( i = 0; i < CountOf(kDateStrings); ++i ) SXMPUtils::ConvertToDate ( kDateStrings[i], &dates[i] );
+
+	checkSum = 0;
+	start = clock();
+	for ( i = 0; i < kCycles; ++i ) {
+		SXMPUtils::ConvertFromDate ( dates [i % CountOf(dates)], &value );
+		checkSum += value.size();
+	}
+	ReportTime ( log, "ConvertFromDate", start, checkSum );
+
+}	// ConvertFromValues
+
+// =================================================================================================
+
+extern "C" int main ( int argc, const char * argv[] )
+{
+	FILE * log = stdout;
+
+	if ( argc > 1 ) {
+		log = fopen ( argv[1], "w" );
+		if ( log == 0 ) {
+			fprintf ( stderr, "Can't open log file %s\n", argv[1] );
+			return -1;
+		}
+	}
+
+	if ( ! SXMPMeta::Initialize() ) {
+		fprintf ( stderr, "Could not initialize toolkit!\n" );
+		return -1;
+	}
+
+	try {
+
+		fprintf ( log, "XMPCore value conversion performance\n" );
+		ConvertToValues ( log );
+		ConvertFromValues ( log );
+
+	} catch ( XMP_Error & excep ) {
+
+		fprintf ( log, "\nCaught XMP_Error %d : %s\n", excep.GetID(), excep.GetErrMsg() );
+
+	}
+
+	SXMPMeta::Terminate();
+	if ( log != stdout ) fclose ( log );
+
+	return 0;
+
+}
@@ -0,0 +1,147 @@
+// =================================================================================================
+// Copyright 2024 Adobe
+// All Rights Reserved.
+//
+// NOTICE:  Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it.
+// =================================================================================================
+
+/**
+ * Times SXMPIterator over a generated packet of about 1 MB, with the common iteration options, and
+ * when the client stops after the first schema. The results are written to stdout, or to the file
+ * named on the command line.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+// Must be defined to instantiate template classes
+#define TXMP_STRING_TYPE std::string
+
+// Ensure XMP templates are instantiated
+#include "public/include/XMP.incl_cpp"
+
+// Provide access to the API
+#include "public/include/XMP.hpp"
+
+using namespace std;
+
+// =================================================================================================
+
+static const size_t kPacketSize = 1024*1024;
+static const size_t kCycles = 50;
+
+static const char * kNS1 = "ns:test1/";
+static const char * kNS2 = "ns:test2/";
+
+// =================================================================================================
+
+static void BuildPacket ( SXMPMeta * meta, string * packet )
+{
+	SXMPMeta::RegisterNamespace ( kNS1, "ns1", 0 );
+	SXMPMeta::RegisterNamespace ( kNS2, "ns2", 0 );
+
+	meta->SetProperty ( kXMP_NS_XMP, "CreatorTool", "IterationPerformance" );
+	meta->SetLocalizedText ( kXMP_NS_DC, "title", "", "x-default", "Iteration test" );
+
+	char name [32], value [64];
+	string item;
+	SXMPUtils::ComposeArrayItemPath ( kNS2, "Seq", kXMP_ArrayLastItem, &item );
+
+	for ( size_t i = 0; packet->size() < kPacketSize; ) {
+
+		// Grow the packet in batches, serializing after each property is too slow.
+		for ( size_t j = 0; j < 100; ++j, ++i ) {
+			snprintf ( name, sizeof(name), "Prop%lu", (unsigned long)i );
+			snprintf ( value, sizeof(value), "Value %lu", (unsigned long)i );
+			meta->SetProperty ( kNS1, name, value );
+			meta->SetQualifier ( kNS1, name, kXMP_NS_DC, "source", "generated" );
+			meta->AppendArrayItem ( kNS2, "Bag", kXMP_PropValueIsArray, value );
+			meta->AppendArrayItem ( kNS2, "Seq", kXMP_PropArrayIsOrdered, 0, kXMP_PropValueIsStruct );
+			meta->SetStructField ( kNS2, item.c_str(), kNS2, "Field1", value );
+			meta->SetStructField ( kNS2, item.c_str(), kNS2, "Field2", name );
+		}
+
+		meta->SerializeToBuffer ( packet, kXMP_UseCompactFormat );
+
+	}
+}	// BuildPacket
+
+// =================================================================================================
+
+static void TimeIteration ( FILE * log, const SXMPMeta & meta, const char * label,
+							const char * schemaNS, XMP_OptionBits options, bool firstSchemaOnly )
+{
+	size_t nodes = 0, pathChars = 0;
+	clock_t start = clock();
+
+	for ( size_t i = 0; i < kCycles; ++i ) {
+		SXMPIterator iter ( meta, schemaNS, options );
+		string schema, path, value;
+		XMP_OptionBits nodeOptions;
+		bool inSchema = false;
+		while ( iter.Next ( &schema, &path, &value, &nodeOptions ) ) {
+			if ( firstSchemaOnly && (nodeOptions & kXMP_SchemaNode) ) {
+				if ( inSchema ) break;
+				inSchema = true;
+			}
+			++nodes;
+			pathChars += path.size();
+		}
+	}
+
+	double elapsed = double ( clock() - start ) / CLOCKS_PER_SEC;
+	fprintf ( log, "  %-24s : %.3f ms per iteration, %lu nodes, %lu path characters\n",
+			  label, (elapsed * 1000.0) / kCycles, (unsigned long)(nodes / kCycles), (unsigned long)(pathChars / kCycles) );
+}	// TimeIteration
+
+// =================================================================================================
+
+extern "C" int main ( int argc, const char * argv[] )
+{
+	FILE * log = stdout;
+
+	if ( argc > 1 ) {
+		log = fopen ( argv[1], "w" );
+		if ( log == 0 ) {
+			fprintf ( stderr, "Can't open log file %s\n", argv[1] );
+			return -1;
+		}
+	}
+
+	if ( ! SXMPMeta::Initialize() ) {
+		fprintf ( stderr, "Could not initialize toolkit!\n" );
+		return -1;
+	}
+
+	try {
+
+		SXMPMeta meta;
+		string packet;
+		BuildPacket ( &meta, &packet );
+
+		fprintf ( log, "XMPCore iteration performance, %lu byte packet, %lu cycles each\n\n",
+				  (unsigned long)packet.size(), (unsigned long)kCycles );
+
+		TimeIteration ( log, meta, "all nodes", 0, 0, false );
+		TimeIteration ( log, meta, "leaf nodes", 0, kXMP_IterJustLeafNodes, false );
+		TimeIteration ( log, meta, "leaf names and values", 0, (kXMP_IterJustLeafNodes | kXMP_IterJustLeafName), false );
+		TimeIteration ( log, meta, "omit qualifiers", 0, kXMP_IterOmitQualifiers, false );
+		TimeIteration ( log, meta, "just children", 0, kXMP_IterJustChildren, false );
+		TimeIteration ( log, meta, "one schema", kNS2, 0, false );
+		TimeIteration ( log, meta, "stop after first schema", 0, 0, true );
+
+	} catch ( XMP_Error & excep ) {
+
+		fprintf ( log, "\nCaught XMP_Error %d : %s\n", excep.GetID(), excep.GetErrMsg() );
+
+	}
+
+	SXMPMeta::Terminate();
+	if ( log != stdout ) fclose ( log );
+
+	return 0;
+
+}
@@ -0,0 +1,527 @@
+// =================================================================================================
+// Copyright 2026 Adobe
+// All Rights Reserved.
+//
+// NOTICE:  Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it.
+// =================================================================================================
+
+/**
+ * Regression checks for the C++ DOM (IMetadata and friends) and its bridge to SXMPMeta. Each check is
+ * logged, the exit status is the number of failed checks. The packets of the samples/testfiles fixtures
+ * are looked for in ../../../../testfiles, as for RoundTripCorrectness, or in the folder named on the
+ * command line.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define TXMP_STRING_TYPE std::string
+#define ENABLE_NEW_DOM_MODEL 1
+#include "public/include/XMP.incl_cpp"
+#include "public/include/XMP.hpp"
+
+#include "XMPCore/Interfaces/IDOMImplementationRegistry.h"
+#include "XMPCore/Interfaces/IDOMParser.h"
+#include "XMPCore/Interfaces/IDOMSerializer.h"
+#include "XMPCore/Interfaces/IMetadata.h"
+#include "XMPCore/Interfaces/ICoreObjectFactory.h"
+#include "XMPCore/Interfaces/ICoreConfigurationManager.h"
+#include "XMPCore/Interfaces/ISimpleNode.h"
+#include "XMPCore/Interfaces/IStructureNode.h"
+#include "XMPCore/Interfaces/IArrayNode.h"
+#include "XMPCore/Interfaces/INodeIterator.h"
+#include "XMPCore/Interfaces/IMetadataConverterUtils.h"
+#include "XMPCommon/Interfaces/IUTF8String.h"
+#include "XMPCommon/Interfaces/IError.h"
+#include "XMPCommon/Interfaces/IMemoryAllocator.h"
+
+using namespace std;
+using namespace AdobeXMPCore;
+using AdobeXMPCommon::npos;
+
+#if WIN_ENV
+	#pragma warning ( disable : 4996 )	// '...' was declared deprecated
+#endif
+
+// =================================================================================================
+
+static FILE * sLogFile = stdout;
+static string sTestFolder = "../../../../testfiles/";
+static int    sFailures = 0;
+
+static const char * kFixtures[] = { "BlueSquare.ai", "BlueSquare.avi", "BlueSquare.eps", "BlueSquare.indd",
+									"BlueSquare.jpg", "BlueSquare.mov", "BlueSquare.mp3", "BlueSquare.pdf",
+									"BlueSquare.png", "BlueSquare.psd", "BlueSquare.tif", "BlueSquare.wav",
+									"Image1.jpg", "Image2.jpg", 0 };
+
+// =================================================================================================
+
+static void WriteMinorLabel ( const char * title )
+{
+	fprintf ( sLogFile, "\n// " );
+	for ( size_t i = 0; i < strlen(title); ++i ) fprintf ( sLogFile, "-" );
+	fprintf ( sLogFile, "--\n// %s :\n\n", title );
+}	// WriteMinorLabel
+
+// -------------------------------------------------------------------------------------------------
+
+static void Check ( bool ok, const char * what )
+{
+	if ( ok ) {
+		fprintf ( sLogFile, "   ok     %s\n", what );
+	} else {
+		fprintf ( sLogFile, "## FAILED %s\n", what );
+		++sFailures;
+	}
+}	// Check
+
+// -------------------------------------------------------------------------------------------------
+
+static string GetSimpleValue ( const spIMetadata & meta, const char * nameSpace, const char * name )
+{
+	spISimpleNode node = meta->GetSimpleNode ( nameSpace, npos, name, npos );
+	return node ? string ( node->GetValue()->c_str() ) : string ( "<none>" );
+}	// GetSimpleValue
+
+// =================================================================================================
+// Memory arena
+// ============
+//
+// With "useArena" set the RDF parser allocates the nodes it creates from an arena kept alive by the
+// metadata. Everything else done during the parse, like registering a namespace met for the first
+// time, must not end up in the arena and so must outlive it. A counting allocator registered with the
+// library shows whether the arena's memory is really returned once the document is gone.
+
+class CountingAllocator : public AdobeXMPCommon::IMemoryAllocator {
+public:
+	CountingAllocator() : mOutstanding ( 0 ) {}
+
+	virtual void * APICALL allocate ( AdobeXMPCommon::sizet size ) __NOTHROW__
+	{
+		size_t * block = (size_t *) malloc ( size + kHeader );
+		if ( block == 0 ) return 0;
+		*block = size;
+		mOutstanding += size;
+		return (char *) block + kHeader;
+	}
+
+	virtual void APICALL deallocate ( void * ptr ) __NOTHROW__
+	{
+		if ( ptr == 0 ) return;
+		size_t * block = (size_t *) ((char *) ptr - kHeader);
+		mOutstanding -= *block;
+		free ( block );
+	}
+
+	virtual void * APICALL reallocate ( void * ptr, AdobeXMPCommon::sizet size ) __NOTHROW__
+	{
+		if ( ptr == 0 ) return allocate ( size );
+		size_t * block = (size_t *) ((char *) ptr - kHeader);
+		size_t oldSize = *block;
+		block = (size_t *) realloc ( block, size + kHeader );
+		if ( block == 0 ) return 0;
+		*block = size;
+		mOutstanding += size;
+		mOutstanding -= oldSize;
+		return (char *) block + kHeader;
+	}
+
+	size_t Outstanding() const { return mOutstanding; }
+
+private:
+	static const size_t kHeader = 16;
+	std::atomic<size_t> mOutstanding;
+};
+
+static CountingAllocator sCountingAllocator;
+
+static const char * kNS_Arena = "ns:newdom-arena/";
+
+static const char * kArenaPacket =
+	"<x:xmpmeta xmlns:x='adobe:ns:meta/'>"
+	"<rdf:RDF xmlns:rdf='http://www.w3.org/1999/02/22-rdf-syntax-ns#'>"
+	"<rdf:Description rdf:about='' xmlns:ar='ns:newdom-arena/' xmlns:dc='http://purl.org/dc/elements/1.1/'>"
+	"<ar:Simple>arena value</ar:Simple>"
+	"<ar:Struct rdf:parseType='Resource'><ar:Field>field value</ar:Field></ar:Struct>"
+	"<dc:subject><rdf:Bag><rdf:li>one</rdf:li><rdf:li>two</rdf:li></rdf:Bag></dc:subject>"
+	"</rdf:Description></rdf:RDF></x:xmpmeta>";
+
+static spIMetadata ParseUsingArena ( const char * packet )
+{
+	spIDOMParser parser = IDOMImplementationRegistry::GetDOMImplementationRegistry()->GetParser ( "rdf" );
+	parser->SetParameter ( IConfigurable::ConvertCharBufferToUint64 ( "useArena" ), true );
+	return parser->Parse ( packet, strlen ( packet ) );
+}	// ParseUsingArena
+
+static void CheckMemoryArena()
+{
+	string prefix;
+	Check ( ! SXMPMeta::GetNamespacePrefix ( kNS_Arena, &prefix ), "namespace not registered before the parse" );
+
+	// This is the first parse, whatever the parser creates lazily for later use must not land in the
+	// arena. Blocks keep going back to the allocator they came from, so it can stay registered.
+	ICoreConfigurationManager::GetCoreConfigurationManager()->RegisterMemoryAllocator ( &sCountingAllocator );
+	size_t baseline = sCountingAllocator.Outstanding();
+
+	spINode detached;
+	{
+		spIMetadata meta = ParseUsingArena ( kArenaPacket );
+		Check ( GetSimpleValue ( meta, kNS_Arena, "Simple" ) == "arena value", "simple property parsed" );
+		spIStructureNode structNode = meta->GetStructureNode ( kNS_Arena, npos, "Struct", npos );
+		Check ( structNode && (structNode->GetSimpleNode ( kNS_Arena, npos, "Field", npos )->GetValue()->compare ( "field value" ) == 0),
+				"struct field parsed" );
+		spIArrayNode arrayNode = meta->GetArrayNode ( kXMP_NS_DC, npos, "subject", npos );
+		Check ( arrayNode && (arrayNode->ChildCount() == 2), "array items parsed" );
+
+		spIMetadata copy = meta->Clone()->ConvertToMetadata();
+		Check ( GetSimpleValue ( copy, kNS_Arena, "Simple" ) == "arena value", "clone of an arena document" );
+
+		// A node taken out of the document keeps its memory alive after the document is gone.
+		detached = meta->RemoveNode ( kNS_Arena, npos, "Struct", npos );
+	}
+
+	Check ( detached && (detached->ConvertToStructureNode()->ChildCount() == 1), "node outlives its arena document" );
+	detached.reset();
+
+	// Only the parser's own lazily created objects may remain, the arena's first chunk alone is 8 KB.
+	size_t remaining = sCountingAllocator.Outstanding() - baseline;
+	Check ( remaining < 8 * 1024, "arena memory returned once the document and its nodes are gone" );
+
+	// The namespace was registered while the arena was in use, the arena is gone now.
+	Check ( SXMPMeta::GetNamespacePrefix ( kNS_Arena, &prefix ) && (prefix == "ar:"), "namespace registered by the parse survives the arena" );
+
+	SXMPMeta xmp;
+	xmp.SetProperty ( kNS_Arena, "Later", "later value" );
+	string rdf;
+	xmp.SerializeToBuffer ( &rdf, kXMP_OmitPacketWrapper );
+	Check ( rdf.find ( "xmlns:ar=\"ns:newdom-arena/\"" ) != string::npos, "namespace used by the old DOM after the arena is freed" );
+
+	spIMetadata meta = IMetadata::CreateMetadata();
+	meta->AppendNode ( ISimpleNode::CreateSimpleNode ( kNS_Arena, npos, "Later", npos, "later value", npos ) );
+	spIUTF8String serialized = IDOMImplementationRegistry::GetDOMImplementationRegistry()->GetSerializer ( "rdf" )->Serialize ( meta );
+	Check ( string ( serialized->c_str() ).find ( "ar:Later" ) != string::npos, "namespace used by the new DOM after the arena is freed" );
+
+	// A second arena document must not see anything of the first one.
+	spIMetadata again = ParseUsingArena ( kArenaPacket );
+	Check ( GetSimpleValue ( again, kNS_Arena, "Simple" ) == "arena value", "second parse into a fresh arena" );
+}	// CheckMemoryArena
+
+// =================================================================================================
+// Shared documents and threads
+// ============================
+//
+// With the C++ DOM behind SXMPMeta a conversion between the two models shares one document, the side
+// changed first switches to a copy of its own. Here one thread works on an SXMPMeta through the old
+// API while another changes the document converted from it, and sometimes the SXMPMeta is destroyed
+// during that change. Each side must only ever see its own changes.
+
+static const char * kNS_Shared = "ns:newdom-shared/";
+
+static string GetOldValue ( const SXMPMeta & meta, const char * name )
+{
+	string value;
+	return meta.GetProperty ( kNS_Shared, name, &value, 0 ) ? value : string ( "<none>" );
+}	// GetOldValue
+
+static void OldSideThread ( SXMPMeta * meta, SXMPMeta * view, bool destroy, std::atomic<int> * errors )
+{
+	try {
+		for ( int i = 0; i < 20; ++i ) {
+			if ( GetOldValue ( *meta, "Value" ) != "original" ) ++*errors;
+			if ( GetOldValue ( *view, "Value" ) != "original" ) ++*errors;
+			SXMPMeta clone = meta->Clone();
+			if ( GetOldValue ( clone, "Value" ) != "original" ) ++*errors;
+			if ( i == 10 ) meta->SetProperty ( kNS_Shared, "OldSide", "old" );
+			if ( i > 10 ) {
+				// Until its first change meta may still share the document the other thread changes.
+				spIMetadata doc = IMetadataConverterUtils::ConvertXMPMetatoIMetadata ( meta );
+				if ( GetSimpleValue ( doc, kNS_Shared, "Value" ) != "original" ) ++*errors;
+			}
+		}
+		if ( destroy ) delete meta;
+	} catch ( ... ) {
+		++*errors;
+	}
+}	// OldSideThread
+
+static void NewSideThread ( spIMetadata doc, std::atomic<int> * errors )
+{
+	try {
+		for ( int i = 0; i < 20; ++i ) {
+			spISimpleNode node = doc->GetSimpleNode ( kNS_Shared, npos, "Value", npos );
+			string value = "new " + to_string ( i );
+			node->SetValue ( value.c_str(), value.size() );
+			if ( GetSimpleValue ( doc, kNS_Shared, "Value" ) != value ) ++*errors;
+			spIMetadata copy = doc->Clone()->ConvertToMetadata();
+			if ( GetSimpleValue ( copy, kNS_Shared, "Value" ) != value ) ++*errors;
+		}
+	} catch ( ... ) {
+		++*errors;
+	}
+}	// NewSideThread
+
+static void CheckSharedDocumentThreads()
+{
+	WXMP_Result wResult;
+	WXMPMeta_Use_CPP_DOM_APIs_1 ( true, &wResult );
+	SXMPMeta::RegisterNamespace ( kNS_Shared, "sh", 0 );
+
+	std::atomic<int> errors ( 0 );
+	int wrongOldSide = 0, wrongNewSide = 0;
+
+	for ( int round = 0; round < 200; ++round ) {
+
+		SXMPMeta * meta = new SXMPMeta();
+		meta->SetProperty ( kNS_Shared, "Value", "original" );
+		spIMetadata doc = IMetadataConverterUtils::ConvertXMPMetatoIMetadata ( meta );
+		SXMPMeta view = IMetadataConverterUtils::ConvertIMetadatatoXMPMeta ( doc );	// A second view of doc.
+
+		bool destroy = (round % 2) == 1;
+		std::thread oldSide ( OldSideThread, meta, &view, destroy, &errors );
+		std::thread newSide ( NewSideThread, doc, &errors );
+		oldSide.join();
+		newSide.join();
+
+		if ( GetSimpleValue ( doc, kNS_Shared, "Value" ) != "new 19" ) ++wrongNewSide;
+		if ( doc->GetSimpleNode ( kNS_Shared, npos, "OldSide", npos ) ) ++wrongNewSide;
+		if ( ! destroy ) {
+			if ( GetOldValue ( *meta, "Value" ) != "original" ) ++wrongOldSide;
+			if ( GetOldValue ( *meta, "OldSide" ) != "old" ) ++wrongOldSide;
+			delete meta;
+		}
+
+	}
+
+	Check ( errors == 0, "each thread sees only its own changes" );
+	Check ( wrongNewSide == 0, "document keeps the changes made through the new DOM" );
+	Check ( wrongOldSide == 0, "SXMPMeta keeps the changes made through the old API" );
+
+	WXMPMeta_Use_CPP_DOM_APIs_1 ( false, &wResult );
+}	// CheckSharedDocumentThreads
+
+// =================================================================================================
+// Serializing into a region
+// =========================
+//
+// With the C++ DOM behind SXMPMeta, SerializeToRegion serializes once, through the fragment cache when
+// it can, and must produce the same bytes as an exact length SerializeToBuffer. A region that is too
+// small is left alone and the normally padded packet is returned instead.
+
+static void CheckSerializeToRegion()
+{
+	WXMP_Result wResult;
+	WXMPMeta_Use_CPP_DOM_APIs_1 ( true, &wResult );
+
+	SXMPMeta xmp;
+	xmp.SetProperty ( kXMP_NS_XMP, "CreatorTool", "NewDOMCorrectness" );
+	xmp.AppendArrayItem ( kXMP_NS_DC, "subject", kXMP_PropArrayIsUnordered, "one" );
+	xmp.AppendArrayItem ( kXMP_NS_DC, "subject", kXMP_PropArrayIsUnordered, "two" );
+	xmp.SetLocalizedText ( kXMP_NS_DC, "title", "", "x-default", "Region" );
+
+	const XMP_OptionBits optionList[] = { 0, kXMP_UseCompactFormat, kXMP_EncodeUTF16Big, kXMP_EncodeUTF16Little };
+	for ( size_t o = 0; o < sizeof(optionList)/sizeof(optionList[0]); ++o ) {
+
+		XMP_OptionBits options = optionList[o];
+		XMP_StringLen unit = (options & kXMP_EncodeUTF16Big) ? 2 : 1;
+		XMP_StringLen size = xmp.GetSerializedSize ( options );
+		char what [200];
+		string exact, packet, overflow;
+
+		// The second pass over each size is served from the fragment cache.
+		for ( int pass = 0; pass < 2; ++pass ) {
+			const XMP_StringLen regionSizes[] = { size, (size + 40*unit) };
+			for ( size_t r = 0; r < sizeof(regionSizes)/sizeof(regionSizes[0]); ++r ) {
+				vector<char> region ( regionSizes[r], '\xA5' );
+				bool fits = xmp.SerializeToRegion ( &region[0], regionSizes[r], &overflow, options );
+				xmp.SerializeToBuffer ( &exact, (options | kXMP_ExactPacketLength), regionSizes[r] );
+				snprintf ( what, sizeof(what), "options 0x%X, region of %u bytes filled exactly", (unsigned)options, (unsigned)regionSizes[r] );
+				Check ( fits && (exact.size() == regionSizes[r]) && (memcmp ( &region[0], exact.data(), regionSizes[r] ) == 0), what );
+			}
+		}
+
+		vector<char> region ( (size - unit), '\xA5' );
+		bool fits = xmp.SerializeToRegion ( &region[0], (size - unit), &overflow, options );
+		bool untouched = true;
+		for ( size_t i = 0; i < region.size(); ++i ) untouched &= (region[i] == '\xA5');
+		xmp.SerializeToBuffer ( &packet, options );
+		snprintf ( what, sizeof(what), "options 0x%X, small region untouched, normal packet returned", (unsigned)options );
+		Check ( (! fits) && untouched && (overflow == packet), what );
+
+	}
+
+	WXMPMeta_Use_CPP_DOM_APIs_1 ( false, &wResult );
+}	// CheckSerializeToRegion
+
+// =================================================================================================
+// Fragment cache
+// ==============
+//
+// The RDF serializer keeps the fragments of the top level properties of a document and only renders
+// those changed since the previous serialization, walking the document with a NodeCursor. The packet
+// of each fixture is parsed into the C++ DOM and serialized through the cache, before and after one of
+// its deepest values is changed. Parsed again, each packet must give the same tree as the packet of a
+// conversion of the whole document to the old DOM, which does not use the cache.
+
+static bool ReadFixturePacket ( const char * fixture, string * packet )
+{
+	string path = sTestFolder + fixture;
+	FILE * file = fopen ( path.c_str(), "rb" );
+	if ( file == 0 ) return false;
+	string contents;
+	char buffer [64*1024];
+	for ( size_t count; (count = fread ( buffer, 1, sizeof(buffer), file )) > 0; ) contents.append ( buffer, count );
+	fclose ( file );
+
+	size_t begin = contents.find ( "<?xpacket begin" );
+	size_t end = contents.find ( "<?xpacket end", begin );
+	if ( (begin == string::npos) || (end == string::npos) ) return false;
+	end = contents.find ( "?>", end );
+	if ( end == string::npos ) return false;
+	packet->assign ( contents, begin, (end + 2 - begin) );
+	return true;
+}	// ReadFixturePacket
+
+static bool SameTree ( const string & packet, const spIMetadata & meta )
+{
+	string uncached;
+	IMetadataConverterUtils::ConvertIMetadatatoXMPMeta ( meta ).SerializeToBuffer ( &uncached );
+	SXMPMeta left ( packet.c_str(), (XMP_StringLen)packet.size() );
+	SXMPMeta right ( uncached.c_str(), (XMP_StringLen)uncached.size() );
+	if ( left.GetFingerprint() != right.GetFingerprint() ) return false;
+	string diff;
+	SXMPUtils::DiffProperties ( left, right, &diff );
+	size_t lines = 0;	// The first line of a diff is the header, each other line is one operation.
+	for ( size_t i = 0; i < diff.size(); ++i ) lines += (diff[i] == '\n');
+	if ( (! diff.empty()) && (diff[diff.size()-1] != '\n') ) ++lines;
+	return (lines <= 1);
+}	// SameTree
+
+// Find the first simple node at the end of the first children, the deepest one of the first composite
+// property if there is one.
+
+static spISimpleNode FindDeepValue ( const spIMetadata & meta )
+{
+	spISimpleNode firstSimple;
+	for ( spINodeIterator props = meta->Iterator(); props; props = props->Next() ) {
+		spINode node = props->GetNode();
+		if ( node->GetNodeType() == INode::kNTSimple ) {
+			if ( ! firstSimple ) firstSimple = node->ConvertToSimpleNode();
+			continue;
+		}
+		while ( node && (node->GetNodeType() != INode::kNTSimple) ) {
+			spINodeIterator children = (node->GetNodeType() == INode::kNTStructure) ?
+									   node->ConvertToStructureNode()->Iterator() : node->ConvertToArrayNode()->Iterator();
+			node = children ? children->GetNode() : spINode();
+		}
+		if ( node ) return node->ConvertToSimpleNode();
+	}
+	return firstSimple;
+}	// FindDeepValue
+
+static void CheckFragmentCache()
+{
+	spIDOMParser parser = IDOMImplementationRegistry::GetDOMImplementationRegistry()->GetParser ( "rdf" );
+	spIDOMSerializer serializer = IDOMImplementationRegistry::GetDOMImplementationRegistry()->GetSerializer ( "rdf" );
+	char what [200];
+
+	for ( size_t i = 0; kFixtures[i] != 0; ++i ) {
+
+		const char * fixture = kFixtures[i];
+		string packet;
+		if ( ! ReadFixturePacket ( fixture, &packet ) ) {
+			snprintf ( what, sizeof(what), "%s : packet found", fixture );
+			Check ( false, what );
+			continue;
+		}
+
+		try {
+
+			spIMetadata meta = parser->Parse ( packet.c_str(), packet.size() );
+
+			string first = serializer->Serialize ( meta )->c_str();
+			snprintf ( what, sizeof(what), "%s : first serialization matches the uncached conversion", fixture );
+			Check ( SameTree ( first, meta ), what );
+
+			string cached = serializer->Serialize ( meta )->c_str();
+			snprintf ( what, sizeof(what), "%s : unchanged document serialized from the cache", fixture );
+			Check ( cached == first, what );
+
+			spISimpleNode value = FindDeepValue ( meta );
+			if ( ! value ) continue;
+			string newValue = string ( value->GetValue()->c_str() ) + " (changed)";
+			value->SetValue ( newValue.c_str(), newValue.size() );
+
+			string changed = serializer->Serialize ( meta )->c_str();
+			snprintf ( what, sizeof(what), "%s : changed value re-rendered, matches the uncached conversion", fixture );
+			Check ( (changed != first) && (changed.find ( newValue ) != string::npos) &&
+					SameTree ( changed, meta ), what );
+
+		} catch ( AdobeXMPCommon::spcIError & error ) {
+			snprintf ( what, sizeof(what), "%s : caught IError %d", fixture, (int) error->GetCode() );
+			Check ( false, what );
+		} catch ( XMP_Error & excep ) {
+			snprintf ( what, sizeof(what), "%s : caught XMP_Error %d", fixture, excep.GetID() );
+			Check ( false, what );
+		}
+
+	}
+
+}	// CheckFragmentCache
+
+// =================================================================================================
+
+extern "C" int main ( int argc, const char * argv[] )
+{
+	if ( argc > 1 ) {
+		sTestFolder = argv[1];
+		if ( (! sTestFolder.empty()) && (sTestFolder[sTestFolder.size()-1] != '/') ) sTestFolder += '/';
+	}
+
+	if ( ! SXMPMeta::Initialize() ) {
+		fprintf ( stderr, "## SXMPMeta::Initialize failed!\n" );
+		return -1;
+	}
+
+	try {
+
+		WriteMinorLabel ( "Memory arena" );
+		CheckMemoryArena();
+
+		WriteMinorLabel ( "Shared documents and threads" );
+		CheckSharedDocumentThreads();
+
+		WriteMinorLabel ( "Serializing into a region" );
+		CheckSerializeToRegion();
+
+		WriteMinorLabel ( "Fragment cache" );
+		CheckFragmentCache();
+
+	} catch ( XMP_Error & excep ) {
+
+		fprintf ( sLogFile, "\n## Caught XMP_Error %d : %s\n", excep.GetID(), excep.GetErrMsg() );
+		++sFailures;
+
+	} catch ( AdobeXMPCommon::spcIError & error ) {
+
+		fprintf ( sLogFile, "\n## Caught IError %d\n", (int) error->GetCode() );
+		++sFailures;
+
+	} catch ( ... ) {
+
+		fprintf ( sLogFile, "\n## Caught unknown exception\n" );
+		++sFailures;
+
+	}
+
+	SXMPMeta::Terminate();
+
+	fprintf ( sLogFile, "\nNewDOMCorrectness finished, %d failures\n", sFailures );
+	return sFailures;
+
+}
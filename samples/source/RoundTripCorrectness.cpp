@@ -0,0 +1,2125 @@
+// =================================================================================================
+// Copyright 2026 Adobe
+// All Rights Reserved.
+//
+// NOTICE:  Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it.
+// =================================================================================================
+
+/**
+ * Regression checks that round trip the XMP of the samples/testfiles fixtures through the newer XMPCore
+ * APIs. Each check is logged, the exit status is the number of failed checks. The fixtures are looked
+ * for in ../../../../testfiles, as for XMPFilesCoverage, or in the folder named on the command line.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define TXMP_STRING_TYPE std::string
+#define XMP_INCLUDE_XMPFILES 1
+#include "public/include/XMP.hpp"
+#include "public/include/XMP.incl_cpp"
+
+using namespace std;
+
+#if WIN_ENV
+	#pragma warning ( disable : 4996 )	// '...' was declared deprecated
+#endif
+
+// =================================================================================================
+
+static FILE * sLogFile = stdout;
+static string sTestFolder = "../../../../testfiles/";
+static int    sFailures = 0;
+
+static const char * kFixtures[] = { "BlueSquare.ai", "BlueSquare.avi", "BlueSquare.eps", "BlueSquare.indd",
+									"BlueSquare.jpg", "BlueSquare.mov", "BlueSquare.mp3", "BlueSquare.pdf",
+									"BlueSquare.png", "BlueSquare.psd", "BlueSquare.tif", "BlueSquare.wav",
+									"Image1.jpg", "Image2.jpg", 0 };
+
+static const char * kNS_RoundTrip = "ns:roundtrip/";
+
+// =================================================================================================
+
+static void WriteMinorLabel ( const char * title )
+{
+	fprintf ( sLogFile, "\n// " );
+	for ( size_t i = 0; i < strlen(title); ++i ) fprintf ( sLogFile, "-" );
+	fprintf ( sLogFile, "--\n// %s :\n\n", title );
+}	// WriteMinorLabel
+
+// -------------------------------------------------------------------------------------------------
+
+static void Check ( bool ok, const char * fixture, const char * what )
+{
+	if ( ok ) {
+		fprintf ( sLogFile, "   ok     %s : %s\n", fixture, what );
+	} else {
+		fprintf ( sLogFile, "## FAILED %s : %s\n", fixture, what );
+		++sFailures;
+	}
+}	// Check
+
+// -------------------------------------------------------------------------------------------------
+
+static void CheckThrows ( void (*proc) ( void * ), void * arg, XMP_Int32 errorID, const char * fixture, const char * what )
+{
+	bool threw = false;
+	try {
+		proc ( arg );
+	} catch ( XMP_Error & excep ) {
+		threw = (excep.GetID() == errorID);
+	}
+	Check ( threw, fixture, what );
+}	// CheckThrows
+
+// -------------------------------------------------------------------------------------------------
+// CountDiffOps
+// ------------
+//
+// The first line of a diff is the header, each other line is one operation.
+
+static size_t CountDiffOps ( const string & diff )
+{
+	size_t lines = 0;
+	for ( size_t i = 0; i < diff.size(); ++i ) {
+		if ( diff[i] == '\n' ) ++lines;
+	}
+	if ( (! diff.empty()) && (diff[diff.size()-1] != '\n') ) ++lines;
+	return (lines > 0) ? (lines - 1) : 0;
+}	// CountDiffOps
+
+// -------------------------------------------------------------------------------------------------
+// SameXMP
+// -------
+//
+// Two objects are the same if they have the same fingerprint and the diff between them is empty.
+
+static bool SameXMP ( const SXMPMeta & left, const SXMPMeta & right )
+{
+	if ( left.GetFingerprint() != right.GetFingerprint() ) return false;
+	string diff;
+	SXMPUtils::DiffProperties ( left, right, &diff );
+	return (CountDiffOps ( diff ) == 0);
+}	// SameXMP
+
+// -------------------------------------------------------------------------------------------------
+
+static bool GetFixtureXMP ( const char * fixture, SXMPMeta * xmp )
+{
+	string path = sTestFolder + fixture;
+	SXMPFiles file;
+	if ( ! file.OpenFile ( path, kXMP_UnknownFile, kXMPFiles_OpenForRead ) ) return false;
+	bool found = file.GetXMP ( xmp );
+	file.CloseFile();
+	return found;
+}	// GetFixtureXMP
+
+// -------------------------------------------------------------------------------------------------
+// ForEachFixture
+// --------------
+//
+// Run one set of checks on the XMP of each fixture. A fixture without XMP is skipped. An exception
+// fails that fixture, the others are still checked.
+
+typedef void (*FixtureCheck) ( const char * fixture, const SXMPMeta & fileXMP );
+
+static void ForEachFixture ( const char * title, FixtureCheck check )
+{
+	WriteMinorLabel ( title );
+
+	for ( size_t i = 0; kFixtures[i] != 0; ++i ) {
+		try {
+			SXMPMeta fileXMP;
+			if ( ! GetFixtureXMP ( kFixtures[i], &fileXMP ) ) {
+				fprintf ( sLogFile, "   --     %s : no XMP found, skipped\n", kFixtures[i] );
+				continue;
+			}
+			check ( kFixtures[i], fileXMP );
+		} catch ( XMP_Error & excep ) {
+			fprintf ( sLogFile, "## Caught XMP_Error %d : %s\n", excep.GetID(), excep.GetErrMsg() );
+			Check ( false, kFixtures[i], "no exception" );
+		}
+	}
+
+}	// ForEachFixture
+
+// =================================================================================================
+// Diff and ApplyDiff
+// ==================
+//
+// Edit a copy of the fixture XMP with the kinds of change the diff describes: new and replaced values,
+// removals, qualifiers, an array item move, and values that need escapes. The diffs both ways must
+// turn each object into the other.
+
+static void ApplyToWrongBase ( void * arg )
+{
+	const string * diff = (const string *)arg;
+	SXMPMeta other;
+	other.SetProperty ( kNS_RoundTrip, "Other", "value" );
+	SXMPUtils::ApplyDiff ( &other, *diff );
+}
+
+struct ApplyDiffArgs {
+	SXMPMeta * xmp;
+	string diff;
+	XMP_OptionBits options;
+};
+
+static void ApplyDiffWithOptions ( void * arg )
+{
+	ApplyDiffArgs * args = (ApplyDiffArgs *)arg;
+	SXMPUtils::ApplyDiff ( args->xmp, args->diff.c_str(), (XMP_StringLen)args->diff.size(), args->options );
+}
+
+// A refused or failing diff leaves the object and the namespace registry alone.
+
+static void CheckDiffFailures ( const char * fixture, const SXMPMeta & oldXMP, const SXMPMeta & newXMP )
+{
+	static const char * kNS_Unregistered = "ns:roundtrip-diff-unregistered/";
+	string header, diff, prefix, before, after;
+	SXMPUtils::DiffProperties ( oldXMP, newXMP, &diff );
+	header = diff.substr ( 0, diff.find ( '\n' ) + 1 );
+
+	SXMPMeta other;
+	other.SetProperty ( kNS_RoundTrip, "Other", "value" );
+	other.SerializeToBuffer ( &before, kXMP_OmitPacketWrapper );
+	ApplyDiffArgs args = { &other, header + "N du " + kNS_Unregistered + "\n+ du:Prop 0 value\n", 0 };
+	CheckThrows ( ApplyDiffWithOptions, &args, kXMPErr_BadParam, fixture, "diff with a new namespace refused for another object" );
+	Check ( ! SXMPMeta::GetNamespacePrefix ( kNS_Unregistered, &prefix ), fixture, "namespace of a refused diff not registered" );
+
+	// The first op matches, the second one does not.
+	SXMPMeta patched = oldXMP.Clone();
+	patched.SerializeToBuffer ( &before, kXMP_OmitPacketWrapper );
+	args.xmp = &patched;
+	args.diff = header + "N rt " + kNS_RoundTrip + "\n= rt:Removed 0 changed\n- rt:Missing\n";
+	args.options = kXMPUtil_IgnoreDiffBase;
+	CheckThrows ( ApplyDiffWithOptions, &args, kXMPErr_BadParam, fixture, "diff that stops matching part way refused" );
+	patched.SerializeToBuffer ( &after, kXMP_OmitPacketWrapper );
+	Check ( (after == before), fixture, "object unchanged after a diff failed part way" );
+
+	// A wrong result fingerprint in the header.
+	args.diff = diff;
+	args.diff.replace ( header.size() - 17, 16, "0000000000000000" );
+	args.options = 0;
+	CheckThrows ( ApplyDiffWithOptions, &args, kXMPErr_BadParam, fixture, "diff with a wrong result fingerprint refused" );
+	patched.SerializeToBuffer ( &after, kXMP_OmitPacketWrapper );
+	Check ( (after == before), fixture, "object unchanged after a wrong result" );
+
+}	// CheckDiffFailures
+
+static void CheckDiff ( const char * fixture, const SXMPMeta & fileXMP )
+{
+	SXMPMeta oldXMP = fileXMP.Clone();
+	oldXMP.AppendArrayItem ( kNS_RoundTrip, "Order", kXMP_PropArrayIsOrdered, "first" );
+	oldXMP.AppendArrayItem ( kNS_RoundTrip, "Order", kXMP_PropArrayIsOrdered, "second" );
+	oldXMP.AppendArrayItem ( kNS_RoundTrip, "Order", kXMP_PropArrayIsOrdered, "third" );
+	oldXMP.SetProperty ( kNS_RoundTrip, "Removed", "going away" );
+
+	SXMPMeta newXMP = oldXMP.Clone();
+	newXMP.SetProperty ( kXMP_NS_XMP, "CreatorTool", "RoundTripCorrectness" );
+	newXMP.SetQualifier ( kXMP_NS_XMP, "CreatorTool", kNS_RoundTrip, "Qual", "qualifier value" );
+	newXMP.SetLocalizedText ( kXMP_NS_DC, "title", "", "x-default", "Line 1\nLine 2\r\\ end" );
+	newXMP.AppendArrayItem ( kXMP_NS_DC, "subject", kXMP_PropArrayIsUnordered, "round trip" );
+	newXMP.DeleteProperty ( kNS_RoundTrip, "Removed" );
+	newXMP.DeleteProperty ( kNS_RoundTrip, "Order" );
+	newXMP.AppendArrayItem ( kNS_RoundTrip, "Order", kXMP_PropArrayIsOrdered, "third" );
+	newXMP.AppendArrayItem ( kNS_RoundTrip, "Order", kXMP_PropArrayIsOrdered, "first" );
+	newXMP.AppendArrayItem ( kNS_RoundTrip, "Order", kXMP_PropArrayIsOrdered, "second" );
+	newXMP.SetStructField ( kNS_RoundTrip, "Struct", kNS_RoundTrip, "Field", "field value" );
+
+	string diff;
+
+	SXMPUtils::DiffProperties ( oldXMP, oldXMP, &diff );
+	Check ( (CountDiffOps ( diff ) == 0), fixture, "diff with itself is empty" );
+
+	SXMPUtils::DiffProperties ( oldXMP, newXMP, &diff );
+	SXMPMeta patched = oldXMP.Clone();
+	SXMPUtils::ApplyDiff ( &patched, diff );
+	Check ( SameXMP ( patched, newXMP ), fixture, "old + diff(old,new) == new" );
+	Check ( (diff.find ( "\n> " ) != string::npos), fixture, "reordered item is a move" );
+
+	CheckThrows ( ApplyToWrongBase, &diff, kXMPErr_BadParam, fixture, "diff refused for another object" );
+	CheckDiffFailures ( fixture, oldXMP, newXMP );
+
+	SXMPUtils::DiffProperties ( newXMP, oldXMP, &diff );
+	patched = newXMP.Clone();
+	SXMPUtils::ApplyDiff ( &patched, diff );
+	Check ( SameXMP ( patched, oldXMP ), fixture, "new + diff(new,old) == old" );
+
+	SXMPMeta emptyXMP;
+	SXMPUtils::DiffProperties ( emptyXMP, fileXMP, &diff );
+	patched = emptyXMP.Clone();
+	SXMPUtils::ApplyDiff ( &patched, diff.c_str(), (XMP_StringLen)diff.size() );
+	Check ( SameXMP ( patched, fileXMP ), fixture, "empty + diff(empty,file) == file" );
+
+	string packet;
+	newXMP.SerializeToBuffer ( &packet, kXMP_OmitPacketWrapper );
+	SXMPMeta parsed ( packet.c_str(), (XMP_StringLen)packet.size() );
+	Check ( SameXMP ( parsed, newXMP ), fixture, "serialized and parsed again is unchanged" );
+
+}	// CheckDiff
+
+// =================================================================================================
+// Reset and SXMPMetaPool
+// ======================
+//
+// A reset object keeps its node storage for the next parse, which must give the same result as
+// parsing into a new object. Check that nothing of the previous tree shows through, also after a
+// bigger tree, and that pooled objects come back empty.
+
+static bool IsEmpty ( const SXMPMeta & xmp )
+{
+	string name;
+	xmp.GetObjectName ( &name );
+	SXMPIterator iter ( xmp );
+	return name.empty() && (! iter.Next());
+}	// IsEmpty
+
+static void CheckReset ( const char * fixture, const SXMPMeta & fileXMP )
+{
+	string packet, biggerPacket;
+	fileXMP.SerializeToBuffer ( &packet, kXMP_OmitPacketWrapper );
+	SXMPMeta fresh ( packet.c_str(), (XMP_StringLen)packet.size() );
+
+	SXMPMeta bigger = fresh.Clone();
+	bigger.SetObjectName ( "bigger" );
+	for ( int i = 1; i <= 100; ++i ) {
+		char value [32];
+		snprintf ( value, sizeof(value), "item %d", i );
+		bigger.AppendArrayItem ( kNS_RoundTrip, "Bag", kXMP_PropValueIsArray, value );
+		bigger.SetQualifier ( kNS_RoundTrip, "Bag[last()]", kNS_RoundTrip, "Qual", value );
+	}
+	bigger.SerializeToBuffer ( &biggerPacket, kXMP_OmitPacketWrapper );
+
+	SXMPMeta reused;
+	reused.ParseFromBuffer ( packet.c_str(), (XMP_StringLen)packet.size() );
+	Check ( SameXMP ( reused, fresh ), fixture, "parsed into an object" );
+	SXMPMeta clone = reused.Clone();
+
+	reused.Reset();
+	Check ( IsEmpty ( reused ), fixture, "empty after Reset" );
+	Check ( SameXMP ( clone, fresh ), fixture, "clone not changed by Reset" );
+	reused.ParseFromBuffer ( packet.c_str(), (XMP_StringLen)packet.size() );
+	Check ( SameXMP ( reused, fresh ), fixture, "parsed again after Reset" );
+
+	reused.Reset();
+	reused.ParseFromBuffer ( biggerPacket.c_str(), (XMP_StringLen)biggerPacket.size() );
+	Check ( SameXMP ( reused, bigger ), fixture, "bigger tree parsed after Reset" );
+	reused.Reset();
+	reused.ParseFromBuffer ( packet.c_str(), (XMP_StringLen)packet.size() );
+	Check ( SameXMP ( reused, fresh ), fixture, "smaller tree parsed after the bigger one" );
+
+	{
+		SXMPMetaPool::Lease lease;
+		Check ( IsEmpty ( *lease ), fixture, "leased object is empty" );
+		lease->ParseFromBuffer ( biggerPacket.c_str(), (XMP_StringLen)biggerPacket.size() );
+		Check ( SameXMP ( *lease, bigger ), fixture, "parsed into a leased object" );
+	}
+
+	{
+		SXMPMetaPool::Lease lease;
+		Check ( IsEmpty ( *lease ), fixture, "leased object is empty when reused" );
+		lease->ParseFromBuffer ( packet.c_str(), (XMP_StringLen)packet.size() );
+		Check ( SameXMP ( *lease, fresh ), fixture, "parsed into a reused leased object" );
+	}
+
+	SXMPMeta * first  = SXMPMetaPool::Acquire();
+	SXMPMeta * second = SXMPMetaPool::Acquire();
+	Check ( (first != second), fixture, "distinct objects acquired" );
+	first->ParseFromBuffer ( packet.c_str(), (XMP_StringLen)packet.size() );
+	second->ParseFromBuffer ( biggerPacket.c_str(), (XMP_StringLen)biggerPacket.size() );
+	Check ( SameXMP ( *first, fresh ) && SameXMP ( *second, bigger ), fixture, "acquired objects are independent" );
+	SXMPMetaPool::Release ( first );
+	SXMPMetaPool::Release ( second );
+
+}	// CheckReset
+
+// =================================================================================================
+// BatchApplyTemplate and BatchRemoveProperties
+// ============================================
+//
+// The batch forms must give each object the same result as the single object forms, for any number
+// of threads. All of the fixtures are done as one batch.
+
+static void GetAllFixtureXMP ( vector<SXMPMeta> * all, vector<string> * names )
+{
+	for ( size_t i = 0; kFixtures[i] != 0; ++i ) {
+		SXMPMeta fileXMP;
+		if ( ! GetFixtureXMP ( kFixtures[i], &fileXMP ) ) continue;
+		all->push_back ( fileXMP );
+		names->push_back ( kFixtures[i] );
+	}
+}	// GetAllFixtureXMP
+
+static void CopyBatch ( const vector<SXMPMeta> & source, vector<SXMPMeta> * copies, vector<SXMPMeta*> * pointers )
+{
+	copies->clear();
+	pointers->clear();
+	for ( size_t i = 0; i < source.size(); ++i ) copies->push_back ( source[i].Clone() );
+	for ( size_t i = 0; i < copies->size(); ++i ) pointers->push_back ( &(*copies)[i] );
+}	// CopyBatch
+
+static void CheckBatch()
+{
+	WriteMinorLabel ( "BatchApplyTemplate and BatchRemoveProperties" );
+
+	vector<SXMPMeta> all;
+	vector<string> names;
+	GetAllFixtureXMP ( &all, &names );
+
+	SXMPMeta templateXMP;
+	GetFixtureXMP ( "BlueSquare.jpg", &templateXMP );
+	templateXMP.SetProperty ( kXMP_NS_XMP, "CreatorTool", "RoundTripCorrectness" );
+	templateXMP.SetProperty ( kXMP_NS_XMP, "Label", "" );
+	templateXMP.SetLocalizedText ( kXMP_NS_DC, "title", "", "x-default", "Template title" );
+	templateXMP.AppendArrayItem ( kXMP_NS_DC, "subject", kXMP_PropArrayIsUnordered, "template" );
+	templateXMP.SetStructField ( kNS_RoundTrip, "Struct", kNS_RoundTrip, "Field", "template field" );
+
+	static const XMP_OptionBits kActions[] = {
+		kXMPTemplate_AddNewProperties,
+		kXMPTemplate_ReplaceExistingProperties,
+		kXMPTemplate_ReplaceExistingProperties | kXMPTemplate_ReplaceWithDeleteEmpty,
+		kXMPTemplate_ClearUnnamedProperties | kXMPTemplate_AddNewProperties,
+		kXMPTemplate_ClearUnnamedProperties | kXMPTemplate_ReplaceExistingProperties |
+			kXMPTemplate_AddNewProperties | kXMPTemplate_IncludeInternalProperties };
+	static const XMP_Index kThreads[] = { 1, 4, 0 };
+
+	vector<SXMPMeta> batch;
+	vector<SXMPMeta*> pointers;
+	char what [100];
+
+	for ( size_t a = 0; a < sizeof(kActions)/sizeof(kActions[0]); ++a ) {
+		for ( size_t t = 0; t < sizeof(kThreads)/sizeof(kThreads[0]); ++t ) {
+			CopyBatch ( all, &batch, &pointers );
+			SXMPUtils::BatchApplyTemplate ( &pointers[0], (XMP_Index)pointers.size(), templateXMP, kActions[a], kThreads[t] );
+			snprintf ( what, sizeof(what), "BatchApplyTemplate actions 0x%X, %d threads", (unsigned)kActions[a], (int)kThreads[t] );
+			for ( size_t i = 0; i < all.size(); ++i ) {
+				SXMPMeta single = all[i].Clone();
+				SXMPUtils::ApplyTemplate ( &single, templateXMP, kActions[a] );
+				Check ( SameXMP ( batch[i], single ), names[i].c_str(), what );
+			}
+		}
+	}
+
+	struct RemoveCase { const char * schemaNS; const char * propName; XMP_OptionBits options; };
+	static const RemoveCase kRemoves[] = {
+		{ kXMP_NS_DC, 0, 0 },
+		{ kXMP_NS_XMP, "CreatorTool", 0 },
+		{ kXMP_NS_XMP_MM, 0, kXMPUtil_DoAllProperties },
+		{ 0, 0, 0 },
+		{ 0, 0, kXMPUtil_DoAllProperties } };
+
+	for ( size_t r = 0; r < sizeof(kRemoves)/sizeof(kRemoves[0]); ++r ) {
+		const RemoveCase & rc = kRemoves[r];
+		CopyBatch ( all, &batch, &pointers );
+		SXMPUtils::BatchRemoveProperties ( &pointers[0], (XMP_Index)pointers.size(), rc.schemaNS, rc.propName, rc.options, 4 );
+		snprintf ( what, sizeof(what), "BatchRemoveProperties %s %s 0x%X",
+				   (rc.schemaNS ? rc.schemaNS : "(all)"), (rc.propName ? rc.propName : "(all)"), (unsigned)rc.options );
+		for ( size_t i = 0; i < all.size(); ++i ) {
+			SXMPMeta single = all[i].Clone();
+			SXMPUtils::RemoveProperties ( &single, rc.schemaNS, rc.propName, rc.options );
+			Check ( SameXMP ( batch[i], single ), names[i].c_str(), what );
+		}
+	}
+
+}	// CheckBatch
+
+// =================================================================================================
+// GetSerializedSize and SerializeToRegion
+// =======================================
+//
+// The counted size must be the size of the unpadded packet, and the smallest exact packet length
+// that works. A region at least that big gets the same bytes as an exact length SerializeToBuffer,
+// a smaller one is left alone and the normal packet is returned instead.
+
+struct SerializeExactArgs {
+	const SXMPMeta * xmp;
+	XMP_OptionBits options;
+	XMP_StringLen size;
+};
+
+static void SerializeExact ( void * arg )
+{
+	const SerializeExactArgs * exact = (const SerializeExactArgs *)arg;
+	string packet;
+	exact->xmp->SerializeToBuffer ( &packet, (exact->options | kXMP_ExactPacketLength), exact->size );
+}
+
+static void CheckRegion ( const char * fixture, const SXMPMeta & fileXMP )
+{
+	static const XMP_OptionBits kOptions[] = {
+		0,
+		kXMP_UseCompactFormat,
+		kXMP_UseCanonicalFormat,
+		kXMP_EncodeUTF16Big,
+		kXMP_UseCompactFormat | kXMP_EncodeUTF16Little,
+		kXMP_UseCompactFormat | kXMP_EncodeUTF32Little };
+
+	SXMPMeta xmp = fileXMP.Clone();
+	xmp.SetProperty ( kNS_RoundTrip, "Escapes", "<&> \"quoted\" \xC3\xA9\xE2\x82\xAC" );
+
+	char what [100];
+
+	for ( size_t o = 0; o < sizeof(kOptions)/sizeof(kOptions[0]); ++o ) {
+
+		const XMP_OptionBits options = kOptions[o];
+		const XMP_StringLen unit = (options & _XMP_UTF32_Bit) ? 4 : ((options & _XMP_UTF16_Bit) ? 2 : 1);
+		string packet, overflow, exact;
+
+		XMP_StringLen size = xmp.GetSerializedSize ( options );
+		xmp.SerializeToBuffer ( &packet, (options | kXMP_ReadOnlyPacket) );
+		snprintf ( what, sizeof(what), "options 0x%X, size is the read-only packet size", (unsigned)options );
+		Check ( (size == packet.size()), fixture, what );
+
+		XMP_StringLen omitSize = xmp.GetSerializedSize ( options | kXMP_OmitPacketWrapper );
+		xmp.SerializeToBuffer ( &packet, (options | kXMP_OmitPacketWrapper) );
+		snprintf ( what, sizeof(what), "options 0x%X, size is the unwrapped size", (unsigned)options );
+		Check ( (omitSize == packet.size()), fixture, what );
+
+		xmp.SerializeToBuffer ( &exact, (options | kXMP_ExactPacketLength), size );
+		snprintf ( what, sizeof(what), "options 0x%X, size is a usable exact length", (unsigned)options );
+		Check ( (exact.size() == size), fixture, what );
+
+		SerializeExactArgs args = { &xmp, options, (size - unit) };
+		snprintf ( what, sizeof(what), "options 0x%X, size is the smallest exact length", (unsigned)options );
+		CheckThrows ( SerializeExact, &args, kXMPErr_BadSerialize, fixture, what );
+
+		const XMP_StringLen regionSizes[] = { size, (size + 40*unit), (size + 4000*unit) };
+		for ( size_t r = 0; r < sizeof(regionSizes)/sizeof(regionSizes[0]); ++r ) {
+			vector<char> region ( regionSizes[r], '\xA5' );
+			bool fits = xmp.SerializeToRegion ( &region[0], regionSizes[r], &overflow, options );
+			xmp.SerializeToBuffer ( &exact, (options | kXMP_ExactPacketLength), regionSizes[r] );
+			snprintf ( what, sizeof(what), "options 0x%X, region of %u bytes filled exactly", (unsigned)options, (unsigned)regionSizes[r] );
+			Check ( (fits && (memcmp ( &region[0], exact.data(), regionSizes[r] ) == 0)), fixture, what );
+			if ( unit == 4 ) continue;	// The parser does not read UTF-32.
+			SXMPMeta parsed ( &region[0], regionSizes[r] );
+			snprintf ( what, sizeof(what), "options 0x%X, region of %u bytes parses back", (unsigned)options, (unsigned)regionSizes[r] );
+			Check ( SameXMP ( parsed, xmp ), fixture, what );
+		}
+
+		vector<char> region ( (size - unit), '\xA5' );
+		bool fits = xmp.SerializeToRegion ( &region[0], (size - unit), &overflow, options );
+		bool untouched = true;
+		for ( size_t i = 0; i < region.size(); ++i ) untouched &= (region[i] == '\xA5');
+		xmp.SerializeToBuffer ( &packet, options );
+		snprintf ( what, sizeof(what), "options 0x%X, small region untouched, normal packet returned", (unsigned)options );
+		Check ( ((! fits) && untouched && (overflow == packet)), fixture, what );
+
+	}
+
+}	// CheckRegion
+
+// =================================================================================================
+// Iteration
+// =========
+//
+// The iterator walks the tree as it goes. Its walks of a small packet are compared with those of the
+// original iterator, which listed all of the nodes up front. Each line is the schema, path, value,
+// and options of one step. A Skip call is made right after the given path is returned. The object
+// is also changed in the middle of some walks, the iterator has to find its place again.
+
+static const char * kIterPacket =
+	"<x:xmpmeta xmlns:x='adobe:ns:meta/'><rdf:RDF xmlns:rdf='http://www.w3.org/1999/02/22-rdf-syntax-ns#'>"
+	"<rdf:Description rdf:about='' xmlns:dc='http://purl.org/dc/elements/1.1/'"
+	" xmlns:xmp='http://ns.adobe.com/xap/1.0/' xmlns:rt='ns:roundtrip/'>"
+	"<xmp:CreatorTool>Tool</xmp:CreatorTool>"
+	"<dc:title><rdf:Alt><rdf:li xml:lang='x-default'>Title</rdf:li><rdf:li xml:lang='fr'>Title</rdf:li></rdf:Alt></dc:title>"
+	"<dc:subject><rdf:Bag><rdf:li>one</rdf:li><rdf:li>two</rdf:li><rdf:li>three</rdf:li></rdf:Bag></dc:subject>"
+	"<rt:Struct rdf:parseType='Resource'><rt:A>a</rt:A>"
+	"<rt:B rdf:parseType='Resource'><rt:C>c</rt:C><rt:D>d</rt:D></rt:B><rt:E>e</rt:E></rt:Struct>"
+	"<rt:Qualified rdf:parseType='Resource'><rdf:value>v</rdf:value><rt:Q1>q1</rt:Q1><rt:Q2>q2</rt:Q2></rt:Qualified>"
+	"<rt:Seq><rdf:Seq><rdf:li rdf:parseType='Resource'><rt:F>f</rt:F><rt:G>g</rt:G></rdf:li>"
+	"<rdf:li rdf:parseType='Resource'><rdf:value>plain</rdf:value><rt:Q>iq</rt:Q></rdf:li></rdf:Seq></rt:Seq>"
+	"</rdf:Description></rdf:RDF></x:xmpmeta>";
+
+static const char * kIterFullWalk =
+	"http://ns.adobe.com/xap/1.0/  =  (80000000)\n"
+	"http://ns.adobe.com/xap/1.0/ xmp:CreatorTool = Tool (0)\n"
+	"http://purl.org/dc/elements/1.1/  =  (80000000)\n"
+	"http://purl.org/dc/elements/1.1/ dc:title =  (1E00)\n"
+	"http://purl.org/dc/elements/1.1/ dc:title[1] = Title (50)\n"
+	"http://purl.org/dc/elements/1.1/ dc:title[1]/?xml:lang = x-default (20)\n"
+	"http://purl.org/dc/elements/1.1/ dc:title[2] = Title (50)\n"
+	"http://purl.org/dc/elements/1.1/ dc:title[2]/?xml:lang = fr (20)\n"
+	"http://purl.org/dc/elements/1.1/ dc:subject =  (200)\n"
+	"http://purl.org/dc/elements/1.1/ dc:subject[1] = one (0)\n"
+	"http://purl.org/dc/elements/1.1/ dc:subject[2] = two (0)\n"
+	"http://purl.org/dc/elements/1.1/ dc:subject[3] = three (0)\n"
+	"ns:roundtrip/  =  (80000000)\n"
+	"ns:roundtrip/ rt:Struct =  (100)\n"
+	"ns:roundtrip/ rt:Struct/rt:A = a (0)\n"
+	"ns:roundtrip/ rt:Struct/rt:B =  (100)\n"
+	"ns:roundtrip/ rt:Struct/rt:B/rt:C = c (0)\n"
+	"ns:roundtrip/ rt:Struct/rt:B/rt:D = d (0)\n"
+	"ns:roundtrip/ rt:Struct/rt:E = e (0)\n"
+	"ns:roundtrip/ rt:Qualified = v (10)\n"
+	"ns:roundtrip/ rt:Qualified/?rt:Q1 = q1 (20)\n"
+	"ns:roundtrip/ rt:Qualified/?rt:Q2 = q2 (20)\n"
+	"ns:roundtrip/ rt:Seq =  (600)\n"
+	"ns:roundtrip/ rt:Seq[1] =  (100)\n"
+	"ns:roundtrip/ rt:Seq[1]/rt:F = f (0)\n"
+	"ns:roundtrip/ rt:Seq[1]/rt:G = g (0)\n"
+	"ns:roundtrip/ rt:Seq[2] = plain (10)\n"
+	"ns:roundtrip/ rt:Seq[2]/?rt:Q = iq (20)\n";
+
+struct IterWalk {
+	const char *   schemaNS;
+	const char *   propName;
+	XMP_OptionBits options;
+	const char *   skipPath;
+	XMP_OptionBits skipOptions;
+	const char *   expected;
+};
+
+static const IterWalk kIterWalks[] = {
+	{ "", "", 0, 0, 0, kIterFullWalk },
+	{ "", "", kXMP_IterJustChildren, 0, 0,
+	  "http://ns.adobe.com/xap/1.0/  =  (80000000)\n"
+	  "http://purl.org/dc/elements/1.1/  =  (80000000)\n"
+	  "ns:roundtrip/  =  (80000000)\n" },
+	{ "", "", kXMP_IterJustLeafNodes | kXMP_IterJustLeafName, 0, 0,
+	  "http://ns.adobe.com/xap/1.0/ xmp:CreatorTool = Tool (0)\n"
+	  " [1] = Title (50)\n"
+	  "http://www.w3.org/XML/1998/namespace xml:lang = x-default (20)\n"
+	  " [2] = Title (50)\n"
+	  "http://www.w3.org/XML/1998/namespace xml:lang = fr (20)\n"
+	  " [1] = one (0)\n"
+	  " [2] = two (0)\n"
+	  " [3] = three (0)\n"
+	  "ns:roundtrip/ rt:A = a (0)\n"
+	  "ns:roundtrip/ rt:C = c (0)\n"
+	  "ns:roundtrip/ rt:D = d (0)\n"
+	  "ns:roundtrip/ rt:E = e (0)\n"
+	  "ns:roundtrip/ rt:Qualified = v (10)\n"
+	  "ns:roundtrip/ rt:Q1 = q1 (20)\n"
+	  "ns:roundtrip/ rt:Q2 = q2 (20)\n"
+	  "ns:roundtrip/ rt:F = f (0)\n"
+	  "ns:roundtrip/ rt:G = g (0)\n"
+	  " [2] = plain (10)\n"
+	  "ns:roundtrip/ rt:Q = iq (20)\n" },
+	{ "ns:roundtrip/", "", kXMP_IterOmitQualifiers, 0, 0,
+	  "ns:roundtrip/  =  (80000000)\n"
+	  "ns:roundtrip/ rt:Struct =  (100)\n"
+	  "ns:roundtrip/ rt:Struct/rt:A = a (0)\n"
+	  "ns:roundtrip/ rt:Struct/rt:B =  (100)\n"
+	  "ns:roundtrip/ rt:Struct/rt:B/rt:C = c (0)\n"
+	  "ns:roundtrip/ rt:Struct/rt:B/rt:D = d (0)\n"
+	  "ns:roundtrip/ rt:Struct/rt:E = e (0)\n"
+	  "ns:roundtrip/ rt:Qualified = v (10)\n"
+	  "ns:roundtrip/ rt:Seq =  (600)\n"
+	  "ns:roundtrip/ rt:Seq[1] =  (100)\n"
+	  "ns:roundtrip/ rt:Seq[1]/rt:F = f (0)\n"
+	  "ns:roundtrip/ rt:Seq[1]/rt:G = g (0)\n"
+	  "ns:roundtrip/ rt:Seq[2] = plain (10)\n" },
+	{ "ns:roundtrip/", "", kXMP_IterJustChildren, 0, 0,
+	  "ns:roundtrip/ rt:Struct =  (100)\n"
+	  "ns:roundtrip/ rt:Qualified = v (10)\n"
+	  "ns:roundtrip/ rt:Seq =  (600)\n" },
+	{ "ns:roundtrip/", "", kXMP_IterJustLeafNodes | kXMP_IterOmitQualifiers, 0, 0,
+	  "ns:roundtrip/ rt:Struct/rt:A = a (0)\n"
+	  "ns:roundtrip/ rt:Struct/rt:B/rt:C = c (0)\n"
+	  "ns:roundtrip/ rt:Struct/rt:B/rt:D = d (0)\n"
+	  "ns:roundtrip/ rt:Struct/rt:E = e (0)\n"
+	  "ns:roundtrip/ rt:Qualified = v (10)\n"
+	  "ns:roundtrip/ rt:Seq[1]/rt:F = f (0)\n"
+	  "ns:roundtrip/ rt:Seq[1]/rt:G = g (0)\n"
+	  "ns:roundtrip/ rt:Seq[2] = plain (10)\n" },
+	{ "ns:roundtrip/", "Struct", 0, 0, 0,
+	  "ns:roundtrip/ rt:Struct =  (100)\n"
+	  "ns:roundtrip/ rt:Struct/rt:A = a (0)\n"
+	  "ns:roundtrip/ rt:Struct/rt:B =  (100)\n"
+	  "ns:roundtrip/ rt:Struct/rt:B/rt:C = c (0)\n"
+	  "ns:roundtrip/ rt:Struct/rt:B/rt:D = d (0)\n"
+	  "ns:roundtrip/ rt:Struct/rt:E = e (0)\n" },
+	{ "ns:roundtrip/", "Struct", kXMP_IterJustChildren | kXMP_IterJustLeafName, 0, 0,
+	  "ns:roundtrip/ rt:A = a (0)\n"
+	  "ns:roundtrip/ rt:B =  (100)\n"
+	  "ns:roundtrip/ rt:E = e (0)\n" },
+	{ "ns:roundtrip/", "Seq[2]", 0, 0, 0,
+	  "ns:roundtrip/ rt:Seq[2] = plain (10)\n"
+	  "ns:roundtrip/ rt:Seq[2]/?rt:Q = iq (20)\n" },
+	{ "ns:roundtrip/", "Qualified", kXMP_IterJustLeafName, 0, 0,
+	  "ns:roundtrip/ rt:Qualified = v (10)\n"
+	  "ns:roundtrip/ rt:Q1 = q1 (20)\n"
+	  "ns:roundtrip/ rt:Q2 = q2 (20)\n" },
+	{ "http://purl.org/dc/elements/1.1/", "title", kXMP_IterJustLeafNodes, 0, 0,
+	  "http://purl.org/dc/elements/1.1/ dc:title[1] = Title (50)\n"
+	  "http://purl.org/dc/elements/1.1/ dc:title[1]/?xml:lang = x-default (20)\n"
+	  "http://purl.org/dc/elements/1.1/ dc:title[2] = Title (50)\n"
+	  "http://purl.org/dc/elements/1.1/ dc:title[2]/?xml:lang = fr (20)\n" },
+	{ "ns:roundtrip/", "Missing", 0, 0, 0,
+	  "" },
+	{ "ns:missing/", "", 0, 0, 0,
+	  "" },
+	{ "ns:roundtrip/", "", 0, "rt:Struct/rt:B", kXMP_IterSkipSubtree,
+	  "ns:roundtrip/  =  (80000000)\n"
+	  "ns:roundtrip/ rt:Struct =  (100)\n"
+	  "ns:roundtrip/ rt:Struct/rt:A = a (0)\n"
+	  "ns:roundtrip/ rt:Struct/rt:B =  (100)\n"
+	  "ns:roundtrip/ rt:Struct/rt:E = e (0)\n"
+	  "ns:roundtrip/ rt:Qualified = v (10)\n"
+	  "ns:roundtrip/ rt:Qualified/?rt:Q1 = q1 (20)\n"
+	  "ns:roundtrip/ rt:Qualified/?rt:Q2 = q2 (20)\n"
+	  "ns:roundtrip/ rt:Seq =  (600)\n"
+	  "ns:roundtrip/ rt:Seq[1] =  (100)\n"
+	  "ns:roundtrip/ rt:Seq[1]/rt:F = f (0)\n"
+	  "ns:roundtrip/ rt:Seq[1]/rt:G = g (0)\n"
+	  "ns:roundtrip/ rt:Seq[2] = plain (10)\n"
+	  "ns:roundtrip/ rt:Seq[2]/?rt:Q = iq (20)\n" },
+	{ "ns:roundtrip/", "", 0, "rt:Struct/rt:B", kXMP_IterSkipSiblings,
+	  "ns:roundtrip/  =  (80000000)\n"
+	  "ns:roundtrip/ rt:Struct =  (100)\n"
+	  "ns:roundtrip/ rt:Struct/rt:A = a (0)\n"
+	  "ns:roundtrip/ rt:Struct/rt:B =  (100)\n"
+	  "ns:roundtrip/ rt:Qualified = v (10)\n"
+	  "ns:roundtrip/ rt:Qualified/?rt:Q1 = q1 (20)\n"
+	  "ns:roundtrip/ rt:Qualified/?rt:Q2 = q2 (20)\n"
+	  "ns:roundtrip/ rt:Seq =  (600)\n"
+	  "ns:roundtrip/ rt:Seq[1] =  (100)\n"
+	  "ns:roundtrip/ rt:Seq[1]/rt:F = f (0)\n"
+	  "ns:roundtrip/ rt:Seq[1]/rt:G = g (0)\n"
+	  "ns:roundtrip/ rt:Seq[2] = plain (10)\n"
+	  "ns:roundtrip/ rt:Seq[2]/?rt:Q = iq (20)\n" },
+	{ "ns:roundtrip/", "", 0, "rt:Qualified", kXMP_IterSkipSubtree,
+	  "ns:roundtrip/  =  (80000000)\n"
+	  "ns:roundtrip/ rt:Struct =  (100)\n"
+	  "ns:roundtrip/ rt:Struct/rt:A = a (0)\n"
+	  "ns:roundtrip/ rt:Struct/rt:B =  (100)\n"
+	  "ns:roundtrip/ rt:Struct/rt:B/rt:C = c (0)\n"
+	  "ns:roundtrip/ rt:Struct/rt:B/rt:D = d (0)\n"
+	  "ns:roundtrip/ rt:Struct/rt:E = e (0)\n"
+	  "ns:roundtrip/ rt:Qualified = v (10)\n"
+	  "ns:roundtrip/ rt:Seq =  (600)\n"
+	  "ns:roundtrip/ rt:Seq[1] =  (100)\n"
+	  "ns:roundtrip/ rt:Seq[1]/rt:F = f (0)\n"
+	  "ns:roundtrip/ rt:Seq[1]/rt:G = g (0)\n"
+	  "ns:roundtrip/ rt:Seq[2] = plain (10)\n"
+	  "ns:roundtrip/ rt:Seq[2]/?rt:Q = iq (20)\n" },
+	{ "ns:roundtrip/", "", 0, "rt:Qualified/?rt:Q1", kXMP_IterSkipSiblings,
+	  "ns:roundtrip/  =  (80000000)\n"
+	  "ns:roundtrip/ rt:Struct =  (100)\n"
+	  "ns:roundtrip/ rt:Struct/rt:A = a (0)\n"
+	  "ns:roundtrip/ rt:Struct/rt:B =  (100)\n"
+	  "ns:roundtrip/ rt:Struct/rt:B/rt:C = c (0)\n"
+	  "ns:roundtrip/ rt:Struct/rt:B/rt:D = d (0)\n"
+	  "ns:roundtrip/ rt:Struct/rt:E = e (0)\n"
+	  "ns:roundtrip/ rt:Qualified = v (10)\n"
+	  "ns:roundtrip/ rt:Qualified/?rt:Q1 = q1 (20)\n"
+	  "ns:roundtrip/ rt:Seq =  (600)\n"
+	  "ns:roundtrip/ rt:Seq[1] =  (100)\n"
+	  "ns:roundtrip/ rt:Seq[1]/rt:F = f (0)\n"
+	  "ns:roundtrip/ rt:Seq[1]/rt:G = g (0)\n"
+	  "ns:roundtrip/ rt:Seq[2] = plain (10)\n"
+	  "ns:roundtrip/ rt:Seq[2]/?rt:Q = iq (20)\n" },
+	{ "ns:roundtrip/", "", kXMP_IterJustChildren, "rt:Struct", kXMP_IterSkipSubtree,
+	  "ns:roundtrip/ rt:Struct =  (100)\n"
+	  "ns:roundtrip/ rt:Qualified = v (10)\n"
+	  "ns:roundtrip/ rt:Seq =  (600)\n" },
+	{ "ns:roundtrip/", "Struct", 0, "rt:Struct", kXMP_IterSkipSiblings,
+	  "ns:roundtrip/ rt:Struct =  (100)\n" },
+	{ "http://purl.org/dc/elements/1.1/", "subject", 0, "dc:subject[2]", kXMP_IterSkipSiblings,
+	  "http://purl.org/dc/elements/1.1/ dc:subject =  (200)\n"
+	  "http://purl.org/dc/elements/1.1/ dc:subject[1] = one (0)\n"
+	  "http://purl.org/dc/elements/1.1/ dc:subject[2] = two (0)\n" },
+	{ "", "", 0, "", kXMP_IterSkipSiblings,
+	  "http://ns.adobe.com/xap/1.0/  =  (80000000)\n" },
+	{ 0, 0, 0, 0, 0, 0 }
+};
+
+typedef void (*IterChange) ( SXMPMeta * xmp );
+
+static void ReparseIterPacket ( SXMPMeta * xmp )
+{
+	xmp->Reset();	// The nodes are reused, at new places in the tree.
+	xmp->ParseFromBuffer ( kIterPacket, (XMP_StringLen)strlen(kIterPacket) );
+}
+
+static void ReplaceStructField ( SXMPMeta * xmp )
+{
+	xmp->DeleteStructField ( kNS_RoundTrip, "Struct", kNS_RoundTrip, "B" );
+	xmp->SetStructField ( kNS_RoundTrip, "Struct", kNS_RoundTrip, "X", "x" );
+}
+
+static void DeleteStruct ( SXMPMeta * xmp )
+{
+	xmp->DeleteProperty ( kNS_RoundTrip, "Struct" );
+}
+
+struct IterChangeWalk {
+	const char * schemaNS;
+	const char * propName;
+	const char * changePath;
+	IterChange   change;
+	const char * expected;
+};
+
+static const IterChangeWalk kIterChangeWalks[] = {
+	{ "", "", "dc:subject[1]", ReparseIterPacket, kIterFullWalk },
+	{ "ns:roundtrip/", "Struct", "rt:Struct/rt:B/rt:C", ReplaceStructField,
+	  "ns:roundtrip/ rt:Struct =  (100)\n"
+	  "ns:roundtrip/ rt:Struct/rt:A = a (0)\n"
+	  "ns:roundtrip/ rt:Struct/rt:B =  (100)\n"
+	  "ns:roundtrip/ rt:Struct/rt:B/rt:C = c (0)\n"
+	  "ns:roundtrip/ rt:Struct/rt:E = e (0)\n"
+	  "ns:roundtrip/ rt:Struct/rt:X = x (0)\n" },
+	{ "ns:roundtrip/", "Struct", "rt:Struct/rt:A", DeleteStruct,
+	  "ns:roundtrip/ rt:Struct =  (100)\n"
+	  "ns:roundtrip/ rt:Struct/rt:A = a (0)\n" },
+	{ 0, 0, 0, 0, 0 }
+};
+
+static string WalkIterator ( SXMPIterator * iter, const char * actionPath, XMP_OptionBits skipOptions,
+							 SXMPMeta * xmp = 0, IterChange change = 0 )
+{
+	string walk, schemaNS, propPath, propValue;
+	XMP_OptionBits options;
+	while ( iter->Next ( &schemaNS, &propPath, &propValue, &options ) ) {
+		char hex [16];
+		snprintf ( hex, sizeof(hex), "%X", (unsigned)options );
+		walk += schemaNS + ' ' + propPath + " = " + propValue + " (" + hex + ")\n";
+		if ( (actionPath == 0) || (propPath != actionPath) ) continue;
+		if ( skipOptions != 0 ) iter->Skip ( skipOptions );
+		if ( change != 0 ) change ( xmp );
+	}
+	return walk;
+}	// WalkIterator
+
+static void CheckIteration()
+{
+	const char * fixture = "Iteration";
+	SXMPMeta xmp ( kIterPacket, (XMP_StringLen)strlen(kIterPacket) );
+	char what [200];
+
+	for ( const IterWalk * walk = kIterWalks; walk->schemaNS != 0; ++walk ) {
+		SXMPIterator iter ( xmp, walk->schemaNS, walk->propName, walk->options );
+		string actual = WalkIterator ( &iter, walk->skipPath, walk->skipOptions );
+		snprintf ( what, sizeof(what), "schema \"%s\", property \"%s\", options 0x%X, skip 0x%X after \"%s\"",
+				   walk->schemaNS, walk->propName, (unsigned)walk->options, (unsigned)walk->skipOptions,
+				   ((walk->skipPath == 0) ? "" : walk->skipPath) );
+		Check ( (actual == walk->expected), fixture, what );
+	}
+
+	for ( const IterChangeWalk * walk = kIterChangeWalks; walk->schemaNS != 0; ++walk ) {
+		SXMPMeta changed ( kIterPacket, (XMP_StringLen)strlen(kIterPacket) );
+		SXMPIterator iter ( changed, walk->schemaNS, walk->propName );
+		string actual = WalkIterator ( &iter, walk->changePath, 0, &changed, walk->change );
+		snprintf ( what, sizeof(what), "schema \"%s\", property \"%s\", changed after \"%s\"",
+				   walk->schemaNS, walk->propName, walk->changePath );
+		Check ( (actual == walk->expected), fixture, what );
+	}
+
+}	// CheckIteration
+
+// =================================================================================================
+// Base 64
+// =======
+//
+// The vector code handles what it can of each line, the table code the rest, so every length up to
+// 4K is encoded and decoded. The encoding must match a plain reference encoder. The decoding must
+// give back the data, also without linefeeds and with other whitespace added, and into a buffer. A
+// buffer that is too small must be left alone, the needed length is returned. Characters outside of
+// the base 64 alphabet, including ones right next to it, must be rejected.
+
+static string EncodeBase64Reference ( const string & raw )
+{
+	static const char * kChars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	string encoded;
+	for ( size_t i = 0; i < raw.size(); i += 3 ) {
+		if ( (i > 0) && ((i % 57) == 0) ) encoded += '\n';	// 19 quads per line.
+		const size_t count = raw.size() - i;
+		XMP_Uns32 merge = (XMP_Uns8)raw[i] << 16;
+		if ( count > 1 ) merge |= (XMP_Uns8)raw[i+1] << 8;
+		if ( count > 2 ) merge |= (XMP_Uns8)raw[i+2];
+		encoded += kChars [ merge >> 18 ];
+		encoded += kChars [ (merge >> 12) & 0x3F ];
+		encoded += (count > 1) ? kChars [ (merge >> 6) & 0x3F ] : '=';
+		encoded += (count > 2) ? kChars [ merge & 0x3F ] : '=';
+	}
+	return encoded;
+}	// EncodeBase64Reference
+
+static void DecodeBase64String ( void * arg )
+{
+	string raw;
+	SXMPUtils::DecodeFromBase64 ( *((const string *)arg), &raw );
+}
+
+static void CheckBase64()
+{
+	const char * fixture = "Base 64";
+	static const char kBadChars[] = { '*', '-', '_', '.', ':', '@', '[', '`', '{', '\x7F', '\x80', '\xFF' };
+
+	bool encodeOK = true, decodeOK = true, spacedOK = true, bufferOK = true, smallOK = true, badOK = true;
+	XMP_Uns32 random = 12345;
+
+	for ( size_t length = 0; length <= 4096; ++length ) {
+
+		string raw ( length, '\0' ), encoded, decoded, spaced;
+		for ( size_t i = 0; i < length; ++i ) {
+			random = random * 1103515245 + 12345;
+			raw[i] = (char)(random >> 16);
+		}
+
+		SXMPUtils::EncodeToBase64 ( raw, &encoded );
+		encodeOK &= (encoded == EncodeBase64Reference ( raw ));
+		SXMPUtils::DecodeFromBase64 ( encoded, &decoded );
+		decodeOK &= (decoded == raw);
+
+		for ( size_t i = 0; i < encoded.size(); ++i ) {
+			if ( encoded[i] != '\n' ) spaced += encoded[i];
+			if ( ((i + length) % 29) == 0 ) spaced += " \t\r\n" [ i & 3 ];
+		}
+		SXMPUtils::DecodeFromBase64 ( spaced, &decoded );
+		spacedOK &= (decoded == raw);
+
+		vector<char> buffer ( length + 1, '#' );
+		XMP_StringLen rawLen = SXMPUtils::DecodeFromBase64 ( encoded.c_str(), (XMP_StringLen)encoded.size(), 0, 0 );
+		bufferOK &= (rawLen == length);
+		rawLen = SXMPUtils::DecodeFromBase64 ( encoded.c_str(), (XMP_StringLen)encoded.size(), &buffer[0], (XMP_StringLen)length );
+		bufferOK &= (rawLen == length) && (memcmp ( &buffer[0], raw.data(), length ) == 0) && (buffer[length] == '#');
+
+		if ( length > 0 ) {
+			buffer.assign ( length + 1, '#' );
+			rawLen = SXMPUtils::DecodeFromBase64 ( encoded.c_str(), (XMP_StringLen)encoded.size(), &buffer[0], (XMP_StringLen)(length - 1) );
+			smallOK &= (rawLen == length) && (buffer == vector<char> ( length + 1, '#' ));
+		}
+
+		if ( (length % 97) == 1 ) {
+			for ( size_t i = 0; i < sizeof(kBadChars); ++i ) {
+				string bad = encoded;
+				bad[ (i * 131) % (bad.size() - 2) ] = kBadChars[i];
+				XMP_Int32 errorID = 0;
+				try {
+					DecodeBase64String ( &bad );
+				} catch ( XMP_Error & excep ) {
+					errorID = excep.GetID();
+				}
+				badOK &= (errorID == kXMPErr_BadParam);
+				XMP_StringLen ignored = 0;
+				errorID = 0;
+				try {
+					ignored = SXMPUtils::DecodeFromBase64 ( bad.c_str(), (XMP_StringLen)bad.size(), &buffer[0], (XMP_StringLen)length );
+				} catch ( XMP_Error & excep ) {
+					errorID = excep.GetID();
+				}
+				badOK &= (errorID == kXMPErr_BadParam) && (ignored == 0);
+			}
+		}
+
+	}
+
+	Check ( encodeOK, fixture, "encoding of 0 to 4096 bytes matches the reference" );
+	Check ( decodeOK, fixture, "decoding gives back the data" );
+	Check ( spacedOK, fixture, "decoding ignores whitespace" );
+	Check ( bufferOK, fixture, "decoding into a buffer gives back the data" );
+	Check ( smallOK, fixture, "a buffer that is too small is left alone and the length is returned" );
+	Check ( badOK, fixture, "bad characters rejected" );
+
+	string truncated = "QUJD\nRA=";	// Not a multiple of 4.
+	CheckThrows ( DecodeBase64String, &truncated, kXMPErr_BadParam, fixture, "truncated data rejected" );
+	string dataAfterPad = "QQ==QUJD";
+	CheckThrows ( DecodeBase64String, &dataAfterPad, kXMPErr_BadParam, fixture, "data after the padding rejected" );
+
+}	// CheckBase64
+
+// =================================================================================================
+// File round trips
+// ================
+//
+// The file checks update a copy of a fixture in the current folder a few times. Each step sets a
+// filler property of a given size, so the XMP grows and shrinks, and must read back as written. The
+// format specific checks compare the rest of the file with the original fixture.
+
+static bool ReadWholeFile ( const string & path, string * contents )
+{
+	contents->clear();
+	FILE * file = fopen ( path.c_str(), "rb" );
+	if ( file == 0 ) return false;
+	char buffer [64*1024];
+	size_t count;
+	while ( (count = fread ( buffer, 1, sizeof(buffer), file )) > 0 ) contents->append ( buffer, count );
+	fclose ( file );
+	return true;
+}	// ReadWholeFile
+
+static bool WriteWholeFile ( const string & path, const string & contents )
+{
+	FILE * file = fopen ( path.c_str(), "wb" );
+	if ( file == 0 ) return false;
+	bool ok = (fwrite ( contents.data(), 1, contents.size(), file ) == contents.size());
+	ok &= (fclose ( file ) == 0);
+	return ok;
+}	// WriteWholeFile
+
+static XMP_Uns32 GetUns32BE ( const string & bytes, size_t offset )
+{
+	const unsigned char * ptr = (const unsigned char *)bytes.data() + offset;
+	return ((XMP_Uns32)ptr[0] << 24) | ((XMP_Uns32)ptr[1] << 16) | ((XMP_Uns32)ptr[2] << 8) | (XMP_Uns32)ptr[3];
+}
+
+static XMP_Uns64 GetUns64BE ( const string & bytes, size_t offset )
+{
+	return ((XMP_Uns64)GetUns32BE ( bytes, offset ) << 32) | GetUns32BE ( bytes, offset + 4 );
+}
+
+// -------------------------------------------------------------------------------------------------
+// UpdateFileXMP
+// -------------
+//
+// Open the file for update, set rt:Step, and set rt:Filler to fillerSize bytes or remove it if the
+// size is 0. Then open it again and check that the XMP reads back the same.
+
+static void UpdateFileXMP ( const char * fixture, const string & path, const char * step,
+							size_t fillerSize, XMP_OptionBits openOptions = 0 )
+{
+	SXMPMeta xmp;
+	SXMPFiles file;
+	bool ok = file.OpenFile ( path, kXMP_UnknownFile, (kXMPFiles_OpenForUpdate | kXMPFiles_OpenUseSmartHandler | openOptions) );
+	if ( ok ) {
+		file.GetXMP ( &xmp );
+		xmp.SetProperty ( kNS_RoundTrip, "Step", step );
+		if ( fillerSize == 0 ) {
+			xmp.DeleteProperty ( kNS_RoundTrip, "Filler" );
+		} else {
+			string filler ( fillerSize, 'x' );
+			filler.replace ( 0, strlen(step), step );
+			xmp.SetProperty ( kNS_RoundTrip, "Filler", filler );
+		}
+		ok = file.CanPutXMP ( xmp );
+		if ( ok ) file.PutXMP ( xmp );
+		file.CloseFile();
+	}
+
+	string what = string ( step ) + ", updated";
+	Check ( ok, fixture, what.c_str() );
+	if ( ! ok ) return;
+
+	SXMPMeta readBack;
+	ok = file.OpenFile ( path, kXMP_UnknownFile, (kXMPFiles_OpenForRead | kXMPFiles_OpenUseSmartHandler) );
+	if ( ok ) {
+		ok = file.GetXMP ( &readBack );
+		file.CloseFile();
+	}
+	what = string ( step ) + ", XMP reads back the same";
+	Check ( (ok && SameXMP ( readBack, xmp )), fixture, what.c_str() );
+
+}	// UpdateFileXMP
+
+// =================================================================================================
+// MPEG-4 and QuickTime
+// ====================
+//
+// The moov is read lazily, the boxes the handler does not change are copied from the file when it
+// is written. Everything in the moov outside of udta must come through byte for byte, except that
+// the chunk offsets may be relocated. For those the media data at each chunk must be the same.
+
+static bool IsMoovContainer ( const string & type )
+{
+	return (type == "moov") || (type == "trak") || (type == "mdia") || (type == "minf") ||
+		   (type == "stbl") || (type == "edts") || (type == "dinf") || (type == "mvex");
+}
+
+static void CollectMoovBoxes ( const string & file, size_t offset, size_t end, const string & path,
+							   vector< pair<string,string> > * boxes )
+{
+	while ( (offset + 8) <= end ) {
+
+		XMP_Uns64 boxSize = GetUns32BE ( file, offset );
+		size_t headerSize = 8;
+		string type = file.substr ( (offset + 4), 4 );
+		if ( boxSize == 1 ) {
+			if ( (offset + 16) > end ) break;
+			boxSize = GetUns64BE ( file, (offset + 8) );
+			headerSize = 16;
+		} else if ( boxSize == 0 ) {
+			boxSize = end - offset;
+		}
+		if ( (boxSize < headerSize) || (boxSize > (end - offset)) ) {
+			boxes->push_back ( make_pair ( (path + type), string ( "bad box size" ) ) );
+			return;
+		}
+
+		const size_t boxEnd = offset + (size_t)boxSize;
+
+		if ( path.empty() && (type != "moov") ) {
+			// Only the moov is compared at the top level.
+		} else if ( IsMoovContainer ( type ) ) {
+			CollectMoovBoxes ( file, (offset + headerSize), boxEnd, (path + type + "/"), boxes );
+		} else if ( (type == "stco") || (type == "co64") ) {
+			const size_t entrySize = (type == "stco") ? 4 : 8;
+			const size_t count = GetUns32BE ( file, (offset + 12) );
+			string chunks;
+			for ( size_t i = 0; (i < count) && ((offset + 16 + (i+1)*entrySize) <= boxEnd); ++i ) {
+				const size_t entryOffset = offset + 16 + i*entrySize;
+				XMP_Uns64 chunkOffset = (entrySize == 4) ? GetUns32BE ( file, entryOffset ) : GetUns64BE ( file, entryOffset );
+				chunks += (chunkOffset < file.size()) ? file.substr ( (size_t)chunkOffset, 16 ) : string ( "chunk out of file" );
+			}
+			boxes->push_back ( make_pair ( (path + "chunks"), chunks ) );
+		} else if ( (type != "udta") && (type != "free") && (type != "skip") ) {
+			boxes->push_back ( make_pair ( (path + type), file.substr ( offset, (size_t)boxSize ) ) );
+		}
+
+		offset = boxEnd;
+
+	}
+}	// CollectMoovBoxes
+
+static void CheckMoovBoxes ( const char * fixture, const char * step, const string & original, const string & path )
+{
+	string updated;
+	vector< pair<string,string> > originalBoxes, updatedBoxes;
+	ReadWholeFile ( path, &updated );
+	CollectMoovBoxes ( original, 0, original.size(), "", &originalBoxes );
+	CollectMoovBoxes ( updated, 0, updated.size(), "", &updatedBoxes );
+	string what = string ( step ) + ", moov boxes and chunk data unchanged";
+	Check ( ((! originalBoxes.empty()) && (originalBoxes == updatedBoxes)), fixture, what.c_str() );
+}	// CheckMoovBoxes
+
+static void CheckMPEG4 ( const char * fixture )
+{
+	string original, path = string ( "RoundTrip-" ) + fixture;
+	if ( ! ReadWholeFile ( sTestFolder + fixture, &original ) || ! WriteWholeFile ( path, original ) ) {
+		Check ( false, fixture, "copy the fixture" );
+		return;
+	}
+
+	UpdateFileXMP ( fixture, path, "small in place", 100 );
+	CheckMoovBoxes ( fixture, "small in place", original, path );
+	UpdateFileXMP ( fixture, path, "grow by 64K", 64*1024 );
+	CheckMoovBoxes ( fixture, "grow by 64K", original, path );
+	UpdateFileXMP ( fixture, path, "grow by 256K and optimize", 256*1024, kXMPFiles_OptimizeFileLayout );
+	CheckMoovBoxes ( fixture, "grow by 256K and optimize", original, path );
+	UpdateFileXMP ( fixture, path, "shrink", 0 );
+	CheckMoovBoxes ( fixture, "shrink", original, path );
+
+	string updated, topLevel;
+	ReadWholeFile ( path, &updated );
+	for ( size_t offset = 0; (offset + 8) <= updated.size(); ) {
+		XMP_Uns64 boxSize = GetUns32BE ( updated, offset );
+		if ( boxSize == 1 ) boxSize = GetUns64BE ( updated, (offset + 8) );
+		if ( boxSize < 8 ) break;
+		topLevel += updated.substr ( (offset + 4), 4 ) + " ";
+		offset += (size_t)boxSize;
+	}
+	Check ( (topLevel.find ( "moov" ) < topLevel.find ( "mdat" )), fixture, "optimized moov is before mdat" );
+
+	remove ( path.c_str() );
+
+}	// CheckMPEG4
+
+// -------------------------------------------------------------------------------------------------
+// BuildMPEG4
+// ----------
+//
+// A file with the moov at the end, after two mdat boxes with a free box between them, so that an
+// optimized layout moves the two mdat boxes by different amounts. The sample tables are big enough
+// to be left in the file when the moov is read: a video track with stsz and stco, a sound track with
+// co64, and optionally a timecode track whose stsc has to be loaded from the file. There is no mvhd,
+// its dates and the timecode track are always written back, which would change the moov. The chunk
+// entries go back and forth between the two mdat boxes in runs of different lengths, each chunk is
+// 16 unique bytes.
+
+static void AppendUns32BE ( string * bytes, XMP_Uns32 value )
+{
+	for ( int shift = 24; shift >= 0; shift -= 8 ) bytes->push_back ( (char)(value >> shift) );
+}
+
+static void AppendUns64BE ( string * bytes, XMP_Uns64 value )
+{
+	AppendUns32BE ( bytes, (XMP_Uns32)(value >> 32) );
+	AppendUns32BE ( bytes, (XMP_Uns32)value );
+}
+
+static void AppendBox ( string * parent, const char * type, const string & content )
+{
+	AppendUns32BE ( parent, (XMP_Uns32)(8 + content.size()) );
+	parent->append ( type, 4 );
+	parent->append ( content );
+}
+
+static const size_t kMPEG4_ChunkCount = 800;	// The chunks in each mdat.
+static const XMP_Uns32 kMPEG4_Timecode = 0x00012345;
+
+static void BuildChunkTable ( string * table, XMP_Uns32 count, size_t entrySize, const XMP_Uns64 mdatContent[2], XMP_Uns32 seed )
+{
+	static const XMP_Uns32 kRuns[] = { 300, 1, 7, 260, 2, 45, 513, 3, 17, 64 };
+	AppendUns32BE ( table, 0 );	// Version and flags.
+	AppendUns32BE ( table, count );
+	for ( XMP_Uns32 i = 0, run = 0, inRun = 0; i < count; ++i, ++inRun ) {
+		if ( inRun == kRuns[run % 10] ) { ++run; inRun = 0; }
+		XMP_Uns64 offset = mdatContent[run & 1] + 16 * ((i * 7919 + seed) % kMPEG4_ChunkCount);
+		if ( entrySize == 4 ) AppendUns32BE ( table, (XMP_Uns32)offset ); else AppendUns64BE ( table, offset );
+	}
+}	// BuildChunkTable
+
+static void BuildTrack ( string * moov, const char * handler, const string & stsd, const string & stsc,
+						 const char * chunkType, const string & chunks, XMP_Uns32 sampleCount )
+{
+	string tkhd ( 84, '\0' ), mdhd ( 24, '\0' ), hdlr, stts, stsz, stbl, minf, mdia, trak;
+
+	AppendUns32BE ( &hdlr, 0 );	// Version and flags.
+	hdlr.append ( "mhlr", 4 );
+	hdlr.append ( handler, 4 );
+	hdlr.append ( 12, '\0' );
+	hdlr.push_back ( '\0' );	// Empty name.
+
+	AppendUns32BE ( &stts, 0 );
+	AppendUns32BE ( &stts, 1 );
+	AppendUns32BE ( &stts, sampleCount );
+	AppendUns32BE ( &stts, 1 );
+
+	AppendUns32BE ( &stsz, 0 );
+	AppendUns32BE ( &stsz, 0 );	// Each sample has its own size.
+	AppendUns32BE ( &stsz, sampleCount );
+	for ( XMP_Uns32 i = 0; i < sampleCount; ++i ) AppendUns32BE ( &stsz, 16 );
+
+	AppendBox ( &stbl, "stsd", stsd );
+	AppendBox ( &stbl, "stts", stts );
+	AppendBox ( &stbl, "stsc", stsc );
+	AppendBox ( &stbl, "stsz", stsz );
+	AppendBox ( &stbl, chunkType, chunks );
+	AppendBox ( &minf, "stbl", stbl );
+	AppendBox ( &mdia, "mdhd", mdhd );
+	AppendBox ( &mdia, "hdlr", hdlr );
+	AppendBox ( &mdia, "minf", minf );
+	AppendBox ( &trak, "tkhd", tkhd );
+	AppendBox ( &trak, "mdia", mdia );
+	AppendBox ( moov, "trak", trak );
+}	// BuildTrack
+
+static void BuildMPEG4 ( string * file, bool quickTime, bool timecode )
+{
+	string ftyp, mdat[2], moov;
+
+	ftyp.append ( quickTime ? "qt  " : "mp42", 4 );
+	AppendUns32BE ( &ftyp, 0 );
+	ftyp.append ( quickTime ? "qt  " : "mp42isom", (quickTime ? 4 : 8) );
+
+	for ( int box = 0; box < 2; ++box ) {
+		char chunk [17];
+		for ( size_t i = 0; i < kMPEG4_ChunkCount; ++i ) {
+			snprintf ( chunk, sizeof(chunk), "chunk %c %08u", ('A' + box), (unsigned)i );
+			mdat[box].append ( chunk, 16 );
+		}
+	}
+	string sample;
+	AppendUns32BE ( &sample, kMPEG4_Timecode );
+	mdat[1].replace ( 0, 4, sample );	// The first chunk of the second mdat is the timecode sample.
+
+	const size_t freeSize = 1000;
+	XMP_Uns64 mdatContent[2];
+	mdatContent[0] = (8 + ftyp.size()) + 8;
+	mdatContent[1] = mdatContent[0] + mdat[0].size() + freeSize + 8;
+
+	string stsd, stsc, chunks;
+	AppendUns32BE ( &stsd, 0 );
+	AppendUns32BE ( &stsd, 1 );
+	AppendUns32BE ( &stsd, 16 );	// A bare sample entry.
+	stsd.append ( "raw ", 4 );
+	stsd.append ( 6, '\0' );
+	stsd.append ( "\0\1", 2 );	// Data reference index.
+
+	AppendUns32BE ( &stsc, 0 );
+	AppendUns32BE ( &stsc, 1 );
+	AppendUns32BE ( &stsc, 1 );	// First chunk.
+	AppendUns32BE ( &stsc, 1 );	// Samples per chunk.
+	AppendUns32BE ( &stsc, 1 );	// Sample description.
+
+	BuildChunkTable ( &chunks, 1100, 4, mdatContent, 0 );
+	BuildTrack ( &moov, "vide", stsd, stsc, "stco", chunks, 1100 );
+	chunks.clear();
+	BuildChunkTable ( &chunks, 700, 8, mdatContent, 11 );
+	BuildTrack ( &moov, "soun", stsd, stsc, "co64", chunks, 700 );
+
+	if ( timecode ) {
+
+		string tmcd;
+		AppendUns32BE ( &tmcd, 0 );
+		AppendUns32BE ( &tmcd, 1 );
+		AppendUns32BE ( &tmcd, 34 );	// The entry size.
+		tmcd.append ( "tmcd", 4 );
+		tmcd.append ( 6, '\0' );
+		tmcd.append ( "\0\1", 2 );
+		AppendUns32BE ( &tmcd, 0 );
+		AppendUns32BE ( &tmcd, 0 );	// Flags, not drop frame.
+		AppendUns32BE ( &tmcd, 30 );	// Time scale.
+		AppendUns32BE ( &tmcd, 1 );	// Frame duration.
+		tmcd.push_back ( (char)30 );	// Frame count.
+		tmcd.push_back ( '\0' );
+
+		stsc.clear();
+		AppendUns32BE ( &stsc, 0 );
+		AppendUns32BE ( &stsc, 400 );
+		for ( XMP_Uns32 i = 1; i <= 400; ++i ) {
+			AppendUns32BE ( &stsc, i );
+			AppendUns32BE ( &stsc, 1 );
+			AppendUns32BE ( &stsc, 1 );
+		}
+
+		chunks.clear();
+		BuildChunkTable ( &chunks, 300, 4, mdatContent, 29 );
+		string first;
+		AppendUns32BE ( &first, (XMP_Uns32)mdatContent[1] );
+		chunks.replace ( 8, 4, first );	// The first chunk is the timecode sample.
+		BuildTrack ( &moov, "tmcd", tmcd, stsc, "stco", chunks, 300 );
+
+	}
+
+	file->clear();
+	AppendBox ( file, "ftyp", ftyp );
+	AppendBox ( file, "mdat", mdat[0] );
+	AppendBox ( file, "free", string ( (freeSize - 8), '\0' ) );
+	AppendBox ( file, "mdat", mdat[1] );
+	AppendBox ( file, "moov", moov );
+
+}	// BuildMPEG4
+
+// -------------------------------------------------------------------------------------------------
+// CheckChunkOffsets
+// -----------------
+//
+// The handler relocates the chunk offsets in blocks, with vector code where the CPU has it. Compare
+// each entry with a plain relocation of the original entry, by the move of the mdat box holding it.
+
+static void CollectChunkTables ( const string & file, size_t offset, size_t end, bool inMoov,
+								 vector< vector<XMP_Uns64> > * tables, vector< pair<XMP_Uns64,XMP_Uns64> > * mdats )
+{
+	while ( (offset + 8) <= end ) {
+
+		XMP_Uns64 boxSize = GetUns32BE ( file, offset );
+		size_t headerSize = 8;
+		string type = file.substr ( (offset + 4), 4 );
+		if ( boxSize == 1 ) {
+			boxSize = GetUns64BE ( file, (offset + 8) );
+			headerSize = 16;
+		}
+		if ( (boxSize < headerSize) || (boxSize > (end - offset)) ) return;
+
+		if ( (! inMoov) && (type == "mdat") ) {
+			mdats->push_back ( make_pair ( (XMP_Uns64)offset, boxSize ) );
+		} else if ( ((! inMoov) && (type == "moov")) || (inMoov && IsMoovContainer ( type )) ) {
+			CollectChunkTables ( file, (offset + headerSize), (offset + (size_t)boxSize), true, tables, mdats );
+		} else if ( inMoov && ((type == "stco") || (type == "co64")) ) {
+			const size_t entrySize = (type == "stco") ? 4 : 8;
+			const size_t count = GetUns32BE ( file, (offset + 12) );
+			tables->push_back ( vector<XMP_Uns64>() );
+			for ( size_t i = 0; (i < count) && ((offset + 16 + (i+1)*entrySize) <= (offset + boxSize)); ++i ) {
+				const size_t entryOffset = offset + 16 + i*entrySize;
+				tables->back().push_back ( (entrySize == 4) ? GetUns32BE ( file, entryOffset ) : GetUns64BE ( file, entryOffset ) );
+			}
+		}
+
+		offset += (size_t)boxSize;
+
+	}
+}	// CollectChunkTables
+
+static void CheckChunkOffsets ( const char * fixture, const char * step, const string & original, const string & path )
+{
+	string updated;
+	ReadWholeFile ( path, &updated );
+	vector< vector<XMP_Uns64> > originalTables, updatedTables;
+	vector< pair<XMP_Uns64,XMP_Uns64> > originalMdats, updatedMdats;
+	CollectChunkTables ( original, 0, original.size(), false, &originalTables, &originalMdats );
+	CollectChunkTables ( updated, 0, updated.size(), false, &updatedTables, &updatedMdats );
+
+	size_t entryCount = 0;
+	bool ok = (! originalTables.empty()) && (originalTables.size() == updatedTables.size()) &&
+			  (originalMdats.size() == updatedMdats.size());
+
+	for ( size_t table = 0; ok && (table < originalTables.size()); ++table ) {
+		const vector<XMP_Uns64> & originalEntries = originalTables[table];
+		const vector<XMP_Uns64> & updatedEntries = updatedTables[table];
+		ok = (originalEntries.size() == updatedEntries.size());
+		for ( size_t i = 0; ok && (i < originalEntries.size()); ++i, ++entryCount ) {
+			size_t box = 0;
+			while ( (box < originalMdats.size()) &&
+					((originalEntries[i] < originalMdats[box].first) ||
+					 (originalEntries[i] >= (originalMdats[box].first + originalMdats[box].second))) ) ++box;
+			ok = (box < originalMdats.size()) &&
+				 (updatedEntries[i] == (updatedMdats[box].first + (originalEntries[i] - originalMdats[box].first)));
+		}
+	}
+
+	string what = string ( step ) + ", chunk offsets match a plain relocation";
+	Check ( (ok && (entryCount >= 1000)), fixture, what.c_str() );
+}	// CheckChunkOffsets
+
+// -------------------------------------------------------------------------------------------------
+// CheckSyntheticMPEG4
+// -------------------
+//
+// The QuickTime XMP is in moov/udta. Adding and growing it rewrites the moov, copying the sample
+// tables that were left in the file, the first time in place at the end of the file. A smaller
+// packet is written in place through the lazy segment offsets, unless the timecode track changes the
+// moov anyway. For MPEG-4 the XMP is in a uuid box and the moov is not changed, so OptimizeFileLayout
+// has to read the lazy moov again.
+
+static void CheckSyntheticMPEG4 ( const char * fixture, bool quickTime, bool timecode )
+{
+	string original, path = string ( "RoundTrip-" ) + fixture;
+	BuildMPEG4 ( &original, quickTime, timecode );
+	if ( ! WriteWholeFile ( path, original ) ) {
+		Check ( false, fixture, "write the file" );
+		return;
+	}
+
+	UpdateFileXMP ( fixture, path, "add the XMP", 4*1024 );
+	CheckMoovBoxes ( fixture, "add the XMP", original, path );
+	CheckChunkOffsets ( fixture, "add the XMP", original, path );
+	UpdateFileXMP ( fixture, path, "small in place", 100 );
+	CheckMoovBoxes ( fixture, "small in place", original, path );
+	CheckChunkOffsets ( fixture, "small in place", original, path );
+	UpdateFileXMP ( fixture, path, "grow by 64K", 64*1024 );
+	CheckMoovBoxes ( fixture, "grow by 64K", original, path );
+	CheckChunkOffsets ( fixture, "grow by 64K", original, path );
+	UpdateFileXMP ( fixture, path, "grow by 128K and optimize", 128*1024, kXMPFiles_OptimizeFileLayout );
+	CheckMoovBoxes ( fixture, "grow by 128K and optimize", original, path );
+	CheckChunkOffsets ( fixture, "grow by 128K and optimize", original, path );
+	UpdateFileXMP ( fixture, path, "shrink", 0 );
+	CheckMoovBoxes ( fixture, "shrink", original, path );
+	CheckChunkOffsets ( fixture, "shrink", original, path );
+
+	if ( timecode ) {
+		SXMPMeta xmp;
+		SXMPFiles file;
+		string timeValue;
+		bool ok = file.OpenFile ( path, kXMP_UnknownFile, (kXMPFiles_OpenForRead | kXMPFiles_OpenUseSmartHandler) );
+		if ( ok ) {
+			file.GetXMP ( &xmp );
+			file.CloseFile();
+			ok = xmp.GetStructField ( kXMP_NS_DM, "altTimecode", kXMP_NS_DM, "timeValue", &timeValue, 0 );
+		}
+		Check ( (ok && (timeValue == "00:41:25:15")), fixture, "timecode sample found through the deferred stsc" );
+	}
+
+	remove ( path.c_str() );
+
+}	// CheckSyntheticMPEG4
+
+// =================================================================================================
+// TIFF
+// ====
+//
+// The XMP moves to the end of the file the first time it grows. After that it grows in place as the
+// last item, and the same size again must not add a copy. A smaller packet is padded to the old size
+// and written in place. The image strips and the other primary IFD tags must not change.
+
+static XMP_Uns32 GetTIFFUns ( const string & file, size_t offset, size_t length, bool bigEndian )
+{
+	XMP_Uns32 value = 0;
+	if ( (offset + length) > file.size() ) return 0;
+	for ( size_t i = 0; i < length; ++i ) {
+		XMP_Uns8 byte = (XMP_Uns8) file[ offset + (bigEndian ? i : (length - 1 - i)) ];
+		value = (value << 8) | byte;
+	}
+	return value;
+}	// GetTIFFUns
+
+static void CollectTIFFTags ( const string & file, vector< pair<XMP_Uns32,string> > * tags )
+{
+	static const size_t kTypeSizes[] = { 0, 1, 1, 2, 4, 8, 1, 1, 2, 4, 8, 4, 8, 4 };
+
+	if ( file.size() < 8 ) return;
+	const bool bigEndian = (file[0] == 'M');
+	const size_t ifdOffset = GetTIFFUns ( file, 4, 4, bigEndian );
+	const size_t count = GetTIFFUns ( file, ifdOffset, 2, bigEndian );
+
+	vector<XMP_Uns32> stripOffsets, stripCounts;
+
+	for ( size_t i = 0; i < count; ++i ) {
+
+		const size_t entry = ifdOffset + 2 + i*12;
+		const XMP_Uns32 tag  = GetTIFFUns ( file, entry, 2, bigEndian );
+		const XMP_Uns32 type = GetTIFFUns ( file, (entry + 2), 2, bigEndian );
+		const size_t valueCount = GetTIFFUns ( file, (entry + 4), 4, bigEndian );
+		const size_t typeSize = (type < sizeof(kTypeSizes)/sizeof(kTypeSizes[0])) ? kTypeSizes[type] : 1;
+		const size_t valueSize = valueCount * typeSize;
+		const size_t valueOffset = (valueSize <= 4) ? (entry + 8) : GetTIFFUns ( file, (entry + 8), 4, bigEndian );
+		const string value = (valueOffset < file.size()) ? file.substr ( valueOffset, valueSize ) : string();
+
+		if ( (tag == 273) || (tag == 279) ) {	// StripOffsets and StripByteCounts, compared as the strips.
+			vector<XMP_Uns32> & list = (tag == 273) ? stripOffsets : stripCounts;
+			for ( size_t v = 0; v < valueCount; ++v ) {
+				list.push_back ( GetTIFFUns ( file, (valueOffset + v*typeSize), typeSize, bigEndian ) );
+			}
+		} else if ( (tag != 700) && (tag != 33723) && (tag != 34377) && (tag != 34665) && (tag != 34853) ) {
+			tags->push_back ( make_pair ( tag, value ) );	// ! Not the XMP, legacy metadata, or IFD links.
+		}
+
+	}
+
+	string strips;
+	for ( size_t i = 0; (i < stripOffsets.size()) && (i < stripCounts.size()); ++i ) {
+		if ( stripOffsets[i] < file.size() ) strips += file.substr ( stripOffsets[i], stripCounts[i] );
+	}
+	tags->push_back ( make_pair ( (XMP_Uns32)273, strips ) );
+
+}	// CollectTIFFTags
+
+static size_t CheckTIFFTags ( const char * fixture, const char * step, const string & original, const string & path )
+{
+	string updated;
+	vector< pair<XMP_Uns32,string> > originalTags, updatedTags;
+	ReadWholeFile ( path, &updated );
+	CollectTIFFTags ( original, &originalTags );
+	CollectTIFFTags ( updated, &updatedTags );
+	string what = string ( step ) + ", image strips and other tags unchanged";
+	Check ( ((originalTags.size() > 1) && (originalTags == updatedTags)), fixture, what.c_str() );
+	return updated.size();
+}	// CheckTIFFTags
+
+static void CheckTIFF ( const char * fixture )
+{
+	string original, path = string ( "RoundTrip-" ) + fixture;
+	if ( ! ReadWholeFile ( sTestFolder + fixture, &original ) || ! WriteWholeFile ( path, original ) ) {
+		Check ( false, fixture, "copy the fixture" );
+		return;
+	}
+
+	UpdateFileXMP ( fixture, path, "grow by 64K", 64*1024 );
+	size_t firstSize = CheckTIFFTags ( fixture, "grow by 64K", original, path );
+	UpdateFileXMP ( fixture, path, "grow by 128K", 128*1024 );
+	size_t grownSize = CheckTIFFTags ( fixture, "grow by 128K", original, path );
+	Check ( (grownSize < (firstSize + 80*1024)), fixture, "last XMP grew in place" );
+	UpdateFileXMP ( fixture, path, "same size again", 128*1024 );
+	size_t sameSize = CheckTIFFTags ( fixture, "same size again", original, path );
+	Check ( (sameSize == grownSize), fixture, "same size XMP added no copy" );
+	UpdateFileXMP ( fixture, path, "shrink", 0 );
+	size_t shrunkSize = CheckTIFFTags ( fixture, "shrink", original, path );
+	Check ( (shrunkSize == sameSize), fixture, "smaller XMP padded in place" );
+
+	remove ( path.c_str() );
+
+}	// CheckTIFF
+
+// =================================================================================================
+// Photoshop
+// =========
+//
+// The image resources are rewritten in the file. A small change fits in the XMP padding. Growth
+// beyond it adds a padding reserve and shifts the layer and image data up, later growth within the
+// reserve must not change the file size. The header, color mode data, other image resources, and
+// the layer and image data must not change.
+
+struct PSDParts {
+	string head;					// The header and color mode data.
+	vector< pair<XMP_Uns32,string> > resources;	// ! Not the XMP or reconciled legacy.
+	string tail;					// The layer and mask information and the image data.
+	bool ok;
+};
+
+static void SplitPSD ( const string & file, PSDParts * parts )
+{
+	parts->ok = false;
+	if ( file.size() < 34 ) return;
+
+	size_t offset = 26;
+	offset += 4 + GetUns32BE ( file, offset );	// Skip the color mode data.
+	if ( (offset + 4) > file.size() ) return;
+	parts->head = file.substr ( 0, offset );
+
+	const size_t resourcesEnd = offset + 4 + GetUns32BE ( file, offset );
+	if ( resourcesEnd > file.size() ) return;
+	parts->tail = file.substr ( resourcesEnd );
+
+	for ( offset += 4; (offset + 12) <= resourcesEnd; ) {
+		if ( file.compare ( offset, 4, "8BIM" ) != 0 ) return;
+		const XMP_Uns32 resourceID = ((XMP_Uns32)(XMP_Uns8)file[offset+4] << 8) | (XMP_Uns8)file[offset+5];
+		size_t nameLength = (XMP_Uns8)file[offset+6];
+		nameLength = (nameLength + 2) & ~(size_t)1;	// Include the length byte, pad to even.
+		const size_t sizeOffset = offset + 6 + nameLength;
+		if ( (sizeOffset + 4) > resourcesEnd ) return;
+		const size_t dataSize = GetUns32BE ( file, sizeOffset );
+		const size_t dataEnd = sizeOffset + 4 + dataSize;
+		if ( dataEnd > resourcesEnd ) return;
+		const bool isReconciled = (resourceID == 1028) || (resourceID == 1034) || (resourceID == 1035) || (resourceID == 1061);
+		if ( (resourceID != 1060) && (! isReconciled) ) {	// ! Not the XMP, or the IPTC, copyright, and URL legacy.
+			parts->resources.push_back ( make_pair ( resourceID, file.substr ( offset, (dataEnd - offset) ) ) );
+		}
+		offset = (dataEnd + 1) & ~(size_t)1;
+	}
+
+	parts->ok = true;
+
+}	// SplitPSD
+
+static size_t CheckPSDParts ( const char * fixture, const char * step, const string & original, const string & path )
+{
+	string updated;
+	PSDParts originalParts, updatedParts;
+	ReadWholeFile ( path, &updated );
+	SplitPSD ( original, &originalParts );
+	SplitPSD ( updated, &updatedParts );
+	string what = string ( step ) + ", other resources and image data unchanged";
+	Check ( (originalParts.ok && updatedParts.ok && (! originalParts.resources.empty()) &&
+			 (originalParts.head == updatedParts.head) && (originalParts.resources == updatedParts.resources) &&
+			 (originalParts.tail == updatedParts.tail)), fixture, what.c_str() );
+	return updated.size();
+}	// CheckPSDParts
+
+static void CheckPSD ( const char * fixture )
+{
+	string original, path = string ( "RoundTrip-" ) + fixture;
+	if ( ! ReadWholeFile ( sTestFolder + fixture, &original ) || ! WriteWholeFile ( path, original ) ) {
+		Check ( false, fixture, "copy the fixture" );
+		return;
+	}
+
+	UpdateFileXMP ( fixture, path, "small in place", 100 );
+	size_t smallSize = CheckPSDParts ( fixture, "small in place", original, path );
+	Check ( (smallSize == original.size()), fixture, "small change fit in the XMP padding" );
+	UpdateFileXMP ( fixture, path, "grow by 64K", 64*1024 );
+	size_t grownSize = CheckPSDParts ( fixture, "grow by 64K", original, path );
+	UpdateFileXMP ( fixture, path, "grow within the reserve", 66*1024 );
+	size_t reserveSize = CheckPSDParts ( fixture, "grow within the reserve", original, path );
+	Check ( (reserveSize == grownSize), fixture, "growth absorbed by the reserve" );
+	UpdateFileXMP ( fixture, path, "shrink", 0 );
+	size_t shrunkSize = CheckPSDParts ( fixture, "shrink", original, path );
+	Check ( (shrunkSize == grownSize), fixture, "smaller XMP padded in place" );
+
+	remove ( path.c_str() );
+
+}	// CheckPSD
+
+// =================================================================================================
+// CRC-32
+// ======
+//
+// PNG chunks and the entries of a UCF package carry a CRC-32, which is computed by the shared code
+// in the toolkit. These checks recompute every CRC in the updated files a byte at a time, and check
+// that the other chunks and entries come through unchanged.
+
+static XMP_Uns32 BytewiseCRC32 ( const string & bytes, size_t offset, size_t length )
+{
+	XMP_Uns32 crc = 0xFFFFFFFF;
+	for ( size_t i = offset; i < (offset + length); ++i ) {
+		crc ^= (XMP_Uns8)bytes[i];
+		for ( int bit = 0; bit < 8; ++bit ) crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+	}
+	return crc ^ 0xFFFFFFFF;
+}	// BytewiseCRC32
+
+static XMP_Uns32 GetUns16LE ( const string & bytes, size_t offset )
+{
+	const unsigned char * ptr = (const unsigned char *)bytes.data() + offset;
+	return ((XMP_Uns32)ptr[1] << 8) | (XMP_Uns32)ptr[0];
+}
+
+static XMP_Uns32 GetUns32LE ( const string & bytes, size_t offset )
+{
+	return (GetUns16LE ( bytes, (offset + 2) ) << 16) | GetUns16LE ( bytes, offset );
+}
+
+static void AppendUns16LE ( string * bytes, XMP_Uns32 value )
+{
+	bytes->push_back ( (char)(value & 0xFF) );
+	bytes->push_back ( (char)((value >> 8) & 0xFF) );
+}
+
+static void AppendUns32LE ( string * bytes, XMP_Uns32 value )
+{
+	AppendUns16LE ( bytes, (value & 0xFFFF) );
+	AppendUns16LE ( bytes, (value >> 16) );
+}
+
+// -------------------------------------------------------------------------------------------------
+// PNG
+// ---
+//
+// The XMP is in an iTXt chunk. A packet that fits is written in place and only that chunk's CRC is
+// updated, otherwise the file is rewritten. The packet is read-only and so has no padding, any
+// growth rewrites the file and a smaller packet is padded in place.
+
+static const char * kPNG_XMPKeyword = "XML:com.adobe.xmp";
+
+static size_t CheckPNGChunks ( const char * fixture, const char * step, const string & original, const string & path )
+{
+	string updated;
+	ReadWholeFile ( path, &updated );
+
+	bool crcsOK = (updated.size() > 8), haveXMP = false;
+	vector<string> originalChunks, updatedChunks;
+
+	for ( int pass = 0; pass < 2; ++pass ) {
+		const string & file = (pass == 0) ? original : updated;
+		vector<string> * chunks = (pass == 0) ? &originalChunks : &updatedChunks;
+		for ( size_t offset = 8; (offset + 12) <= file.size(); ) {
+			const size_t dataLength = GetUns32BE ( file, offset );
+			if ( (offset + 12 + dataLength) > file.size() ) {
+				crcsOK = false;
+				break;
+			}
+			if ( pass == 1 ) crcsOK &= (GetUns32BE ( file, (offset + 8 + dataLength) ) == BytewiseCRC32 ( file, (offset + 4), (dataLength + 4) ));
+			if ( (file.compare ( (offset + 4), 4, "iTXt" ) == 0) &&
+				 (file.compare ( (offset + 8), (strlen(kPNG_XMPKeyword) + 1), kPNG_XMPKeyword, (strlen(kPNG_XMPKeyword) + 1) ) == 0) ) {
+				if ( pass == 1 ) haveXMP = true;	// ! The XMP chunk is not compared.
+			} else {
+				chunks->push_back ( file.substr ( offset, (12 + dataLength) ) );
+			}
+			offset += 12 + dataLength;
+		}
+	}
+
+	string what = string ( step ) + ", chunk CRCs match";
+	Check ( (crcsOK && haveXMP), fixture, what.c_str() );
+	what = string ( step ) + ", other chunks unchanged";
+	Check ( ((originalChunks.size() > 1) && (originalChunks == updatedChunks)), fixture, what.c_str() );
+	return updated.size();
+
+}	// CheckPNGChunks
+
+static void CheckPNG ( const char * fixture )
+{
+	string original, path = string ( "RoundTrip-" ) + fixture;
+	if ( ! ReadWholeFile ( sTestFolder + fixture, &original ) || ! WriteWholeFile ( path, original ) ) {
+		Check ( false, fixture, "copy the fixture" );
+		return;
+	}
+
+	UpdateFileXMP ( fixture, path, "grow by 64K", 64*1024 );
+	size_t grownSize = CheckPNGChunks ( fixture, "grow by 64K", original, path );
+	UpdateFileXMP ( fixture, path, "shrink", 0 );
+	size_t shrunkSize = CheckPNGChunks ( fixture, "shrink", original, path );
+	Check ( (shrunkSize == grownSize), fixture, "smaller XMP padded in place" );
+
+	remove ( path.c_str() );
+
+}	// CheckPNG
+
+// -------------------------------------------------------------------------------------------------
+// UCF
+// ---
+//
+// There is no UCF fixture, so an IDML package is built here. It has the stored mimetype entry and a
+// stored entry large enough that the handler does not compress the XMP. The XMP entry is stored, so
+// its CRC can be checked without inflating it.
+
+static const char * kUCF_MimeType = "application/vnd.adobe.indesign-idml-package";
+static const char * kUCF_XMPEntry = "META-INF/metadata.xml";
+
+static void AppendZipHeader ( string * zip, XMP_Uns32 signature, const string & name, const string & data, size_t localOffset )
+{
+	const bool isCentral = (signature == 0x02014B50);
+	AppendUns32LE ( zip, signature );
+	if ( isCentral ) AppendUns16LE ( zip, 20 );	// Version made by.
+	AppendUns16LE ( zip, 20 );	// Version needed.
+	AppendUns16LE ( zip, 0 );	// Flags.
+	AppendUns16LE ( zip, 0 );	// Stored.
+	AppendUns16LE ( zip, 0 );	// Time.
+	AppendUns16LE ( zip, 0x21 );	// Date, 1 January 1980.
+	AppendUns32LE ( zip, BytewiseCRC32 ( data, 0, data.size() ) );
+	AppendUns32LE ( zip, (XMP_Uns32)data.size() );
+	AppendUns32LE ( zip, (XMP_Uns32)data.size() );
+	AppendUns16LE ( zip, (XMP_Uns32)name.size() );
+	AppendUns16LE ( zip, 0 );	// Extra field length.
+	if ( isCentral ) {
+		AppendUns16LE ( zip, 0 );	// Comment length.
+		AppendUns16LE ( zip, 0 );	// Disk number.
+		AppendUns16LE ( zip, 0 );	// Internal attributes.
+		AppendUns32LE ( zip, 0 );	// External attributes.
+		AppendUns32LE ( zip, (XMP_Uns32)localOffset );
+	}
+	zip->append ( name );
+	if ( ! isCentral ) zip->append ( data );
+}	// AppendZipHeader
+
+static void BuildUCF ( string * zip )
+{
+	const string names[2] = { "mimetype", "Resources/Filler.bin" };
+	const string data[2] = { kUCF_MimeType, string ( 64*1024, 'f' ) };
+	size_t localOffsets[2];
+
+	zip->clear();
+	for ( size_t i = 0; i < 2; ++i ) {
+		localOffsets[i] = zip->size();
+		AppendZipHeader ( zip, 0x04034B50, names[i], data[i], 0 );
+	}
+
+	const size_t cdOffset = zip->size();
+	for ( size_t i = 0; i < 2; ++i ) AppendZipHeader ( zip, 0x02014B50, names[i], data[i], localOffsets[i] );
+
+	AppendUns32LE ( zip, 0x06054B50 );
+	AppendUns32LE ( zip, 0 );	// Disk numbers.
+	AppendUns16LE ( zip, 2 );
+	AppendUns16LE ( zip, 2 );
+	AppendUns32LE ( zip, (XMP_Uns32)(zip->size() - 12 - cdOffset) );
+	AppendUns32LE ( zip, (XMP_Uns32)cdOffset );
+	AppendUns16LE ( zip, 0 );	// Comment length.
+}	// BuildUCF
+
+// -------------------------------------------------------------------------------------------------
+// CollectZipEntries
+// -----------------
+//
+// Walk the central directory. Each entry's local header must agree with it, and a stored entry's
+// data must match the CRC. The entries other than the XMP are returned as name and data.
+
+static bool CollectZipEntries ( const string & zip, vector< pair<string,string> > * entries, bool * haveXMP )
+{
+	entries->clear();
+	*haveXMP = false;
+	if ( (zip.size() < 22) || (GetUns32LE ( zip, (zip.size() - 22) ) != 0x06054B50) ) return false;
+
+	const size_t count = GetUns16LE ( zip, (zip.size() - 12) );
+	size_t offset = GetUns32LE ( zip, (zip.size() - 6) );
+
+	for ( size_t i = 0; i < count; ++i ) {
+		if ( ((offset + 46) > zip.size()) || (GetUns32LE ( zip, offset ) != 0x02014B50) ) return false;
+		const XMP_Uns32 method = GetUns16LE ( zip, (offset + 10) );
+		const XMP_Uns32 crc = GetUns32LE ( zip, (offset + 16) );
+		const size_t size = GetUns32LE ( zip, (offset + 20) );
+		const size_t nameLength = GetUns16LE ( zip, (offset + 28) );
+		const size_t local = GetUns32LE ( zip, (offset + 42) );
+		const string name = zip.substr ( (offset + 46), nameLength );
+		offset += 46 + nameLength + GetUns16LE ( zip, (offset + 30) ) + GetUns16LE ( zip, (offset + 32) );
+
+		if ( ((local + 30) > zip.size()) || (GetUns32LE ( zip, local ) != 0x04034B50) ) return false;
+		if ( (GetUns32LE ( zip, (local + 14) ) != crc) || (GetUns32LE ( zip, (local + 18) ) != size) ) return false;
+		const size_t dataOffset = local + 30 + GetUns16LE ( zip, (local + 26) ) + GetUns16LE ( zip, (local + 28) );
+		if ( (dataOffset + size) > zip.size() ) return false;
+		if ( (method == 0) && (BytewiseCRC32 ( zip, dataOffset, size ) != crc) ) return false;
+
+		if ( name == kUCF_XMPEntry ) {
+			*haveXMP = (method == 0);	// ! The XMP must be stored for its CRC to be checked.
+		} else {
+			entries->push_back ( make_pair ( name, zip.substr ( dataOffset, size ) ) );
+		}
+	}
+
+	return true;
+
+}	// CollectZipEntries
+
+static size_t CheckUCFEntries ( const char * fixture, const char * step, const string & original, const string & path )
+{
+	string updated;
+	vector< pair<string,string> > originalEntries, updatedEntries;
+	bool originalXMP, updatedXMP;
+	ReadWholeFile ( path, &updated );
+	CollectZipEntries ( original, &originalEntries, &originalXMP );
+	bool ok = CollectZipEntries ( updated, &updatedEntries, &updatedXMP );
+	string what = string ( step ) + ", entry CRCs match";
+	Check ( (ok && updatedXMP), fixture, what.c_str() );
+	what = string ( step ) + ", other entries unchanged";
+	Check ( ((originalEntries.size() == 2) && (originalEntries == updatedEntries)), fixture, what.c_str() );
+	return updated.size();
+}	// CheckUCFEntries
+
+static void CheckUCF()
+{
+	const char * fixture = "Synthetic.idml";
+	string original, path = string ( "RoundTrip-" ) + fixture;
+	BuildUCF ( &original );
+	if ( ! WriteWholeFile ( path, original ) ) {
+		Check ( false, fixture, "write the package" );
+		return;
+	}
+
+	UpdateFileXMP ( fixture, path, "add the XMP", 100 );
+	CheckUCFEntries ( fixture, "add the XMP", original, path );
+	UpdateFileXMP ( fixture, path, "grow by 4K", 4*1024 );
+	size_t grownSize = CheckUCFEntries ( fixture, "grow by 4K", original, path );
+	UpdateFileXMP ( fixture, path, "same again", 4*1024 );	// ! Same length, only an exact fit is in place.
+	size_t sameSize = CheckUCFEntries ( fixture, "same again", original, path );
+	Check ( (sameSize == grownSize), fixture, "same size XMP rewritten in place" );
+
+	remove ( path.c_str() );
+
+}	// CheckUCF
+
+// =================================================================================================
+// MP3
+// ===
+//
+// The XMP is in a PRIV frame of the ID3v2 tag. A small change fits in the tag's padding. Growth
+// beyond it rewrites the tag with a padding reserve and shifts the audio up, later growth within
+// the reserve must not change the file size. A shrink that leaves much more padding than needed
+// makes the tag smaller and truncates the file. The audio must not change.
+
+static bool GetMP3Audio ( const string & file, string * audio )
+{
+	audio->clear();
+	if ( (file.size() < 10) || (file.compare ( 0, 3, "ID3" ) != 0) ) return false;
+
+	size_t tagSize = 0;
+	for ( size_t i = 6; i < 10; ++i ) tagSize = (tagSize << 7) | ((XMP_Uns8)file[i] & 0x7F);	// ! Synchsafe.
+	size_t audioStart = 10 + tagSize;
+	if ( file[5] & 0x10 ) audioStart += 10;	// The footer.
+
+	size_t audioEnd = file.size();
+	if ( (audioEnd >= 128) && (file.compare ( (audioEnd - 128), 3, "TAG" ) == 0) ) audioEnd -= 128;	// ! Not the ID3v1 tag.
+	if ( audioStart >= audioEnd ) return false;
+
+	*audio = file.substr ( audioStart, (audioEnd - audioStart) );
+	return true;
+}	// GetMP3Audio
+
+static size_t CheckMP3Audio ( const char * fixture, const char * step, const string & original, const string & path )
+{
+	string updated, originalAudio, updatedAudio;
+	ReadWholeFile ( path, &updated );
+	bool ok = GetMP3Audio ( original, &originalAudio ) && GetMP3Audio ( updated, &updatedAudio );
+	string what = string ( step ) + ", audio unchanged";
+	Check ( (ok && (originalAudio == updatedAudio)), fixture, what.c_str() );
+	return updated.size();
+}	// CheckMP3Audio
+
+static void CheckMP3 ( const char * fixture )
+{
+	string original, path = string ( "RoundTrip-" ) + fixture;
+	if ( ! ReadWholeFile ( sTestFolder + fixture, &original ) || ! WriteWholeFile ( path, original ) ) {
+		Check ( false, fixture, "copy the fixture" );
+		return;
+	}
+
+	UpdateFileXMP ( fixture, path, "small in place", 100 );
+	size_t smallSize = CheckMP3Audio ( fixture, "small in place", original, path );
+	Check ( (smallSize == original.size()), fixture, "small change fit in the tag padding" );
+	UpdateFileXMP ( fixture, path, "grow by 64K", 64*1024 );
+	size_t grownSize = CheckMP3Audio ( fixture, "grow by 64K", original, path );
+	UpdateFileXMP ( fixture, path, "grow within the reserve", 96*1024 );
+	size_t reserveSize = CheckMP3Audio ( fixture, "grow within the reserve", original, path );
+	Check ( (reserveSize == grownSize), fixture, "growth absorbed by the reserve" );
+	UpdateFileXMP ( fixture, path, "shrink", 0 );
+	size_t shrunkSize = CheckMP3Audio ( fixture, "shrink", original, path );
+	Check ( (shrunkSize < grownSize), fixture, "excess padding released" );
+
+	remove ( path.c_str() );
+
+}	// CheckMP3
+
+// =================================================================================================
+// ASF
+// ===
+//
+// There is no ASF fixture, so a WMV file is built here. It has a header with a file properties
+// object, a data object, and a simple index object after it. The XMP object goes right after the
+// data object, so adding or growing it shifts the index within the file. Growth gets a padding
+// reserve that later growth fits in. The other objects must not change, except the file size.
+
+static const char * kASF_HeaderGUID = "\x30\x26\xB2\x75\x8E\x66\xCF\x11\xA6\xD9\x00\xAA\x00\x62\xCE\x6C";
+static const char * kASF_FilePropertiesGUID = "\xA1\xDC\xAB\x8C\x47\xA9\xCF\x11\x8E\xE4\x00\xC0\x0C\x20\x53\x65";
+static const char * kASF_DataGUID = "\x36\x26\xB2\x75\x8E\x66\xCF\x11\xA6\xD9\x00\xAA\x00\x62\xCE\x6C";
+static const char * kASF_SimpleIndexGUID = "\x90\x08\x00\x33\xB1\xE5\xCF\x11\x89\xF4\x00\xA0\xC9\x03\x49\xCB";
+static const char * kASF_XMPGUID = "\xCB\xCF\x7A\xBE\xA9\x97\xE8\x42\x9C\x71\x99\x94\x91\xE3\xAF\xAC";
+
+static const size_t kASF_FileSizeOffset = 30 + 40;	// In the file properties, the first header child.
+
+static void AppendUns64LE ( string * bytes, XMP_Uns64 value )
+{
+	AppendUns32LE ( bytes, (XMP_Uns32)value );
+	AppendUns32LE ( bytes, (XMP_Uns32)(value >> 32) );
+}
+
+static XMP_Uns64 GetUns64LE ( const string & bytes, size_t offset )
+{
+	return ((XMP_Uns64)GetUns32LE ( bytes, (offset + 4) ) << 32) | GetUns32LE ( bytes, offset );
+}
+
+static void AppendASFObject ( string * file, const char * guid, const string & data )
+{
+	file->append ( guid, 16 );
+	AppendUns64LE ( file, (24 + data.size()) );
+	file->append ( data );
+}
+
+static void BuildASF ( string * file )
+{
+	string fileProperties ( 16, '\x11' );	// File ID.
+	AppendUns64LE ( &fileProperties, 0 );	// File size, set below.
+	AppendUns64LE ( &fileProperties, 0 );	// Creation date.
+	AppendUns64LE ( &fileProperties, 16 );	// Data packets.
+	AppendUns64LE ( &fileProperties, 10000000 );	// Play duration.
+	AppendUns64LE ( &fileProperties, 10000000 );	// Send duration.
+	AppendUns64LE ( &fileProperties, 0 );	// Preroll.
+	AppendUns32LE ( &fileProperties, 2 );	// Seekable.
+	AppendUns32LE ( &fileProperties, 4096 );	// Minimum and maximum packet size.
+	AppendUns32LE ( &fileProperties, 4096 );
+	AppendUns32LE ( &fileProperties, 128000 );	// Maximum bitrate.
+
+	string header;
+	AppendUns32LE ( &header, 1 );	// Header object count.
+	header.append ( "\x01\x02", 2 );	// Reserved.
+	AppendASFObject ( &header, kASF_FilePropertiesGUID, fileProperties );
+
+	string data ( 16, '\x11' );	// File ID.
+	AppendUns64LE ( &data, 16 );	// Data packets.
+	data.append ( "\x01\x01", 2 );	// Reserved.
+	for ( size_t i = 0; i < 16*4096; ++i ) data.push_back ( (char)(i * 7) );
+
+	string index ( 16, '\x11' );	// File ID.
+	AppendUns64LE ( &index, 10000000 );	// Index entry time interval.
+	AppendUns32LE ( &index, 1 );	// Maximum packet count.
+	AppendUns32LE ( &index, 16 );	// Index entries.
+	for ( XMP_Uns32 i = 0; i < 16; ++i ) {
+		AppendUns32LE ( &index, i );	// Packet number.
+		AppendUns16LE ( &index, 1 );	// Packet count.
+	}
+
+	file->clear();
+	AppendASFObject ( file, kASF_HeaderGUID, header );
+	AppendASFObject ( file, kASF_DataGUID, data );
+	AppendASFObject ( file, kASF_SimpleIndexGUID, index );
+
+	string fileSize;
+	AppendUns64LE ( &fileSize, file->size() );
+	file->replace ( kASF_FileSizeOffset, 8, fileSize );
+}	// BuildASF
+
+// -------------------------------------------------------------------------------------------------
+// CollectASFObjects
+// -----------------
+//
+// Walk the top level objects, which must cover the whole file. The objects other than the XMP are
+// returned in order, with the file size field masked out of the header. The XMP must follow the data.
+
+static bool CollectASFObjects ( const string & file, vector<string> * objects, bool * xmpAfterData )
+{
+	objects->clear();
+	*xmpAfterData = false;
+	bool lastWasData = false;
+
+	size_t offset = 0;
+	while ( offset < file.size() ) {
+		if ( (offset + 24) > file.size() ) return false;
+		const XMP_Uns64 objectSize = GetUns64LE ( file, (offset + 16) );
+		if ( (objectSize < 24) || (objectSize > (file.size() - offset)) ) return false;
+		if ( file.compare ( offset, 16, kASF_XMPGUID, 16 ) == 0 ) {
+			*xmpAfterData = lastWasData;
+		} else {
+			objects->push_back ( file.substr ( offset, (size_t)objectSize ) );
+		}
+		lastWasData = (file.compare ( offset, 16, kASF_DataGUID, 16 ) == 0);
+		offset += (size_t)objectSize;
+	}
+
+	if ( objects->empty() || ((*objects)[0].size() < (kASF_FileSizeOffset + 8)) ) return false;
+	if ( GetUns64LE ( (*objects)[0], kASF_FileSizeOffset ) != file.size() ) return false;
+	(*objects)[0].replace ( kASF_FileSizeOffset, 8, 8, '\0' );
+	return true;
+
+}	// CollectASFObjects
+
+static size_t CheckASFObjects ( const char * fixture, const char * step, const string & original, const string & path )
+{
+	string updated;
+	vector<string> originalObjects, updatedObjects;
+	bool originalXMP, updatedXMP;
+	ReadWholeFile ( path, &updated );
+	CollectASFObjects ( original, &originalObjects, &originalXMP );
+	bool ok = CollectASFObjects ( updated, &updatedObjects, &updatedXMP );
+	string what = string ( step ) + ", objects cover the file and the XMP follows the data";
+	Check ( (ok && updatedXMP), fixture, what.c_str() );
+	what = string ( step ) + ", other objects unchanged";
+	Check ( ((originalObjects.size() == 3) && (originalObjects == updatedObjects)), fixture, what.c_str() );
+	return updated.size();
+}	// CheckASFObjects
+
+static void CheckASF()
+{
+	const char * fixture = "Synthetic.wmv";
+	string original, path = string ( "RoundTrip-" ) + fixture;
+	BuildASF ( &original );
+	if ( ! WriteWholeFile ( path, original ) ) {
+		Check ( false, fixture, "write the file" );
+		return;
+	}
+
+	UpdateFileXMP ( fixture, path, "add the XMP", 100 );
+	CheckASFObjects ( fixture, "add the XMP", original, path );
+	UpdateFileXMP ( fixture, path, "grow by 64K", 64*1024 );
+	size_t grownSize = CheckASFObjects ( fixture, "grow by 64K", original, path );
+	UpdateFileXMP ( fixture, path, "grow within the reserve", (64*1024 + 4*1024) );
+	size_t reserveSize = CheckASFObjects ( fixture, "grow within the reserve", original, path );
+	Check ( (reserveSize == grownSize), fixture, "growth absorbed by the reserve" );
+	UpdateFileXMP ( fixture, path, "shrink", 0 );
+	size_t shrunkSize = CheckASFObjects ( fixture, "shrink", original, path );
+	Check ( (shrunkSize == grownSize), fixture, "smaller XMP padded in place" );
+
+	remove ( path.c_str() );
+
+}	// CheckASF
+
+// =================================================================================================
+
+extern "C" int main ( int argc, const char * argv[] )
+{
+	if ( argc > 1 ) {
+		sTestFolder = argv[1];
+		if ( (! sTestFolder.empty()) && (sTestFolder[sTestFolder.size()-1] != '/') ) sTestFolder += '/';
+	}
+
+	if ( ! SXMPMeta::Initialize() ) {
+		fprintf ( stderr, "## SXMPMeta::Initialize failed!\n" );
+		return -1;
+	}
+	XMP_OptionBits options = 0;
+	#if UNIX_ENV
+		options |= kXMPFiles_ServerMode;
+	#endif
+	if ( ! SXMPFiles::Initialize ( options ) ) {
+		fprintf ( stderr, "## SXMPFiles::Initialize failed!\n" );
+		return -1;
+	}
+
+	SXMPMeta::RegisterNamespace ( kNS_RoundTrip, "rt", 0 );
+
+	try {
+
+		ForEachFixture ( "Diff and ApplyDiff", CheckDiff );
+		ForEachFixture ( "Reset and SXMPMetaPool", CheckReset );
+		CheckBatch();
+		ForEachFixture ( "GetSerializedSize and SerializeToRegion", CheckRegion );
+
+		WriteMinorLabel ( "Iteration" );
+		CheckIteration();
+
+		WriteMinorLabel ( "Base 64" );
+		CheckBase64();
+
+		WriteMinorLabel ( "MPEG-4 lazy moov" );
+		CheckMPEG4 ( "BlueSquare.mov" );
+		CheckSyntheticMPEG4 ( "Synthetic.mov", true, false );
+		CheckSyntheticMPEG4 ( "SyntheticTimecode.mov", true, true );
+		CheckSyntheticMPEG4 ( "Synthetic.mp4", false, false );
+
+		WriteMinorLabel ( "TIFF in place growth" );
+		CheckTIFF ( "BlueSquare.tif" );
+
+		WriteMinorLabel ( "Photoshop in place growth" );
+		CheckPSD ( "BlueSquare.psd" );
+
+		WriteMinorLabel ( "CRC-32" );
+		CheckPNG ( "BlueSquare.png" );
+		CheckUCF();
+
+		WriteMinorLabel ( "MP3 in place growth" );
+		CheckMP3 ( "BlueSquare.mp3" );
+
+		WriteMinorLabel ( "ASF in place growth" );
+		CheckASF();
+
+	} catch ( XMP_Error & excep ) {
+
+		fprintf ( sLogFile, "\n## Caught XMP_Error %d : %s\n", excep.GetID(), excep.GetErrMsg() );
+		++sFailures;
+
+	} catch ( ... ) {
+
+		fprintf ( sLogFile, "\n## Caught unknown exception\n" );
+		++sFailures;
+
+	}
+
+	SXMPMetaPool::Clear();
+	SXMPFiles::Terminate();
+	SXMPMeta::Terminate();
+
+	fprintf ( sLogFile, "\nRoundTripCorrectness finished, %d failures\n", sFailures );
+	return sFailures;
+
+}
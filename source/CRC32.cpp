@@ -0,0 +1,375 @@
+// =================================================================================================
+// Copyright Adobe
+// Copyright 2024 Adobe
+// All Rights Reserved
+//
+// NOTICE:  Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it.
+// =================================================================================================
+
+#include "public/include/XMP_Environment.h"	// ! XMP_Environment.h must be the first included header.
+
+#include "public/include/XMP_Const.h"
+
+#include "source/CRC32.hpp"
+
+// =================================================================================================
+// Hardware selection
+// ==================
+//
+// The hardware code is compiled with function level target attributes, so that no special compiler
+// options are needed and the library still runs on processors without the instructions.
+
+#define CRC32_HaveCLMUL 0
+#define CRC32_HaveARMv8 0
+
+#if XMP_CRC32_UseHardware
+
+	#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+		#undef  CRC32_HaveCLMUL
+		#define CRC32_HaveCLMUL 1
+		#define CRC32_TargetCLMUL __attribute__ ((target ( "pclmul,sse4.1" )))
+		#include <immintrin.h>
+	#elif (defined(_M_X64) || defined(_M_IX86)) && defined(_MSC_VER)
+		#undef  CRC32_HaveCLMUL
+		#define CRC32_HaveCLMUL 1
+		#define CRC32_TargetCLMUL
+		#include <intrin.h>
+	#endif
+
+	#if defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+		#if XMP_UNIXBuild | XMP_AndroidBuild
+			#include <sys/auxv.h>
+			#include <asm/hwcap.h>
+			#undef  CRC32_HaveARMv8
+			#define CRC32_HaveARMv8 1
+		#elif XMP_MacBuild | XMP_iOSBuild
+			#include <sys/sysctl.h>
+			#undef  CRC32_HaveARMv8
+			#define CRC32_HaveARMv8 1
+		#endif
+		#if CRC32_HaveARMv8
+			#if defined(__clang__)
+				#define CRC32_TargetARMv8 __attribute__ ((target ( "crc" )))
+			#else
+				#define CRC32_TargetARMv8 __attribute__ ((target ( "+crc" )))
+			#endif
+			#include <arm_acle.h>
+		#endif
+	#endif
+
+#endif
+
+// =================================================================================================
+// Slicing-by-8 tables
+// ===================
+//
+// Table 0 is the classic byte at a time table for the reflected polynomial 0xEDB88320. Table k
+// gives the CRC of a byte followed by k zero bytes, so 8 bytes are folded with 8 independent loads.
+
+struct CRC32_Tables {
+
+	XMP_Uns32 t [8] [256];
+
+	CRC32_Tables()
+	{
+		for ( XMP_Uns32 n = 0; n < 256; ++n ) {
+			XMP_Uns32 c = n;
+			for ( int k = 0; k < 8; ++k ) c = (c & 1) ? (0xEDB88320UL ^ (c >> 1)) : (c >> 1);
+			this->t[0][n] = c;
+		}
+		for ( XMP_Uns32 n = 0; n < 256; ++n ) {
+			XMP_Uns32 c = this->t[0][n];
+			for ( int k = 1; k < 8; ++k ) {
+				c = this->t[0][c & 0xFF] ^ (c >> 8);
+				this->t[k][n] = c;
+			}
+		}
+	}
+
+};
+
+static const CRC32_Tables & GetTables()
+{
+	static const CRC32_Tables sTables;	// ! Initialized once, on first use, thread safe in C++11.
+	return sTables;
+}
+
+// =================================================================================================
+// UpdateSlicing8
+// ==============
+//
+// Works on the inverted CRC register. The words are assembled from bytes, that is endian neutral and
+// compilers turn it into single loads on little endian hosts.
+
+static XMP_Uns32 UpdateSlicing8 ( XMP_Uns32 crc, const XMP_Uns8 * data, size_t length )
+{
+	const XMP_Uns32 (* t) [256] = GetTables().t;
+
+	while ( (length > 0) && ((((size_t)data) & 7) != 0) ) {
+		crc = t[0][(crc ^ *data) & 0xFF] ^ (crc >> 8);
+		++data;
+		--length;
+	}
+
+	for ( ; length >= 8; data += 8, length -= 8 ) {
+		XMP_Uns32 lo = crc ^ ((XMP_Uns32)data[0] | ((XMP_Uns32)data[1] << 8) |
+							  ((XMP_Uns32)data[2] << 16) | ((XMP_Uns32)data[3] << 24));
+		XMP_Uns32 hi = (XMP_Uns32)data[4] | ((XMP_Uns32)data[5] << 8) |
+					   ((XMP_Uns32)data[6] << 16) | ((XMP_Uns32)data[7] << 24);
+		crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+			  t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+	}
+
+	for ( ; length > 0; ++data, --length ) {
+		crc = t[0][(crc ^ *data) & 0xFF] ^ (crc >> 8);
+	}
+
+	return crc;
+
+}	// UpdateSlicing8
+
+// =================================================================================================
+// UpdateCLMUL
+// ===========
+//
+// Folds 64 bytes at a time with carryless multiplication, then reduces to 32 bits with a Barrett
+// reduction. This is the method of Intel's "Fast CRC Computation for Generic Polynomials Using
+// PCLMULQDQ Instruction", with the bit reflected constants for 0xEDB88320. Works on the inverted
+// CRC register, the length must be a multiple of 16 and at least 64.
+
+#if CRC32_HaveCLMUL
+
+static const size_t kMinCLMULLength = 64;
+
+CRC32_TargetCLMUL
+static XMP_Uns32 UpdateCLMUL ( XMP_Uns32 crc, const XMP_Uns8 * data, size_t length )
+{
+	const __m128i k1k2 = _mm_set_epi64x ( 0x01C6E41596LL, 0x0154442BD4LL );
+	const __m128i k3k4 = _mm_set_epi64x ( 0x00CCAA009ELL, 0x01751997D0LL );
+	const __m128i k5k0 = _mm_set_epi64x ( 0x0000000000LL, 0x0163CD6124LL );
+	const __m128i poly = _mm_set_epi64x ( 0x01F7011641LL, 0x01DB710641LL );
+	const __m128i mask = _mm_setr_epi32 ( ~0, 0, ~0, 0 );
+
+	__m128i x1 = _mm_loadu_si128 ( (const __m128i*)(data + 0x00) );
+	__m128i x2 = _mm_loadu_si128 ( (const __m128i*)(data + 0x10) );
+	__m128i x3 = _mm_loadu_si128 ( (const __m128i*)(data + 0x20) );
+	__m128i x4 = _mm_loadu_si128 ( (const __m128i*)(data + 0x30) );
+	__m128i x5, x6, x7, x8;
+
+	x1 = _mm_xor_si128 ( x1, _mm_cvtsi32_si128 ( (int)crc ) );
+	data += 64;
+	length -= 64;
+
+	for ( ; length >= 64; data += 64, length -= 64 ) {	// Fold 4 lanes in parallel.
+
+		x5 = _mm_clmulepi64_si128 ( x1, k1k2, 0x00 );
+		x6 = _mm_clmulepi64_si128 ( x2, k1k2, 0x00 );
+		x7 = _mm_clmulepi64_si128 ( x3, k1k2, 0x00 );
+		x8 = _mm_clmulepi64_si128 ( x4, k1k2, 0x00 );
+
+		x1 = _mm_clmulepi64_si128 ( x1, k1k2, 0x11 );
+		x2 = _mm_clmulepi64_si128 ( x2, k1k2, 0x11 );
+		x3 = _mm_clmulepi64_si128 ( x3, k1k2, 0x11 );
+		x4 = _mm_clmulepi64_si128 ( x4, k1k2, 0x11 );
+
+		x1 = _mm_xor_si128 ( _mm_xor_si128 ( x1, x5 ), _mm_loadu_si128 ( (const __m128i*)(data + 0x00) ) );
+		x2 = _mm_xor_si128 ( _mm_xor_si128 ( x2, x6 ), _mm_loadu_si128 ( (const __m128i*)(data + 0x10) ) );
+		x3 = _mm_xor_si128 ( _mm_xor_si128 ( x3, x7 ), _mm_loadu_si128 ( (const __m128i*)(data + 0x20) ) );
+		x4 = _mm_xor_si128 ( _mm_xor_si128 ( x4, x8 ), _mm_loadu_si128 ( (const __m128i*)(data + 0x30) ) );
+
+	}
+
+	// Fold the 4 lanes into one, then any remaining 16 byte blocks.
+
+	x5 = _mm_clmulepi64_si128 ( x1, k3k4, 0x00 );
+	x1 = _mm_clmulepi64_si128 ( x1, k3k4, 0x11 );
+	x1 = _mm_xor_si128 ( _mm_xor_si128 ( x1, x2 ), x5 );
+
+	x5 = _mm_clmulepi64_si128 ( x1, k3k4, 0x00 );
+	x1 = _mm_clmulepi64_si128 ( x1, k3k4, 0x11 );
+	x1 = _mm_xor_si128 ( _mm_xor_si128 ( x1, x3 ), x5 );
+
+	x5 = _mm_clmulepi64_si128 ( x1, k3k4, 0x00 );
+	x1 = _mm_clmulepi64_si128 ( x1, k3k4, 0x11 );
+	x1 = _mm_xor_si128 ( _mm_xor_si128 ( x1, x4 ), x5 );
+
+	for ( ; length >= 16; data += 16, length -= 16 ) {
+		x5 = _mm_clmulepi64_si128 ( x1, k3k4, 0x00 );
+		x1 = _mm_clmulepi64_si128 ( x1, k3k4, 0x11 );
+		x1 = _mm_xor_si128 ( _mm_xor_si128 ( x1, _mm_loadu_si128 ( (const __m128i*)data ) ), x5 );
+	}
+
+	// Fold 128 bits to 64, then Barrett reduce to 32.
+
+	x2 = _mm_clmulepi64_si128 ( x1, k3k4, 0x10 );
+	x1 = _mm_xor_si128 ( _mm_srli_si128 ( x1, 8 ), x2 );
+
+	x2 = _mm_srli_si128 ( x1, 4 );
+	x1 = _mm_and_si128 ( x1, mask );
+	x1 = _mm_clmulepi64_si128 ( x1, k5k0, 0x00 );
+	x1 = _mm_xor_si128 ( x1, x2 );
+
+	x2 = _mm_and_si128 ( x1, mask );
+	x2 = _mm_clmulepi64_si128 ( x2, poly, 0x10 );
+	x2 = _mm_and_si128 ( x2, mask );
+	x2 = _mm_clmulepi64_si128 ( x2, poly, 0x00 );
+	x1 = _mm_xor_si128 ( x1, x2 );
+
+	return (XMP_Uns32) _mm_extract_epi32 ( x1, 1 );
+
+}	// UpdateCLMUL
+
+static bool HaveCLMUL()
+{
+	#if defined(_MSC_VER) && ! defined(__clang__)
+		int info[4];
+		__cpuid ( info, 1 );
+		return ((info[2] & (1 << 1)) != 0) && ((info[2] & (1 << 19)) != 0);	// PCLMULQDQ and SSE4.1.
+	#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports ( "pclmul" ) && __builtin_cpu_supports ( "sse4.1" );
+	#endif
+}
+
+#endif	// CRC32_HaveCLMUL
+
+// =================================================================================================
+// UpdateARMv8
+// ===========
+//
+// The ARMv8 CRC32 instructions use the same polynomial as zip and PNG, not the CRC32C one. Works on
+// the inverted CRC register.
+
+#if CRC32_HaveARMv8
+
+CRC32_TargetARMv8
+static XMP_Uns32 UpdateARMv8 ( XMP_Uns32 crc, const XMP_Uns8 * data, size_t length )
+{
+	while ( (length > 0) && ((((size_t)data) & 7) != 0) ) {
+		crc = __crc32b ( crc, *data );
+		++data;
+		--length;
+	}
+
+	for ( ; length >= 32; data += 32, length -= 32 ) {
+		crc = __crc32d ( crc, *((const XMP_Uns64*)(data + 0)) );	// ! Aligned, the host is little endian.
+		crc = __crc32d ( crc, *((const XMP_Uns64*)(data + 8)) );
+		crc = __crc32d ( crc, *((const XMP_Uns64*)(data + 16)) );
+		crc = __crc32d ( crc, *((const XMP_Uns64*)(data + 24)) );
+	}
+
+	for ( ; length >= 8; data += 8, length -= 8 ) {
+		crc = __crc32d ( crc, *((const XMP_Uns64*)data) );
+	}
+
+	for ( ; length > 0; ++data, --length ) {
+		crc = __crc32b ( crc, *data );
+	}
+
+	return crc;
+
+}	// UpdateARMv8
+
+static bool HaveARMv8()
+{
+	#if XMP_UNIXBuild | XMP_AndroidBuild
+		return (getauxval ( AT_HWCAP ) & HWCAP_CRC32) != 0;
+	#else
+		int value = 0;
+		size_t size = sizeof(value);
+		if ( sysctlbyname ( "hw.optional.armv8_crc32", &value, &size, 0, 0 ) != 0 ) return false;
+		return (value != 0);
+	#endif
+}
+
+#endif	// CRC32_HaveARMv8
+
+// =================================================================================================
+// Dispatch
+// ========
+
+enum { kUsePortable = 0, kUseCLMUL = 1, kUseARMv8 = 2 };
+
+static int SelectImplementation()
+{
+	#if CRC32_HaveCLMUL
+		if ( HaveCLMUL() ) return kUseCLMUL;
+	#endif
+	#if CRC32_HaveARMv8
+		if ( HaveARMv8() ) return kUseARMv8;
+	#endif
+	return kUsePortable;
+}
+
+static int GetSelection()
+{
+	static const int sSelection = SelectImplementation();	// ! Checked once, thread safe in C++11.
+	return sSelection;
+}
+
+// =================================================================================================
+// CRC32::UpdatePortable
+// =====================
+
+XMP_Uns32 CRC32::UpdatePortable ( XMP_Uns32 crc, const void * data, size_t length )
+{
+	if ( (data == 0) || (length == 0) ) return crc;
+	return ~UpdateSlicing8 ( ~crc, (const XMP_Uns8*)data, length );
+
+}	// CRC32::UpdatePortable
+
+// =================================================================================================
+// CRC32::Update
+// =============
+
+XMP_Uns32 CRC32::Update ( XMP_Uns32 crc, const void * data, size_t length )
+{
+	if ( (data == 0) || (length == 0) ) return crc;
+
+	const XMP_Uns8 * bytes = (const XMP_Uns8*)data;
+	crc = ~crc;
+
+	switch ( GetSelection() ) {
+
+		#if CRC32_HaveCLMUL
+		case kUseCLMUL :
+			if ( length >= kMinCLMULLength ) {
+				size_t blockLength = length & ~((size_t)15);
+				crc = UpdateCLMUL ( crc, bytes, blockLength );
+				bytes += blockLength;
+				length -= blockLength;
+			}
+			crc = UpdateSlicing8 ( crc, bytes, length );
+			break;
+		#endif
+
+		#if CRC32_HaveARMv8
+		case kUseARMv8 :
+			crc = UpdateARMv8 ( crc, bytes, length );
+			break;
+		#endif
+
+		default :
+			crc = UpdateSlicing8 ( crc, bytes, length );
+			break;
+
+	}
+
+	return ~crc;
+
+}	// CRC32::Update
+
+// =================================================================================================
+// CRC32::GetImplementation
+// ========================
+
+const char * CRC32::GetImplementation()
+{
+	switch ( GetSelection() ) {
+		case kUseCLMUL : return "PCLMULQDQ";
+		case kUseARMv8 : return "ARMv8 CRC32";
+		default        : return "slicing-by-8";
+	}
+
+}	// CRC32::GetImplementation
@@ -0,0 +1,50 @@
+#ifndef __CRC32_hpp__
+#define __CRC32_hpp__ 1
+
+// =================================================================================================
+// Copyright Adobe
+// Copyright 2024 Adobe
+// All Rights Reserved
+//
+// NOTICE:  Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it.
+// =================================================================================================
+
+#include "public/include/XMP_Environment.h"	// ! XMP_Environment.h must be the first included header.
+
+#include "public/include/XMP_Const.h"
+
+#include <cstddef>
+
+// =================================================================================================
+// CRC-32
+// ======
+//
+// The CRC-32 of ISO 3309 and ITU-T V.42, as used by PNG chunks and zip headers. The results match
+// zlib's crc32: Update takes the CRC of the preceding data, 0 to begin, and returns the CRC with the
+// new data included.
+//
+// The work is done by carryless multiplication (PCLMULQDQ) on x86, by the CRC32 instructions on
+// 64 bit ARM, else by slicing-by-8 tables. The hardware is checked once at run time. Define
+// XMP_CRC32_UseHardware as 0 to build with only the portable code.
+
+#ifndef XMP_CRC32_UseHardware
+	#define XMP_CRC32_UseHardware 1
+#endif
+
+namespace CRC32 {
+
+	extern XMP_Uns32 Update ( XMP_Uns32 crc, const void * data, size_t length );
+
+	static inline XMP_Uns32 Compute ( const void * data, size_t length )
+	{
+		return Update ( 0, data, length );
+	}
+
+	extern XMP_Uns32 UpdatePortable ( XMP_Uns32 crc, const void * data, size_t length );	// Always slicing-by-8.
+
+	extern const char * GetImplementation();	// A short name for the code Update is using.
+
+};	// CRC32
+
+#endif	// __CRC32_hpp__
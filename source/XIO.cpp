@@ -16,6 +16,8 @@
 #include "source/XMP_LibUtils.hpp"
 #include "source/UnicodeConversions.hpp"
 
+#include <vector>
+
 #if XMP_WinBuild
 	#pragma warning ( disable : 4800 )	// forcing value to bool 'true' or 'false' (performance warning)
 #endif
@@ -178,13 +180,25 @@ void XIO::Copy ( XMP_IO* sourceFile, XMP_IO* destFile, XMP_Int64 length,
 //
 // * however can also be used to move data between two files *
 // (having both option is handy for flexible use in update()/re-write() handler routines)
+//
+// Large moves use a 1 MB heap buffer, shifting media data is then dominated by the transfer rather
+// than by the number of seeks and calls. Small moves keep to a buffer on the stack.
 
 void XIO::Move ( XMP_IO* srcFile, XMP_Int64 srcOffset,
 				 XMP_IO* dstFile, XMP_Int64 dstOffset,
 				 XMP_Int64 length, XMP_AbortProc abortProc /* = 0 */, void * abortArg /* = 0 */ )
 {
-	enum { kBufferLen = 64*1024 };
-	XMP_Uns8 buffer [kBufferLen];
+	enum { kStackBufferLen = 64*1024, kHeapBufferLen = 1024*1024 };
+	XMP_Uns8 stackBuffer [kStackBufferLen];
+	std::vector<XMP_Uns8> heapBuffer;
+
+	XMP_Uns8 * buffer = stackBuffer;
+	XMP_Int32 bufferLen = kStackBufferLen;
+	if ( length > kStackBufferLen ) {
+		bufferLen = (length < kHeapBufferLen) ? (XMP_Int32)length : (XMP_Int32)kHeapBufferLen;
+		heapBuffer.resize ( bufferLen );
+		buffer = &heapBuffer[0];
+	}
 
 	const bool checkAbort = (abortProc != 0);
 
@@ -195,8 +209,8 @@ void XIO::Move ( XMP_IO* srcFile, XMP_Int64 srcOffset,
 		while ( length > 0 ) {
 
 			if ( checkAbort && abortProc(abortArg) ) XMP_Throw ( "XIO::Move - User abort", kXMPErr_UserAbort );
-			XMP_Int32 ioCount = kBufferLen;
-			if ( length < kBufferLen ) ioCount = (XMP_Int32)length; //smartly avoids 32/64 bit issues
+			XMP_Int32 ioCount = bufferLen;
+			if ( length < bufferLen ) ioCount = (XMP_Int32)length; //smartly avoids 32/64 bit issues
 
 			srcFile->Seek ( srcOffset, kXMP_SeekFromStart );
 			srcFile->ReadAll ( buffer, ioCount );
@@ -217,8 +231,8 @@ void XIO::Move ( XMP_IO* srcFile, XMP_Int64 srcOffset,
 		while ( length > 0 ) {
 
 			if ( checkAbort && abortProc(abortArg) ) XMP_Throw ( "XIO::Move - User abort", kXMPErr_UserAbort );
-			XMP_Int32 ioCount = kBufferLen;
-			if ( length < kBufferLen ) ioCount = (XMP_Int32)length; //smartly avoids 32/64 bit issues
+			XMP_Int32 ioCount = bufferLen;
+			if ( length < bufferLen ) ioCount = (XMP_Int32)length; //smartly avoids 32/64 bit issues
 
 			srcOffset -= ioCount;
 			dstOffset -= ioCount;